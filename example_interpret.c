@@ -0,0 +1,1327 @@
+/*
+ *    example_interpret.c    --    driver and benchmarks for KAPPA's interpreter.
+ *
+ *    Authored by Karl "p0lyh3dron" Kreuze on October 18, 2026
+ *
+ *    This file is part of the KAPPA project.
+ *
+ *    Renders fractal.kasm through the embedding API, or with a command
+ *    first, runs one of the interpreter's benchmarks and differential
+ *    tests, reaching into its internals where a test needs them.
+ *
+ *    Usage: example_interpret [bench|ngrams|jit|aot|load|lanes|render|slices|kinds|hosts] [...]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "libk_interpret_internal.h"
+
+/* Modules lowered to C ahead of time are loaded as shared objects where there is a dynamic loader.  */
+#if defined(__unix__) && !defined(K_NO_AOT)
+#define _K_AOT 1
+#include <dlfcn.h>
+#endif
+
+/* A call the differential test of the compiler makes, over a range of arguments.  */
+typedef struct {
+    int         module;
+    const char *func;
+    const char *args;
+    double      lo;
+    double      hi;
+    char        ret;
+} _k_case_t;
+
+double _k_seconds() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+ *    Sets up a call to one of the benchmark kernels, fib(90), z(), or
+ *    escape() at a point that never escapes, running all 64 iterations.
+ *
+ *    @param _k_interp_t *interp    The interpreter holding the kernel.
+ *    @param int kernel             0 for fib, 1 for z, 2 for escape.
+ *    @param float *z               Storage for z's arguments, live until the call returns.
+ */
+void _k_bench_call(_k_interp_t *interp, int kernel, float *z) {
+    long   n        = 90;
+    double c[2]     = { -0.5, 0.0 };
+    float *real_ptr = &z[0];
+    float *imag_ptr = &z[1];
+
+    z[0] = 0.25;
+    z[1] = 0.5;
+
+    if (kernel == 0) {
+        call(interp, "fib");
+        push(interp, &n, sizeof(long));
+    } else if (kernel == 2) {
+        call(interp, "escape");
+        push(interp, &c[0], sizeof(double));
+        push(interp, &c[1], sizeof(double));
+    } else {
+        call(interp, "z");
+        push(interp, &real_ptr, sizeof(float*));
+        push(interp, &imag_ptr, sizeof(float*));
+    }
+}
+
+/*
+ *    Times fib(90) from fib.kasm, and z() and escape() from fractal.kasm,
+ *    under the reference dispatch, one indirect call per instruction,
+ *    under the main loop, traced and tiered from fresh loads, and compiled
+ *    to native code up front, reporting nanoseconds per instruction the
+ *    interpreter executes.
+ */
+int _k_bench(const char *fib_path, const char *fractal_path, long runs) {
+    for (int k = 0; k < 3; k++) {
+        _k_interp_t *interp = _k_load(k == 0 ? fib_path : fractal_path, (_k_host_t*)0x0);
+        _k_interp_t *traced = _k_load(k == 0 ? fib_path : fractal_path, (_k_host_t*)0x0);
+        _k_interp_t *tiered = _k_load(k == 0 ? fib_path : fractal_path, (_k_host_t*)0x0);
+        long         insts  = 0;
+        long         funcs  = 0;
+        long         loops  = 0;
+        double       times[5];
+
+        if (interp == (_k_interp_t*)0x0 || traced == (_k_interp_t*)0x0 || tiered == (_k_interp_t*)0x0) return 1;
+
+        interp->module->tiered  = 0;
+        interp->module->tracing = 0;
+        traced->module->tiered  = 0;
+
+        for (int mode = 0; mode < 5; mode++) {
+            _k_interp_t *run = mode == 2 ? traced : mode == 3 ? tiered : interp;
+
+            if (mode == 4) funcs = _k_jit(interp);
+
+            double begin = _k_seconds();
+
+            for (long i = 0; i < runs; i++) {
+                float z[2];
+
+                _k_bench_call(run, k, z);
+
+                if (mode == 0) _k_loop_calls(run, run->frames, &insts, (_k_grams_t*)0x0);
+                else           loop(run, run->frames);
+            }
+
+            times[mode] = _k_seconds() - begin;
+        }
+
+        for (long i = 0; i < traced->module->inst_count; i++) loops += traced->module->insts[i].op == _K_INST_LOOPT;
+
+        fprintf(stderr, "%-8s %10ld instructions: calls %6.2f ns/inst, %s %6.2f ns/inst (%.2fx), traced %6.2f ns/inst (%.2fx, %ld loops), "
+                "tiered %6.2f ns/inst (%.2fx), native %6.2f ns/inst (%.2fx, %ld functions)\n",
+                k == 0 ? "fib(90)" : k == 1 ? "z()" : "escape()", insts, times[0] * 1e9 / insts,
+#ifdef _K_THREADED
+                "threaded",
+#else
+                "switch",
+#endif
+                times[1] * 1e9 / insts, times[0] / times[1], times[2] * 1e9 / insts, times[0] / times[2], loops,
+                times[3] * 1e9 / insts, times[0] / times[3], times[4] * 1e9 / insts, times[0] / times[4], funcs);
+
+        _k_unload(interp);
+        _k_unload(traced);
+        _k_unload(tiered);
+    }
+
+    return 0;
+}
+
+/*
+ *    Profiles the benchmark kernels under the reference dispatch, and
+ *    prints the runs of n adjacent instructions they execute most, the
+ *    candidates for superinstructions.
+ */
+int _k_ngrams(const char *fib_path, const char *fractal_path, int n, long runs) {
+    _k_interp_t *fib     = _k_load(fib_path, (_k_host_t*)0x0);
+    _k_interp_t *fractal = _k_load(fractal_path, (_k_host_t*)0x0);
+
+    if (fib == (_k_interp_t*)0x0 || fractal == (_k_interp_t*)0x0 || n < 1 || n * _K_GRAM_BITS > 60) return 1;
+
+    _k_grams_t grams = { n, 0, 0, (void*)0x0, calloc(_K_GRAM_BUCKETS, sizeof(unsigned long)), calloc(_K_GRAM_BUCKETS, sizeof(long)), 0, 0, 0, 0 };
+    long       insts = 0;
+
+    for (int k = 0; k < 2; k++) {
+        _k_interp_t *interp = k == 0 ? fib : fractal;
+
+        for (long i = 0; i < runs; i++) {
+            float z[2];
+
+            _k_bench_call(interp, k, z);
+            _k_loop_calls(interp, interp->frames, &insts, &grams);
+        }
+    }
+
+    fprintf(stderr, "%ld instructions in %ld dispatches, %ld %d-grams (%ld distinct)\n", insts, grams.dispatches, grams.total, n, grams.distinct);
+
+    /* Prints the most frequent first, taking each out of the table once printed.  */
+    for (int rank = 0; rank < 24; rank++) {
+        long best = -1;
+
+        for (long h = 0; h < _K_GRAM_BUCKETS; h++) {
+            if (grams.counts[h] > 0 && (best < 0 || grams.counts[h] > grams.counts[best])) best = h;
+        }
+
+        if (best < 0) break;
+
+        fprintf(stderr, "%10ld %5.1f%% ", grams.counts[best], 100.0 * grams.counts[best] / grams.total);
+
+        for (int k = n - 1; k >= 0; k--) {
+            fprintf(stderr, " %s", _k_inst_list[((grams.keys[best] - 1) >> (_K_GRAM_BITS * k)) & ((1 << _K_GRAM_BITS) - 1)].name + 1);
+        }
+
+        fprintf(stderr, "\n");
+
+        grams.counts[best] = 0;
+    }
+
+    free(grams.keys);
+    free(grams.counts);
+
+    return 0;
+}
+
+/* Calls the differential test makes: the module, the function, its argument kinds, the range they sweep and its result's kind.  */
+const _k_case_t _k_jit_cases[] = {
+    {0, "fib", "i", 0, 90, 'i'},        {0, "factorial", "i", 1, 20, 'i'},  {0, "cos_approx", "f", -4, 4, 'f'},
+    {0, "cos", "f", -20, 20, 'f'},      {0, "sin", "f", -20, 20, 'f'},
+    {1, "cos_approx", "f", -4, 4, 'f'}, {1, "cos", "f", -20, 20, 'f'},      {1, "sin", "f", -20, 20, 'f'},
+    {1, "ipow", "fi", 0, 12, 'f'},      {1, "fact", "i", 0, 12, 'w'},       {1, "exp", "f", -8, 8, 'f'},
+    {1, "log", "f", 0.01, 50, 'f'},     {1, "pow", "ff", 0.1, 9, 'f'},      {1, "cosh", "f", -5, 5, 'f'},
+    {1, "sinh", "f", -5, 5, 'f'},
+    {2, "cos", "f", -20, 20, 'f'},      {2, "sin", "f", -20, 20, 'f'},      {2, "ipow", "fi", 0, 12, 'f'},
+    {2, "exp", "f", -8, 8, 'f'},        {2, "log", "f", 0.01, 50, 'f'},     {2, "pow", "ff", 0.1, 9, 'f'},
+    {2, "sinz", "pp", -3, 3, 'f'},      {2, "rmin", "", 0, 0, 'f'},         {2, "imax", "", 0, 0, 'f'},
+    {2, "abs", "f", -5, 5, 'f'},        {2, "z", "pp", -2, 2, 'f'},         {2, "escape", "ff", -2.3, 1, 'w'},
+};
+
+/*
+ *    Runs each module interpreted, compiled up front, tiered and traced
+ *    side by side, calling the functions in _k_jit_cases over their
+ *    argument ranges, and reports every call whose result, or the floats
+ *    it wrote through pointers, differ by a single bit. The tiered copy
+ *    promotes functions as they turn hot, some in the middle of a loop,
+ *    and the traced copy only compiles the paths its hot loops take.
+ *
+ *    @return int    0 if every call matched.
+ */
+int _k_jit_diff(const char **paths, long steps) {
+    const char  *names[4] = { "interpreted", "native", "tiered", "traced" };
+    _k_interp_t *interps[3][4];
+    long         calls      = 0;
+    long         mismatches = 0;
+
+    for (int m = 0; m < 3; m++) {
+        for (int v = 0; v < 4; v++) {
+            if ((interps[m][v] = _k_load(paths[m], (_k_host_t*)0x0)) == (_k_interp_t*)0x0) return 1;
+        }
+
+        interps[m][0]->module->tiered  = 0;
+        interps[m][0]->module->tracing = 0;
+        interps[m][3]->module->tiered  = 0;
+
+        fprintf(stderr, "%s: %ld functions compiled\n", paths[m], _k_jit(interps[m][1]));
+    }
+
+    for (unsigned long c = 0; c < sizeof(_k_jit_cases) / sizeof(_k_jit_cases[0]); c++) {
+        const _k_case_t *test = &_k_jit_cases[c];
+        long             bad  = 0;
+
+        for (long k = 0; k < steps; k++) {
+            double results[4];
+            float  cells[4][4];
+
+            for (int v = 0; v < 4; v++) {
+                _k_interp_t *interp = interps[test->module][v];
+
+                if (call(interp, (char*)test->func)) return 1;
+
+                for (int j = 0; test->args[j] != '\0'; j++) {
+                    double x = test->lo + (test->hi - test->lo) * k / (steps > 1 ? steps - 1 : 1) + 0.25 * j;
+                    long   n = (long)x;
+                    float *p = &cells[v][j];
+
+                    cells[v][j] = x;
+
+                    if (test->args[j] == 'i')      push(interp, &n, sizeof(long));
+                    else if (test->args[j] == 'f') push(interp, &x, sizeof(double));
+                    else                           push(interp, &p, sizeof(float*));
+                }
+
+                results[v] = loop(interp, interp->frames);
+            }
+
+            for (int v = 1; v < 4; v++) {
+                calls++;
+
+                if (memcmp(&results[0], &results[v], sizeof(double)) == 0 && memcmp(cells[0], cells[v], sizeof(float) * strlen(test->args)) == 0) continue;
+
+                if (bad++ == 0) {
+                    fprintf(stderr, "%s: %s step %ld: interpreted %.9g, %s %.9g\n", paths[test->module], test->func, k, results[0], names[v], results[v]);
+                }
+            }
+        }
+
+        mismatches += bad;
+    }
+
+    for (int m = 0; m < 3; m++) {
+        long promoted = 0;
+        long traced   = 0;
+
+        for (long i = 0; i < interps[m][2]->module->inst_count; i++) promoted += interps[m][2]->module->insts[i].op == _K_INST_FRNAT;
+        for (long i = 0; i < interps[m][3]->module->inst_count; i++) traced   += interps[m][3]->module->insts[i].op == _K_INST_LOOPT;
+
+        fprintf(stderr, "%s: %ld functions promoted, %ld loops traced\n", paths[m], promoted, traced);
+    }
+
+    fprintf(stderr, "%ld calls compared, %ld mismatches\n", calls, mismatches);
+
+    for (int m = 0; m < 3; m++) {
+        for (int v = 0; v < 4; v++) _k_unload(interps[m][v]);
+    }
+
+    return mismatches != 0;
+}
+
+#ifdef _K_AOT
+/*
+ *    Calls a function lowered to C with the arguments of a test case,
+ *    returning its result the way the interpreter leaves it in r0.
+ *
+ *    @param void            *fn      The lowered function.
+ *    @param const _k_case_t *test    The test case.
+ *    @param double          *x       The float arguments.
+ *    @param float          **p       The pointer arguments.
+ *
+ *    @return double    The result, integers bit for bit.
+ */
+double _k_aot_call(void *fn, const _k_case_t *test, double *x, float **p) {
+    const char *a = test->args;
+    double      r = 0.0;
+
+    if (test->ret == 'w') {
+        long w = a[0] == 'i' ? ((unsigned int (*)(unsigned int))fn)((long)x[0]) : ((unsigned int (*)(float, float))fn)(x[0], x[1]);
+
+        memcpy(&r, &w, sizeof(double));
+
+        return r;
+    }
+
+    if (a[0] == '\0')                 r = ((float (*)(void))fn)();
+    else if (strcmp(a, "f") == 0)     r = ((float (*)(float))fn)(x[0]);
+    else if (strcmp(a, "ff") == 0)    r = ((float (*)(float, float))fn)(x[0], x[1]);
+    else if (strcmp(a, "fi") == 0)    r = ((float (*)(float, unsigned int))fn)(x[0], (long)x[1]);
+    else if (strcmp(a, "pp") == 0)    r = ((float (*)(float*, float*))fn)(p[0], p[1]);
+
+    return r;
+}
+
+/*
+ *    Compares math.k and fractal.k lowered to C and built into shared
+ *    objects against the interpreter, calling the functions in
+ *    _k_jit_cases over their argument ranges. Reports every function
+ *    whose result, or the floats it wrote through pointers, differ,
+ *    and the time per call interpreted, tiered and in C.
+ *
+ *    @return int    0 if every call matched.
+ */
+int _k_bench_aot(const char **paths, const char **objects, long steps, long runs) {
+    _k_interp_t *interps[2][2];
+    void        *handles[2];
+    long         mismatches = 0;
+
+    for (int m = 0; m < 2; m++) {
+        if ((handles[m] = dlopen(objects[m], RTLD_NOW | RTLD_LOCAL)) == (void*)0x0) {
+            fprintf(stderr, "%s\n", dlerror());
+
+            return 1;
+        }
+
+        for (int v = 0; v < 2; v++) {
+            if ((interps[m][v] = _k_load(paths[m], (_k_host_t*)0x0)) == (_k_interp_t*)0x0) return 1;
+        }
+
+        interps[m][0]->module->tiered  = 0;
+        interps[m][0]->module->tracing = 0;
+    }
+
+    for (unsigned long c = 0; c < sizeof(_k_jit_cases) / sizeof(_k_jit_cases[0]); c++) {
+        const _k_case_t *test = &_k_jit_cases[c];
+        char             name[64];
+        double           times[3];
+        long             bad = 0;
+
+        if (test->module == 0) continue;
+
+        snprintf(name, sizeof(name), "kappa_%s", test->func);
+
+        void *fn = dlsym(handles[test->module - 1], name);
+
+        if (fn == (void*)0x0) {
+            fprintf(stderr, "%s: %s not found\n", objects[test->module - 1], name);
+
+            return 1;
+        }
+
+        /* Mode 0 and 1 run interpreted and tiered, mode 2 runs the C.  */
+        for (int mode = 0; mode < 3; mode++) {
+            _k_interp_t *interp = interps[test->module - 1][mode == 1];
+            double       begin  = _k_seconds();
+
+            for (long i = 0; i < runs; i++) {
+                long    k = i % steps;
+                double  x[4];
+                float   cells[4];
+                float  *p[4];
+                double  result;
+
+                for (int j = 0; test->args[j] != '\0'; j++) {
+                    x[j]     = test->lo + (test->hi - test->lo) * k / (steps > 1 ? steps - 1 : 1) + 0.25 * j;
+                    cells[j] = x[j];
+                    p[j]     = &cells[j];
+                }
+
+                if (mode < 2) {
+                    if (call(interp, (char*)test->func)) return 1;
+
+                    for (int j = 0; test->args[j] != '\0'; j++) {
+                        long n = (long)x[j];
+
+                        if (test->args[j] == 'i')      push(interp, &n, sizeof(long));
+                        else if (test->args[j] == 'f') push(interp, &x[j], sizeof(double));
+                        else                           push(interp, &p[j], sizeof(float*));
+                    }
+
+                    result = loop(interp, interp->frames);
+                } else {
+                    result = _k_aot_call(fn, test, x, p);
+                }
+
+                /* The first sweep of the interpreter is the reference the others are checked against.  */
+                static double expected[4096][3];
+
+                if (i >= steps || steps > 4096) continue;
+
+                if (mode == 0) {
+                    expected[k][0] = result;
+                    expected[k][1] = cells[0];
+                    expected[k][2] = cells[1];
+                } else if (memcmp(&expected[k][0], &result, sizeof(double)) != 0 ||
+                           (test->args[0] == 'p' && (expected[k][1] != cells[0] || expected[k][2] != cells[1]))) {
+                    if (bad++ == 0) fprintf(stderr, "%s: %s step %ld: interpreted %.9g, %s %.9g\n", paths[test->module - 1], test->func, k,
+                                            expected[k][0], mode == 1 ? "tiered" : "C", result);
+                }
+            }
+
+            times[mode] = _k_seconds() - begin;
+        }
+
+        fprintf(stderr, "%-10s interpreted %8.1f ns/call, tiered %8.1f ns/call (%.1fx), C %8.1f ns/call (%.1fx)\n", test->func,
+                times[0] * 1e9 / runs, times[1] * 1e9 / runs, times[0] / times[1], times[2] * 1e9 / runs, times[0] / times[2]);
+
+        mismatches += bad;
+    }
+
+    fprintf(stderr, "%ld mismatches\n", mismatches);
+
+    for (int m = 0; m < 2; m++) {
+        _k_unload(interps[m][0]);
+        _k_unload(interps[m][1]);
+
+        dlclose(handles[m]);
+    }
+
+    return mismatches != 0;
+}
+#endif
+
+/*
+ *    Times loading synthetic modules of up to the given number of
+ *    instructions, doubling in size, to show the loader scales linearly.
+ *    Each function counts up to its argument and calls the next one.
+ */
+int _k_bench_load(long insts) {
+    /* Instructions in each generated function, its frame included.  */
+    const long per_func = 17;
+
+    for (long size = insts / 8; size <= insts; size *= 2) {
+        long  funcs  = size / per_func > 0 ? size / per_func : 1;
+        long  cap    = funcs * 512;
+        long  len    = 0;
+        char *source = malloc(cap);
+
+        for (long f = 0; f < funcs; ++f) {
+            len += snprintf(source + len, cap - len,
+                            "\nF%ld: \n\tpoprr: r1\n\tnewsv: u64 n\n\tsaver: n r1\n.line: %ld 5\n"
+                            "\tnewsv: u64 i\n\tmovrn: r2 0\n\tsaver: i r2\n"
+                            "S%ld: \n\tloadr: r2 i\n\tloadr: r3 n\n\tjgeii: r2 r3 E%ld\n"
+                            "\tmovrn: r3 1\n\taddii: r2 r2 r3\n\tsaver: i r2\n\tjmpal: S%ld\n"
+                            "E%ld: \n\tloadr: r1 i\n\tpushr: r1\n\tcallf: F%ld\n\tmovrr: r0 r1\n\tleave: \n",
+                            f, f + 1, f, f, f, f, (f + 1) % funcs);
+        }
+
+        double       begin  = _k_seconds();
+        _k_interp_t *interp = _k_load_source(source, (_k_host_t*)0x0);
+        double       time   = _k_seconds() - begin;
+
+        if (interp == (_k_interp_t*)0x0) return 1;
+
+        fprintf(stderr, "load %8ld instructions, %9ld bytes: %8.2f ms, %6.1f ns/inst\n", interp->module->inst_count, len,
+                time * 1e3, time * 1e9 / interp->module->inst_count);
+
+        _k_unload(interp);
+    }
+
+    return 0;
+}
+
+/*
+ *    Renders fractal.k's escape over an image as one batch, one call at
+ *    a time and across lanes, interpreted and tiered. Reports the pixels
+ *    per second of each and checks the lanes render the same image.
+ *
+ *    @return int    0 if every image matched.
+ */
+int _k_bench_lanes(const char *path, long width, long height) {
+    long       n      = width * height;
+    k_value_t *in[2]  = { malloc(n * sizeof(k_value_t)), malloc(n * sizeof(k_value_t)) };
+    k_value_t *out[2] = { malloc(n * sizeof(k_value_t)), malloc(n * sizeof(k_value_t)) };
+    long       bad    = 0;
+    int        lanes  = 1;
+
+#ifdef _K_LANES
+    lanes = _K_LANES;
+#endif
+
+    for (long y = 0; y < height; y++) {
+        for (long x = 0; x < width; x++) {
+            in[0][y * width + x].f = (float)(-2.3 + 3.3 * x / width);
+            in[1][y * width + x].f = (float)(-1.5 + 3.0 * y / height);
+        }
+    }
+
+    for (int tiered = 0; tiered < 2; tiered++) {
+        k_env_t *env = k_new_env();
+
+        if (env == (k_env_t*)0x0 || k_load_module(env, path)) return 1;
+
+        k_function_t *escape = k_get_function(env, "escape");
+
+        if (escape == (k_function_t*)0x0) return 1;
+
+        double times[2];
+
+        env->interp->module->tiered = tiered;
+
+        for (int spmd = 0; spmd < 2; spmd++) {
+            env->interp->spmd = spmd;
+
+            double begin = _k_seconds();
+
+            if (k_call_batch(env, escape, n, (const k_value_t**)in, out[spmd])) return 1;
+
+            times[spmd] = _k_seconds() - begin;
+        }
+
+        for (long i = 0; i < n; i++) bad += out[0][i].i != out[1][i].i;
+
+        fprintf(stderr, "%-11s one at a time %6.2f Mpixels/s, %d lanes %6.2f Mpixels/s (%.2fx)\n", tiered ? "tiered" : "interpreted",
+                n / times[0] * 1e-6, lanes, n / times[1] * 1e-6, times[0] / times[1]);
+
+        k_destroy_env(env);
+    }
+
+    fprintf(stderr, "%ld mismatches\n", bad);
+
+    free(in[0]);
+    free(in[1]);
+    free(out[0]);
+    free(out[1]);
+
+    return bad != 0;
+}
+
+/*
+ *    Renders fractal.k's escape over an image from one module, through
+ *    pools of 1 to threads threads stealing tiles of the image's pixels
+ *    from each other. Reports the pixels per second of each and the
+ *    scaling over one thread, and checks every pool renders the same
+ *    image.
+ *
+ *    @return int    0 if every image matched.
+ */
+int _k_bench_render(const char *path, long width, long height, long threads, long grain) {
+    long       n      = width * height;
+    k_value_t *in[2]  = { malloc(n * sizeof(k_value_t)), malloc(n * sizeof(k_value_t)) };
+    k_value_t *out[2] = { malloc(n * sizeof(k_value_t)), malloc(n * sizeof(k_value_t)) };
+    long       bad    = 0;
+    double     one    = 0;
+
+    for (long y = 0; y < height; y++) {
+        for (long x = 0; x < width; x++) {
+            in[0][y * width + x].f = (float)(-2.3 + 3.3 * x / width);
+            in[1][y * width + x].f = (float)(-1.5 + 3.0 * y / height);
+        }
+    }
+
+    k_env_t *env = k_new_env();
+
+    if (env == (k_env_t*)0x0 || k_load_module(env, path)) return 1;
+
+    k_function_t *escape = k_get_function(env, "escape");
+
+    if (escape == (k_function_t*)0x0) return 1;
+
+    /* Warms the module up, so every run after it finds the same code.  */
+    if (k_call_batch(env, escape, n, (const k_value_t**)in, out[0])) return 1;
+
+    for (long count = 1; count <= threads; count++) {
+        k_pool_t *pool = k_new_pool(env, count);
+        long      stolen = 0;
+
+        double begin = _k_seconds();
+
+        bad += k_parallel_for(pool, escape, n, grain, (const k_value_t**)in, out[count > 1]);
+
+        double time = _k_seconds() - begin;
+
+        if (count == 1) one = time;
+
+        for (long t = 0; t < pool->threads; t++) stolen += pool->workers[t].stolen;
+
+        if (count > 1) {
+            for (long i = 0; i < n; i++) bad += out[0][i].i != out[1][i].i;
+        }
+
+        fprintf(stderr, "%2ld threads %7.2f Mpixels/s (%.2fx), %ld of %ld tiles stolen\n", pool->threads, n / time * 1e-6, one / time, stolen,
+                (n + grain - 1) / grain);
+
+        k_destroy_pool(pool);
+    }
+
+    fprintf(stderr, "%ld mismatches\n", bad);
+
+    k_destroy_env(env);
+
+    free(in[0]);
+    free(in[1]);
+    free(out[0]);
+    free(out[1]);
+
+    return bad != 0;
+}
+
+/* A script that never returns, run alongside the others to show it cannot hold up their turns.  */
+const char *_k_spin_source =
+    "spin: \n"
+    "\tnewsv: u64 i\n"
+    "\tmovrn: r1 0\n"
+    "\tsaver: i r1\n"
+    "S0: \n"
+    "\tloadr: r1 i\n"
+    "\tmovrn: r2 1\n"
+    "\taddii: r1 r1 r2\n"
+    "\tsaver: i r1\n"
+    "\tjmpal: S0\n";
+
+/*
+ *    Renders fractal.k's escape over an image on one thread, from many
+ *    scripts each rendering every scripts'th pixel, and a script that
+ *    never returns, taking turns of budget back-edges and calls. Reports
+ *    the pixels per second against rendering straight through, and the
+ *    mean and longest turns, and checks the scripts render the same image.
+ *
+ *    @return int    0 if the images matched.
+ */
+int _k_bench_slices(const char *path, long scripts, long budget) {
+    long          width  = 320;
+    long          height = 240;
+    long          n      = width * height;
+    k_value_t    *in     = malloc(2 * n * sizeof(k_value_t));
+    k_value_t    *out[2] = { malloc(n * sizeof(k_value_t)), malloc(n * sizeof(k_value_t)) };
+    k_context_t **ctxs   = malloc((scripts + 1) * sizeof(k_context_t*));
+    long         *next   = malloc(scripts * sizeof(long));
+    long          live   = scripts;
+    long          turns  = 0;
+    long          bad    = 0;
+    double        worst  = 0;
+
+    for (long i = 0; i < n; i++) {
+        in[2 * i].f     = (float)(-2.3 + 3.3 * (i % width) / width);
+        in[2 * i + 1].f = (float)(-1.5 + 3.0 * (i / width) / height);
+    }
+
+    k_env_t *env  = k_new_env();
+    k_env_t *spin = k_new_env();
+
+    if (env == (k_env_t*)0x0 || spin == (k_env_t*)0x0 || k_load_module(env, path) || k_load_source(spin, _k_spin_source)) return 1;
+
+    k_function_t *escape = k_get_function(env, "escape");
+
+    if (escape == (k_function_t*)0x0) return 1;
+
+    /* Renders straight through first, which also warms the module up.  */
+    double begin = _k_seconds();
+
+    for (long i = 0; i < n; i++) bad += k_call(env, escape, &in[2 * i], &out[0][i]);
+
+    double straight = _k_seconds() - begin;
+
+    for (long s = 0; s < scripts; s++) {
+        ctxs[s] = k_new_context(env);
+        next[s] = s;
+
+        if (s < n) bad += k_start(ctxs[s], escape, &in[2 * s], &out[1][s]);
+        else       live--;
+    }
+
+    ctxs[scripts] = k_new_context(spin);
+
+    bad += k_start(ctxs[scripts], k_get_function(spin, "spin"), (k_value_t*)0x0, (k_value_t*)0x0);
+
+    begin = _k_seconds();
+
+    /* Every script takes a turn in each round, until the last pixel is done.  */
+    while (live > 0) {
+        for (long s = 0; s <= scripts; s++) {
+            if (s < scripts && next[s] >= n) continue;
+
+            double    turn  = _k_seconds();
+            k_state_t state = k_run(ctxs[s], budget);
+
+            turn = _k_seconds() - turn;
+            turns++;
+
+            if (turn > worst) worst = turn;
+
+            if (state == K_YIELDED) continue;
+
+            if (state == K_FAILED || s == scripts) {
+                bad++;
+                live = 0;
+                break;
+            }
+
+            if ((next[s] += scripts) < n) bad += k_start(ctxs[s], escape, &in[2 * next[s]], &out[1][next[s]]);
+            else                          live--;
+        }
+    }
+
+    double sliced = _k_seconds() - begin;
+
+    for (long i = 0; i < n; i++) bad += out[0][i].i != out[1][i].i;
+
+    fprintf(stderr, "%ld scripts and one spinning, budget %ld: %ld turns of %.2f us, the longest %.1f us\n", scripts, budget, turns, sliced / turns * 1e6, worst * 1e6);
+    fprintf(stderr, "straight through %7.2f Mpixels/s, in turns %7.2f Mpixels/s (%.2fx)\n", n / straight * 1e-6, n / sliced * 1e-6, straight / sliced);
+    fprintf(stderr, "%ld mismatches\n", bad);
+
+    for (long s = 0; s <= scripts; s++) k_destroy_context(ctxs[s]);
+
+    k_destroy_env(env);
+    k_destroy_env(spin);
+
+    free(in);
+    free(out[0]);
+    free(out[1]);
+    free(ctxs);
+    free(next);
+
+    return bad != 0;
+}
+
+/* A script taking a float from one host function and an integer from another, one after the other.  */
+const char *_k_kinds_source =
+    "both: \n"
+    "\tpoprr: r1\n"
+    "\tnewsv: u64 n\n"
+    "\tsaver: n r1\n"
+    "\tnewsv: f64 x\n"
+    "\tloadr: r1 n\n"
+    "\tpushr: r1\n"
+    "\tcallf: half\n"
+    "\tmovrr: r1 r0\n"
+    "\trtofr: r1 r1\n"
+    "\tsaver: x r1\n"
+    "\tnewsv: u64 y\n"
+    "\tloadr: r1 n\n"
+    "\tpushr: r1\n"
+    "\tcallf: twice\n"
+    "\tmovrr: r1 r0\n"
+    "\trtoir: r1 r1\n"
+    "\tsaver: y r1\n"
+    "\tloadr: r1 x\n"
+    "\tloadr: r2 y\n"
+    "\titofr: r2 r2\n"
+    "\taddff: r1 r1 r2\n"
+    "\tmovrr: r0 r1\n"
+    "\tleave: \n";
+
+/*
+ *    Halves its argument into a float. With data set, it completes the
+ *    call before returning it as in flight, for the run to pick up.
+ */
+k_state_t _k_host_half(k_context_t *ctx, const k_value_t *args, k_value_t *ret, void *data) {
+    k_value_t value = { .f = args[0].i / 2.0 };
+
+    if (*(int*)data) {
+        k_complete(ctx, value);
+        return K_YIELDED;
+    }
+
+    *ret = value;
+
+    return K_DONE;
+}
+
+/*
+ *    Doubles its argument into an integer, completing the call as
+ *    _k_host_half does.
+ */
+k_state_t _k_host_twice(k_context_t *ctx, const k_value_t *args, k_value_t *ret, void *data) {
+    k_value_t value = { .i = 2 * args[0].i };
+
+    if (*(int*)data) {
+        k_complete(ctx, value);
+        return K_YIELDED;
+    }
+
+    *ret = value;
+
+    return K_DONE;
+}
+
+/*
+ *    Calls a script taking a float from one host function and then an
+ *    integer from another, straight through, past the calls that promote
+ *    it, then in runs resumed with each result. Checks every sum, which
+ *    a result read as the other kind throws off.
+ *
+ *    @return int    0 if every sum was right.
+ */
+int _k_host_kinds(long calls) {
+    int      parked = 0;
+    long     bad    = 0;
+    k_env_t *env    = k_new_env();
+
+    if (env == (k_env_t*)0x0 || k_set_host(env, "half", 1, 1, _k_host_half, &parked) || k_set_host(env, "twice", 1, 0, _k_host_twice, &parked)) return 1;
+
+    if (k_load_source(env, _k_kinds_source)) return 1;
+
+    k_function_t *both = k_get_function(env, "both");
+    k_context_t  *ctx  = k_new_context(env);
+
+    if (both == (k_function_t*)0x0 || ctx == (k_context_t*)0x0) return 1;
+
+    for (parked = 0; parked < 2; parked++) {
+        for (long n = 0; n < calls; n++) {
+            k_value_t arg   = { .i = n };
+            k_value_t ret   = { .i = 0 };
+            k_state_t state = K_FAILED;
+
+            if (!parked)                              state = k_context_call(ctx, both, &arg, &ret) ? K_FAILED : K_DONE;
+            else if (!k_start(ctx, both, &arg, &ret)) while ((state = k_run(ctx, 1000)) == K_YIELDED);
+
+            bad += state != K_DONE || ret.f != n / 2.0 + 2 * n;
+        }
+    }
+
+    fprintf(stderr, "%ld calls, %ld mismatches\n", 2 * calls, bad);
+
+    k_destroy_context(ctx);
+    k_destroy_env(env);
+
+    return bad != 0;
+}
+
+#ifdef _K_PTHREAD
+/* A script summing n reads from the host's store, one after the other.  */
+const char *_k_reads_source =
+    "sum: \n"
+    "\tpoprr: r1\n"
+    "\tnewsv: u64 n\n"
+    "\tsaver: n r1\n"
+    "\tnewsv: u64 i\n"
+    "\tmovrn: r1 0\n"
+    "\tsaver: i r1\n"
+    "\tnewsv: u64 s\n"
+    "\tmovrn: r1 0\n"
+    "\tsaver: s r1\n"
+    "S0: \n"
+    "\tloadr: r1 i\n"
+    "\tloadr: r2 n\n"
+    "\tjgeii: r1 r2 S1\n"
+    "\tloadr: r1 i\n"
+    "\tpushr: r1\n"
+    "\tcallf: read\n"
+    "\tloadr: r1 s\n"
+    "\taddii: r1 r1 r0\n"
+    "\tsaver: s r1\n"
+    "\tloadr: r1 i\n"
+    "\tmovrn: r2 1\n"
+    "\taddii: r1 r1 r2\n"
+    "\tsaver: i r1\n"
+    "\tjmpal: S0\n"
+    "S1: \n"
+    "\tloadr: r0 s\n"
+    "\tleave: \n";
+
+/*
+ *    A store answering each read after a fixed latency, with any number
+ *    in flight, and the threads taking turns running the scripts reading
+ *    from it. Reads are completed in the order they were made, by one
+ *    thread, which queues the runs they leave ready. Blocking, a read
+ *    holds its thread for the whole latency instead.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t  read;
+    pthread_cond_t  ready;
+
+    k_context_t   **reads;
+    double         *due;
+    long           *values;
+    long            read_first;
+    long            read_end;
+
+    k_context_t   **runs;
+    long            run_first;
+    long            run_end;
+
+    long            cap;
+    long            left;
+    long            waits;
+    long            failed;
+    double          latency;
+    int             blocking;
+
+    k_function_t   *sum;
+    k_value_t      *out;
+    long            next;
+    long            scripts;
+    long            length;
+} _k_store_t;
+
+/* What the store holds at an address.  */
+long _k_store_value(long i) {
+    return i * i % 1009;
+}
+
+void _k_store_sleep(double seconds) {
+    struct timespec ts;
+
+    if (seconds <= 0) return;
+
+    ts.tv_sec  = (time_t)seconds;
+    ts.tv_nsec = (long)((seconds - ts.tv_sec) * 1e9);
+
+    nanosleep(&ts, (struct timespec*)0x0);
+}
+
+k_state_t _k_store_read(k_context_t *ctx, const k_value_t *args, k_value_t *ret, void *data) {
+    _k_store_t *store = data;
+
+    if (store->blocking) {
+        _k_store_sleep(store->latency);
+
+        ret->i = _k_store_value(args[0].i);
+
+        return K_DONE;
+    }
+
+    pthread_mutex_lock(&store->lock);
+
+    long k = store->read_end++ % store->cap;
+
+    store->reads[k]  = ctx;
+    store->due[k]    = _k_seconds() + store->latency;
+    store->values[k] = _k_store_value(args[0].i);
+
+    pthread_cond_signal(&store->read);
+    pthread_mutex_unlock(&store->lock);
+
+    return K_YIELDED;
+}
+
+/* Completes reads as they fall due, queueing the runs that were waiting on them.  */
+void *_k_store_main(void *arg) {
+    _k_store_t *store = arg;
+
+    pthread_mutex_lock(&store->lock);
+
+    while (store->left > 0) {
+        if (store->read_first == store->read_end) {
+            pthread_cond_wait(&store->read, &store->lock);
+            continue;
+        }
+
+        long         k     = store->read_first++ % store->cap;
+        k_context_t *ctx   = store->reads[k];
+        k_value_t    value = { .i = store->values[k] };
+        double       due   = store->due[k];
+
+        pthread_mutex_unlock(&store->lock);
+
+        _k_store_sleep(due - _k_seconds());
+
+        int parked = k_complete(ctx, value);
+
+        pthread_mutex_lock(&store->lock);
+
+        if (parked) {
+            store->runs[store->run_end++ % store->cap] = ctx;
+            pthread_cond_signal(&store->ready);
+        }
+    }
+
+    pthread_mutex_unlock(&store->lock);
+
+    return (void*)0x0;
+}
+
+/* Runs scripts until all are done: parked ones as they turn ready, or blocking ones to the end, each in turn.  */
+void *_k_store_run(void *arg) {
+    _k_store_t  *store = arg;
+    k_context_t *ctx   = (k_context_t*)0x0;
+
+    pthread_mutex_lock(&store->lock);
+
+    if (store->blocking) ctx = store->runs[store->run_first++];
+
+    while (store->left > 0) {
+        if (store->blocking) {
+            long      s = store->next++;
+            k_value_t n = { .i = store->length };
+
+            if (s >= store->scripts) break;
+
+            pthread_mutex_unlock(&store->lock);
+
+            int failed = k_context_call(ctx, store->sum, &n, &store->out[s]);
+
+            pthread_mutex_lock(&store->lock);
+
+            store->failed += failed;
+            store->left--;
+            continue;
+        }
+
+        if (store->run_first == store->run_end) {
+            pthread_cond_wait(&store->ready, &store->lock);
+            continue;
+        }
+
+        ctx = store->runs[store->run_first++ % store->cap];
+
+        pthread_mutex_unlock(&store->lock);
+
+        k_state_t state = k_run(ctx, 1000);
+
+        pthread_mutex_lock(&store->lock);
+
+        if (state == K_YIELDED) store->runs[store->run_end++ % store->cap] = ctx;
+        else if (state == K_WAITING) store->waits++;
+        else {
+            store->failed += state == K_FAILED;
+
+            /* The last script done wakes every thread waiting, to leave.  */
+            if (--store->left == 0) {
+                pthread_cond_broadcast(&store->ready);
+                pthread_cond_signal(&store->read);
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&store->lock);
+
+    return (void*)0x0;
+}
+
+/*
+ *    Runs scripts each summing reads from a store with a fixed latency,
+ *    first with the reads blocking their threads, then with them leaving
+ *    the scripts parked until the store completes them. Reports the
+ *    scripts per second of each, and checks their sums.
+ *
+ *    @return int    0 if every sum was right.
+ */
+int _k_bench_hosts(long scripts, long threads, long reads, double latency) {
+    _k_store_t    store;
+    k_context_t **ctxs = malloc(scripts * sizeof(k_context_t*));
+    pthread_t    *ids  = malloc((threads + 1) * sizeof(pthread_t));
+    long          want = 0;
+    long          bad  = 0;
+    double        took[2];
+
+    /* Blocking, each thread takes a script's context for its own.  */
+    if (threads > scripts) threads = scripts;
+
+    for (long i = 0; i < reads; i++) want += _k_store_value(i);
+
+    store.cap     = scripts + 1;
+    store.reads   = malloc(store.cap * sizeof(k_context_t*));
+    store.due     = malloc(store.cap * sizeof(double));
+    store.values  = malloc(store.cap * sizeof(long));
+    store.runs    = malloc(store.cap * sizeof(k_context_t*));
+    store.out     = malloc(scripts * sizeof(k_value_t));
+    store.scripts = scripts;
+    store.length  = reads;
+    store.latency = latency;
+
+    pthread_mutex_init(&store.lock, (pthread_mutexattr_t*)0x0);
+    pthread_cond_init(&store.read, (pthread_condattr_t*)0x0);
+    pthread_cond_init(&store.ready, (pthread_condattr_t*)0x0);
+
+    k_env_t *env = k_new_env();
+
+    if (env == (k_env_t*)0x0 || k_set_host(env, "read", 1, 0, _k_store_read, &store) || k_load_source(env, _k_reads_source)) return 1;
+
+    store.sum = k_get_function(env, "sum");
+
+    for (long s = 0; s < scripts; s++) ctxs[s] = k_new_context(env);
+
+    for (int blocking = 1; blocking >= 0; blocking--) {
+        store.blocking   = blocking;
+        store.read_first = store.read_end = 0;
+        store.run_first  = store.run_end  = 0;
+        store.left       = scripts;
+        store.waits      = 0;
+        store.failed     = 0;
+        store.next       = 0;
+
+        /* Blocking, each thread runs scripts in a context of its own. Parked, every script has one, and all are started at once.  */
+        for (long s = 0; s < scripts; s++) {
+            k_value_t n = { .i = reads };
+
+            store.out[s].i = 0;
+
+            if (!blocking && k_start(ctxs[s], store.sum, &n, &store.out[s])) return 1;
+
+            store.runs[store.run_end++] = ctxs[s];
+        }
+
+        double begin = _k_seconds();
+
+        for (long t = 0; t < threads; t++) pthread_create(&ids[t], (pthread_attr_t*)0x0, _k_store_run, &store);
+
+        if (!blocking) pthread_create(&ids[threads], (pthread_attr_t*)0x0, _k_store_main, &store);
+
+        for (long t = 0; t < threads + !blocking; t++) pthread_join(ids[t], (void**)0x0);
+
+        took[blocking] = _k_seconds() - begin;
+
+        bad += store.failed;
+
+        for (long s = 0; s < scripts; s++) bad += store.out[s].i != want;
+
+        fprintf(stderr, "%s: %ld scripts of %ld reads on %ld threads %9.0f scripts/s", blocking ? "blocking" : "  parked", scripts, reads, threads, scripts / took[blocking]);
+
+        if (blocking) fprintf(stderr, "\n");
+        else          fprintf(stderr, " (%.1fx), %ld waits\n", took[1] / took[0], store.waits);
+    }
+
+    fprintf(stderr, "%ld mismatches\n", bad);
+
+    for (long s = 0; s < scripts; s++) k_destroy_context(ctxs[s]);
+
+    k_destroy_env(env);
+
+    pthread_mutex_destroy(&store.lock);
+    pthread_cond_destroy(&store.read);
+    pthread_cond_destroy(&store.ready);
+
+    free(store.reads);
+    free(store.due);
+    free(store.values);
+    free(store.runs);
+    free(store.out);
+    free(ctxs);
+    free(ids);
+
+    return bad != 0;
+}
+#endif
+
+int main(int argc, char **argv) {
+    /* libk_interpret bench [fib.kasm] [fractal.kasm] [runs]  */
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        return _k_bench(argc > 2 ? argv[2] : "fib.kasm", argc > 3 ? argv[3] : "fractal.kasm", argc > 4 ? atol(argv[4]) : 100000);
+    }
+
+    /* libk_interpret ngrams [n] [fib.kasm] [fractal.kasm] [runs]  */
+    if (argc > 1 && strcmp(argv[1], "ngrams") == 0) {
+        return _k_ngrams(argc > 3 ? argv[3] : "fib.kasm", argc > 4 ? argv[4] : "fractal.kasm", argc > 2 ? atoi(argv[2]) : 2, argc > 5 ? atol(argv[5]) : 100);
+    }
+
+    /* libk_interpret jit [fib.kasm] [math.kasm] [fractal.kasm] [steps]  */
+    if (argc > 1 && strcmp(argv[1], "jit") == 0) {
+        const char *paths[3] = { argc > 2 ? argv[2] : "fib.kasm", argc > 3 ? argv[3] : "math.kasm", argc > 4 ? argv[4] : "fractal.kasm" };
+
+        return _k_jit_diff(paths, argc > 5 ? atol(argv[5]) : 97);
+    }
+
+#ifdef _K_AOT
+    /* libk_interpret aot [math.kasm] [math.so] [fractal.kasm] [fractal.so] [runs]  */
+    if (argc > 1 && strcmp(argv[1], "aot") == 0) {
+        const char *paths[2]   = { argc > 2 ? argv[2] : "math.kasm", argc > 4 ? argv[4] : "fractal.kasm" };
+        const char *objects[2] = { argc > 3 ? argv[3] : "./math.so", argc > 5 ? argv[5] : "./fractal.so" };
+
+        return _k_bench_aot(paths, objects, 97, argc > 6 ? atol(argv[6]) : 100000);
+    }
+#endif
+
+    /* libk_interpret load [instructions]  */
+    if (argc > 1 && strcmp(argv[1], "load") == 0) {
+        return _k_bench_load(argc > 2 ? atol(argv[2]) : 1000000);
+    }
+
+    /* libk_interpret lanes [fractal.kasm] [width] [height]  */
+    if (argc > 1 && strcmp(argv[1], "lanes") == 0) {
+        return _k_bench_lanes(argc > 2 ? argv[2] : "fractal.kasm", argc > 3 ? atol(argv[3]) : 640, argc > 4 ? atol(argv[4]) : 480);
+    }
+
+    /* libk_interpret render [fractal.kasm] [width] [height] [threads] [grain]  */
+    if (argc > 1 && strcmp(argv[1], "render") == 0) {
+#ifdef _K_PTHREAD
+        long threads = sysconf(_SC_NPROCESSORS_ONLN);
+#else
+        long threads = 1;
+#endif
+
+        return _k_bench_render(argc > 2 ? argv[2] : "fractal.kasm", argc > 3 ? atol(argv[3]) : 640, argc > 4 ? atol(argv[4]) : 480,
+                               argc > 5 ? atol(argv[5]) : threads, argc > 6 ? atol(argv[6]) : 256);
+    }
+
+    /* libk_interpret slices [fractal.kasm] [scripts] [budget]  */
+    if (argc > 1 && strcmp(argv[1], "slices") == 0) {
+        return _k_bench_slices(argc > 2 ? argv[2] : "fractal.kasm", argc > 3 ? atol(argv[3]) : 1000, argc > 4 ? atol(argv[4]) : 100);
+    }
+
+    /* libk_interpret kinds [calls]  */
+    if (argc > 1 && strcmp(argv[1], "kinds") == 0) {
+        return _k_host_kinds(argc > 2 ? atol(argv[2]) : 5000);
+    }
+
+#ifdef _K_PTHREAD
+    /* libk_interpret hosts [scripts] [threads] [reads] [latency in us]  */
+    if (argc > 1 && strcmp(argv[1], "hosts") == 0) {
+        return _k_bench_hosts(argc > 2 ? atol(argv[2]) : 1000, argc > 3 ? atol(argv[3]) : 4, argc > 4 ? atol(argv[4]) : 16,
+                              (argc > 5 ? atol(argv[5]) : 200) * 1e-6);
+    }
+#endif
+
+    k_env_t *env = k_new_env();
+
+    if (env == (k_env_t*)0x0 || k_load_module(env, "fractal.kasm")) return 1;
+
+    k_function_t *z   = k_get_function(env, "z");
+    k_function_t *abs = k_get_function(env, "abs");
+
+    if (z == (k_function_t*)0x0 || abs == (k_function_t*)0x0) return 1;
+
+    k_value_t ret;
+
+    long   r0d = 0;
+    double r0f = 0.0;
+
+    double rmin;
+    double rmax;
+
+    double imin;
+    double imax;
+
+    float real = 1.0;
+    float imag = 1.0;
+
+    float *real_ptr = &real;
+    float *imag_ptr = &imag;
+
+    //push(interp, &real, sizeof(double));
+    //push(interp, &imag, sizeof(double));
+    if (k_call_function(env, "rmin", &ret, 0)) return 1;
+    rmin = ret.f;
+
+    if (k_call_function(env, "rmax", &ret, 0)) return 1;
+    rmax = ret.f;
+
+    if (k_call_function(env, "imin", &ret, 0)) return 1;
+    imin = ret.f;
+
+    if (k_call_function(env, "imax", &ret, 0)) return 1;
+    imax = ret.f;
+
+    fprintf(stderr, "rmin = %f\n", rmin);
+    fprintf(stderr, "rmax = %f\n", rmax);
+    fprintf(stderr, "imin = %f\n", imin);
+    fprintf(stderr, "imax = %f\n", imax);
+
+    k_value_t a = { .f = 1.0 };
+    k_value_t b = { .f = -1.0 };
+
+    k_call(env, abs, &a, &ret);
+    double c = ret.f;
+
+    k_call(env, abs, &b, &ret);
+    double d = ret.f;
+
+    fprintf(stderr, "abs(%f) = %f\n", a.f, c);
+    fprintf(stderr, "abs(%f) = %f\n", b.f, d);
+
+    const int W = 640; const int H = 640;
+    char img[W][H];
+
+    k_value_t args[2] = { { .p = real_ptr }, { .p = imag_ptr } };
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            int i = 0;
+
+            real = rmin + (rmax - rmin) * x / W;
+            imag = imin + (imax - imin) * y / H;
+
+            while (real * real + imag * imag < 16 && i < 64) {
+                k_call(env, z, args, (k_value_t*)0x0);
+
+                //printf("z = %f + %fi\n", real, imag);
+
+                real += rmin + (rmax - rmin) * x / W;
+                imag += imin + (imax - imin) * y / H;
+
+                i++;
+            }
+
+            img[x][y] = i == 64 ? 0 : 4 * i;
+        }
+
+        fprintf(stderr, "%d\%\n", y * 100 / H);
+    }
+
+    printf("P6\n%d %d\n100\n", W, H);
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            printf("%c%c%c", img[x][y], 0, 0);
+        }
+    }
+    
+
+    /*printf("r0 = %d (as decimal)\n", r0d);
+    printf("r0 = %f (as float)\n", r0f);*/
+
+    /*printf("real = %f\n", rmin);
+    printf("imag = %f\n", imag);*/
+    
+
+    k_destroy_env(env);
+
+    return 0;
+}
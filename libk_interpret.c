@@ -5,121 +5,172 @@
  * 
  *    This file is part of the KAPPA project.
  * 
- *    This file contains a standalone interpreter for the KAPPA language.
+ *    This file contains the interpreter for the KAPPA language: its
+ *    instructions, the loop dispatching them, the loader and the
+ *    embedding API. The compiler, lanes and pool have files of their own.
  */
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdarg.h>
+#include <limits.h>
 
-typedef struct {
-    char *name;
-    char *type;
-    char *mem;
-} _k_var_t;
-
-typedef struct {
-    int      (*func)(void *, void *, void *, void *);
-    void      *a0;
-    void      *a1;
-    void      *a2;
-    char       flags;
-} _k_inst2_t;
-
-typedef struct {
-    long r;
-    char rf;
-} _k_reg_t;
-
-typedef struct _k_frame_s {
-    long        sp;
-    long        bp;
-    _k_inst2_t *cur;
-    _k_reg_t    r[32];
-    char        cmp;
-
-    _k_var_t *vars;
-    long      var_count;
-
-    struct _k_frame_s *next;
-    struct _k_frame_s *prev;
-} _k_frame_t;
-
-typedef struct {
-    char *name;
-    void *ptr;
-} _k_label_t;
-
-typedef struct {
-    char *source;
-    char *mem;
-    long  size;
-
-    _k_inst2_t *insts;
-    _k_inst2_t *cur;
-    long        inst_count;
-
-    _k_label_t *labels;
-    long        label_count;
-
-    _k_frame_t *frame;
-} _k_interp_t;
-
-typedef struct {
-    char *name;
-    int (*func)(_k_interp_t *, char *, char *, char *);
-} _k_inst_t;
-
-typedef enum {
-    _K_INST_PUSHR,
-    _K_INST_POPRR,
-    _K_INST_NEWSV,
-    _K_INST_LEAVE,
-    _K_INST_MOVRN,
-    _K_INST_MOVRR,
-    _K_INST_CALLF,
-    _K_INST_LOADR,
-    _K_INST_SAVER,
-    _K_INST_ADDRR,
-    _K_INST_SUBRR,
-    _K_INST_MULRR,
-    _K_INST_DIVRR,
-    _K_INST_LESRR,
-    _K_INST_GRERR,
-    _K_INST_EQURR,
-    _K_INST_CMPRD,
-    _K_INST_JMPEQ,
-    _K_INST_JMPAL,
-    _K_INST_DEREF,
-    _K_INST_REFSV,
-    _K_INST_SAVEA
-} _k_inst_e;
-
-void _k_print_args(_k_interp_t *interp) {
-    for (int i = 0; i < interp->frame->var_count; ++i) {
-        fprintf(stderr, "%s: %s = %ld (long) %f (double)\n", interp->frame->vars[i].type, interp->frame->vars[i].name, *(long*)interp->frame->vars[i].mem, *(double*)interp->frame->vars[i].mem);
+#include "libk_interpret_internal.h"
+
+unsigned long _k_hash(const char *str, long len) {
+    unsigned long hash = 14695981039346656037UL;
+
+    for (long i = 0; i < len; ++i) {
+        hash = (hash ^ (unsigned char)str[i]) * 1099511628211UL;
+    }
+
+    return hash;
+}
+
+/*
+ *    Probes the label table for a name.
+ *
+ *    @param _k_interp_t *interp    The interpreter, whose table must not be empty.
+ *    @param const char *name       The label's name.
+ *
+ *    @return long *                The bucket holding the label's index, or the empty one it would take.
+ */
+long *_k_label_bucket(_k_interp_t *interp, const char *name) {
+    for (unsigned long h = _k_hash(name, strlen(name));; h++) {
+        long *bucket = &interp->module->label_table[h & (interp->module->label_buckets - 1)];
+
+        if (*bucket < 0 || strcmp(interp->module->labels[*bucket].name, name) == 0) return bucket;
     }
 }
 
+_k_inst2_t *_k_label_target(_k_interp_t *interp, const char *label) {
+    if (interp->module->label_buckets == 0) return (_k_inst2_t *)0x0;
+
+    long *bucket = _k_label_bucket(interp, label);
+
+    return *bucket >= 0 ? (_k_inst2_t *)(interp->module->labels[*bucket].ptr) : (_k_inst2_t *)0x0;
+}
+
 int _k_find_label(_k_interp_t *interp, const char *label) {
-    for (long i = 0; i < interp->label_count; ++i) {
-        if (strcmp(interp->labels[i].name, label) == 0) {
-            interp->frame->cur = (_k_inst2_t *)(interp->labels[i].ptr);
+    _k_inst2_t *target = _k_label_target(interp, label);
 
-            return 0;
-        }
+    if (target == (_k_inst2_t *)0x0) {
+        fprintf(stderr, "Unknown label %s!\n", label);
+
+        return 1;
     }
 
+    interp->frame->cur = target;
+
     return 0;
 }
 
+_k_line_t *_k_find_line(_k_interp_t *interp, _k_inst2_t *inst) {
+    long lo = 0;
+    long hi = interp->module->line_count;
+
+    /* Last entry starting at or before the instruction.  */
+    while (lo < hi) {
+        long mid = (lo + hi) / 2;
+
+        if (interp->module->lines[mid].inst <= inst - interp->module->insts) lo = mid + 1;
+        else                                                 hi = mid;
+    }
+
+    return lo > 0 ? &interp->module->lines[lo - 1] : (_k_line_t*)0x0;
+}
+
+void _k_print_location(_k_interp_t *interp, _k_inst2_t *inst) {
+    _k_line_t *line = _k_find_line(interp, inst);
+
+    if (line == (_k_line_t*)0x0) {
+        fprintf(stderr, "\tat instruction %ld\n", (long)(inst - interp->module->insts));
+        return;
+    }
+
+    fprintf(stderr, "\tat %s:%ld:%ld in %s\n", interp->module->file != (char*)0x0 ? interp->module->file : "?", line->line, line->column, line->func != (const char*)0x0 ? line->func : "?");
+}
+
 void *_k_get_register(_k_interp_t *interp, char *reg) {
-    if (reg[0] == 'r') {
+    if (reg != (char*)0x0 && reg[0] == 'r') {
         return (void*)atoi(reg + 1);
     } else {
         return (void*)0x0;
     }
 }
 
+int _k_jump(_k_interp_t *interp, void *target) {
+    interp->frame->cur = (_k_inst2_t *)target - 1;
+
+    return 0;
+}
+
+double _k_reg_double(_k_reg_t *reg) {
+    return reg->rf ? *(double*)&reg->r : (double)reg->r;
+}
+
+int _k_cmprr(_k_reg_t *r0, _k_reg_t *r1) {
+    if (r0->rf || r1->rf) {
+        double f0 = _k_reg_double(r0);
+        double f1 = _k_reg_double(r1);
+
+        return (f0 > f1) - (f0 < f1);
+    }
+
+    return (r0->r > r1->r) - (r0->r < r1->r);
+}
+
+int _k_cmprn(_k_reg_t *r0, long n) {
+    if (r0->rf) {
+        double f0 = *(double*)&r0->r;
+
+        return (f0 > n) - (f0 < n);
+    }
+
+    return (r0->r > n) - (r0->r < n);
+}
+
+int _k_cmprf(_k_reg_t *r0, double f) {
+    double f0 = _k_reg_double(r0);
+
+    return (f0 > f) - (f0 < f);
+}
+
+/* Typed float compares, which hold as _k_cmprr's would, a NaN being neither less nor greater than anything.  */
+#define _K_FLT(x, y) ((x) < (y))
+#define _K_FGT(x, y) ((x) > (y))
+#define _K_FLE(x, y) (!((x) > (y)))
+#define _K_FGE(x, y) (!((x) < (y)))
+#define _K_FEQ(x, y) (!((x) < (y) || (x) > (y)))
+#define _K_FNE(x, y) ((x) < (y) || (x) > (y))
+
+/*
+ *    Pushes a frame for a call, its registers following the caller's.
+ *
+ *    @param _k_interp_t *interp    The interpreter.
+ *
+ *    @return _k_frame_t *          The new frame, or NULL if the call stack is full.
+ */
+_k_frame_t *_k_enter(_k_interp_t *interp) {
+    _k_frame_t *frame = interp->frame + 1;
+
+    if (frame == interp->frames + _K_STACK_DEPTH) {
+        fprintf(stderr, "Call stack overflow!\n");
+
+        return (_k_frame_t*)0x0;
+    }
+
+    frame->sp   = interp->frame->sp;
+    frame->bp   = interp->frame->sp;
+    frame->cur  = interp->frame->cur;
+    frame->r    = interp->frame->r + interp->frame->regs;
+    frame->regs = _K_FRAME_REGS;
+
+    interp->frame = frame;
+
+    return frame;
+}
+
 int _k_pushr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
     interp->frame->sp -= sizeof(long);
     memcpy(interp->mem + interp->frame->sp, &interp->frame->r[(long)a0], sizeof(long));
@@ -128,43 +179,106 @@ int _k_pushr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
 }
 
 int _k_poprr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
-    memcpy(&interp->frame->r[(long)a0], interp->mem + interp->frame->sp, sizeof(long));
-    interp->frame->sp += sizeof(long);
+    memcpy(&interp->frame->r[(long)a0], interp->mem + interp->frame->ap, sizeof(long));
+    interp->frame->ap += sizeof(long);
 
     return 0;
 }
 
-int _k_newsv(_k_interp_t *interp, char *a0, char *a1, char *a2) {
-    interp->frame->sp -= sizeof(long);
-    
-    interp->frame->vars = realloc(interp->frame->vars, sizeof(_k_var_t) * (interp->frame->var_count + 1));
+long _k_type_size(const char *type) {
+    long len = strlen(type);
 
-    char buf[256];
+    /* Like the assembler, only u32 and f32 are narrow, i32 is held whole.  */
+    if ((type[0] == 'u' || type[0] == 'f') && len > 2 && strcmp(type + len - 2, "32") == 0) return 4;
 
-    for (int i = 0; i < 256; i++) {
-        if (a1[i] == '\n' || a1[i] == '\0') {
-            buf[i] = '\0';
-            break;
-        }
+    return sizeof(long);
+}
+
+int _k_frame(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    long sp = (interp->frame->sp - (long)a0) & ~(long)(sizeof(long) - 1);
 
-        buf[i] = a1[i];
+    if (sp < 0) {
+        fprintf(stderr, "Stack overflow!\n");
+
+        return 1;
     }
 
-    interp->frame->vars[interp->frame->var_count].name = strdup(buf);
+    interp->frame->ap   = interp->frame->sp;
+    interp->frame->sp   = sp;
+    interp->frame->bp   = sp;
+    interp->frame->regs = (long)a1;
 
-    for (int i = 0; i < 256; i++) {
-        if (a0[i] == '\n' || a0[i] == '\0') {
-            buf[i] = '\0';
-            break;
-        }
+    return 0;
+}
 
-        buf[i] = a0[i];
-    }
+int _k_lodii(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = *(long*)(interp->mem + interp->frame->bp + (long)a1);
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_lodff(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    *(double*)&r0->r = *(double*)(interp->mem + interp->frame->bp + (long)a1);
+    r0->rf           = 1;
+
+    return 0;
+}
+
+int _k_lodww(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = *(unsigned int*)(interp->mem + interp->frame->bp + (long)a1);
+    r0->rf = 0;
+
+    return 0;
+}
 
-    interp->frame->vars[interp->frame->var_count].type = strdup(buf);
-    interp->frame->vars[interp->frame->var_count].mem  = interp->mem + interp->frame->sp;
+int _k_lodhh(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = *(int*)(interp->mem + interp->frame->bp + (long)a1);
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_lodss(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    *(double*)&r0->r = *(float*)(interp->mem + interp->frame->bp + (long)a1);
+    r0->rf           = 1;
+
+    return 0;
+}
+
+int _k_stoii(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    *(long*)(interp->mem + interp->frame->bp + (long)a0) = interp->frame->r[(long)a1].r;
+
+    return 0;
+}
 
-    interp->frame->var_count++;
+int _k_stoww(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    *(int*)(interp->mem + interp->frame->bp + (long)a0) = (int)interp->frame->r[(long)a1].r;
+
+    return 0;
+}
+
+int _k_stoss(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    *(float*)(interp->mem + interp->frame->bp + (long)a0) = (float)*(double*)&interp->frame->r[(long)a1].r;
+
+    return 0;
+}
+
+int _k_refsl(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = (long)(interp->mem + interp->frame->bp + (long)a1);
+    r0->rf = 0;
 
     return 0;
 }
@@ -172,15 +286,17 @@ int _k_newsv(_k_interp_t *interp, char *a0, char *a1, char *a2) {
 int _k_leave(_k_interp_t *interp, char *a0, char *a1, char *a2) {
     _k_frame_t *frame = interp->frame;
 
-    if (frame->prev != (_k_frame_t*)0x0) {
-        interp->frame->prev->r[0].r  = interp->frame->r[0].r;
-        interp->frame->prev->r[0].rf = interp->frame->r[0].rf;
+    if (frame == interp->frames) {
+        fprintf(stderr, "Leave outside of a call!\n");
+
+        return 1;
     }
 
-    interp->frame = interp->frame->prev;
+    /* The caller gets r0 back, and its stack as it was before pushing the arguments.  */
+    frame[-1].r[0] = frame->r[0];
+    frame[-1].sp   = frame->ap;
 
-    free(frame->vars);
-    free(frame);
+    interp->frame = frame - 1;
 
     return 0;
 }
@@ -210,90 +326,76 @@ int _k_movrr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
 }
 
 int _k_callf(_k_interp_t *interp, char *a0, char *a1, char *a2) {
-    _k_frame_t *frame = malloc(sizeof(_k_frame_t));
+    _k_frame_t *frame = _k_enter(interp);
 
-    frame->vars = (_k_var_t*)0x0;
-    frame->var_count = 0;
-    frame->next = (_k_frame_t*)0x0;
-    frame->prev = interp->frame;
-    frame->sp = interp->frame->sp;
-    frame->bp = interp->frame->sp;
-    frame->cur = interp->frame->cur;
+    if (frame == (_k_frame_t*)0x0) return 1;
 
-    interp->frame = frame;
+    frame->cur = (_k_inst2_t *)a0 - 1;
 
-    _k_find_label(interp, a0);
+    return 0;
+}
 
-    frame->cur--;
+int _k_argrr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    interp->frame->r[interp->frame->regs + (long)a0] = interp->frame->r[(long)a1];
 
     return 0;
 }
 
-int _k_loadr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
-    char buf[256];
+int _k_callr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_inst2_t *entry = (_k_inst2_t *)a0;
+    _k_frame_t *frame = _k_enter(interp);
 
-    for (int i = 0; i < 256; i++) {
-        if (a1[i] == '\n' || a1[i] == '\0') {
-            buf[i] = '\0';
-            break;
-        }
+    if (frame == (_k_frame_t*)0x0) return 1;
 
-        buf[i] = a1[i];
-    }
+    /* The arguments are already in the callee's registers, so its poprr's are skipped.  */
+    if (_k_frame(interp, entry->a0, entry->a1, (char*)0x0)) return 1;
 
-    for (long i = 0; i < interp->frame->var_count; ++i) {
-        if (strcmp(interp->frame->vars[i].name, buf) == 0) {
-            if (interp->frame->vars[i].type[0] == 'f') {
-                interp->frame->r[(long)a0].rf = 1;
+    frame->cur = entry + (long)a2;
 
-                double f = *(double*)interp->frame->vars[i].mem;
+    return 0;
+}
 
-                memcpy(&interp->frame->r[(long)a0], &f, sizeof(long));
-            }
+/*
+ *    Calls a host function with the arguments pushed for it. A call the
+ *    host leaves in flight puts the run out of budget, parking it past
+ *    the call until the host completes it.
+ */
+int _k_hostc(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_host_t  *host  = (_k_host_t *)a0;
+    _k_frame_t *frame = interp->frame;
+    k_value_t   args[_K_FRAME_REGS];
+    k_value_t   ret;
 
-            else {
-                interp->frame->r[(long)a0].rf = 0;
+    /* The last argument is the one pushed last, as for callf.  */
+    for (long k = 0; k < host->params; ++k) memcpy(&args[k], interp->mem + frame->sp + sizeof(long) * (host->params - 1 - k), sizeof(long));
 
-                long l = *(long*)interp->frame->vars[i].mem;
+    frame->sp    += sizeof(long) * host->params;
+    ret.i         = 0;
+    interp->call  = host;
 
-                memcpy(&interp->frame->r[(long)a0], &l, sizeof(long));
-            }
+    /* The host may complete the call before it has even returned.  */
+    __atomic_store_n(&interp->wait, 1, __ATOMIC_RELAXED);
 
+    switch (host->fn(interp, args, &ret, host->data)) {
+        case K_DONE:
+            interp->wait   = 0;
+            frame->r[0].r  = ret.i;
+            frame->r[0].rf = (char)host->real;
             return 0;
-        }
-    }
-
-    printf("Failed to load variable %s!\n", a1);
-
-    return 1;
-}
 
-int _k_saver(_k_interp_t *interp, char *a0, char *a1, char *a2) {
-    _k_reg_t *r0 = &interp->frame->r[(long)a1];
-
-    for (long i = 0; i < interp->frame->var_count; ++i) {
-        if (strcmp(interp->frame->vars[i].name, a0) == 0) {
-            if (interp->frame->vars[i].type[0] == 'f') {
-                double f = *(double*)&(r0->r);
-
-                memcpy(interp->frame->vars[i].mem, &f, sizeof(double));
-            }
-
-            else {
-                long l = *(long*)_k_get_register(interp, a1);
-
-                memcpy(interp->frame->vars[i].mem, &l, sizeof(long));
+        case K_YIELDED:
+            if (interp->run != (_k_frame_t*)0x0) {
+                interp->budget = -1;
+                return 0;
             }
 
-            //_k_print_args(interp);
+            fprintf(stderr, "%s left its call in flight outside a run!\n", host->name);
+            /* Fall through.  */
 
-            return 0;
-        }
+        default:
+            interp->wait = 0;
+            return 1;
     }
-
-    printf("Failed to save variable %s!\n", a0);
-
-    return 1;
 }
 
 int _k_addrr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
@@ -431,20 +533,20 @@ int _k_lesrr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
 
     if (r1->rf && r2->rf) {
         long f = *(double*)&r1->r < *(double*)&r2->r;
-        memcpy(&r0->r, &f, sizeof(double));
-        r0->rf = 1;
+        memcpy(&r0->r, &f, sizeof(long));
+        r0->rf = 0;
     }
 
     else if (r1->rf && !r2->rf) {
         long f = *(double*)&r1->r < r2->r;
-        memcpy(&r0->r, &f, sizeof(double));
-        r0->rf = 1;
+        memcpy(&r0->r, &f, sizeof(long));
+        r0->rf = 0;
     }
 
     else if (!r1->rf && r2->rf) {
         long f = r1->r < *(double*)&r2->r;
-        memcpy(&r0->r, &f, sizeof(double));
-        r0->rf = 1;
+        memcpy(&r0->r, &f, sizeof(long));
+        r0->rf = 0;
     }
 
     else {
@@ -463,20 +565,20 @@ int _k_grerr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
 
     if (r1->rf && r2->rf) {
         long f = *(double*)&r1->r > *(double*)&r2->r;
-        memcpy(&r0->r, &f, sizeof(double));
-        r0->rf = 1;
+        memcpy(&r0->r, &f, sizeof(long));
+        r0->rf = 0;
     }
 
     else if (r1->rf && !r2->rf) {
         long f = *(double*)&r1->r > r2->r;
-        memcpy(&r0->r, &f, sizeof(double));
-        r0->rf = 1;
+        memcpy(&r0->r, &f, sizeof(long));
+        r0->rf = 0;
     }
 
     else if (!r1->rf && r2->rf) {
         long f = r1->r > *(double*)&r2->r;
-        memcpy(&r0->r, &f, sizeof(double));
-        r0->rf = 1;
+        memcpy(&r0->r, &f, sizeof(long));
+        r0->rf = 0;
     }
 
     else {
@@ -495,20 +597,20 @@ int _k_equrr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
 
     if (r1->rf && r2->rf) {
         long f = *(double*)&r1->r == *(double*)&r2->r;
-        memcpy(&r0->r, &f, sizeof(double));
-        r0->rf = 1;
+        memcpy(&r0->r, &f, sizeof(long));
+        r0->rf = 0;
     }
 
     else if (r1->rf && !r2->rf) {
         long f = *(double*)&r1->r == r2->r;
-        memcpy(&r0->r, &f, sizeof(double));
-        r0->rf = 1;
+        memcpy(&r0->r, &f, sizeof(long));
+        r0->rf = 0;
     }
 
     else if (!r1->rf && r2->rf) {
         long f = r1->r == *(double*)&r2->r;
-        memcpy(&r0->r, &f, sizeof(double));
-        r0->rf = 1;
+        memcpy(&r0->r, &f, sizeof(long));
+        r0->rf = 0;
     }
 
     else {
@@ -520,6 +622,33 @@ int _k_equrr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
     return 0;
 }
 
+int _k_leqrr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = _k_cmprr(&interp->frame->r[(long)a1], &interp->frame->r[(long)a2]) <= 0;
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_geqrr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = _k_cmprr(&interp->frame->r[(long)a1], &interp->frame->r[(long)a2]) >= 0;
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_neqrr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = _k_cmprr(&interp->frame->r[(long)a1], &interp->frame->r[(long)a2]) != 0;
+    r0->rf = 0;
+
+    return 0;
+}
+
 int _k_cmprd(_k_interp_t *interp, char *a0, char *a1, char *a2) {
     _k_reg_t *r0 = &interp->frame->r[(long)a0];
 
@@ -531,102 +660,713 @@ int _k_cmprd(_k_interp_t *interp, char *a0, char *a1, char *a2) {
 }
 
 int _k_jmpeq(_k_interp_t *interp, char *a0, char *a1, char *a2) {
-    if (interp->frame->cmp) {
-        int ret = _k_find_label(interp, a0);
-        interp->frame->cur--;
-
-        return ret;
-    }
+    if (interp->frame->cmp) return _k_jump(interp, a0);
 
     return 0;
 }
 
 int _k_jmpal(_k_interp_t *interp, char *a0, char *a1, char *a2) {
-    return _k_find_label(interp, a0);
+    return _k_jump(interp, a0);
 }
 
-int _k_deref(_k_interp_t *interp, char *a0, char *a1, char *a2) {
-    long addr = *(long*)&interp->frame->r[(long)a1];
+int _k_jltrr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_k_cmprr(&interp->frame->r[(long)a0], &interp->frame->r[(long)a1]) < 0) return _k_jump(interp, a2);
 
-    memcpy(&interp->frame->r[(long)a0], (char*)addr, sizeof(long));
+    return 0;
+}
 
-    /*if (interp->frame->rf[atoi(a0 + 1)])
-        printf("Dereferenced %ld to %f\n", addr, *(double*)_k_get_register(interp, a0));
+int _k_jgtrr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_k_cmprr(&interp->frame->r[(long)a0], &interp->frame->r[(long)a1]) > 0) return _k_jump(interp, a2);
 
-    else printf("Dereferenced %ld to %ld\n", addr, *(long*)_k_get_register(interp, a0));*/
+    return 0;
+}
+
+int _k_jlerr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_k_cmprr(&interp->frame->r[(long)a0], &interp->frame->r[(long)a1]) <= 0) return _k_jump(interp, a2);
 
     return 0;
 }
 
-int _k_refsv(_k_interp_t *interp, char *a0, char *a1, char *a2) {
-    char buf[256];
+int _k_jgerr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_k_cmprr(&interp->frame->r[(long)a0], &interp->frame->r[(long)a1]) >= 0) return _k_jump(interp, a2);
 
-    for (int i = 0; i < 256; i++) {
-        if (a1[i] == '\n' || a1[i] == '\0') {
-            buf[i] = '\0';
-            break;
-        }
+    return 0;
+}
 
-        buf[i] = a1[i];
-    }
+int _k_jeqrr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_k_cmprr(&interp->frame->r[(long)a0], &interp->frame->r[(long)a1]) == 0) return _k_jump(interp, a2);
 
-    for (long i = 0; i < interp->frame->var_count; ++i) {
-        if (strcmp(interp->frame->vars[i].name, buf) == 0) {
-            memcpy(&interp->frame->r[(long)a0], &interp->frame->vars[i].mem, sizeof(long));
+    return 0;
+}
 
-            interp->frame->r[atoi(a0 + 1)].rf = interp->frame->vars[i].type[0] == 'f' ? 1 : 0;
+int _k_jnerr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_k_cmprr(&interp->frame->r[(long)a0], &interp->frame->r[(long)a1]) != 0) return _k_jump(interp, a2);
 
-            return 0;
-        }
-    }
+    return 0;
+}
 
-    printf("Failed to reference variable %s!\n", a1);
+int _k_jltrn(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_k_cmprn(&interp->frame->r[(long)a0], (long)a1) < 0) return _k_jump(interp, a2);
 
-    return 1;
+    return 0;
 }
 
-int _k_savea(_k_interp_t *interp, char *a0, char *a1, char *a2) {
-    long addr = *(long*)&interp->frame->r[(long)a0];
+int _k_jgtrn(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_k_cmprn(&interp->frame->r[(long)a0], (long)a1) > 0) return _k_jump(interp, a2);
 
-    memcpy((char*)addr, &interp->frame->r[(long)a1], sizeof(long));
+    return 0;
+}
 
-    /*if (interp->frame->rf[atoi(a1 + 1)])
-        printf("Saved %f to %ld\n", *(double*)_k_get_register(interp, a1), addr);
+int _k_jlern(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_k_cmprn(&interp->frame->r[(long)a0], (long)a1) <= 0) return _k_jump(interp, a2);
 
-    else printf("Saved %ld to %ld\n", *(long*)_k_get_register(interp, a1), addr);*/
+    return 0;
+}
+
+int _k_jgern(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_k_cmprn(&interp->frame->r[(long)a0], (long)a1) >= 0) return _k_jump(interp, a2);
 
     return 0;
 }
 
-int _k_negrr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
-    _k_reg_t *r0 = &interp->frame->r[(long)a0];
-    _k_reg_t *r1 = &interp->frame->r[(long)a1];
+int _k_jeqrn(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_k_cmprn(&interp->frame->r[(long)a0], (long)a1) == 0) return _k_jump(interp, a2);
 
-    if (r1->rf) {
-        double f = -*(double*)&r1->r;
-        memcpy(&r0->r, &f, sizeof(double));
-        r0->rf = 1;
-    }
+    return 0;
+}
 
-    else {
-        long l = -r1->r;
-        memcpy(&r0->r, &l, sizeof(long));
-        r0->rf = 0;
-    }
+int _k_jnern(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_k_cmprn(&interp->frame->r[(long)a0], (long)a1) != 0) return _k_jump(interp, a2);
 
     return 0;
 }
 
-const _k_inst_t _k_inst_list[] = {
+int _k_jltrf(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_k_cmprf(&interp->frame->r[(long)a0], *(double*)&a1) < 0) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jgtrf(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_k_cmprf(&interp->frame->r[(long)a0], *(double*)&a1) > 0) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jlerf(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_k_cmprf(&interp->frame->r[(long)a0], *(double*)&a1) <= 0) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jgerf(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_k_cmprf(&interp->frame->r[(long)a0], *(double*)&a1) >= 0) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jeqrf(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_k_cmprf(&interp->frame->r[(long)a0], *(double*)&a1) == 0) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jnerf(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_k_cmprf(&interp->frame->r[(long)a0], *(double*)&a1) != 0) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_addii(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = interp->frame->r[(long)a1].r + interp->frame->r[(long)a2].r;
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_addff(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    *(double*)&r0->r = *(double*)&interp->frame->r[(long)a1].r + *(double*)&interp->frame->r[(long)a2].r;
+    r0->rf           = 1;
+
+    return 0;
+}
+
+int _k_subii(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = interp->frame->r[(long)a1].r - interp->frame->r[(long)a2].r;
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_subff(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    *(double*)&r0->r = *(double*)&interp->frame->r[(long)a1].r - *(double*)&interp->frame->r[(long)a2].r;
+    r0->rf           = 1;
+
+    return 0;
+}
+
+int _k_mulii(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = interp->frame->r[(long)a1].r * interp->frame->r[(long)a2].r;
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_mulff(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    *(double*)&r0->r = *(double*)&interp->frame->r[(long)a1].r * *(double*)&interp->frame->r[(long)a2].r;
+    r0->rf           = 1;
+
+    return 0;
+}
+
+int _k_divii(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = interp->frame->r[(long)a1].r / interp->frame->r[(long)a2].r;
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_divff(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    *(double*)&r0->r = *(double*)&interp->frame->r[(long)a1].r / *(double*)&interp->frame->r[(long)a2].r;
+    r0->rf           = 1;
+
+    return 0;
+}
+
+int _k_lesii(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = interp->frame->r[(long)a1].r < interp->frame->r[(long)a2].r;
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_lesff(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = _K_FLT(*(double*)&interp->frame->r[(long)a1].r, *(double*)&interp->frame->r[(long)a2].r);
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_greii(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = interp->frame->r[(long)a1].r > interp->frame->r[(long)a2].r;
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_greff(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = _K_FGT(*(double*)&interp->frame->r[(long)a1].r, *(double*)&interp->frame->r[(long)a2].r);
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_leqii(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = interp->frame->r[(long)a1].r <= interp->frame->r[(long)a2].r;
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_leqff(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = _K_FLE(*(double*)&interp->frame->r[(long)a1].r, *(double*)&interp->frame->r[(long)a2].r);
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_geqii(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = interp->frame->r[(long)a1].r >= interp->frame->r[(long)a2].r;
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_geqff(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = _K_FGE(*(double*)&interp->frame->r[(long)a1].r, *(double*)&interp->frame->r[(long)a2].r);
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_equii(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = interp->frame->r[(long)a1].r == interp->frame->r[(long)a2].r;
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_equff(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = _K_FEQ(*(double*)&interp->frame->r[(long)a1].r, *(double*)&interp->frame->r[(long)a2].r);
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_neqii(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = interp->frame->r[(long)a1].r != interp->frame->r[(long)a2].r;
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_neqff(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = _K_FNE(*(double*)&interp->frame->r[(long)a1].r, *(double*)&interp->frame->r[(long)a2].r);
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_negii(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = -interp->frame->r[(long)a1].r;
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_negff(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    *(double*)&r0->r = -*(double*)&interp->frame->r[(long)a1].r;
+    r0->rf           = 1;
+
+    return 0;
+}
+
+int _k_itofr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    *(double*)&r0->r = (double)interp->frame->r[(long)a1].r;
+    r0->rf           = 1;
+
+    return 0;
+}
+
+int _k_ftoir(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = (long)*(double*)&interp->frame->r[(long)a1].r;
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_rtofr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    *(double*)&r0->r = _k_reg_double(&interp->frame->r[(long)a1]);
+    r0->rf           = 1;
+
+    return 0;
+}
+
+int _k_rtoir(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+    _k_reg_t *r1 = &interp->frame->r[(long)a1];
+
+    r0->r  = r1->rf ? (long)*(double*)&r1->r : r1->r;
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_jltii(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (interp->frame->r[(long)a0].r < interp->frame->r[(long)a1].r) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jgtii(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (interp->frame->r[(long)a0].r > interp->frame->r[(long)a1].r) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jleii(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (interp->frame->r[(long)a0].r <= interp->frame->r[(long)a1].r) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jgeii(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (interp->frame->r[(long)a0].r >= interp->frame->r[(long)a1].r) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jeqii(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (interp->frame->r[(long)a0].r == interp->frame->r[(long)a1].r) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jneii(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (interp->frame->r[(long)a0].r != interp->frame->r[(long)a1].r) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jltff(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_K_FLT(*(double*)&interp->frame->r[(long)a0].r, *(double*)&interp->frame->r[(long)a1].r)) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jgtff(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_K_FGT(*(double*)&interp->frame->r[(long)a0].r, *(double*)&interp->frame->r[(long)a1].r)) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jleff(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_K_FLE(*(double*)&interp->frame->r[(long)a0].r, *(double*)&interp->frame->r[(long)a1].r)) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jgeff(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_K_FGE(*(double*)&interp->frame->r[(long)a0].r, *(double*)&interp->frame->r[(long)a1].r)) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jeqff(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_K_FEQ(*(double*)&interp->frame->r[(long)a0].r, *(double*)&interp->frame->r[(long)a1].r)) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jneff(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_K_FNE(*(double*)&interp->frame->r[(long)a0].r, *(double*)&interp->frame->r[(long)a1].r)) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jltin(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (interp->frame->r[(long)a0].r < (long)a1) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jgtin(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (interp->frame->r[(long)a0].r > (long)a1) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jlein(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (interp->frame->r[(long)a0].r <= (long)a1) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jgein(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (interp->frame->r[(long)a0].r >= (long)a1) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jeqin(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (interp->frame->r[(long)a0].r == (long)a1) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jnein(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (interp->frame->r[(long)a0].r != (long)a1) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jltfn(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_K_FLT(*(double*)&interp->frame->r[(long)a0].r, *(double*)&a1)) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jgtfn(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_K_FGT(*(double*)&interp->frame->r[(long)a0].r, *(double*)&a1)) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jlefn(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_K_FLE(*(double*)&interp->frame->r[(long)a0].r, *(double*)&a1)) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jgefn(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_K_FGE(*(double*)&interp->frame->r[(long)a0].r, *(double*)&a1)) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jeqfn(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_K_FEQ(*(double*)&interp->frame->r[(long)a0].r, *(double*)&a1)) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_jnefn(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    if (_K_FNE(*(double*)&interp->frame->r[(long)a0].r, *(double*)&a1)) return _k_jump(interp, a2);
+
+    return 0;
+}
+
+int _k_addww(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = (unsigned int)(interp->frame->r[(long)a1].r + interp->frame->r[(long)a2].r);
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_addss(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    *(double*)&r0->r = (float)(*(double*)&interp->frame->r[(long)a1].r + *(double*)&interp->frame->r[(long)a2].r);
+    r0->rf           = 1;
+
+    return 0;
+}
+
+int _k_subww(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = (unsigned int)(interp->frame->r[(long)a1].r - interp->frame->r[(long)a2].r);
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_subss(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    *(double*)&r0->r = (float)(*(double*)&interp->frame->r[(long)a1].r - *(double*)&interp->frame->r[(long)a2].r);
+    r0->rf           = 1;
+
+    return 0;
+}
+
+int _k_mulww(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = (unsigned int)(interp->frame->r[(long)a1].r * interp->frame->r[(long)a2].r);
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_mulss(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    *(double*)&r0->r = (float)(*(double*)&interp->frame->r[(long)a1].r * *(double*)&interp->frame->r[(long)a2].r);
+    r0->rf           = 1;
+
+    return 0;
+}
+
+int _k_divww(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = (unsigned int)(interp->frame->r[(long)a1].r / interp->frame->r[(long)a2].r);
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_divss(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    *(double*)&r0->r = (float)(*(double*)&interp->frame->r[(long)a1].r / *(double*)&interp->frame->r[(long)a2].r);
+    r0->rf           = 1;
+
+    return 0;
+}
+
+int _k_negww(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = (unsigned int)-interp->frame->r[(long)a1].r;
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_itowr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = (unsigned int)interp->frame->r[(long)a1].r;
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_ftosr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    *(double*)&r0->r = (float)*(double*)&interp->frame->r[(long)a1].r;
+    r0->rf           = 1;
+
+    return 0;
+}
+
+int _k_derii(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = *(long*)interp->frame->r[(long)a1].r;
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_derff(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    *(double*)&r0->r = *(double*)interp->frame->r[(long)a1].r;
+    r0->rf           = 1;
+
+    return 0;
+}
+
+int _k_derww(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    r0->r  = *(unsigned int*)interp->frame->r[(long)a1].r;
+    r0->rf = 0;
+
+    return 0;
+}
+
+int _k_derss(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+
+    *(double*)&r0->r = *(float*)interp->frame->r[(long)a1].r;
+    r0->rf           = 1;
+
+    return 0;
+}
+
+int _k_savii(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    *(long*)interp->frame->r[(long)a0].r = interp->frame->r[(long)a1].r;
+
+    return 0;
+}
+
+int _k_savff(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    *(double*)interp->frame->r[(long)a0].r = *(double*)&interp->frame->r[(long)a1].r;
+
+    return 0;
+}
+
+int _k_savww(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    *(unsigned int*)interp->frame->r[(long)a0].r = interp->frame->r[(long)a1].r;
+
+    return 0;
+}
+
+int _k_savss(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    *(float*)interp->frame->r[(long)a0].r = *(double*)&interp->frame->r[(long)a1].r;
+
+    return 0;
+}
+
+int _k_deref(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    long addr = *(long*)&interp->frame->r[(long)a1];
+
+    memcpy(&interp->frame->r[(long)a0], (char*)addr, sizeof(long));
+
+    /*if (interp->frame->rf[atoi(a0 + 1)])
+        printf("Dereferenced %ld to %f\n", addr, *(double*)_k_get_register(interp, a0));
+
+    else printf("Dereferenced %ld to %ld\n", addr, *(long*)_k_get_register(interp, a0));*/
+
+    return 0;
+}
+
+int _k_savea(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    long addr = *(long*)&interp->frame->r[(long)a0];
+
+    memcpy((char*)addr, &interp->frame->r[(long)a1], sizeof(long));
+
+    /*if (interp->frame->rf[atoi(a1 + 1)])
+        printf("Saved %f to %ld\n", *(double*)_k_get_register(interp, a1), addr);
+
+    else printf("Saved %ld to %ld\n", *(long*)_k_get_register(interp, a1), addr);*/
+
+    return 0;
+}
+
+int _k_negrr(_k_interp_t *interp, char *a0, char *a1, char *a2) {
+    _k_reg_t *r0 = &interp->frame->r[(long)a0];
+    _k_reg_t *r1 = &interp->frame->r[(long)a1];
+
+    if (r1->rf) {
+        double f = -*(double*)&r1->r;
+        memcpy(&r0->r, &f, sizeof(double));
+        r0->rf = 1;
+    }
+
+    else {
+        long l = -r1->r;
+        memcpy(&r0->r, &l, sizeof(long));
+        r0->rf = 0;
+    }
+
+    return 0;
+}
+
+const _k_inst_t _k_inst_list[] = {
     {"\tpushr:", _k_pushr},
     {"\tpoprr:", _k_poprr},
-    {"\tnewsv:", _k_newsv},
     {"\tleave:", _k_leave},
     {"\tmovrn:", _k_movrn},
     {"\tmovrr:", _k_movrr},
     {"\tcallf:", _k_callf},
-    {"\tloadr:", _k_loadr},
-    {"\tsaver:", _k_saver},
     {"\taddrr:", _k_addrr},
     {"\tsubrr:", _k_subrr},
     {"\tmulrr:", _k_mulrr},
@@ -638,214 +1378,1634 @@ const _k_inst_t _k_inst_list[] = {
     {"\tjmpeq:", _k_jmpeq},
     {"\tjmpal:", _k_jmpal},
     {"\tderef:", _k_deref},
-    {"\trefsv:", _k_refsv},
     {"\tsavea:", _k_savea},
-    {"\tnegrr:", _k_negrr}
+    {"\tnegrr:", _k_negrr},
+    {"\tleqrr:", _k_leqrr},
+    {"\tgeqrr:", _k_geqrr},
+    {"\tneqrr:", _k_neqrr},
+    {"\tjltrr:", _k_jltrr},
+    {"\tjgtrr:", _k_jgtrr},
+    {"\tjlerr:", _k_jlerr},
+    {"\tjgerr:", _k_jgerr},
+    {"\tjeqrr:", _k_jeqrr},
+    {"\tjnerr:", _k_jnerr},
+    {"\tjltrn:", _k_jltrn},
+    {"\tjgtrn:", _k_jgtrn},
+    {"\tjlern:", _k_jlern},
+    {"\tjgern:", _k_jgern},
+    {"\tjeqrn:", _k_jeqrn},
+    {"\tjnern:", _k_jnern},
+    {"\tjltrf:", _k_jltrf},
+    {"\tjgtrf:", _k_jgtrf},
+    {"\tjlerf:", _k_jlerf},
+    {"\tjgerf:", _k_jgerf},
+    {"\tjeqrf:", _k_jeqrf},
+    {"\tjnerf:", _k_jnerf},
+    {"\taddii:", _k_addii},
+    {"\taddff:", _k_addff},
+    {"\tsubii:", _k_subii},
+    {"\tsubff:", _k_subff},
+    {"\tmulii:", _k_mulii},
+    {"\tmulff:", _k_mulff},
+    {"\tdivii:", _k_divii},
+    {"\tdivff:", _k_divff},
+    {"\tlesii:", _k_lesii},
+    {"\tlesff:", _k_lesff},
+    {"\tgreii:", _k_greii},
+    {"\tgreff:", _k_greff},
+    {"\tleqii:", _k_leqii},
+    {"\tleqff:", _k_leqff},
+    {"\tgeqii:", _k_geqii},
+    {"\tgeqff:", _k_geqff},
+    {"\tequii:", _k_equii},
+    {"\tequff:", _k_equff},
+    {"\tneqii:", _k_neqii},
+    {"\tneqff:", _k_neqff},
+    {"\tnegii:", _k_negii},
+    {"\tnegff:", _k_negff},
+    {"\titofr:", _k_itofr},
+    {"\tftoir:", _k_ftoir},
+    {"\trtofr:", _k_rtofr},
+    {"\trtoir:", _k_rtoir},
+    {"\tjltii:", _k_jltii},
+    {"\tjgtii:", _k_jgtii},
+    {"\tjleii:", _k_jleii},
+    {"\tjgeii:", _k_jgeii},
+    {"\tjeqii:", _k_jeqii},
+    {"\tjneii:", _k_jneii},
+    {"\tjltff:", _k_jltff},
+    {"\tjgtff:", _k_jgtff},
+    {"\tjleff:", _k_jleff},
+    {"\tjgeff:", _k_jgeff},
+    {"\tjeqff:", _k_jeqff},
+    {"\tjneff:", _k_jneff},
+    {"\tjltin:", _k_jltin},
+    {"\tjgtin:", _k_jgtin},
+    {"\tjlein:", _k_jlein},
+    {"\tjgein:", _k_jgein},
+    {"\tjeqin:", _k_jeqin},
+    {"\tjnein:", _k_jnein},
+    {"\tjltfn:", _k_jltfn},
+    {"\tjgtfn:", _k_jgtfn},
+    {"\tjlefn:", _k_jlefn},
+    {"\tjgefn:", _k_jgefn},
+    {"\tjeqfn:", _k_jeqfn},
+    {"\tjnefn:", _k_jnefn},
+    {"\taddww:", _k_addww},
+    {"\taddss:", _k_addss},
+    {"\tsubww:", _k_subww},
+    {"\tsubss:", _k_subss},
+    {"\tmulww:", _k_mulww},
+    {"\tmulss:", _k_mulss},
+    {"\tdivww:", _k_divww},
+    {"\tdivss:", _k_divss},
+    {"\tnegww:", _k_negww},
+    {"\titowr:", _k_itowr},
+    {"\tftosr:", _k_ftosr},
+    {"\tderii:", _k_derii},
+    {"\tderff:", _k_derff},
+    {"\tderww:", _k_derww},
+    {"\tderss:", _k_derss},
+    {"\tsavii:", _k_savii},
+    {"\tsavff:", _k_savff},
+    {"\tsavww:", _k_savww},
+    {"\tsavss:", _k_savss},
+    {"\tmovrf:", _k_movrf},
+    {"\tframe:", _k_frame},
+    {"\tlodii:", _k_lodii},
+    {"\tlodff:", _k_lodff},
+    {"\tlodww:", _k_lodww},
+    {"\tlodhh:", _k_lodhh},
+    {"\tlodss:", _k_lodss},
+    {"\tstoii:", _k_stoii},
+    {"\tstoww:", _k_stoww},
+    {"\tstoss:", _k_stoss},
+    {"\trefsl:", _k_refsl},
+    {"\taddqi:", _k_addrr},
+    {"\taddqf:", _k_addrr},
+    {"\tsubqi:", _k_subrr},
+    {"\tsubqf:", _k_subrr},
+    {"\tmulqi:", _k_mulrr},
+    {"\tmulqf:", _k_mulrr},
+    {"\tdivqi:", _k_divrr},
+    {"\tdivqf:", _k_divrr},
+    {"\tlesqi:", _k_lesrr},
+    {"\tlesqf:", _k_lesrr},
+    {"\tgreqi:", _k_grerr},
+    {"\tgreqf:", _k_grerr},
+    {"\tleqqi:", _k_leqrr},
+    {"\tleqqf:", _k_leqrr},
+    {"\tgeqqi:", _k_geqrr},
+    {"\tgeqqf:", _k_geqrr},
+    {"\tequqi:", _k_equrr},
+    {"\tequqf:", _k_equrr},
+    {"\tneqqi:", _k_neqrr},
+    {"\tneqqf:", _k_neqrr},
+    {"\tnegqi:", _k_negrr},
+    {"\tnegqf:", _k_negrr},
+    {"\targrr:", _k_argrr},
+    {"\tcallr:", _k_callr},
+    {"\tcalln:", _k_callr},
+    {"\tfrnat:", _k_frame},
+    {"\tloopb:", _k_jmpal},
+    {"\tloopt:", _k_jmpal},
+    {"\tloopi:", _k_jmpal},
+    {"\thostc:", _k_hostc},
+    {"\tldinc:", _k_lodii},
+    {"\tlljge:", _k_lodii},
+    {"\tllmss:", _k_lodss},
+    {"\tldlii:", _k_lodii},
+    {"\tldsti:", _k_lodii},
+    {"\tadsti:", _k_addii},
+    {"\tstjmp:", _k_stoii},
+    {"\tlddss:", _k_lodii},
+    {"\tpushc:", _k_pushr},
+    {"\tfrpop:", _k_frame},
+    {"\tmvlea:", _k_movrr}
+};
+
+/* Guarded variants of the polymorphic instructions, for integer and float operands.  */
+const short _k_quick_list[_K_INST_COUNT][2] = {
+    [_K_INST_ADDRR] = { _K_INST_ADDQI, _K_INST_ADDQF },
+    [_K_INST_SUBRR] = { _K_INST_SUBQI, _K_INST_SUBQF },
+    [_K_INST_MULRR] = { _K_INST_MULQI, _K_INST_MULQF },
+    [_K_INST_DIVRR] = { _K_INST_DIVQI, _K_INST_DIVQF },
+    [_K_INST_LESRR] = { _K_INST_LESQI, _K_INST_LESQF },
+    [_K_INST_GRERR] = { _K_INST_GREQI, _K_INST_GREQF },
+    [_K_INST_LEQRR] = { _K_INST_LEQQI, _K_INST_LEQQF },
+    [_K_INST_GEQRR] = { _K_INST_GEQQI, _K_INST_GEQQF },
+    [_K_INST_EQURR] = { _K_INST_EQUQI, _K_INST_EQUQF },
+    [_K_INST_NEQRR] = { _K_INST_NEQQI, _K_INST_NEQQF },
+    [_K_INST_NEGRR] = { _K_INST_NEGQI, _K_INST_NEGQF },
+};
+
+const short _k_generic_list[_K_INST_COUNT] = {
+    [_K_INST_ADDQI] = _K_INST_ADDRR, [_K_INST_ADDQF] = _K_INST_ADDRR,
+    [_K_INST_SUBQI] = _K_INST_SUBRR, [_K_INST_SUBQF] = _K_INST_SUBRR,
+    [_K_INST_MULQI] = _K_INST_MULRR, [_K_INST_MULQF] = _K_INST_MULRR,
+    [_K_INST_DIVQI] = _K_INST_DIVRR, [_K_INST_DIVQF] = _K_INST_DIVRR,
+    [_K_INST_LESQI] = _K_INST_LESRR, [_K_INST_LESQF] = _K_INST_LESRR,
+    [_K_INST_GREQI] = _K_INST_GRERR, [_K_INST_GREQF] = _K_INST_GRERR,
+    [_K_INST_LEQQI] = _K_INST_LEQRR, [_K_INST_LEQQF] = _K_INST_LEQRR,
+    [_K_INST_GEQQI] = _K_INST_GEQRR, [_K_INST_GEQQF] = _K_INST_GEQRR,
+    [_K_INST_EQUQI] = _K_INST_EQURR, [_K_INST_EQUQF] = _K_INST_EQURR,
+    [_K_INST_NEQQI] = _K_INST_NEQRR, [_K_INST_NEQQF] = _K_INST_NEQRR,
+    [_K_INST_NEGQI] = _K_INST_NEGRR, [_K_INST_NEGQF] = _K_INST_NEGRR,
+};
+
+/* Superinstructions, in the order the loader tries them, and the runs they stand for.  */
+const _k_fusion_t _k_fusion_list[] = {
+    { _K_INST_LDINC, 4, { _K_INST_LODII, _K_INST_MOVRN, _K_INST_ADDII, _K_INST_STOII } },
+    { _K_INST_LLJGE, 3, { _K_INST_LODII, _K_INST_LODII, _K_INST_JGEII } },
+    { _K_INST_LLMSS, 3, { _K_INST_LODSS, _K_INST_LODSS, _K_INST_MULSS } },
+    { _K_INST_LDLII, 2, { _K_INST_LODII, _K_INST_LODII } },
+    { _K_INST_LDSTI, 2, { _K_INST_LODII, _K_INST_STOII } },
+    { _K_INST_ADSTI, 2, { _K_INST_ADDII, _K_INST_STOII } },
+    { _K_INST_STJMP, 2, { _K_INST_STOII, _K_INST_JMPAL } },
+    { _K_INST_LDDSS, 2, { _K_INST_LODII, _K_INST_DERSS } },
+    { _K_INST_PUSHC, 2, { _K_INST_PUSHR, _K_INST_CALLF } },
+    { _K_INST_FRPOP, 2, { _K_INST_FRAME, _K_INST_POPRR } },
+    { _K_INST_MVLEA, 2, { _K_INST_MOVRR, _K_INST_LEAVE } }
 };
 
-int push(_k_interp_t *interp, void *data, long size) {
-    interp->frame->sp -= size;
-    memcpy(interp->mem + interp->frame->sp, data, size);
+/* The instruction an instruction was loaded as, before fusion, quickening and promotion.  */
+short _k_base_op(short op) {
+    if (op >= _K_INST_FUSED)                        return _k_fusion_list[op - _K_INST_FUSED].ops[0];
+    if (op >= _K_INST_ADDQI && op <= _K_INST_NEGQF) return _k_generic_list[op];
+    if (op == _K_INST_CALLN)                        return _K_INST_CALLR;
+    if (op == _K_INST_FRNAT)                        return _K_INST_FRAME;
+    if (op >= _K_INST_LOOPB && op <= _K_INST_LOOPI) return _K_INST_JMPAL;
+
+    return op;
+}
+
+int push(_k_interp_t *interp, void *data, long size) {
+    interp->frame->sp -= size;
+    memcpy(interp->mem + interp->frame->sp, data, size);
+
+    return 0;
+}
+
+int call(_k_interp_t *interp, char *func) {
+    if (_k_enter(interp) == (_k_frame_t*)0x0) return 1;
+
+    return _k_find_label(interp, func);
+}
+
+/*
+ *    Records an executed instruction, counting the n-gram it ends if the
+ *    n instructions before it ran in a straight line.
+ *
+ *    @param _k_grams_t *grams    The counts.
+ *    @param _k_inst2_t *inst     The instruction.
+ */
+void _k_count_gram(_k_grams_t *grams, _k_inst2_t *inst) {
+    unsigned long mask = (1UL << (_K_GRAM_BITS * grams->n)) - 1;
+    short         op   = inst->op;
+
+    /* Counts what the main loop would dispatch, superinstructions taking their whole run.  */
+    if (inst == (_k_inst2_t*)grams->last + 1 && grams->skip > 0) {
+        grams->skip--;
+    } else {
+        grams->dispatches++;
+        grams->skip = op >= _K_INST_FUSED ? _k_fusion_list[op - _K_INST_FUSED].length - 1 : 0;
+    }
+
+    /* N-grams are of the instructions as loaded from source.  */
+    if (op >= _K_INST_FUSED)                          op = _k_fusion_list[op - _K_INST_FUSED].ops[0];
+    else if (op >= _K_INST_ADDQI && op <= _K_INST_NEGQF) op = _k_generic_list[op];
+    else if (op >= _K_INST_LOOPB && op <= _K_INST_LOOPI) op = _K_INST_JMPAL;
+
+    if (inst != (_k_inst2_t*)grams->last + 1) grams->length = 0;
+
+    grams->last   = inst;
+    grams->window = (grams->window << _K_GRAM_BITS | op) & mask;
+
+    if (++grams->length < grams->n) return;
+
+    for (unsigned long h = _k_hash((const char*)&grams->window, sizeof(unsigned long));; h++) {
+        unsigned long *key = &grams->keys[h & (_K_GRAM_BUCKETS - 1)];
+
+        if (*key == 0) {
+            if (2 * grams->distinct >= _K_GRAM_BUCKETS) return;
+
+            *key = grams->window + 1;
+
+            grams->distinct++;
+        }
+
+        if (*key == grams->window + 1) {
+            grams->counts[h & (_K_GRAM_BUCKETS - 1)]++;
+            grams->total++;
+
+            return;
+        }
+    }
+}
+
+double _k_loop_calls(_k_interp_t *interp, _k_frame_t *start, long *count, _k_grams_t *grams) {
+    double r0 = 0;
+    do {
+        r0 = *(double*)&interp->frame->r[0];
+
+        if (grams != (_k_grams_t*)0x0) _k_count_gram(grams, interp->frame->cur);
+
+        if (interp->frame->cur->func(interp, interp->frame->cur->a0, interp->frame->cur->a1, interp->frame->cur->a2)) {
+            _k_print_location(interp, interp->frame->cur);
+
+            return 1;
+        }
+
+        interp->frame->cur++;
+
+        (*count)++;
+    } while(interp->frame != start);
+
+    return r0;
+}
+
+#define _K_R(a) (regs[(long)ip->a])
+#define _K_F(a) (*(double*)&regs[(long)ip->a].r)
+
+/* Operands of the instructions a superinstruction stands for.  */
+#define _K_RN(n, a) (regs[(long)ip[n].a])
+#define _K_FN(n, a) (*(double*)&regs[(long)ip[n].a].r)
+
+/* Contexts on other cores rewrite instructions as they run them, their operands first, so handlers are read with acquire.  */
+#ifdef _K_THREADED
+#define _K_OP(op)    op_##op:
+#define _K_CALL      op_call:
+#define _K_ADDR(i)   __atomic_load_n(&(i)->addr, __ATOMIC_ACQUIRE)
+#define _K_NEXT      goto *_K_ADDR(++ip)
+#define _K_GO        goto *_K_ADDR(ip)
+#define _K_SKIP(n)   goto *_K_ADDR(ip += (n))
+#define _K_JUMP(a)   { ip = (_k_inst2_t*)ip->a; goto *_K_ADDR(ip); }
+#define _K_SET(o)    { short _o = (o); __atomic_store_n(&ip->op, _o, __ATOMIC_RELAXED); __atomic_store_n(&ip->addr, ops[_o], __ATOMIC_RELEASE); }
+#define _K_BIND      goto op_bind
+#else
+#define _K_OP(op)    case _K_INST_##op:
+#define _K_CALL      default: op_call:
+#define _K_NEXT      ++ip; continue
+#define _K_GO        continue
+#define _K_SKIP(n)   ip += (n); continue
+#define _K_JUMP(a)   { ip = (_k_inst2_t*)ip->a; continue; }
+#define _K_SET(o)    { __atomic_store_n(&ip->op, (o), __ATOMIC_RELEASE); }
+#define _K_BIND      continue
+#endif
+
+double loop(_k_interp_t *interp, _k_frame_t *start) {
+    _k_frame_t *frame = interp->frame;
+    _k_inst2_t *ip    = frame->cur;
+    _k_reg_t   *regs  = frame->r;
+    char       *slots = interp->mem + frame->bp;
+    double      r0    = 0;
+    _k_inst2_t *hot;
+    void       *native;
+
+#ifdef _K_THREADED
+    static void *const ops[_K_INST_COUNT] = {
+        [_K_INST_PUSHR] = &&op_PUSHR, [_K_INST_POPRR] = &&op_POPRR, [_K_INST_MOVRN] = &&op_MOVRN,
+        [_K_INST_MOVRF] = &&op_MOVRF, [_K_INST_MOVRR] = &&op_MOVRR,
+        [_K_INST_ADDII] = &&op_ADDII, [_K_INST_ADDFF] = &&op_ADDFF, [_K_INST_ADDWW] = &&op_ADDWW, [_K_INST_ADDSS] = &&op_ADDSS,
+        [_K_INST_SUBII] = &&op_SUBII, [_K_INST_SUBFF] = &&op_SUBFF, [_K_INST_SUBWW] = &&op_SUBWW, [_K_INST_SUBSS] = &&op_SUBSS,
+        [_K_INST_MULII] = &&op_MULII, [_K_INST_MULFF] = &&op_MULFF, [_K_INST_MULWW] = &&op_MULWW, [_K_INST_MULSS] = &&op_MULSS,
+        [_K_INST_DIVII] = &&op_DIVII, [_K_INST_DIVFF] = &&op_DIVFF, [_K_INST_DIVWW] = &&op_DIVWW, [_K_INST_DIVSS] = &&op_DIVSS,
+        [_K_INST_LESII] = &&op_LESII, [_K_INST_LESFF] = &&op_LESFF, [_K_INST_GREII] = &&op_GREII, [_K_INST_GREFF] = &&op_GREFF,
+        [_K_INST_LEQII] = &&op_LEQII, [_K_INST_LEQFF] = &&op_LEQFF, [_K_INST_GEQII] = &&op_GEQII, [_K_INST_GEQFF] = &&op_GEQFF,
+        [_K_INST_EQUII] = &&op_EQUII, [_K_INST_EQUFF] = &&op_EQUFF, [_K_INST_NEQII] = &&op_NEQII, [_K_INST_NEQFF] = &&op_NEQFF,
+        [_K_INST_NEGII] = &&op_NEGII, [_K_INST_NEGFF] = &&op_NEGFF, [_K_INST_NEGWW] = &&op_NEGWW,
+        [_K_INST_ITOFR] = &&op_ITOFR, [_K_INST_FTOIR] = &&op_FTOIR, [_K_INST_ITOWR] = &&op_ITOWR, [_K_INST_FTOSR] = &&op_FTOSR,
+        [_K_INST_DERII] = &&op_DERII, [_K_INST_DERFF] = &&op_DERFF, [_K_INST_DERWW] = &&op_DERWW, [_K_INST_DERSS] = &&op_DERSS,
+        [_K_INST_SAVII] = &&op_SAVII, [_K_INST_SAVFF] = &&op_SAVFF, [_K_INST_SAVWW] = &&op_SAVWW, [_K_INST_SAVSS] = &&op_SAVSS,
+        [_K_INST_FRAME] = &&op_FRAME, [_K_INST_REFSL] = &&op_REFSL, [_K_INST_CALLF] = &&op_CALLF, [_K_INST_LEAVE] = &&op_LEAVE,
+        [_K_INST_ARGRR] = &&op_ARGRR, [_K_INST_CALLR] = &&op_CALLR,
+        [_K_INST_CALLN] = &&op_CALLN, [_K_INST_FRNAT] = &&op_FRNAT, [_K_INST_LOOPB] = &&op_LOOPB, [_K_INST_LOOPT] = &&op_LOOPT, [_K_INST_LOOPI] = &&op_LOOPI,
+        [_K_INST_LODII] = &&op_LODII, [_K_INST_LODFF] = &&op_LODFF, [_K_INST_LODWW] = &&op_LODWW, [_K_INST_LODHH] = &&op_LODHH, [_K_INST_LODSS] = &&op_LODSS,
+        [_K_INST_STOII] = &&op_STOII, [_K_INST_STOWW] = &&op_STOWW, [_K_INST_STOSS] = &&op_STOSS,
+        [_K_INST_ADDRR] = &&op_ADDRR, [_K_INST_SUBRR] = &&op_SUBRR, [_K_INST_MULRR] = &&op_MULRR, [_K_INST_DIVRR] = &&op_DIVRR, [_K_INST_LESRR] = &&op_LESRR, [_K_INST_GRERR] = &&op_GRERR,
+        [_K_INST_LEQRR] = &&op_LEQRR, [_K_INST_GEQRR] = &&op_GEQRR, [_K_INST_EQURR] = &&op_EQURR, [_K_INST_NEQRR] = &&op_NEQRR, [_K_INST_NEGRR] = &&op_NEGRR,
+        [_K_INST_ADDQI] = &&op_ADDQI, [_K_INST_ADDQF] = &&op_ADDQF, [_K_INST_SUBQI] = &&op_SUBQI, [_K_INST_SUBQF] = &&op_SUBQF, [_K_INST_MULQI] = &&op_MULQI, [_K_INST_MULQF] = &&op_MULQF, [_K_INST_DIVQI] = &&op_DIVQI, [_K_INST_DIVQF] = &&op_DIVQF,
+        [_K_INST_LESQI] = &&op_LESQI, [_K_INST_LESQF] = &&op_LESQF, [_K_INST_GREQI] = &&op_GREQI, [_K_INST_GREQF] = &&op_GREQF, [_K_INST_LEQQI] = &&op_LEQQI, [_K_INST_LEQQF] = &&op_LEQQF, [_K_INST_GEQQI] = &&op_GEQQI, [_K_INST_GEQQF] = &&op_GEQQF,
+        [_K_INST_EQUQI] = &&op_EQUQI, [_K_INST_EQUQF] = &&op_EQUQF, [_K_INST_NEQQI] = &&op_NEQQI, [_K_INST_NEQQF] = &&op_NEQQF, [_K_INST_NEGQI] = &&op_NEGQI, [_K_INST_NEGQF] = &&op_NEGQF,
+        [_K_INST_LDINC] = &&op_LDINC, [_K_INST_LLJGE] = &&op_LLJGE, [_K_INST_LLMSS] = &&op_LLMSS, [_K_INST_LDLII] = &&op_LDLII, [_K_INST_LDSTI] = &&op_LDSTI, [_K_INST_ADSTI] = &&op_ADSTI,
+        [_K_INST_STJMP] = &&op_STJMP, [_K_INST_LDDSS] = &&op_LDDSS, [_K_INST_PUSHC] = &&op_PUSHC, [_K_INST_FRPOP] = &&op_FRPOP, [_K_INST_MVLEA] = &&op_MVLEA,
+        [_K_INST_CMPRD] = &&op_CMPRD, [_K_INST_JMPEQ] = &&op_JMPEQ, [_K_INST_JMPAL] = &&op_JMPAL,
+        [_K_INST_JLTRR] = &&op_JLTRR, [_K_INST_JGTRR] = &&op_JGTRR, [_K_INST_JLERR] = &&op_JLERR, [_K_INST_JGERR] = &&op_JGERR, [_K_INST_JEQRR] = &&op_JEQRR, [_K_INST_JNERR] = &&op_JNERR,
+        [_K_INST_JLTRN] = &&op_JLTRN, [_K_INST_JGTRN] = &&op_JGTRN, [_K_INST_JLERN] = &&op_JLERN, [_K_INST_JGERN] = &&op_JGERN, [_K_INST_JEQRN] = &&op_JEQRN, [_K_INST_JNERN] = &&op_JNERN,
+        [_K_INST_JLTRF] = &&op_JLTRF, [_K_INST_JGTRF] = &&op_JGTRF, [_K_INST_JLERF] = &&op_JLERF, [_K_INST_JGERF] = &&op_JGERF, [_K_INST_JEQRF] = &&op_JEQRF, [_K_INST_JNERF] = &&op_JNERF,
+        [_K_INST_JLTII] = &&op_JLTII, [_K_INST_JGTII] = &&op_JGTII, [_K_INST_JLEII] = &&op_JLEII, [_K_INST_JGEII] = &&op_JGEII, [_K_INST_JEQII] = &&op_JEQII, [_K_INST_JNEII] = &&op_JNEII,
+        [_K_INST_JLTFF] = &&op_JLTFF, [_K_INST_JGTFF] = &&op_JGTFF, [_K_INST_JLEFF] = &&op_JLEFF, [_K_INST_JGEFF] = &&op_JGEFF, [_K_INST_JEQFF] = &&op_JEQFF, [_K_INST_JNEFF] = &&op_JNEFF,
+        [_K_INST_JLTIN] = &&op_JLTIN, [_K_INST_JGTIN] = &&op_JGTIN, [_K_INST_JLEIN] = &&op_JLEIN, [_K_INST_JGEIN] = &&op_JGEIN, [_K_INST_JEQIN] = &&op_JEQIN, [_K_INST_JNEIN] = &&op_JNEIN,
+        [_K_INST_JLTFN] = &&op_JLTFN, [_K_INST_JGTFN] = &&op_JGTFN, [_K_INST_JLEFN] = &&op_JLEFN, [_K_INST_JGEFN] = &&op_JGEFN, [_K_INST_JEQFN] = &&op_JEQFN, [_K_INST_JNEFN] = &&op_JNEFN,
+    };
+
+    /* Binds every instruction to its handler the first time the module runs, and again once any is promoted, under the lock promotions take.  */
+op_bind:
+    if (!__atomic_load_n(&interp->module->threaded, __ATOMIC_ACQUIRE)) {
+        _K_LOCK(interp->module);
+
+        /* Only instructions that changed are written, as other contexts are dispatching through the rest.  */
+        for (long i = 0; i < interp->module->inst_count; ++i) {
+            short op   = __atomic_load_n(&interp->module->insts[i].op, __ATOMIC_RELAXED);
+            void *addr = op < _K_INST_COUNT && ops[op] != (void*)0x0 ? ops[op] : &&op_call;
+
+            if (__atomic_load_n(&interp->module->insts[i].addr, __ATOMIC_RELAXED) != addr) __atomic_store_n(&interp->module->insts[i].addr, addr, __ATOMIC_RELEASE);
+        }
+
+        __atomic_store_n(&interp->module->threaded, 1, __ATOMIC_RELEASE);
+
+        _K_UNLOCK(interp->module);
+    }
+
+    _K_GO;
+#else
+    for (;;) switch (__atomic_load_n(&ip->op, __ATOMIC_ACQUIRE)) {
+#endif
+
+    _K_OP(PUSHR) frame->sp -= sizeof(long); memcpy(interp->mem + frame->sp, &_K_R(a0), sizeof(long)); _K_NEXT;
+    _K_OP(POPRR) memcpy(&_K_R(a0), interp->mem + frame->ap, sizeof(long)); frame->ap += sizeof(long); _K_NEXT;
+    _K_OP(MOVRN) _K_R(a0).r = (long)ip->a1; _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(MOVRF) _K_R(a0).r = (long)ip->a1; _K_R(a0).rf = 1; _K_NEXT;
+    _K_OP(MOVRR) _K_R(a0) = _K_R(a1); _K_NEXT;
+
+    _K_OP(ADDII) _K_R(a0).r = _K_R(a1).r + _K_R(a2).r;                   _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(ADDFF) _K_F(a0)   = _K_F(a1) + _K_F(a2);                       _K_R(a0).rf = 1; _K_NEXT;
+    _K_OP(ADDWW) _K_R(a0).r = (unsigned int)(_K_R(a1).r + _K_R(a2).r);   _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(ADDSS) _K_F(a0)   = (float)(_K_F(a1) + _K_F(a2));              _K_R(a0).rf = 1; _K_NEXT;
+    _K_OP(SUBII) _K_R(a0).r = _K_R(a1).r - _K_R(a2).r;                   _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(SUBFF) _K_F(a0)   = _K_F(a1) - _K_F(a2);                       _K_R(a0).rf = 1; _K_NEXT;
+    _K_OP(SUBWW) _K_R(a0).r = (unsigned int)(_K_R(a1).r - _K_R(a2).r);   _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(SUBSS) _K_F(a0)   = (float)(_K_F(a1) - _K_F(a2));              _K_R(a0).rf = 1; _K_NEXT;
+    _K_OP(MULII) _K_R(a0).r = _K_R(a1).r * _K_R(a2).r;                   _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(MULFF) _K_F(a0)   = _K_F(a1) * _K_F(a2);                       _K_R(a0).rf = 1; _K_NEXT;
+    _K_OP(MULWW) _K_R(a0).r = (unsigned int)(_K_R(a1).r * _K_R(a2).r);   _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(MULSS) _K_F(a0)   = (float)(_K_F(a1) * _K_F(a2));              _K_R(a0).rf = 1; _K_NEXT;
+    _K_OP(DIVII) _K_R(a0).r = _K_R(a1).r / _K_R(a2).r;                   _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(DIVFF) _K_F(a0)   = _K_F(a1) / _K_F(a2);                       _K_R(a0).rf = 1; _K_NEXT;
+    _K_OP(DIVWW) _K_R(a0).r = (unsigned int)(_K_R(a1).r / _K_R(a2).r);   _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(DIVSS) _K_F(a0)   = (float)(_K_F(a1) / _K_F(a2));              _K_R(a0).rf = 1; _K_NEXT;
+
+    _K_OP(LESII) _K_R(a0).r = _K_R(a1).r <  _K_R(a2).r; _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(LESFF) _K_R(a0).r = _K_FLT(_K_F(a1), _K_F(a2));   _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(GREII) _K_R(a0).r = _K_R(a1).r >  _K_R(a2).r; _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(GREFF) _K_R(a0).r = _K_FGT(_K_F(a1), _K_F(a2));   _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(LEQII) _K_R(a0).r = _K_R(a1).r <= _K_R(a2).r; _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(LEQFF) _K_R(a0).r = _K_FLE(_K_F(a1), _K_F(a2));   _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(GEQII) _K_R(a0).r = _K_R(a1).r >= _K_R(a2).r; _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(GEQFF) _K_R(a0).r = _K_FGE(_K_F(a1), _K_F(a2));   _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(EQUII) _K_R(a0).r = _K_R(a1).r == _K_R(a2).r; _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(EQUFF) _K_R(a0).r = _K_FEQ(_K_F(a1), _K_F(a2));   _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(NEQII) _K_R(a0).r = _K_R(a1).r != _K_R(a2).r; _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(NEQFF) _K_R(a0).r = _K_FNE(_K_F(a1), _K_F(a2));   _K_R(a0).rf = 0; _K_NEXT;
+
+    _K_OP(NEGII) _K_R(a0).r = -_K_R(a1).r;                _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(NEGFF) _K_F(a0)   = -_K_F(a1);                  _K_R(a0).rf = 1; _K_NEXT;
+    _K_OP(NEGWW) _K_R(a0).r = (unsigned int)-_K_R(a1).r;  _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(ITOFR) _K_F(a0)   = (double)_K_R(a1).r;         _K_R(a0).rf = 1; _K_NEXT;
+    _K_OP(FTOIR) _K_R(a0).r = (long)_K_F(a1);             _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(ITOWR) _K_R(a0).r = (unsigned int)_K_R(a1).r;   _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(FTOSR) _K_F(a0)   = (float)_K_F(a1);            _K_R(a0).rf = 1; _K_NEXT;
+
+    _K_OP(DERII) _K_R(a0).r = *(long*)_K_R(a1).r;         _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(DERFF) _K_F(a0)   = *(double*)_K_R(a1).r;       _K_R(a0).rf = 1; _K_NEXT;
+    _K_OP(DERWW) _K_R(a0).r = *(unsigned int*)_K_R(a1).r; _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(DERSS) _K_F(a0)   = *(float*)_K_R(a1).r;        _K_R(a0).rf = 1; _K_NEXT;
+    _K_OP(SAVII) *(long*)_K_R(a0).r         = _K_R(a1).r; _K_NEXT;
+    _K_OP(SAVFF) *(double*)_K_R(a0).r       = _K_F(a1);   _K_NEXT;
+    _K_OP(SAVWW) *(unsigned int*)_K_R(a0).r = _K_R(a1).r; _K_NEXT;
+    _K_OP(SAVSS) *(float*)_K_R(a0).r        = _K_F(a1);   _K_NEXT;
+
+    /* Entering a function, as taking a back-edge, counts against the context's budget.  */
+    _K_OP(FRAME)
+        if (--interp->budget < 0) goto op_yield;
+        if (_K_HEAT(ip)) { hot = ip; goto op_tier; }
+        if (frame->sp < (long)ip->a0) goto op_call;
+        frame->ap   = frame->sp;
+        frame->sp   = (frame->sp - (long)ip->a0) & ~(long)(sizeof(long) - 1);
+        frame->bp   = frame->sp;
+        frame->regs = (long)ip->a1;
+        slots       = interp->mem + frame->bp;
+        _K_NEXT;
+
+    /* Calls and returns only move along the frame stack; the handlers report overflows.  */
+    _K_OP(CALLF) op_callf:
+        if (frame + 1 == interp->frames + _K_STACK_DEPTH) goto op_call;
+        frame->cur     = ip;
+        frame[1].sp    = frame->sp;
+        frame[1].bp    = frame->sp;
+        frame[1].r     = regs + frame->regs;
+        frame[1].regs  = _K_FRAME_REGS;
+        interp->frame  = ++frame;
+        regs           = frame->r;
+        _K_JUMP(a0);
+
+    /* Register calls write their arguments into the callee's window, and enter it past its poprr's.  */
+    _K_OP(ARGRR) regs[frame->regs + (long)ip->a0] = _K_R(a1); _K_NEXT;
+
+    _K_OP(CALLR) {
+        _k_inst2_t *entry = (_k_inst2_t*)ip->a0;
+
+        if (--interp->budget < 0) goto op_yield;
+        if (_K_HEAT(entry)) { hot = entry; goto op_tier; }
+        if (frame + 1 == interp->frames + _K_STACK_DEPTH || frame->sp < (long)entry->a0) goto op_call;
+        frame->cur     = ip;
+        frame[1].ap    = frame->sp;
+        frame[1].sp    = (frame->sp - (long)entry->a0) & ~(long)(sizeof(long) - 1);
+        frame[1].bp    = frame[1].sp;
+        frame[1].r     = regs + frame->regs;
+        frame[1].regs  = (long)entry->a1;
+        interp->frame  = ++frame;
+        regs           = frame->r;
+        slots          = interp->mem + frame->bp;
+        ip             = entry + 1 + (long)ip->a2;
+        _K_GO;
+    }
+
+    /* Compiled functions run natively on the frame set up for them, and leave it themselves.  */
+    _K_OP(CALLN) {
+        _k_inst2_t *entry = (_k_inst2_t*)ip->a0;
+        int         status;
+
+        if (--interp->budget < 0) goto op_yield;
+        if (frame + 1 == interp->frames + _K_STACK_DEPTH || frame->sp < (long)entry->a0) goto op_call;
+        frame->cur     = ip;
+        frame[1].ap    = frame->sp;
+        frame[1].sp    = (frame->sp - (long)entry->a0) & ~(long)(sizeof(long) - 1);
+        frame[1].bp    = frame[1].sp;
+        frame[1].r     = regs + frame->regs;
+        frame[1].regs  = (long)entry->a1;
+        interp->frame  = frame + 1;
+
+        if ((status = interp->module->native(interp, __atomic_load_n(&ip->a1, __ATOMIC_ACQUIRE))) == 3) goto op_resume;
+
+        if (status != 0) {
+            if (status == 1) _k_print_location(interp, interp->frame->cur);
+
+            return 1;
+        }
+
+        _K_NEXT;
+    }
+
+    _K_OP(FRNAT)
+        if (--interp->budget < 0) goto op_yield;
+        if (frame->sp < (long)ip->a0) goto op_call;
+        frame->ap   = frame->sp;
+        frame->sp   = (frame->sp - (long)ip->a0) & ~(long)(sizeof(long) - 1);
+        frame->bp   = frame->sp;
+        frame->regs = (long)ip->a1;
+        native      = __atomic_load_n(&ip->a2, __ATOMIC_ACQUIRE);
+        goto op_native;
+
+    /* Back-edges count toward promoting their function, and carry on in its native code once it has some.  */
+    _K_OP(LOOPB) op_loopb:
+        if (--interp->budget < 0) goto op_yield;
+        if (__atomic_load_n(&((_k_inst2_t*)ip->a1)->heat, __ATOMIC_RELAXED) >= _K_TIER_HOT ||
+            __atomic_add_fetch(&((_k_inst2_t*)ip->a1)->heat, 1, __ATOMIC_RELAXED) >= _K_TIER_HOT) goto op_osr;
+        _K_JUMP(a0);
+
+    op_osr:
+        _k_tier(interp, (_k_inst2_t*)ip->a1);
+
+        {
+            void **at = __atomic_load_n(&interp->module->native_at, __ATOMIC_ACQUIRE);
+
+            if (at != (void**)0x0 && (native = __atomic_load_n(&at[(_k_inst2_t*)ip->a0 - interp->module->insts], __ATOMIC_ACQUIRE)) != (void*)0x0) goto op_native;
+        }
+
+        /* Loops of functions left interpreted are traced instead, until tracing them has failed too often.  */
+        if (!interp->module->tracing || __atomic_load_n(&ip->flags, __ATOMIC_RELAXED) >= _K_DEOPTS) {
+            _K_SET(_K_INST_LOOPI);
+            _K_JUMP(a0);
+        }
+
+        if (_k_trace(interp, ip)) {
+            _k_print_location(interp, interp->frame->cur);
+
+            return 1;
+        }
+
+    /* Picks up wherever recording a trace, or leaving one, left the interpreter.  */
+    op_resume:
+        frame = interp->frame;
+        ip    = frame->cur;
+        regs  = frame->r;
+        slots = interp->mem + frame->bp;
+
+        /* Native code out of budget leaves at the instruction the interpreter parks at.  */
+        if (interp->budget < 0) return r0;
+
+        _K_BIND;
+
+    /* Back-edges whose loops stay interpreted only count against the budget.  */
+    _K_OP(LOOPI) op_loopi:
+        if (--interp->budget < 0) goto op_yield;
+        _K_JUMP(a0);
+
+    /* Traces run a loop natively from its back-edge, and leave through side exits.  */
+    _K_OP(LOOPT) op_loopt:
+        if (--interp->budget < 0) goto op_yield;
+        native = __atomic_load_n(&ip->a2, __ATOMIC_ACQUIRE);
+
+    op_native: {
+        int status;
+
+        frame->cur = ip;
+
+        if ((status = interp->module->native(interp, native)) == 3) goto op_resume;
+
+        if (status != 0) {
+            if (status == 1) _k_print_location(interp, interp->frame->cur);
+
+            return 1;
+        }
+
+        frame = interp->frame;
+        r0    = *(double*)&frame->r[0];
+
+        frame->cur++;
+
+        if (frame == start) goto op_return;
+
+        ip    = frame->cur;
+        regs  = frame->r;
+        slots = interp->mem + frame->bp;
+        _K_BIND;
+    }
+
+    /* A run out of budget parks before the instruction that found it out, which runs again as it is resumed.  */
+    op_yield:
+        frame->cur = ip;
+        return r0;
+
+    /* A function turning hot is promoted, and the instruction that found it hot runs again in its new form.  */
+    op_tier:
+        _k_tier(interp, hot);
+        _K_BIND;
+
+    /* Returning to the host ends the run, unless a batch has calls left, which start straight away. Native code calling back in returns to its own frame.  */
+    op_return:
+        if (interp->batch == (_k_batch_t*)0x0 || start != interp->batch->host || _k_batch_next(interp, interp->batch)) return r0;
+
+        frame = interp->frame;
+        ip    = frame->cur;
+        regs  = frame->r;
+        slots = interp->mem + frame->bp;
+        _K_BIND;
+
+    _K_OP(LEAVE) op_leave:
+        if (frame == interp->frames) goto op_call;
+        r0             = *(double*)&regs[0];
+        frame[-1].r[0] = regs[0];
+        frame[-1].sp   = frame->ap;
+        interp->frame  = --frame;
+
+        frame->cur++;
+
+        if (frame == start) goto op_return;
+
+        ip    = frame->cur;
+        regs  = frame->r;
+        slots = interp->mem + frame->bp;
+        _K_GO;
+
+    _K_OP(LODII) _K_R(a0).r = *(long*)(slots + (long)ip->a1);         _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(LODFF) _K_F(a0)   = *(double*)(slots + (long)ip->a1);       _K_R(a0).rf = 1; _K_NEXT;
+    _K_OP(LODWW) _K_R(a0).r = *(unsigned int*)(slots + (long)ip->a1); _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(LODHH) _K_R(a0).r = *(int*)(slots + (long)ip->a1);          _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(LODSS) _K_F(a0)   = *(float*)(slots + (long)ip->a1);        _K_R(a0).rf = 1; _K_NEXT;
+    _K_OP(STOII) *(long*)(slots + (long)ip->a0)  = _K_R(a1).r;        _K_NEXT;
+    _K_OP(STOWW) *(int*)(slots + (long)ip->a0)   = (int)_K_R(a1).r;   _K_NEXT;
+    _K_OP(STOSS) *(float*)(slots + (long)ip->a0) = (float)_K_F(a1);   _K_NEXT;
+    _K_OP(REFSL) _K_R(a0).r = (long)(slots + (long)ip->a1);           _K_R(a0).rf = 0; _K_NEXT;
+
+    /* Superinstructions run the instructions that follow them inline, then skip past them.  */
+    _K_OP(LDINC)
+        _K_RN(0, a0).r = *(long*)(slots + (long)ip[0].a1);    _K_RN(0, a0).rf = 0;
+        _K_RN(1, a0).r = (long)ip[1].a1;                       _K_RN(1, a0).rf = 0;
+        _K_RN(2, a0).r = _K_RN(2, a1).r + _K_RN(2, a2).r;      _K_RN(2, a0).rf = 0;
+        *(long*)(slots + (long)ip[3].a0) = _K_RN(3, a1).r;
+        _K_SKIP(4);
+    _K_OP(LLJGE)
+        _K_RN(0, a0).r = *(long*)(slots + (long)ip[0].a1);    _K_RN(0, a0).rf = 0;
+        _K_RN(1, a0).r = *(long*)(slots + (long)ip[1].a1);    _K_RN(1, a0).rf = 0;
+        if (_K_RN(2, a0).r >= _K_RN(2, a1).r) { ip = (_k_inst2_t*)ip[2].a2; _K_GO; }
+        _K_SKIP(3);
+    _K_OP(LLMSS)
+        _K_FN(0, a0) = *(float*)(slots + (long)ip[0].a1);     _K_RN(0, a0).rf = 1;
+        _K_FN(1, a0) = *(float*)(slots + (long)ip[1].a1);     _K_RN(1, a0).rf = 1;
+        _K_FN(2, a0) = (float)(_K_FN(2, a1) * _K_FN(2, a2));  _K_RN(2, a0).rf = 1;
+        _K_SKIP(3);
+    _K_OP(LDLII)
+        _K_RN(0, a0).r = *(long*)(slots + (long)ip[0].a1);    _K_RN(0, a0).rf = 0;
+        _K_RN(1, a0).r = *(long*)(slots + (long)ip[1].a1);    _K_RN(1, a0).rf = 0;
+        _K_SKIP(2);
+    _K_OP(LDSTI)
+        _K_RN(0, a0).r = *(long*)(slots + (long)ip[0].a1);    _K_RN(0, a0).rf = 0;
+        *(long*)(slots + (long)ip[1].a0) = _K_RN(1, a1).r;
+        _K_SKIP(2);
+    _K_OP(ADSTI)
+        _K_RN(0, a0).r = _K_RN(0, a1).r + _K_RN(0, a2).r;      _K_RN(0, a0).rf = 0;
+        *(long*)(slots + (long)ip[1].a0) = _K_RN(1, a1).r;
+        _K_SKIP(2);
+    _K_OP(STJMP)
+        *(long*)(slots + (long)ip[0].a0) = _K_RN(0, a1).r;
+        if ((++ip)->op == _K_INST_LOOPB) goto op_loopb;
+        if (ip->op == _K_INST_LOOPT)     goto op_loopt;
+        if (ip->op == _K_INST_LOOPI)     goto op_loopi;
+        _K_JUMP(a0);
+    _K_OP(LDDSS)
+        _K_RN(0, a0).r = *(long*)(slots + (long)ip[0].a1);    _K_RN(0, a0).rf = 0;
+        _K_FN(1, a0)   = *(float*)_K_RN(1, a1).r;              _K_RN(1, a0).rf = 1;
+        _K_SKIP(2);
+    _K_OP(PUSHC)
+        frame->sp -= sizeof(long);
+        memcpy(interp->mem + frame->sp, &_K_R(a0), sizeof(long));
+        ip++;
+        goto op_callf;
+    _K_OP(FRPOP)
+        if (--interp->budget < 0) goto op_yield;
+        if (_K_HEAT(ip)) { hot = ip; goto op_tier; }
+        if (frame->sp < (long)ip->a0) goto op_call;
+        frame->ap   = frame->sp;
+        frame->sp   = (frame->sp - (long)ip->a0) & ~(long)(sizeof(long) - 1);
+        frame->bp   = frame->sp;
+        frame->regs = (long)ip->a1;
+        slots       = interp->mem + frame->bp;
+        memcpy(&_K_RN(1, a0), interp->mem + frame->ap, sizeof(long));
+        frame->ap  += sizeof(long);
+        _K_SKIP(2);
+    _K_OP(MVLEA)
+        _K_R(a0) = _K_R(a1);
+        ip++;
+        goto op_leave;
+
+    /* Polymorphic instructions rewrite themselves into a variant guarded on the kinds they see. Contexts rewriting one at once each go by its generic form, so any of them can land last.  */
+    _K_OP(ADDRR) _K_OP(SUBRR) _K_OP(MULRR) _K_OP(DIVRR) _K_OP(LESRR) _K_OP(GRERR)
+    _K_OP(LEQRR) _K_OP(GEQRR) _K_OP(EQURR) _K_OP(NEQRR)
+        if (__atomic_load_n(&ip->flags, __ATOMIC_RELAXED) >= _K_DEOPTS || _K_R(a1).rf != _K_R(a2).rf) goto op_call;
+        _K_SET(_k_quick_list[_k_base_op(ip->op)][(int)_K_R(a1).rf]);
+        _K_GO;
+
+    _K_OP(NEGRR)
+        if (__atomic_load_n(&ip->flags, __ATOMIC_RELAXED) >= _K_DEOPTS) goto op_call;
+        _K_SET(_k_quick_list[_k_base_op(ip->op)][(int)_K_R(a1).rf]);
+        _K_GO;
+
+    /* A failed guard runs the generic handler, and the next execution quickens again.  */
+    op_deopt:
+        __atomic_add_fetch(&ip->flags, 1, __ATOMIC_RELAXED);
+        _K_SET(_k_base_op(ip->op));
+        goto op_call;
+
+    _K_OP(ADDQI) if (_K_R(a1).rf | _K_R(a2).rf)    goto op_deopt; _K_R(a0).r = _K_R(a1).r + _K_R(a2).r;     _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(ADDQF) if (!(_K_R(a1).rf & _K_R(a2).rf)) goto op_deopt; _K_F(a0)   = _K_F(a1) + _K_F(a2);         _K_R(a0).rf = 1; _K_NEXT;
+    _K_OP(SUBQI) if (_K_R(a1).rf | _K_R(a2).rf)    goto op_deopt; _K_R(a0).r = _K_R(a1).r - _K_R(a2).r;     _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(SUBQF) if (!(_K_R(a1).rf & _K_R(a2).rf)) goto op_deopt; _K_F(a0)   = _K_F(a1) - _K_F(a2);         _K_R(a0).rf = 1; _K_NEXT;
+    _K_OP(MULQI) if (_K_R(a1).rf | _K_R(a2).rf)    goto op_deopt; _K_R(a0).r = _K_R(a1).r * _K_R(a2).r;     _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(MULQF) if (!(_K_R(a1).rf & _K_R(a2).rf)) goto op_deopt; _K_F(a0)   = _K_F(a1) * _K_F(a2);         _K_R(a0).rf = 1; _K_NEXT;
+    _K_OP(DIVQI) if (_K_R(a1).rf | _K_R(a2).rf)    goto op_deopt; _K_R(a0).r = _K_R(a1).r / _K_R(a2).r;     _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(DIVQF) if (!(_K_R(a1).rf & _K_R(a2).rf)) goto op_deopt; _K_F(a0)   = _K_F(a1) / _K_F(a2);         _K_R(a0).rf = 1; _K_NEXT;
+    _K_OP(LESQI) if (_K_R(a1).rf | _K_R(a2).rf)    goto op_deopt; _K_R(a0).r = _K_R(a1).r < _K_R(a2).r;     _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(LESQF) if (!(_K_R(a1).rf & _K_R(a2).rf)) goto op_deopt; _K_R(a0).r = _K_F(a1) < _K_F(a2);         _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(GREQI) if (_K_R(a1).rf | _K_R(a2).rf)    goto op_deopt; _K_R(a0).r = _K_R(a1).r > _K_R(a2).r;     _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(GREQF) if (!(_K_R(a1).rf & _K_R(a2).rf)) goto op_deopt; _K_R(a0).r = _K_F(a1) > _K_F(a2);         _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(LEQQI) if (_K_R(a1).rf | _K_R(a2).rf)    goto op_deopt; _K_R(a0).r = _K_R(a1).r <= _K_R(a2).r;    _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(LEQQF) if (!(_K_R(a1).rf & _K_R(a2).rf)) goto op_deopt; _K_R(a0).r = !(_K_F(a1) > _K_F(a2));      _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(GEQQI) if (_K_R(a1).rf | _K_R(a2).rf)    goto op_deopt; _K_R(a0).r = _K_R(a1).r >= _K_R(a2).r;    _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(GEQQF) if (!(_K_R(a1).rf & _K_R(a2).rf)) goto op_deopt; _K_R(a0).r = !(_K_F(a1) < _K_F(a2));      _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(EQUQI) if (_K_R(a1).rf | _K_R(a2).rf)    goto op_deopt; _K_R(a0).r = _K_R(a1).r == _K_R(a2).r;    _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(EQUQF) if (!(_K_R(a1).rf & _K_R(a2).rf)) goto op_deopt; _K_R(a0).r = _K_F(a1) == _K_F(a2);        _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(NEQQI) if (_K_R(a1).rf | _K_R(a2).rf)    goto op_deopt; _K_R(a0).r = _K_R(a1).r != _K_R(a2).r;    _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(NEQQF) if (!(_K_R(a1).rf & _K_R(a2).rf)) goto op_deopt; _K_R(a0).r = _K_F(a1) < _K_F(a2) || _K_F(a1) > _K_F(a2); _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(NEGQI) if (_K_R(a1).rf)                  goto op_deopt; _K_R(a0).r = -_K_R(a1).r;                 _K_R(a0).rf = 0; _K_NEXT;
+    _K_OP(NEGQF) if (!_K_R(a1).rf)                 goto op_deopt; _K_F(a0)   = -_K_F(a1);                   _K_R(a0).rf = 1; _K_NEXT;
+
+    _K_OP(CMPRD) frame->cmp = _K_R(a0).r == (long)ip->a1; _K_NEXT;
+    _K_OP(JMPEQ) if (frame->cmp) _K_JUMP(a0); _K_NEXT;
+    _K_OP(JMPAL) _K_JUMP(a0);
+
+    _K_OP(JLTRR) if (_k_cmprr(&_K_R(a0), &_K_R(a1)) <  0) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JGTRR) if (_k_cmprr(&_K_R(a0), &_K_R(a1)) >  0) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JLERR) if (_k_cmprr(&_K_R(a0), &_K_R(a1)) <= 0) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JGERR) if (_k_cmprr(&_K_R(a0), &_K_R(a1)) >= 0) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JEQRR) if (_k_cmprr(&_K_R(a0), &_K_R(a1)) == 0) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JNERR) if (_k_cmprr(&_K_R(a0), &_K_R(a1)) != 0) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JLTRN) if (_k_cmprn(&_K_R(a0), (long)ip->a1) <  0) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JGTRN) if (_k_cmprn(&_K_R(a0), (long)ip->a1) >  0) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JLERN) if (_k_cmprn(&_K_R(a0), (long)ip->a1) <= 0) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JGERN) if (_k_cmprn(&_K_R(a0), (long)ip->a1) >= 0) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JEQRN) if (_k_cmprn(&_K_R(a0), (long)ip->a1) == 0) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JNERN) if (_k_cmprn(&_K_R(a0), (long)ip->a1) != 0) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JLTRF) if (_k_cmprf(&_K_R(a0), *(double*)&ip->a1) <  0) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JGTRF) if (_k_cmprf(&_K_R(a0), *(double*)&ip->a1) >  0) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JLERF) if (_k_cmprf(&_K_R(a0), *(double*)&ip->a1) <= 0) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JGERF) if (_k_cmprf(&_K_R(a0), *(double*)&ip->a1) >= 0) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JEQRF) if (_k_cmprf(&_K_R(a0), *(double*)&ip->a1) == 0) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JNERF) if (_k_cmprf(&_K_R(a0), *(double*)&ip->a1) != 0) _K_JUMP(a2); _K_NEXT;
+
+    _K_OP(JLTII) if (_K_R(a0).r <  _K_R(a1).r) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JGTII) if (_K_R(a0).r >  _K_R(a1).r) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JLEII) if (_K_R(a0).r <= _K_R(a1).r) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JGEII) if (_K_R(a0).r >= _K_R(a1).r) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JEQII) if (_K_R(a0).r == _K_R(a1).r) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JNEII) if (_K_R(a0).r != _K_R(a1).r) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JLTFF) if (_K_FLT(_K_F(a0), _K_F(a1))) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JGTFF) if (_K_FGT(_K_F(a0), _K_F(a1))) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JLEFF) if (_K_FLE(_K_F(a0), _K_F(a1))) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JGEFF) if (_K_FGE(_K_F(a0), _K_F(a1))) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JEQFF) if (_K_FEQ(_K_F(a0), _K_F(a1))) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JNEFF) if (_K_FNE(_K_F(a0), _K_F(a1))) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JLTIN) if (_K_R(a0).r <  (long)ip->a1) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JGTIN) if (_K_R(a0).r >  (long)ip->a1) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JLEIN) if (_K_R(a0).r <= (long)ip->a1) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JGEIN) if (_K_R(a0).r >= (long)ip->a1) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JEQIN) if (_K_R(a0).r == (long)ip->a1) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JNEIN) if (_K_R(a0).r != (long)ip->a1) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JLTFN) if (_K_FLT(_K_F(a0), *(double*)&ip->a1)) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JGTFN) if (_K_FGT(_K_F(a0), *(double*)&ip->a1)) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JLEFN) if (_K_FLE(_K_F(a0), *(double*)&ip->a1)) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JGEFN) if (_K_FGE(_K_F(a0), *(double*)&ip->a1)) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JEQFN) if (_K_FEQ(_K_F(a0), *(double*)&ip->a1)) _K_JUMP(a2); _K_NEXT;
+    _K_OP(JNEFN) if (_K_FNE(_K_F(a0), *(double*)&ip->a1)) _K_JUMP(a2); _K_NEXT;
+
+    /* Everything else runs its handler, which may jump or switch frames.  */
+    _K_CALL
+        r0         = *(double*)&regs[0];
+        frame->cur = ip;
+
+        if (ip->func(interp, ip->a0, ip->a1, ip->a2)) {
+            _k_print_location(interp, interp->frame->cur);
+
+            return 1;
+        }
+
+        frame = interp->frame;
+
+        frame->cur++;
+
+        /* A host call left in flight parks the run past it.  */
+        if (interp->budget < 0) return r0;
+
+        if (frame == start) goto op_return;
+
+        ip    = frame->cur;
+        regs  = frame->r;
+        slots = interp->mem + frame->bp;
+
+#ifdef _K_THREADED
+        _K_GO;
+#else
+        continue;
+    }
+#endif
+}
+
+#undef _K_R
+#undef _K_F
+#undef _K_RN
+#undef _K_FN
+#undef _K_OP
+#undef _K_CALL
+#undef _K_NEXT
+#undef _K_GO
+#undef _K_ADDR
+#undef _K_SKIP
+#undef _K_JUMP
+#undef _K_SET
+#undef _K_BIND
+
+/*
+ *    Appends a cleared instruction, growing the array geometrically.
+ *
+ *    @param _k_interp_t *interp    The interpreter.
+ *
+ *    @return _k_inst2_t *          The new instruction, valid until the next one is added.
+ */
+_k_inst2_t *_k_new_inst(_k_interp_t *interp) {
+    if (interp->module->inst_count == interp->module->inst_cap) {
+        interp->module->inst_cap = interp->module->inst_cap ? 2 * interp->module->inst_cap : 256;
+        interp->module->insts    = realloc(interp->module->insts, sizeof(_k_inst2_t) * interp->module->inst_cap);
+    }
+
+    _k_inst2_t *inst = &interp->module->insts[interp->module->inst_count++];
+
+    memset(inst, 0, sizeof(_k_inst2_t));
+
+    return inst;
+}
+
+long _k_open_frame(_k_interp_t *interp) {
+    _k_inst2_t *inst = _k_new_inst(interp);
+
+    inst->func = (int(*)(void*,void*,void*,void*))_k_frame;
+    inst->op   = _K_INST_FRAME;
+
+    return interp->module->inst_count - 1;
+}
+
+/*
+ *    Allocates the frame and register stacks, and sets up the host's frame at their base.
+ *
+ *    @param _k_interp_t *interp    The interpreter.
+ *
+ *    @return int                   0 on success, 1 if the stacks could not be allocated.
+ */
+int _k_open_stack(_k_interp_t *interp) {
+    interp->frames = malloc(sizeof(_k_frame_t) * _K_STACK_DEPTH);
+    interp->regs   = calloc(_K_STACK_DEPTH * _K_FRAME_REGS, sizeof(_k_reg_t));
+
+    if (interp->frames == (_k_frame_t*)0x0 || interp->regs == (_k_reg_t*)0x0) return 1;
+
+    interp->frame       = interp->frames;
+    interp->frame->sp   = interp->size;
+    interp->frame->bp   = interp->size;
+    interp->frame->ap   = interp->size;
+    interp->frame->cur  = (_k_inst2_t*)0x0;
+    interp->frame->r    = interp->regs;
+    interp->frame->regs = _K_FRAME_REGS;
+
+    return 0;
+}
+
+/*
+ *    Finds a label, adding it undefined if it has not been seen yet.
+ *
+ *    @param _k_interp_t *interp    The interpreter.
+ *    @param const char *name       The label's name.
+ *
+ *    @return long                  The label's index.
+ */
+long _k_intern_label(_k_interp_t *interp, const char *name) {
+    /* Keeps the table at most half full.  */
+    if (2 * (interp->module->label_count + 1) > interp->module->label_buckets) {
+        interp->module->label_buckets = interp->module->label_buckets ? 2 * interp->module->label_buckets : 256;
+        interp->module->label_table   = realloc(interp->module->label_table, sizeof(long) * interp->module->label_buckets);
+
+        memset(interp->module->label_table, 0xFF, sizeof(long) * interp->module->label_buckets);
+
+        for (long i = 0; i < interp->module->label_count; ++i) {
+            *_k_label_bucket(interp, interp->module->labels[i].name) = i;
+        }
+    }
+
+    long *bucket = _k_label_bucket(interp, name);
+
+    if (*bucket >= 0) return *bucket;
+
+    if (interp->module->label_count == interp->module->label_cap) {
+        interp->module->label_cap = interp->module->label_cap ? 2 * interp->module->label_cap : 64;
+        interp->module->labels    = realloc(interp->module->labels, sizeof(_k_label_t) * interp->module->label_cap);
+    }
+
+    interp->module->labels[interp->module->label_count].name = strdup(name);
+    interp->module->labels[interp->module->label_count].ptr  = _K_UNDEFINED;
+
+    return *bucket = interp->module->label_count++;
+}
+
+_k_slot_t *_k_find_slot(_k_slot_t *slots, long slot_count, const char *name) {
+    for (long i = 0; i < slot_count; ++i) {
+        if (strcmp(slots[i].name, name) == 0) return &slots[i];
+    }
+
+    return (_k_slot_t*)0x0;
+}
+
+/*
+ *    Splits a line in place on spaces.
+ *
+ *    @param char *line       The line, which is cut into its tokens.
+ *    @param char **tokens    The tokens, missing ones left NULL.
+ *    @param int max          The number of tokens to read.
+ */
+void _k_split(char *line, char **tokens, int max) {
+    for (int k = 0; k < max; ++k) {
+        while (*line == ' ') line++;
+
+        tokens[k] = *line != '\0' ? line : (char*)0x0;
+
+        while (*line != ' ' && *line != '\0') line++;
+
+        if (*line != '\0') *line++ = '\0';
+    }
+}
+
+/*
+ *    Fills a hash table mapping mnemonics to their opcode.
+ *
+ *    @param short *ops    The table, of _K_OP_BUCKETS entries.
+ */
+void _k_op_table(short *ops) {
+    for (long k = 0; k < _K_OP_BUCKETS; ++k) ops[k] = _K_INST_COUNT;
+
+    for (short k = 0; k < _K_INST_INTERNAL; ++k) {
+        unsigned long h = _k_hash(_k_inst_list[k].name + 1, 5);
+
+        while (ops[h & (_K_OP_BUCKETS - 1)] != _K_INST_COUNT) h++;
+
+        ops[h & (_K_OP_BUCKETS - 1)] = k;
+    }
+}
+
+short _k_find_op(short *ops, const char *inst) {
+    if (strlen(inst) != 6) return _K_INST_COUNT;
+
+    for (unsigned long h = _k_hash(inst, 5); ops[h & (_K_OP_BUCKETS - 1)] != _K_INST_COUNT; h++) {
+        short op = ops[h & (_K_OP_BUCKETS - 1)];
+
+        if (strcmp(_k_inst_list[op].name + 1, inst) == 0) return op;
+    }
+
+    return _K_INST_COUNT;
+}
+
+int _k_translate(_k_interp_t *interp) {
+    const char *source = interp->module->source;
+    long        length = strlen(source);
+    char        buf[256];
+    short       ops[_K_OP_BUCKETS];
+    const char *func  = (const char*)0x0;
+    long        line_cap = 0;
+
+    /* Functions open at the labels marked by a .func entry, or in sources written without them, at the labels opening a block.  */
+    int         marked = strncmp(source, ".func:", 6) == 0 || strstr(source, "\n.func:") != (char*)0x0;
+    int         opens  = !marked;
+
+    /* Variables of the function being loaded, and the instruction reserving its frame.  */
+    _k_slot_t  *slots      = (_k_slot_t*)0x0;
+    long        slot_count = 0;
+    long        slot_cap   = 0;
+    long        frame_size = 0;
+    long        frame_regs = 0;
+    long        frame      = -1;
+
+    _k_op_table(ops);
+
+    for (long i = 0, next; i < length; i = next) {
+        long j = i;
+
+        while (j < length && source[j] != '\n') j++;
+
+        next = j + 1;
+
+        if (j == i) {
+            if (!marked) opens = 1;
+
+            continue;
+        }
+
+        if (j - i >= sizeof(buf)) {
+            fprintf(stderr, "Line too long!\n");
+
+            goto fail;
+        }
+
+        memcpy(buf, source + i, j - i);
+
+        buf[j - i] = '\0';
+
+        if (buf[0] == '.') {
+            char *tokens[3];
+
+            _k_split(buf, tokens, 3);
+
+            if (strcmp(tokens[0], ".line:") == 0 && tokens[2] != (char*)0x0) {
+                if (interp->module->line_count == line_cap) {
+                    line_cap      = line_cap ? 2 * line_cap : 256;
+                    interp->module->lines = realloc(interp->module->lines, sizeof(_k_line_t) * line_cap);
+                }
+
+                interp->module->lines[interp->module->line_count].inst   = interp->module->inst_count;
+                interp->module->lines[interp->module->line_count].line   = atol(tokens[1]);
+                interp->module->lines[interp->module->line_count].column = atol(tokens[2]);
+                interp->module->lines[interp->module->line_count].func   = func;
+
+                interp->module->line_count++;
+            } else if (strcmp(tokens[0], ".file:") == 0 && tokens[1] != (char*)0x0) {
+                free(interp->module->file);
+
+                interp->module->file = strdup(tokens[1]);
+            } else if (strcmp(tokens[0], ".func:") == 0) {
+                opens = 1;
+            }
+
+            continue;
+        }
+
+        if (buf[0] != '\t') {
+            char *colon = strchr(buf, ':');
+
+            if (colon != (char*)0x0) *colon = '\0';
+
+            long label = _k_intern_label(interp, buf);
+
+            /* The first definition of a label wins.  */
+            if (interp->module->labels[label].ptr == _K_UNDEFINED) {
+                interp->module->labels[label].ptr = (void*)interp->module->inst_count;
+            }
+
+            /* Functions own the entry that precedes them.  */
+            if (opens) {
+                func = interp->module->labels[label].name;
+
+                if (interp->module->line_count > 0 && interp->module->lines[interp->module->line_count - 1].inst == interp->module->inst_count) {
+                    interp->module->lines[interp->module->line_count - 1].func = func;
+                }
+
+                if (frame >= 0) {
+                    interp->module->insts[frame].a0 = (void*)frame_size;
+                    interp->module->insts[frame].a1 = (void*)frame_regs;
+                }
+
+                for (long k = 0; k < slot_count; ++k) free(slots[k].name);
+
+                slot_count = 0;
+                frame_size = 0;
+                frame_regs = 0;
+                frame      = _k_open_frame(interp);
+            }
+
+            opens = 0;
+
+            continue;
+        }
+
+        opens = 0;
+
+        char *tokens[4];
+
+        _k_split(buf + 1, tokens, 4);
+
+        char *inst = tokens[0];
+        char *a0   = tokens[1];
+        char *a1   = tokens[2];
+        char *a2   = tokens[3];
+
+        if (inst == (char*)0x0) continue;
+
+        if (frame < 0) frame = _k_open_frame(interp);
+
+        /* Frames only take as many registers as their function names.  */
+        for (int k = 1; k < 4; ++k) {
+            if (tokens[k] == (char*)0x0 || tokens[k][0] != 'r' || tokens[k][1] < '0' || tokens[k][1] > '9') continue;
+
+            long reg = atol(tokens[k] + 1);
+
+            if (reg >= _K_FRAME_REGS) {
+                fprintf(stderr, "Register %s out of range!\n", tokens[k]);
+
+                goto fail;
+            }
+
+            if (reg >= frame_regs) frame_regs = reg + 1;
+        }
+
+        /* Declarations only claim a slot in the frame, one per name as the compiler gives it.  */
+        if (strcmp(inst, "newsv:") == 0) {
+            if (a1 != (char*)0x0) {
+                long       size = _k_type_size(a0);
+                int        real = a0[0] == 'f';
+                short      load = size == sizeof(float) ? (real ? _K_INST_LODSS : _K_INST_LODWW) : (real ? _K_INST_LODFF : _K_INST_LODII);
+                short      save = size == sizeof(float) ? (real ? _K_INST_STOSS : _K_INST_STOWW) : _K_INST_STOII;
+                _k_slot_t *slot = _k_find_slot(slots, slot_count, a1);
+
+                /* A second slot would leave earlier uses reading the first, so only the same type may be declared again.  */
+                if (slot != (_k_slot_t*)0x0 && (slot->load != load || slot->save != save)) {
+                    fprintf(stderr, "Variable %s redeclared as %s!\n", a1, a0);
+
+                    goto fail;
+                }
+
+                if (slot == (_k_slot_t*)0x0) {
+                    if (slot_count == slot_cap) {
+                        slot_cap = slot_cap ? 2 * slot_cap : 16;
+                        slots    = realloc(slots, sizeof(_k_slot_t) * slot_cap);
+                    }
+
+                    slots[slot_count].name   = strdup(a1);
+                    slots[slot_count].offset = (frame_size + size - 1) & ~(size - 1);
+                    slots[slot_count].load   = load;
+                    slots[slot_count].save   = save;
+
+                    frame_size = slots[slot_count].offset + size;
+
+                    slot_count++;
+                }
+            }
+
+            continue;
+        }
+
+        _k_inst2_t *ins = _k_new_inst(interp);
+
+        ins->a0 = _k_get_register(interp, a0);
+        ins->a1 = _k_get_register(interp, a1);
+        ins->a2 = _k_get_register(interp, a2);
+
+        if (strcmp(inst, "loadr:") == 0 || strcmp(inst, "saver:") == 0 || strcmp(inst, "refsv:") == 0) {
+            int        save = inst[0] == 's';
+            char      *name = save ? a0 : a1;
+            _k_slot_t *slot = name != (char*)0x0 ? _k_find_slot(slots, slot_count, name) : (_k_slot_t*)0x0;
+
+            if (slot == (_k_slot_t*)0x0) {
+                fprintf(stderr, "Unknown variable %s!\n", name != (char*)0x0 ? name : "");
+
+                _k_print_location(interp, ins);
+
+                goto fail;
+            }
+
+            /* Variables are addressed by their offset in the frame.  */
+            if (save) {
+                ins->op = slot->save;
+                ins->a0 = (void*)slot->offset;
+            } else {
+                ins->op = inst[0] == 'r' ? _K_INST_REFSL : slot->load;
+                ins->a1 = (void*)slot->offset;
+            }
+        } else {
+            ins->op = _k_find_op(ops, inst);
+
+            if (ins->op == _K_INST_COUNT) {
+                fprintf(stderr, "Unknown instruction %s!\n", inst);
+
+                _k_print_location(interp, ins);
+
+                goto fail;
+            }
+
+            /* Labels are interned, and their index replaced by the target once all are known.  */
+            char **label = (char**)0x0;
+
+            switch (ins->op) {
+                case _K_INST_MOVRN:
+                case _K_INST_CMPRD:
+                    ins->a1 = (void*)(a1 != (char*)0x0 ? atol(a1) : 0);
+                    break;
+                case _K_INST_MOVRF: {
+                    double f = a1 != (char*)0x0 ? atof(a1) : 0.0;
+
+                    ins->a1 = (void*)*(long*)&f;
+                    break;
+                }
+                case _K_INST_CALLF:
+                case _K_INST_JMPEQ:
+                case _K_INST_JMPAL:
+                    label = &a0;
+                    break;
+                default:
+                    /* Branches take an immediate in a float (f, fn) or integer (n) form, and a label.  */
+                    if (inst[0] == 'j') {
+                        label = &a2;
+
+                        if ((inst[3] == 'r' && inst[4] == 'f') || (inst[3] == 'f' && inst[4] == 'n')) {
+                            double f = a1 != (char*)0x0 ? atof(a1) : 0.0;
+
+                            ins->a1 = (void*)*(long*)&f;
+                        } else if (inst[4] == 'n') {
+                            ins->a1 = (void*)(a1 != (char*)0x0 ? atol(a1) : 0);
+                        }
+                    }
+            }
+
+            if (label != (char**)0x0) {
+                if (*label == (char*)0x0) {
+                    fprintf(stderr, "Missing label for %s!\n", inst);
+
+                    _k_print_location(interp, ins);
+
+                    goto fail;
+                }
+
+                void *index = (void*)_k_intern_label(interp, *label);
+
+                if (label == &a0) ins->a0 = index;
+                else              ins->a2 = index;
+            }
+        }
+
+        ins->func = (int(*)(void*,void*,void*,void*))_k_inst_list[ins->op].func;
+    }
+
+    interp->module->threaded = 0;
+
+    if (frame >= 0) {
+        interp->module->insts[frame].a0 = (void*)frame_size;
+        interp->module->insts[frame].a1 = (void*)frame_regs;
+    }
+
+    for (long k = 0; k < slot_count; ++k) free(slots[k].name);
+
+    free(slots);
+
+    for (long i = 0; i < interp->module->label_count; i++) {
+        if (interp->module->labels[i].ptr == _K_UNDEFINED) interp->module->labels[i].ptr = (void*)0x0;
+        else                                       interp->module->labels[i].ptr = interp->module->insts + (long)interp->module->labels[i].ptr;
+    }
+
+    /* Jumps and calls hold their target instruction rather than its label.  */
+    for (long i = 0; i < interp->module->inst_count; i++) {
+        _k_inst2_t *inst = &interp->module->insts[i];
+        void      **slot = (void**)0x0;
+
+        if (inst->op == _K_INST_JMPEQ || inst->op == _K_INST_JMPAL || inst->op == _K_INST_CALLF) slot = &inst->a0;
+        else if (_k_inst_list[inst->op].name[1] == 'j')                                          slot = &inst->a2;
+
+        if (slot == (void**)0x0) continue;
+
+        _k_label_t *label = &interp->module->labels[(long)*slot];
+
+        /* Calls to a function the module does not define go to the host function by that name, if there is one.  */
+        for (long k = 0; label->ptr == (void*)0x0 && inst->op == _K_INST_CALLF && k < interp->module->host_count; ++k) {
+            if (strcmp(interp->module->hosts[k].name, label->name) != 0) continue;
+
+            inst->op   = _K_INST_HOSTC;
+            inst->func = (int(*)(void*,void*,void*,void*))_k_inst_list[inst->op].func;
+            label      = (_k_label_t*)0x0;
+            *slot      = &interp->module->hosts[k];
+            break;
+        }
+
+        if (label == (_k_label_t*)0x0) continue;
+
+        if (label->ptr == (void*)0x0) {
+            fprintf(stderr, "Unknown label %s!\n", label->name);
+
+            _k_print_location(interp, inst);
+
+            return 1;
+        }
+
+        *slot = label->ptr;
+    }
 
     return 0;
+
+fail:
+    for (long k = 0; k < slot_count; ++k) free(slots[k].name);
+
+    free(slots);
+
+    return 1;
+}
+
+/*
+ *    Drops a hold on a module, and frees it with the last.
+ *
+ *    @param _k_module_t *module    The module.
+ */
+void _k_release(_k_module_t *module) {
+    if (__atomic_sub_fetch(&module->refs, 1, __ATOMIC_ACQ_REL) != 0) return;
+
+    for (long i = 0; i < module->label_count; ++i) free(module->labels[i].name);
+
+    free(module->labels);
+    free(module->label_table);
+    free(module->insts);
+    free(module->lines);
+    free(module->file);
+    free(module->source);
+
+    for (long i = 0; i < module->host_count; ++i) free(module->hosts[i].name);
+
+    free(module->hosts);
+
+#ifdef _K_JIT
+    /* Each mapping of native code starts with the one before it and its size.  */
+    while (module->native_code != (unsigned char*)0x0) {
+        unsigned char *code = module->native_code;
+        long           size = module->native_size;
+
+        memcpy(&module->native_code, code, sizeof(unsigned char*));
+        memcpy(&module->native_size, code + sizeof(unsigned char*), sizeof(long));
+        munmap(code, size);
+    }
+#endif
+
+#ifdef _K_LANES
+    free(module->lane_ops);
+    free(module->lane_checked);
+    free(module->lane_refs);
+    free(module->lane_native);
+#endif
+
+#ifdef _K_PTHREAD
+    pthread_mutex_destroy(&module->lock);
+#endif
+
+    free(module->native_at);
+    free(module);
 }
 
-int call(_k_interp_t *interp, char *func) {
-    _k_frame_t *frame = malloc(sizeof(_k_frame_t));
+/*
+ *    Frees a context, and drops its hold on its module.
+ *
+ *    @param _k_interp_t *interp    The interpreter.
+ */
+void _k_unload(_k_interp_t *interp) {
+    free(interp->frames);
+    free(interp->regs);
+    free(interp->mem);
+
+#ifdef _K_LANES
+    if (interp->lanes != (_k_lanes_t*)0x0) {
+        free(interp->lanes->regs);
+        free(interp->lanes->mem);
+        free(interp->lanes->frames);
+        free(interp->lanes);
+    }
+#endif
+
+    _k_release(interp->module);
+
+    free(interp);
+}
+
+/*
+ *    Passes arguments in registers wherever a call's pushes can be matched
+ *    to it. Each pushr becomes an argrr writing straight into the callee's
+ *    window, and the callf a callr entering the callee past its poprr's.
+ *    Calls whose arguments span a label, a jump or another call keep
+ *    passing them on the stack, which is also how the host calls in.
+ *
+ *    @param _k_interp_t *interp    The interpreter.
+ */
+void _k_window_calls(_k_interp_t *interp) {
+    char *target  = calloc(interp->module->inst_count + 1, 1);
+    long *pending = malloc(sizeof(long) * (interp->module->inst_count + 1));
+    long  count   = 0;
+
+    for (long i = 0; i < interp->module->label_count; ++i) {
+        if (interp->module->labels[i].ptr != (void*)0x0) target[(_k_inst2_t*)interp->module->labels[i].ptr - interp->module->insts] = 1;
+    }
+
+    for (long i = 0; i < interp->module->inst_count; ++i) {
+        _k_inst2_t *inst = &interp->module->insts[i];
+
+        if (target[i] || inst->op == _K_INST_FRAME || inst->op == _K_INST_LEAVE || _k_inst_list[inst->op].name[1] == 'j') count = 0;
+
+        if (inst->op == _K_INST_PUSHR) {
+            pending[count++] = i;
+
+            continue;
+        }
+
+        if (inst->op != _K_INST_CALLF) continue;
+
+        _k_inst2_t *entry  = (_k_inst2_t*)inst->a0;
+        long        params = 0;
+
+        while (entry + 1 + params < interp->module->insts + interp->module->inst_count && entry[1 + params].op == _K_INST_POPRR) params++;
+
+        /* The last argument pushed is the first the callee pops.  */
+        if (entry->op == _K_INST_FRAME && count == params) {
+            for (long k = 0; k < params; ++k) {
+                _k_inst2_t *push = &interp->module->insts[pending[k]];
+
+                push->func = (int(*)(void*,void*,void*,void*))_k_argrr;
+                push->op   = _K_INST_ARGRR;
+                push->a1   = push->a0;
+                push->a0   = entry[params - k].a0;
+            }
+
+            inst->func = (int(*)(void*,void*,void*,void*))_k_callr;
+            inst->op   = _K_INST_CALLR;
+            inst->a2   = (void*)params;
+        }
+
+        count = 0;
+    }
+
+    free(target);
+    free(pending);
+}
+
+/*
+ *    Replaces the first instruction of each run matching a superinstruction
+ *    with it. The rest of the run stays in place, so jumps into its middle
+ *    still land on the plain instructions.
+ *
+ *    @param _k_interp_t *interp    The interpreter.
+ */
+void _k_fuse(_k_interp_t *interp) {
+    for (long i = 0; i < interp->module->inst_count;) {
+        long length = 1;
+
+        for (long f = 0; f < sizeof(_k_fusion_list) / sizeof(_k_fusion_t); ++f) {
+            const _k_fusion_t *fusion = &_k_fusion_list[f];
+            long               k      = 0;
+
+            if (i + fusion->length > interp->module->inst_count) continue;
+
+            while (k < fusion->length && interp->module->insts[i + k].op == fusion->ops[k]) k++;
+
+            if (k == fusion->length) {
+                interp->module->insts[i].op = fusion->op;
+                length              = fusion->length;
+
+                break;
+            }
+        }
+
+        i += length;
+    }
+}
+
+/*
+ *    Marks every jump back to an earlier instruction, the end of a while
+ *    loop's body, as a back-edge of the function it is in. Back-edges count
+ *    toward promoting their function, and are where a running loop moves
+ *    into its native code.
+ *
+ *    @param _k_interp_t *interp    The interpreter.
+ */
+void _k_mark_loops(_k_interp_t *interp) {
+    _k_inst2_t *entry = (_k_inst2_t*)0x0;
+
+    for (long i = 0; i < interp->module->inst_count; ++i) {
+        _k_inst2_t *inst = &interp->module->insts[i];
+
+        if (inst->op == _K_INST_FRAME || inst->op == _K_INST_FRPOP) entry = inst;
+
+        if (inst->op != _K_INST_JMPAL || (_k_inst2_t*)inst->a0 > inst || entry == (_k_inst2_t*)0x0) continue;
+
+        inst->op = _K_INST_LOOPB;
+        inst->a1 = entry;
+    }
+}
+
+/*
+ *    Creates a context running a module, with a stack of its own.
+ *
+ *    @param _k_module_t *module    The module, which the context holds.
+ *
+ *    @return _k_interp_t *         The interpreter, or NULL if it could not be allocated.
+ */
+_k_interp_t *_k_context(_k_module_t *module) {
+    _k_interp_t *interp = calloc(1, sizeof(_k_interp_t));
+
+    if (interp == (_k_interp_t*)0x0) return (_k_interp_t*)0x0;
 
-    frame->vars = (_k_var_t*)0x0;
-    frame->var_count = 0;
-    frame->next = (_k_frame_t*)0x0;
-    frame->prev = interp->frame;
-    frame->sp = interp->frame->sp;
-    frame->bp = interp->frame->sp;
-    frame->cur = interp->frame->cur;
+    interp->module = module;
+    interp->size   = 0xFFFF;
+    interp->mem    = malloc(interp->size);
+    interp->batch  = (_k_batch_t*)0x0;
+    interp->run    = (_k_frame_t*)0x0;
+    interp->budget = LONG_MAX;
+    interp->wait   = 0;
+    interp->spmd   = 1;
+    interp->lanes  = (struct _k_lanes_s*)0x0;
+
+    if (interp->mem == (char*)0x0 || _k_open_stack(interp)) {
+        free(interp->frames);
+        free(interp->regs);
+        free(interp->mem);
+        free(interp);
+
+        return (_k_interp_t*)0x0;
+    }
 
-    interp->frame = frame;
+    __atomic_add_fetch(&module->refs, 1, __ATOMIC_RELAXED);
 
-    return _k_find_label(interp, func);
+    return interp;
 }
 
-double loop(_k_interp_t *interp, _k_frame_t *start) {
-    double r0 = 0;
-    do {
-        r0 = *(double*)&interp->frame->r[0];
+/*
+ *    Loads a module from KASM source.
+ *
+ *    @param char *source               The source, which the interpreter takes ownership of.
+ *    @param const _k_host_t *hosts     The host functions it may call, which it copies, or NULL.
+ *
+ *    @return _k_interp_t *  A context running the module, or NULL if the module failed to load.
+ */
+_k_interp_t *_k_load_source(char *source, const _k_host_t *hosts) {
+    _k_module_t *module = malloc(sizeof(_k_module_t));
 
-        if (interp->frame->cur->func(interp, interp->frame->cur->a0, interp->frame->cur->a1, interp->frame->cur->a2)) return 1;
+    module->source = source;
 
-        interp->frame->cur++;
-    } while(interp->frame != start);
+    module->inst_count = 0;
+    module->inst_cap   = 0;
+    module->insts      = (_k_inst2_t*)0x0;
 
-    return r0;
-}
+    module->label_count   = 0;
+    module->label_cap     = 0;
+    module->labels        = (_k_label_t*)0x0;
+    module->label_buckets = 0;
+    module->label_table   = (long*)0x0;
 
-void _k_translate(_k_interp_t *interp) {
-    char buf[256];
-    for (int i = 0; i < strlen(interp->source); i++) {
-        int j = 0;
+    module->file = (char*)0x0;
+    module->line_count = 0;
+    module->lines = (_k_line_t*)0x0;
 
-        if (interp->source[i] != '\t') {
+    module->tiered      = 1;
+    module->tracing     = 1;
+    module->native_code = (unsigned char*)0x0;
+    module->native_size = 0;
+    module->native_at   = (void**)0x0;
+    module->native      = (int(*)(void*,void*))0x0;
+    module->refs        = 0;
 
-            if (interp->source[i] == '\n') {
-                continue;
-            }
+    module->host_count = 0;
 
-            interp->label_count++;
+    for (const _k_host_t *host = hosts; host != (_k_host_t*)0x0; host = host->next) module->host_count++;
 
-            interp->labels = realloc(interp->labels, sizeof(_k_label_t) * interp->label_count);
+    module->hosts = calloc(module->host_count + 1, sizeof(_k_host_t));
 
-            while (interp->source[i + j] != ':') {
-                buf[j++] = interp->source[i + j];
-            }
+    for (long k = 0; hosts != (_k_host_t*)0x0; hosts = hosts->next, ++k) {
+        module->hosts[k]      = *hosts;
+        module->hosts[k].name = strdup(hosts->name);
+        module->hosts[k].next = (_k_host_t*)0x0;
+    }
 
-            buf[j] = '\0';
+#ifdef _K_LANES
+    module->lane_ops     = (short*)0x0;
+    module->lane_checked = (char*)0x0;
+    module->lane_refs    = (unsigned long*)0x0;
+    module->lane_native  = (void**)0x0;
+    module->lane_enter   = (int(*)(_k_lane_frame_t*, void*, void*))0x0;
+#endif
 
-            interp->labels[interp->label_count - 1].name = strdup(buf);
-            interp->labels[interp->label_count - 1].ptr  = (void*)interp->inst_count;
+#ifdef _K_PTHREAD
+    /* Compiling lane code checks each function, and checking one checks those it calls, each under the lock.  */
+    pthread_mutexattr_t attr;
 
-            while (interp->source[i + j] != '\n') {
-                j++;
-            }
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&module->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+#endif
 
-            i += j;
+    _k_interp_t *interp = _k_context(module);
 
-            continue;
-        }
+    /* Without a context, the module goes with the hold it would have had.  */
+    if (interp == (_k_interp_t*)0x0) {
+        module->refs = 1;
 
-        i++;
+        _k_release(module);
 
-        while (interp->source[i + j] != '\n') {
-            j++;
-        }
+        return (_k_interp_t*)0x0;
+    }
 
-        strncpy(buf, interp->source + i, j + 1);
-
-        buf[j] = '\0';
-
-        char *inst = strtok(buf, " ");
-        char *a0   = strtok((char*)0x0, " ");
-        char *a1   = strtok((char*)0x0, " ");
-        char *a2   = strtok((char*)0x0, " ");
-
-        interp->inst_count++;
-
-        interp->insts = realloc(interp->insts, sizeof(_k_inst2_t) * interp->inst_count);
-
-        interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))0x0;
-        interp->insts[interp->inst_count - 1].a0   = (void*)0x0;
-        interp->insts[interp->inst_count - 1].a1   = (void*)0x0;
-        interp->insts[interp->inst_count - 1].a2   = (void*)0x0;
-
-        if (strcmp(inst, "pushr:") == 0) {
-            interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))_k_pushr;
-            interp->insts[interp->inst_count - 1].a0   = _k_get_register(interp, a0);
-        } else if (strcmp(inst, "poprr:") == 0) {
-            interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))_k_poprr;
-            interp->insts[interp->inst_count - 1].a0   = _k_get_register(interp, a0);
-        } else if (strcmp(inst, "newsv:") == 0) {
-            interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))_k_newsv;
-            interp->insts[interp->inst_count - 1].a0   = strdup(a0);
-            interp->insts[interp->inst_count - 1].a1   = strdup(a1);
-        } else if (strcmp(inst, "leave:") == 0) {
-            interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))_k_leave;
-        } else if (strcmp(inst, "movrn:") == 0) {
-            interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))_k_movrn;
-            interp->insts[interp->inst_count - 1].a0   = _k_get_register(interp, a0);
-            interp->insts[interp->inst_count - 1].a1    = (void*)atoi(a1);
-        } else if (strcmp(inst, "movrf:") == 0) {
-            double f = atof(a1);
-
-            interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))_k_movrf;
-            interp->insts[interp->inst_count - 1].a0   = _k_get_register(interp, a0);
-            interp->insts[interp->inst_count - 1].a1    = (void*)*(long*)&f;
-        } else if (strcmp(inst, "movrr:") == 0) {
-            interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))_k_movrr;
-            interp->insts[interp->inst_count - 1].a0   = _k_get_register(interp, a0);
-            interp->insts[interp->inst_count - 1].a1   = _k_get_register(interp, a1);
-        } else if (strcmp(inst, "callf:") == 0) {
-            interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))_k_callf;
-            interp->insts[interp->inst_count - 1].a0   = strdup(a0);
-        } else if (strcmp(inst, "loadr:") == 0) {
-            interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))_k_loadr;
-            interp->insts[interp->inst_count - 1].a0   = _k_get_register(interp, a0);
-            interp->insts[interp->inst_count - 1].a1   = strdup(a1);
-        } else if (strcmp(inst, "saver:") == 0) {
-            interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))_k_saver;
-            interp->insts[interp->inst_count - 1].a0   = strdup(a0);
-            interp->insts[interp->inst_count - 1].a1   = _k_get_register(interp, a1);
-        } else if (strcmp(inst, "addrr:") == 0) {
-            interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))_k_addrr;
-            interp->insts[interp->inst_count - 1].a0   = _k_get_register(interp, a0);
-            interp->insts[interp->inst_count - 1].a1   = _k_get_register(interp, a1);
-            interp->insts[interp->inst_count - 1].a2   = _k_get_register(interp, a2);
-        } else if (strcmp(inst, "subrr:") == 0) {
-            interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))_k_subrr;
-            interp->insts[interp->inst_count - 1].a0   = _k_get_register(interp, a0);
-            interp->insts[interp->inst_count - 1].a1   = _k_get_register(interp, a1);
-            interp->insts[interp->inst_count - 1].a2   = _k_get_register(interp, a2);
-        } else if (strcmp(inst, "mulrr:") == 0) {
-            interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))_k_mulrr;
-            interp->insts[interp->inst_count - 1].a0   = _k_get_register(interp, a0);
-            interp->insts[interp->inst_count - 1].a1   = _k_get_register(interp, a1);
-            interp->insts[interp->inst_count - 1].a2   = _k_get_register(interp, a2);
-        } else if (strcmp(inst, "divrr:") == 0) {
-            interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))_k_divrr;
-            interp->insts[interp->inst_count - 1].a0   = _k_get_register(interp, a0);
-            interp->insts[interp->inst_count - 1].a1   = _k_get_register(interp, a1);
-            interp->insts[interp->inst_count - 1].a2   = _k_get_register(interp, a2);
-        } else if (strcmp(inst, "lesrr:") == 0) {
-            interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))_k_lesrr;
-            interp->insts[interp->inst_count - 1].a0   = _k_get_register(interp, a0);
-            interp->insts[interp->inst_count - 1].a1   = _k_get_register(interp, a1);
-            interp->insts[interp->inst_count - 1].a2   = _k_get_register(interp, a2);
-        } else if (strcmp(inst, "grerr:") == 0) {
-            interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))_k_grerr;
-            interp->insts[interp->inst_count - 1].a0   = _k_get_register(interp, a0);
-            interp->insts[interp->inst_count - 1].a1   = _k_get_register(interp, a1);
-            interp->insts[interp->inst_count - 1].a2   = _k_get_register(interp, a2);
-        } else if (strcmp(inst, "equrr:") == 0) {
-            interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))_k_equrr;
-            interp->insts[interp->inst_count - 1].a0   = _k_get_register(interp, a0);
-            interp->insts[interp->inst_count - 1].a1   = _k_get_register(interp, a1);
-            interp->insts[interp->inst_count - 1].a2   = _k_get_register(interp, a2);
-        } else if (strcmp(inst, "cmprd:") == 0) {
-            interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))_k_cmprd;
-            interp->insts[interp->inst_count - 1].a0   = _k_get_register(interp, a0);
-            interp->insts[interp->inst_count - 1].a1   = (void*)atoi(a1);
-        } else if (strcmp(inst, "jmpeq:") == 0) {
-            interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))_k_jmpeq;
-            interp->insts[interp->inst_count - 1].a0   = strdup(a0);
-        } else if (strcmp(inst, "jmpal:") == 0) {
-            interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))_k_jmpal;
-            interp->insts[interp->inst_count - 1].a0   = strdup(a0);
-        } else if (strcmp(inst, "deref:") == 0) {
-            interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))_k_deref;
-            interp->insts[interp->inst_count - 1].a0   = _k_get_register(interp, a0);
-            interp->insts[interp->inst_count - 1].a1   = _k_get_register(interp, a1);
-        } else if (strcmp(inst, "refsv:") == 0) {
-            interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))_k_refsv;
-            interp->insts[interp->inst_count - 1].a0   = _k_get_register(interp, a0);
-            interp->insts[interp->inst_count - 1].a1   = strdup(a1);
-        } else if (strcmp(inst, "savea:") == 0) {
-            interp->insts[interp->inst_count - 1].func = (int(*)(void*,void*,void*,void*))_k_savea;
-            interp->insts[interp->inst_count - 1].a0   = _k_get_register(interp, a0);
-            interp->insts[interp->inst_count - 1].a1   = _k_get_register(interp, a1);
-        }
+    if (_k_translate(interp)) {
+        _k_unload(interp);
 
-        i += j;
+        return (_k_interp_t*)0x0;
     }
 
-    for (int i = 0; i < interp->label_count; i++) {
-        interp->labels[i].ptr = interp->insts + (long)interp->labels[i].ptr;
-    }
+    _k_window_calls(interp);
+    _k_fuse(interp);
+    _k_mark_loops(interp);
+
+    return interp;
 }
 
-int main() {
-    FILE *fp = fopen("fractal.kasm", "r");
+_k_interp_t *_k_load(const char *path, const _k_host_t *hosts) {
+    FILE *fp = fopen(path, "r");
 
     if (fp == (FILE*)0x0) {
-        fprintf(stderr, "Failed to open math.kasm!\n");
-        return 1;
+        fprintf(stderr, "Failed to open %s!\n", path);
+        return (_k_interp_t*)0x0;
     }
 
     fseek(fp, 0, SEEK_END);
@@ -857,130 +3017,609 @@ int main() {
 
     fread(source, fsize, 1, fp);
 
+    source[fsize] = '\0';
+
     fclose(fp);
 
-    _k_interp_t *interp = malloc(sizeof(_k_interp_t));
+    return _k_load_source(source, hosts);
+}
 
-    interp->source = source;
-    interp->size   = 0xFFFF;
-    interp->mem    = malloc(interp->size);
+/*
+ *    Creates an environment with no module loaded.
+ *
+ *    @return k_env_t *    The environment, or NULL if it could not be allocated.
+ */
+k_env_t *k_new_env(void) {
+    k_env_t *env = malloc(sizeof(k_env_t));
 
-    interp->inst_count = 0;
-    interp->insts = (_k_inst2_t*)0x0;
+    if (env == (k_env_t*)0x0) return (k_env_t*)0x0;
 
-    interp->label_count = 0;
-    interp->labels = (_k_label_t*)0x0;
+    env->interp    = (_k_interp_t*)0x0;
+    env->functions = (k_function_t*)0x0;
+    env->hosts     = (_k_host_t*)0x0;
 
-    interp->frame = malloc(sizeof(_k_frame_t));
-    interp->frame->vars = (_k_var_t*)0x0;
-    interp->frame->var_count = 0;
-    interp->frame->next = (_k_frame_t*)0x0;
-    interp->frame->prev = (_k_frame_t*)0x0;
-    interp->frame->sp = interp->size;
-    interp->frame->bp = interp->size;
-    interp->frame->cur = &interp->insts[0];
+    return env;
+}
 
-    _k_frame_t *frame = interp->frame;
+/*
+ *    Unloads an environment's module, and frees every handle into it.
+ *
+ *    @param k_env_t *env    The environment.
+ */
+void _k_env_unload(k_env_t *env) {
+    while (env->functions != (k_function_t*)0x0) {
+        k_function_t *next = env->functions->next;
 
-    _k_translate(interp);
+        free(env->functions->name);
+        free(env->functions);
 
-    long   r0d = 0;
-    double r0f = 0.0;
+        env->functions = next;
+    }
 
-    double rmin;
-    double rmax;
+    if (env->interp != (_k_interp_t*)0x0) _k_unload(env->interp);
 
-    double imin;
-    double imax;
+    env->interp = (_k_interp_t*)0x0;
+}
 
-    double real = 1.0;
-    double imag = 1.0;
+/*
+ *    Loads a module from KASM source into an environment, replacing
+ *    the module it held, if any.
+ *
+ *    @param k_env_t    *env       The environment.
+ *    @param const char *source    The KASM source, which is copied.
+ *
+ *    @return int    0 on success, 1 if the module failed to load.
+ */
+int k_load_source(k_env_t *env, const char *source) {
+    char *copy = malloc(strlen(source) + 1);
 
-    double *real_ptr = &real;
-    double *imag_ptr = &imag;
+    if (copy == (char*)0x0) return 1;
 
-    //push(interp, &real, sizeof(double));
-    //push(interp, &imag, sizeof(double));
-    call(interp, "rmin");
-    rmin = loop(interp, frame);
+    strcpy(copy, source);
 
-    call(interp, "rmax");
-    rmax = loop(interp, frame);
+    _k_env_unload(env);
 
-    call(interp, "imin");
-    imin = loop(interp, frame);
+    env->interp = _k_load_source(copy, env->hosts);
 
-    call(interp, "imax");
-    imax = loop(interp, frame);
+    return env->interp == (_k_interp_t*)0x0;
+}
 
-    fprintf(stderr, "rmin = %f\n", rmin);
-    fprintf(stderr, "rmax = %f\n", rmax);
-    fprintf(stderr, "imin = %f\n", imin);
-    fprintf(stderr, "imax = %f\n", imax);
+/*
+ *    Registers a host function with an environment, for the modules
+ *    loaded into it from then on.
+ *
+ *    @param k_env_t    *env       The environment.
+ *    @param const char *name      The name scripts call it by.
+ *    @param int         params    The number of arguments it takes.
+ *    @param int         real      1 if it returns a float, in ret's f
+ *                                 field, 0 if an integer or pointer.
+ *    @param k_host_t    fn        The function.
+ *    @param void       *data      Data passed to each of its calls.
+ *
+ *    @return int    0 on success, 1 if it takes too many arguments or could not be allocated.
+ */
+int k_set_host(k_env_t *env, const char *name, int params, int real, k_host_t fn, void *data) {
+    _k_host_t *host = env->hosts;
 
-    double a = 1.0;
-    double b = -1.0;
+    if (params < 0 || params > _K_FRAME_REGS) return 1;
 
-    call(interp, "abs");
-    push(interp, &a, sizeof(double));
-    double c = loop(interp, frame);
+    while (host != (_k_host_t*)0x0 && strcmp(host->name, name) != 0) host = host->next;
 
-    call(interp, "abs");
-    push(interp, &b, sizeof(double));
-    double d = loop(interp, frame);
+    if (host == (_k_host_t*)0x0) {
+        if ((host = malloc(sizeof(_k_host_t))) == (_k_host_t*)0x0) return 1;
 
-    fprintf(stderr, "abs(%f) = %f\n", a, c);
-    fprintf(stderr, "abs(%f) = %f\n", b, d);
+        if ((host->name = strdup(name)) == (char*)0x0) {
+            free(host);
 
-    const int W = 640; const int H = 640;
-    char img[W][H];
+            return 1;
+        }
 
-    for (int y = 0; y < H; y++) {
-        for (int x = 0; x < W; x++) {
-            int i = 0;
+        host->next = env->hosts;
+        env->hosts = host;
+    }
 
-            real = rmin + (rmax - rmin) * x / W;
-            imag = imin + (imax - imin) * y / H;
+    host->params = params;
+    host->real   = real != 0;
+    host->fn     = fn;
+    host->data   = data;
 
-            while (real * real + imag * imag < 16 && i < 64) {
-                call(interp, "z");
-                push(interp, &real_ptr, sizeof(double));
-                push(interp, &imag_ptr, sizeof(double));
-                loop(interp, frame);
+    return 0;
+}
 
-                //printf("z = %f + %fi\n", real, imag);
+/*
+ *    Loads a module from a KASM file into an environment.
+ *
+ *    @param k_env_t    *env     The environment.
+ *    @param const char *path    The path of the KASM file.
+ *
+ *    @return int    0 on success, 1 if the module failed to load.
+ */
+int k_load_module(k_env_t *env, const char *path) {
+    _k_env_unload(env);
 
-                real += rmin + (rmax - rmin) * x / W;
-                imag += imin + (imax - imin) * y / H;
+    env->interp = _k_load(path, env->hosts);
 
-                i++;
-            }
+    return env->interp == (_k_interp_t*)0x0;
+}
 
-            img[x][y] = i == 64 ? 0 : 4 * i;
-        }
+/*
+ *    Makes a handle on a function of an environment's module, and adds it
+ *    to the environment's handles.
+ *
+ *    @param _k_interp_t *interp    The environment's interpreter.
+ *    @param k_env_t    *env        The environment.
+ *    @param const char *name       The name of the function.
+ *
+ *    @return k_function_t *        The function, or NULL if the module has none by that name.
+ */
+k_function_t *_k_new_function(_k_interp_t *interp, k_env_t *env, const char *name) {
+    _k_inst2_t *entry = _k_label_target(interp, name);
+
+    if (entry == (_k_inst2_t*)0x0 || entry == _K_UNDEFINED || entry >= interp->module->insts + interp->module->inst_count) return (k_function_t*)0x0;
+
+    /* Only labels starting a frame are functions.  */
+    if (entry->op != _K_INST_FRAME && entry->op != _K_INST_FRPOP && entry->op != _K_INST_FRNAT) return (k_function_t*)0x0;
+
+    k_function_t *fn = malloc(sizeof(k_function_t));
+
+    if (fn == (k_function_t*)0x0) return (k_function_t*)0x0;
+
+    fn->name   = malloc(strlen(name) + 1);
+    fn->entry  = entry;
+    fn->params = 0;
+    fn->next   = env->functions;
+
+    strcpy(fn->name, name);
+
+    while (entry + 1 + fn->params < interp->module->insts + interp->module->inst_count && entry[1 + fn->params].op == _K_INST_POPRR) fn->params++;
+
+    env->functions = fn;
+
+    return fn;
+}
+
+/*
+ *    Looks up a function of the loaded module.
+ *
+ *    @param k_env_t    *env     The environment.
+ *    @param const char *name    The name of the function.
+ *
+ *    @return k_function_t *    The function, or NULL if the module has none by that name.
+ */
+k_function_t *k_get_function(k_env_t *env, const char *name) {
+    if (env->interp == (_k_interp_t*)0x0) return (k_function_t*)0x0;
+
+    _k_interp_t  *interp = env->interp;
+    k_function_t *fn;
 
-        fprintf(stderr, "%d\%\n", y * 100 / H);
+    /* Threads running contexts of the module look handles up at once.  */
+    _K_LOCK(interp->module);
+
+    for (fn = env->functions; fn != (k_function_t*)0x0; fn = fn->next) {
+        if (strcmp(fn->name, name) == 0) break;
     }
 
-    printf("P6\n%d %d\n100\n", W, H);
+    if (fn == (k_function_t*)0x0) fn = _k_new_function(interp, env, name);
+
+    _K_UNLOCK(interp->module);
+
+    return fn;
+}
+
+/*
+ *    Gets the number of parameters a function takes.
+ *
+ *    @param k_function_t *fn    The function.
+ *
+ *    @return int    The number of parameters.
+ */
+int k_function_params(k_function_t *fn) {
+    return fn->params;
+}
+
+/*
+ *    Enters a function from the host's frame, leaving it ready for the
+ *    loop to run.
+ *
+ *    Functions left interpreted are entered the way register calls
+ *    enter them: the arguments are written into the callee's registers,
+ *    and it starts past its poprr's. Compiled functions take theirs on
+ *    the stack, and are entered at their frame.
+ *
+ *    @param _k_interp_t     *interp    The interpreter.
+ *    @param k_function_t    *fn        The function.
+ *    @param const k_value_t *args      Its arguments, one per parameter.
+ *
+ *    @return int    0 on success, 1 if the call stack is full.
+ */
+int _k_call_enter(_k_interp_t *interp, k_function_t *fn, const k_value_t *args) {
+    _k_frame_t *host  = interp->frame;
+    _k_inst2_t *entry = fn->entry;
+
+    /* Host calls count toward promoting the callee, as calls from the module do.  */
+    if (__atomic_load_n(&entry->op, __ATOMIC_ACQUIRE) != _K_INST_FRNAT && _K_HEAT(entry)) _k_tier(interp, entry);
+
+    _k_frame_t *frame = _k_enter(interp);
+
+    if (frame == (_k_frame_t*)0x0) return 1;
+
+    if (__atomic_load_n(&entry->op, __ATOMIC_ACQUIRE) != _K_INST_FRNAT) {
+        if (_k_frame(interp, entry->a0, entry->a1, (char*)0x0)) {
+            interp->frame = host;
 
-    for (int y = 0; y < H; y++) {
-        for (int x = 0; x < W; x++) {
-            printf("%c%c%c", img[x][y], 0, 0);
+            return 1;
         }
+
+        /* The last argument is the first the callee pops.  */
+        for (long k = 0; k < fn->params; ++k) frame->r[(long)entry[fn->params - k].a0].r = args[k].i;
+
+        frame->cur = entry + 1 + fn->params;
+    } else {
+        for (long k = 0; k < fn->params; ++k) push(interp, (void*)&args[k], sizeof(long));
+
+        frame->cur = entry;
     }
-    
 
-    /*printf("r0 = %d (as decimal)\n", r0d);
-    printf("r0 = %f (as float)\n", r0f);*/
+    return 0;
+}
 
-    /*printf("real = %f\n", rmin);
-    printf("imag = %f\n", imag);*/
-    
+/*
+ *    Creates a context running an environment's module.
+ *
+ *    @param k_env_t *env    The environment.
+ *
+ *    @return k_context_t *    The context, or NULL if the environment has no module loaded
+ *                             or the context could not be allocated.
+ */
+k_context_t *k_new_context(k_env_t *env) {
+    if (env->interp == (_k_interp_t*)0x0) return (k_context_t*)0x0;
 
-    free(interp->mem);
-    free(interp->source);
-    free(interp);
+    return _k_context(env->interp->module);
+}
+
+/*
+ *    Calls a function in a context.
+ *
+ *    @param k_context_t     *ctx     The context.
+ *    @param k_function_t    *fn      The function.
+ *    @param const k_value_t *args    Its arguments, one per parameter.
+ *    @param k_value_t       *ret     Where to write its result, or NULL.
+ *
+ *    @return int    0 on success, 1 if the call failed.
+ */
+int k_context_call(k_context_t *ctx, k_function_t *fn, const k_value_t *args, k_value_t *ret) {
+    _k_interp_t *interp = ctx;
+    _k_frame_t  *host   = interp->frame;
+
+    /* A parked run has the frames calls would return through.  */
+    if (interp->run != (_k_frame_t*)0x0 || _k_call_enter(interp, fn, args)) return 1;
+
+    loop(interp, host);
+
+    /* A failed instruction leaves the frames it was running in.  */
+    if (interp->frame != host) {
+        interp->frame = host;
+
+        return 1;
+    }
+
+    if (ret != (k_value_t*)0x0) ret->i = host->r[0].r;
+
+    return 0;
+}
+
+/*
+ *    Calls a function.
+ *
+ *    @param k_env_t         *env     The environment.
+ *    @param k_function_t    *fn      The function.
+ *    @param const k_value_t *args    Its arguments, one per parameter.
+ *    @param k_value_t       *ret     Where to write its result, or NULL.
+ *
+ *    @return int    0 on success, 1 if the call failed.
+ */
+int k_call(k_env_t *env, k_function_t *fn, const k_value_t *args, k_value_t *ret) {
+    return k_context_call(env->interp, fn, args, ret);
+}
+
+/*
+ *    Starts a run of a function in a context, entering it without running
+ *    any of it.
+ *
+ *    @param k_context_t     *ctx     The context.
+ *    @param k_function_t    *fn      The function.
+ *    @param const k_value_t *args    Its arguments, one per parameter.
+ *    @param k_value_t       *ret     Where to write its result once it is done, or NULL.
+ *
+ *    @return int    0 on success, 1 if the context has a run already or the call stack is full.
+ */
+int k_start(k_context_t *ctx, k_function_t *fn, const k_value_t *args, k_value_t *ret) {
+    _k_interp_t *interp = ctx;
+    _k_frame_t  *host   = interp->frame;
+
+    if (interp->run != (_k_frame_t*)0x0 || _k_call_enter(interp, fn, args)) return 1;
+
+    interp->run = host;
+    interp->ret = ret;
+
+    return 0;
+}
+
+/*
+ *    Runs a context's run until it is done, fails, has taken a budget of
+ *    back-edges and calls, or has left a host call in flight, parking its
+ *    frames where it stopped for the next run to pick up.
+ *
+ *    @param k_context_t *ctx       The context.
+ *    @param long         budget    The back-edges and calls it may take.
+ *
+ *    @return k_state_t    What the run was left doing.
+ */
+k_state_t k_run(k_context_t *ctx, long budget) {
+    _k_interp_t *interp = ctx;
+    _k_frame_t  *host   = interp->run;
+    int          wait   = __atomic_load_n(&interp->wait, __ATOMIC_ACQUIRE);
+
+    if (host == (_k_frame_t*)0x0) return K_FAILED;
+
+    /* A run parked on a host call goes on only once the host has completed it, with its result.  */
+    if (wait == 2) return K_WAITING;
+
+    if (wait == 3) {
+        interp->frame->r[0].r  = interp->reply.i;
+        interp->frame->r[0].rf = (char)interp->call->real;
+        interp->wait           = 0;
+    }
+
+    /* Every run goes at least as far as the back-edge or call the last one parked at.  */
+    interp->budget = budget < 1 ? 1 : budget;
+
+    loop(interp, host);
+
+    if (interp->budget < 0) {
+        interp->budget = LONG_MAX;
+        wait           = 1;
+
+        /* A host call in flight parks the run to wait on it, unless the host has completed it already.  */
+        if (__atomic_compare_exchange_n(&interp->wait, &wait, 2, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) return K_WAITING;
+
+        return K_YIELDED;
+    }
+
+    interp->budget = LONG_MAX;
+    interp->run    = (_k_frame_t*)0x0;
+
+    /* A failed instruction leaves the frames it was running in.  */
+    if (interp->frame != host) {
+        interp->frame = host;
+
+        return K_FAILED;
+    }
+
+    if (interp->ret != (k_value_t*)0x0) interp->ret->i = host->r[0].r;
+
+    return K_DONE;
+}
+
+/*
+ *    Completes the host call a context's run left in flight. The result
+ *    is picked up by the next k_run, which runs on past the call.
+ *
+ *    @param k_context_t *ctx      The context.
+ *    @param k_value_t    value    The call's result.
+ *
+ *    @return int    1 if the run was parked waiting on the call, 0 if it had not parked yet.
+ */
+int k_complete(k_context_t *ctx, k_value_t value) {
+    _k_interp_t *interp = ctx;
+
+    interp->reply = value;
+
+    return __atomic_exchange_n(&interp->wait, 3, __ATOMIC_ACQ_REL) == 2;
+}
+
+/*
+ *    Finishes a call of a batch that returned to the host, and enters
+ *    the next.
+ *
+ *    The first call is entered as any other, and the frame it is
+ *    entered in is kept. The calls after it start from a copy of that
+ *    frame, with only their arguments written, until the function is
+ *    promoted and has to be entered another way.
+ *
+ *    @param _k_interp_t *interp    The interpreter, back in the host's frame.
+ *    @param _k_batch_t  *batch     The batch.
+ *
+ *    @return int    0 if a call was entered, 1 once the batch is done or failed.
+ */
+int _k_batch_next(_k_interp_t *interp, _k_batch_t *batch) {
+    _k_frame_t *host   = interp->frame;
+    _k_inst2_t *entry  = batch->fn->entry;
+    long        params = batch->fn->params;
+    long        i      = batch->done;
+
+    if (i > 0 && batch->out != (k_value_t*)0x0) batch->out[i - 1].i = host->r[0].r;
+
+    if (i == batch->n) return 1;
+
+    if (i > 0 && __atomic_load_n(&entry->op, __ATOMIC_ACQUIRE) == batch->op) {
+        if (batch->op != _K_INST_FRNAT && _K_HEAT(entry)) _k_tier(interp, entry);
+
+        _k_frame_t *frame = host + 1;
+
+        /* Field by field, which compilers otherwise turn into a slow string move.  */
+        frame->sp   = batch->frame.sp;
+        frame->bp   = batch->frame.bp;
+        frame->ap   = batch->frame.ap;
+        frame->cur  = batch->frame.cur;
+        frame->r    = batch->frame.r;
+        frame->regs = batch->frame.regs;
+        frame->cmp  = batch->frame.cmp;
+
+        /* Compiled functions pop their arguments from where the first call pushed them. The kept frame decides, as promoting the function just now leaves it valid.  */
+        if (batch->op == _K_INST_FRNAT) {
+            for (long k = 0; k < params; ++k) memcpy(interp->mem + batch->frame.sp + sizeof(long) * (params - 1 - k), &batch->in[k][i], sizeof(long));
+        } else {
+            for (long k = 0; k < params; ++k) frame->r[(long)entry[params - k].a0].r = batch->in[k][i].i;
+        }
+
+        interp->frame = frame;
+    } else {
+        k_value_t args[_K_FRAME_REGS];
+
+        for (long k = 0; k < params; ++k) args[k] = batch->in[k][i];
+
+        if (_k_call_enter(interp, batch->fn, args)) {
+            batch->failed = 1;
+
+            return 1;
+        }
+
+        batch->frame = *interp->frame;
+        batch->op    = __atomic_load_n(&entry->op, __ATOMIC_ACQUIRE);
+    }
+
+    batch->done++;
 
     return 0;
-}
\ No newline at end of file
+}
+
+/*
+ *    Calls a function over arrays of arguments in a context.
+ *
+ *    @param k_context_t      *ctx    The context.
+ *    @param k_function_t     *fn     The function.
+ *    @param long              n      The number of calls.
+ *    @param const k_value_t **in     One array of n arguments per parameter.
+ *    @param k_value_t        *out    The array of n results, or NULL.
+ *
+ *    @return int    0 on success, 1 if a call failed.
+ */
+int k_context_call_batch(k_context_t *ctx, k_function_t *fn, long n, const k_value_t **in, k_value_t *out) {
+    _k_interp_t *interp = ctx;
+    _k_frame_t  *host   = interp->frame;
+    _k_batch_t   batch;
+
+    if (interp->run != (_k_frame_t*)0x0) return 1;
+
+#ifdef _K_LANES
+    /* Functions that can run across lanes take _K_LANES calls at a time, without entering the loop. Arguments may be shared, so none may be stored through.  */
+    if (interp->spmd && _k_lanes_open(interp) != (_k_lanes_t*)0x0 && !_k_lanes_check(interp, fn->entry) &&
+        interp->module->lane_refs[fn->entry - interp->module->insts] == 0) {
+        for (long i = 0; i < n; i += _K_LANES) {
+            if (_k_lanes_call(interp, fn, in, i, n - i < _K_LANES ? n - i : _K_LANES, out)) return 1;
+        }
+
+        return 0;
+    }
+#endif
+
+    batch.fn     = fn;
+    batch.n      = n;
+    batch.done   = 0;
+    batch.in     = in;
+    batch.out    = out;
+    batch.failed = 0;
+    batch.host   = host;
+
+    if (n <= 0 || _k_batch_next(interp, &batch)) return batch.failed;
+
+    /* Every call after the first is entered by the loop as the one before returns.  */
+    interp->batch = &batch;
+
+    loop(interp, host);
+
+    interp->batch = (_k_batch_t*)0x0;
+
+    if (interp->frame != host) {
+        interp->frame = host;
+
+        return 1;
+    }
+
+    return batch.failed;
+}
+
+/*
+ *    Calls a function over arrays of arguments.
+ *
+ *    @param k_env_t          *env    The environment.
+ *    @param k_function_t     *fn     The function.
+ *    @param long              n      The number of calls.
+ *    @param const k_value_t **in     One array of n arguments per parameter.
+ *    @param k_value_t        *out    The array of n results, or NULL.
+ *
+ *    @return int    0 on success, 1 if a call failed.
+ */
+int k_call_batch(k_env_t *env, k_function_t *fn, long n, const k_value_t **in, k_value_t *out) {
+    return k_context_call_batch(env->interp, fn, n, in, out);
+}
+
+/*
+ *    Calls a function by name.
+ *
+ *    @param k_env_t    *env     The environment.
+ *    @param const char *name    The name of the function.
+ *    @param k_value_t  *ret     Where to write its result, or NULL.
+ *    @param int         argc    The number of arguments that follow.
+ *
+ *    @return int    0 on success, 1 if the function is unknown, takes
+ *                   another number of arguments, or the call failed.
+ */
+int k_call_function(k_env_t *env, const char *name, k_value_t *ret, int argc, ...) {
+    k_function_t *fn = k_get_function(env, name);
+    k_value_t     args[_K_FRAME_REGS];
+    va_list       list;
+
+    if (fn == (k_function_t*)0x0) {
+        fprintf(stderr, "Unknown function %s!\n", name);
+
+        return 1;
+    }
+
+    if (argc != fn->params) {
+        fprintf(stderr, "%s takes %ld arguments, not %d!\n", name, fn->params, argc);
+
+        return 1;
+    }
+
+    va_start(list, argc);
+
+    for (int k = 0; k < argc; ++k) args[k].i = va_arg(list, long);
+
+    va_end(list);
+
+    return k_call(env, fn, args, ret);
+}
+
+/*
+ *    Destroys a context.
+ *
+ *    @param k_context_t *ctx    The context.
+ */
+void k_destroy_context(k_context_t *ctx) {
+    if (ctx != (k_context_t*)0x0) _k_unload(ctx);
+}
+
+/*
+ *    Destroys an environment and every handle into it, and its module
+ *    once no context holds it.
+ *
+ *    @param k_env_t *env    The environment.
+ */
+void k_destroy_env(k_env_t *env) {
+    if (env == (k_env_t*)0x0) return;
+
+    _k_env_unload(env);
+
+    while (env->hosts != (_k_host_t*)0x0) {
+        _k_host_t *next = env->hosts->next;
+
+        free(env->hosts->name);
+        free(env->hosts);
+
+        env->hosts = next;
+    }
+
+    free(env);
+}
@@ -0,0 +1,326 @@
+/*
+ *    libk_interpret.h    --    header for embedding KAPPA's interpreter.
+ *
+ *    Authored by Karl "p0lyh3dron" Kreuze on October 18, 2026
+ *
+ *    This file is part of the KAPPA project.
+ *
+ *    This file declares the API hosts embed the interpreter through.
+ *    A module is loaded once into an environment, its functions are
+ *    looked up once into handles, and calls through a handle write
+ *    their arguments straight into the callee's frame.
+ *
+ *    The environment's module is shared by the contexts made from it,
+ *    each with a stack and frames of its own, so threads can each run
+ *    the module in a context at once.
+ *
+ *    Scripts call back into the host through host functions, which may
+ *    leave their call in flight. A run making one parks until the host
+ *    completes it, without holding a thread meanwhile.
+ *
+ *    The interpreter is libk_interpret.c, libk_interpret_jit.c,
+ *    libk_interpret_lanes.c and libk_interpret_pool.c, linked into a
+ *    host. example_interpret.c is its standalone driver and benchmarks.
+ */
+#ifndef _LIBK_INTERPRET_H
+#define _LIBK_INTERPRET_H
+
+typedef struct k_env_s      k_env_t;
+typedef struct k_function_s k_function_t;
+typedef struct k_context_s  k_context_t;
+typedef struct k_pool_s     k_pool_t;
+
+/* What a run of a context was left doing by k_run.  */
+typedef enum {
+    K_DONE,
+    K_FAILED,
+    K_YIELDED,
+    K_WAITING,
+} k_state_t;
+
+/* A value as the interpreter holds it in a register: an integer or pointer, or a float widened to a double.  */
+typedef union {
+    long    i;
+    double  f;
+    void   *p;
+} k_value_t;
+
+/*
+ *    A function of the host scripts call as they would one of their own.
+ *    It either writes its result and returns K_DONE, returns K_FAILED, or
+ *    starts a slow operation and returns K_YIELDED, in which case the
+ *    operation hands its result to k_complete once it is done, from any
+ *    thread, and may do so before the function has returned.
+ *
+ *    @param k_context_t     *ctx     The context calling it.
+ *    @param const k_value_t *args    Its arguments, one per parameter.
+ *    @param k_value_t       *ret     Where to write its result.
+ *    @param void            *data    The data it was registered with.
+ *
+ *    @return k_state_t    K_DONE, K_FAILED or K_YIELDED.
+ */
+typedef k_state_t (*k_host_t)(k_context_t *ctx, const k_value_t *args, k_value_t *ret, void *data);
+
+/*
+ *    Creates an environment with no module loaded.
+ *
+ *    @return k_env_t *    The environment, or NULL if it could not be allocated.
+ */
+k_env_t *k_new_env(void);
+
+/*
+ *    Loads a module from KASM source into an environment, replacing
+ *    the module it held, if any.
+ *
+ *    @param k_env_t    *env       The environment.
+ *    @param const char *source    The KASM source, which is copied.
+ *
+ *    @return int    0 on success, 1 if the module failed to load.
+ */
+int k_load_source(k_env_t *env, const char *source);
+
+/*
+ *    Registers a host function with an environment, or replaces the one
+ *    registered by that name. Modules loaded from then on call it through
+ *    callf's to the name they do not define themselves.
+ *
+ *    @param k_env_t    *env       The environment.
+ *    @param const char *name      The name scripts call it by.
+ *    @param int         params    The number of arguments it takes.
+ *    @param int         real      1 if it returns a float, in ret's f
+ *                                 field, 0 if an integer or pointer.
+ *    @param k_host_t    fn        The function.
+ *    @param void       *data      Data passed to each of its calls.
+ *
+ *    @return int    0 on success, 1 if it takes too many arguments or
+ *                   could not be allocated.
+ */
+int k_set_host(k_env_t *env, const char *name, int params, int real, k_host_t fn, void *data);
+
+/*
+ *    Loads a module from a KASM file into an environment.
+ *
+ *    @param k_env_t    *env     The environment.
+ *    @param const char *path    The path of the KASM file.
+ *
+ *    @return int    0 on success, 1 if the module failed to load.
+ */
+int k_load_module(k_env_t *env, const char *path);
+
+/*
+ *    Looks up a function of the loaded module. Handles live as long as
+ *    the module is loaded in the environment, and looking up the same
+ *    name again gives the same one. Any thread may look functions up.
+ *
+ *    @param k_env_t    *env     The environment.
+ *    @param const char *name    The name of the function.
+ *
+ *    @return k_function_t *    The function, or NULL if the module has none by that name.
+ */
+k_function_t *k_get_function(k_env_t *env, const char *name);
+
+/*
+ *    Gets the number of parameters a function takes.
+ *
+ *    @param k_function_t *fn    The function.
+ *
+ *    @return int    The number of parameters.
+ */
+int k_function_params(k_function_t *fn);
+
+/*
+ *    Calls a function.
+ *
+ *    @param k_env_t         *env     The environment.
+ *    @param k_function_t    *fn      The function.
+ *    @param const k_value_t *args    Its arguments, one per parameter.
+ *    @param k_value_t       *ret     Where to write its result, or NULL.
+ *
+ *    @return int    0 on success, 1 if the call failed.
+ */
+int k_call(k_env_t *env, k_function_t *fn, const k_value_t *args, k_value_t *ret);
+
+/*
+ *    Calls a function over arrays of arguments, from a single entry
+ *    into the interpreter. As each call returns, its result is stored
+ *    and the next is entered in the frame it left.
+ *
+ *    Functions that neither print, call the host, nor store through
+ *    references other than to their own variables run several calls at
+ *    once across the lanes of vector registers, as SIMD code does, with
+ *    the lanes that branch apart masked off until they meet again.
+ *
+ *    @param k_env_t          *env    The environment.
+ *    @param k_function_t     *fn     The function.
+ *    @param long              n      The number of calls.
+ *    @param const k_value_t **in     One array of n arguments per parameter.
+ *    @param k_value_t        *out    The array of n results, or NULL.
+ *
+ *    @return int    0 on success, 1 if a call failed. The calls before
+ *                   it have stored their results.
+ */
+int k_call_batch(k_env_t *env, k_function_t *fn, long n, const k_value_t **in, k_value_t *out);
+
+/*
+ *    Calls a function by name. Each argument is passed as a long
+ *    holding a register's bits, as with k_value_t's i field.
+ *
+ *    @param k_env_t    *env     The environment.
+ *    @param const char *name    The name of the function.
+ *    @param k_value_t  *ret     Where to write its result, or NULL.
+ *    @param int         argc    The number of arguments that follow.
+ *
+ *    @return int    0 on success, 1 if the function is unknown, takes
+ *                   another number of arguments, or the call failed.
+ */
+int k_call_function(k_env_t *env, const char *name, k_value_t *ret, int argc, ...);
+
+/*
+ *    Creates a context running an environment's module, which it holds
+ *    until it is destroyed. One thread at a time may call through a
+ *    context, and calls in different contexts run at once. A context
+ *    with a run started takes no calls until the run is done.
+ *
+ *    @param k_env_t *env    The environment.
+ *
+ *    @return k_context_t *    The context, or NULL if the environment has no module loaded
+ *                             or the context could not be allocated.
+ */
+k_context_t *k_new_context(k_env_t *env);
+
+/*
+ *    Calls a function in a context, as k_call does. Outside a run, a host
+ *    function leaving its call in flight fails the call.
+ *
+ *    @param k_context_t     *ctx     The context.
+ *    @param k_function_t    *fn      A function of the context's module.
+ *    @param const k_value_t *args    Its arguments, one per parameter.
+ *    @param k_value_t       *ret     Where to write its result, or NULL.
+ *
+ *    @return int    0 on success, 1 if the call failed.
+ */
+int k_context_call(k_context_t *ctx, k_function_t *fn, const k_value_t *args, k_value_t *ret);
+
+/*
+ *    Calls a function over arrays of arguments in a context, as
+ *    k_call_batch does.
+ *
+ *    @param k_context_t      *ctx    The context.
+ *    @param k_function_t     *fn     A function of the context's module.
+ *    @param long              n      The number of calls.
+ *    @param const k_value_t **in     One array of n arguments per parameter.
+ *    @param k_value_t        *out    The array of n results, or NULL.
+ *
+ *    @return int    0 on success, 1 if a call failed. The calls before
+ *                   it have stored their results.
+ */
+int k_context_call_batch(k_context_t *ctx, k_function_t *fn, long n, const k_value_t **in, k_value_t *out);
+
+/*
+ *    Starts a run of a function in a context, entering it without running
+ *    any of it. Until the run is done, k_run runs it a slice at a time,
+ *    and the context takes no other calls.
+ *
+ *    @param k_context_t     *ctx     The context.
+ *    @param k_function_t    *fn      A function of the context's module.
+ *    @param const k_value_t *args    Its arguments, one per parameter.
+ *    @param k_value_t       *ret     Where to write its result once it is done, or NULL.
+ *
+ *    @return int    0 on success, 1 if the context has a run already or
+ *                   the call stack is full.
+ */
+int k_start(k_context_t *ctx, k_function_t *fn, const k_value_t *args, k_value_t *ret);
+
+/*
+ *    Runs a context's run for a slice of at most budget back-edges and
+ *    calls, in the interpreter and native code alike. A run out of budget
+ *    parks its frames where it stopped and yields, and the next k_run
+ *    carries on from there, on any thread. A loop that never ends still
+ *    yields every budget back-edges, so one thread can take turns running
+ *    many contexts.
+ *
+ *    A host function leaving its call in flight parks the run just past
+ *    the call, and the run waits until k_complete hands it the result.
+ *
+ *    @param k_context_t *ctx       The context.
+ *    @param long         budget    The back-edges and calls the slice may take.
+ *
+ *    @return k_state_t    K_DONE once the run has returned, with its
+ *                         result written, K_YIELDED if it is parked,
+ *                         K_WAITING if it is parked on a host call, or
+ *                         K_FAILED if it failed or no run was started.
+ */
+k_state_t k_run(k_context_t *ctx, long budget);
+
+/*
+ *    Completes the host call a context's run left in flight, once per
+ *    call a host function returned K_YIELDED from. Any thread may
+ *    complete it.
+ *
+ *    @param k_context_t *ctx      The context.
+ *    @param k_value_t    value    The call's result.
+ *
+ *    @return int    1 if the run was waiting on the call and is ready to
+ *                   be run again, or 0 if it had not parked yet, in which
+ *                   case the k_run parking it returns K_YIELDED instead.
+ */
+int k_complete(k_context_t *ctx, k_value_t value);
+
+/*
+ *    Destroys a context, and the module with it if nothing else holds it.
+ *
+ *    @param k_context_t *ctx    The context.
+ */
+void k_destroy_context(k_context_t *ctx);
+
+/*
+ *    Creates a pool of threads, each running the environment's module in
+ *    a context of its own. Without pthreads, a pool has only the thread
+ *    calling into it, and a pool some of whose threads fail to start
+ *    runs on those that did.
+ *
+ *    @param k_env_t *env        The environment.
+ *    @param long     threads    The number of threads, the caller's included.
+ *
+ *    @return k_pool_t *    The pool, or NULL if the environment has no module loaded or
+ *                          the pool or a context for one of its threads could not be
+ *                          allocated.
+ */
+k_pool_t *k_new_pool(k_env_t *env, long threads);
+
+/*
+ *    Calls a function over arrays of arguments across a pool's threads,
+ *    as k_call_batch does. The calls are cut into tiles of grain calls,
+ *    shared evenly between the threads, and a thread through its own
+ *    tiles steals half of those another has left. One thread at a time
+ *    may call into a pool, and is one of its threads until all the calls
+ *    have returned.
+ *
+ *    @param k_pool_t         *pool     The pool.
+ *    @param k_function_t     *fn       A function of the pool's module.
+ *    @param long              n        The number of calls.
+ *    @param long              grain    The number of calls in a tile.
+ *    @param const k_value_t **in       One array of n arguments per parameter.
+ *    @param k_value_t        *out      The array of n results, or NULL.
+ *
+ *    @return int    0 on success, 1 if a call failed, in which case the
+ *                   tiles not yet started are left without results.
+ */
+int k_parallel_for(k_pool_t *pool, k_function_t *fn, long n, long grain, const k_value_t **in, k_value_t *out);
+
+/*
+ *    Destroys a pool, joining its threads and destroying their contexts.
+ *
+ *    @param k_pool_t *pool    The pool.
+ */
+void k_destroy_pool(k_pool_t *pool);
+
+/*
+ *    Destroys an environment and every handle into it, and its module
+ *    once no context holds it.
+ *
+ *    @param k_env_t *env    The environment.
+ */
+void k_destroy_env(k_env_t *env);
+
+#endif /* _LIBK_INTERPRET_H  */
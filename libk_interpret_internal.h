@@ -0,0 +1,616 @@
+/*
+ *    libk_interpret_internal.h    --    internals of KAPPA's interpreter.
+ *
+ *    Authored by Karl "p0lyh3dron" Kreuze on October 18, 2026
+ *
+ *    This file is part of the KAPPA project.
+ *
+ *    This file declares what the interpreter's translation units share:
+ *    the features a build has, the loaded module and the contexts that
+ *    run it, the instruction set, and the functions one unit calls in
+ *    another. Hosts embed the interpreter through libk_interpret.h.
+ */
+#ifndef _LIBK_INTERPRET_INTERNAL_H
+#define _LIBK_INTERPRET_INTERNAL_H
+
+#include "libk_interpret.h"
+
+/* Threads dispatch through computed gotos where the compiler has them.  */
+#if defined(__GNUC__) && !defined(K_NO_THREADED)
+#define _K_THREADED 1
+#endif
+
+/* Functions compile to x86-64 where code can be mapped executable.  */
+#if defined(__x86_64__) && defined(__unix__) && !defined(K_NO_JIT)
+#define _K_JIT 1
+#include <stddef.h>
+#include <sys/mman.h>
+#endif
+
+/* Batches run _K_LANES calls at a time in vector registers where the compiler has vector extensions.  */
+#if defined(__GNUC__) && !defined(K_NO_LANES)
+#define _K_LANES 8
+#endif
+
+/* Contexts on several threads share a module, which guards what it compiles with a lock, where there are POSIX threads.  */
+#if defined(__unix__) && !defined(K_NO_PTHREAD)
+#define _K_PTHREAD 1
+#include <pthread.h>
+#include <unistd.h>
+#define _K_LOCK(m)   pthread_mutex_lock(&(m)->lock)
+#define _K_UNLOCK(m) pthread_mutex_unlock(&(m)->lock)
+#else
+#define _K_LOCK(m)   (void)(m)
+#define _K_UNLOCK(m) (void)(m)
+#endif
+
+/* Frames live on one preallocated stack, each holding at most _K_FRAME_REGS registers.  */
+#define _K_STACK_DEPTH 1024
+#define _K_FRAME_REGS  32
+
+/* Calls lanes go into before they give up, and the bytes of stack each lane has.  */
+#define _K_LANE_DEPTH 64
+#define _K_LANE_STACK 0x4000
+
+/* Instructions a loop's trace runs through, and calls it inlines, before recording it gives up.  */
+#define _K_TRACE_LENGTH 512
+#define _K_TRACE_DEPTH  8
+
+/* Mnemonics are looked up in a table of _K_OP_BUCKETS, and labels not yet defined point here.  */
+#define _K_OP_BUCKETS  512
+#define _K_UNDEFINED   ((void*)-1)
+
+/* Opcodes pack into n-gram keys _K_GRAM_BITS at a time.  */
+#define _K_GRAM_BITS    10
+#define _K_GRAM_BUCKETS (1 << 16)
+
+typedef struct {
+    int      (*func)(void *, void *, void *, void *);
+    void      *a0;
+    void      *a1;
+    void      *a2;
+    char       flags;
+    short      op;
+    unsigned   heat;
+    void      *addr;
+} _k_inst2_t;
+
+typedef struct {
+    long r;
+    char rf;
+} _k_reg_t;
+
+typedef struct _k_frame_s {
+    long        sp;
+    long        bp;
+    long        ap;
+    _k_inst2_t *cur;
+    _k_reg_t   *r;
+    long        regs;
+    char        cmp;
+} _k_frame_t;
+
+typedef struct {
+    char *name;
+    void *ptr;
+} _k_label_t;
+
+typedef struct {
+    char *name;
+    long  offset;
+    short load;
+    short save;
+} _k_slot_t;
+
+typedef struct {
+    long        inst;
+    long        line;
+    long        column;
+    const char *func;
+} _k_line_t;
+
+/*
+ *    Native code being emitted, with each instruction's offset into it,
+ *    and the register xmm0 is known to hold, or -1. Lane code homes its
+ *    first registers in ymm registers, with the number of homes, those
+ *    holding their register and those yet to be stored.
+ */
+typedef struct {
+    unsigned char *code;
+    long           length;
+    long          *at;
+    long          *fixups;
+    long           fixup_count;
+    char          *compiled;
+    long           held;
+    long           homes;
+    unsigned       homed;
+    unsigned       dirty;
+} _k_jit_t;
+
+/* The instructions one iteration of a loop ran, each with the kind of its operands or whether it jumped.  */
+typedef struct {
+    _k_inst2_t *insts[_K_TRACE_LENGTH];
+    char        info[_K_TRACE_LENGTH];
+    long        length;
+    int         closed;
+} _k_trace_t;
+
+/* Counts of the executed runs of n adjacent instructions, keyed by their packed opcodes.  */
+typedef struct {
+    int            n;
+    long           length;
+    unsigned long  window;
+    void          *last;
+    unsigned long *keys;
+    long          *counts;
+    long           distinct;
+    long           total;
+    long           skip;
+    long           dispatches;
+} _k_grams_t;
+
+/* Calls of one function over arrays of arguments, all run from one entry into the loop.  */
+typedef struct {
+    k_function_t     *fn;
+    long              n;
+    long              done;
+    const k_value_t **in;
+    k_value_t        *out;
+    int               failed;
+    _k_frame_t       *host;
+
+    struct _k_frame_s frame;
+    short             op;
+} _k_batch_t;
+
+#ifdef _K_LANES
+/* A register across every lane, as integers or floats, and as many values half as wide.  */
+typedef long   _k_lanei_t __attribute__((vector_size(sizeof(long) * _K_LANES)));
+typedef unsigned long _k_laneu_t __attribute__((vector_size(sizeof(long) * _K_LANES)));
+typedef double _k_lanef_t __attribute__((vector_size(sizeof(double) * _K_LANES)));
+typedef int    _k_halfi_t __attribute__((vector_size(sizeof(int) * _K_LANES)));
+typedef float  _k_halff_t __attribute__((vector_size(sizeof(float) * _K_LANES)));
+
+typedef union {
+    _k_lanei_t i;
+    _k_lanef_t f;
+} _k_lane_t;
+
+/*
+ *    A frame of a function running across lanes, which share its stack
+ *    pointers. Native code also keeps the lanes left out of what runs,
+ *    where its result goes, and which lanes are running, waiting and in
+ *    the function here, where the interpreter has them in locals.
+ */
+typedef struct {
+    _k_lanei_t  cmp;
+    _k_lanei_t  keep;
+    _k_lane_t  *r;
+    _k_lane_t  *ret;
+    long        sp;
+    long        bp;
+    long        ap;
+    long        regs;
+    _k_inst2_t *wait;
+    _k_inst2_t *pc[_K_LANES];
+    unsigned    bits;
+    unsigned    live;
+} _k_lane_frame_t;
+
+/*
+ *    What running across lanes needs of a context: the registers of every
+ *    frame, and the stack each lane has. Where there is a compiler, the
+ *    frames native code runs in and the stack to unwind to.
+ */
+typedef struct _k_lanes_s {
+    _k_lane_t       *regs;
+    char            *mem;
+    _k_lane_frame_t *frames;
+    void            *stack;
+} _k_lanes_t;
+#endif
+
+/* A host function, as registered with an environment and as each module loaded after keeps a copy of it.  */
+typedef struct _k_host_s {
+    char              *name;
+    long               params;
+    int                real;
+    k_host_t           fn;
+    void              *data;
+    struct _k_host_s  *next;
+} _k_host_t;
+
+/*
+ *    A loaded module: its code, which every context running it shares.
+ *    Instructions only change as they are quickened and promoted, and
+ *    promoting them, compiling lane code and looking up handles take the
+ *    lock. Across lanes, it has the instruction each was loaded as, which
+ *    functions were found to run across lanes (1) or not (2), and where
+ *    there is a compiler, the lane code of each instruction and the entry
+ *    into it. Host calls hold the host function they call.
+ */
+typedef struct {
+    char *source;
+
+    _k_inst2_t *insts;
+    _k_inst2_t *cur;
+    long        inst_count;
+    long        inst_cap;
+
+    _k_label_t *labels;
+    long        label_count;
+    long        label_cap;
+    long       *label_table;
+    long        label_buckets;
+
+    char       *file;
+    _k_line_t  *lines;
+    long        line_count;
+
+    int         threaded;
+    int         tiered;
+    int         tracing;
+
+    unsigned char *native_code;
+    long           native_size;
+    void         **native_at;
+    int          (*native)(void *, void *);
+
+    _k_host_t     *hosts;
+    long           host_count;
+
+#ifdef _K_LANES
+    short         *lane_ops;
+    char          *lane_checked;
+    unsigned long *lane_refs;
+    void         **lane_native;
+    int          (*lane_enter)(_k_lane_frame_t *, void *, void *);
+#endif
+
+    int            refs;
+#ifdef _K_PTHREAD
+    pthread_mutex_t lock;
+#endif
+} _k_module_t;
+
+/*
+ *    What one thread running a module has of its own: the stack, its
+ *    frames and registers, and its batch. A run started by k_start keeps
+ *    the host's frame it returns to and where its result goes, and the
+ *    back-edges and calls it may take before it parks. A run calling a
+ *    host function has it in flight (1), is parked waiting on it (2) or
+ *    has its result to pick up (3), of the kind the host returns.
+ */
+typedef struct k_context_s {
+    _k_module_t *module;
+
+    char *mem;
+    long  size;
+
+    _k_frame_t *frame;
+    _k_frame_t *frames;
+    _k_reg_t   *regs;
+
+    _k_batch_t *batch;
+
+    _k_frame_t *run;
+    k_value_t  *ret;
+    long        budget;
+    int         wait;
+    k_value_t   reply;
+    _k_host_t  *call;
+
+    int                spmd;
+    struct _k_lanes_s *lanes;
+} _k_interp_t;
+
+/* A handle on a function of a module, with the number of arguments its poprr's take.  */
+struct k_function_s {
+    char         *name;
+    _k_inst2_t   *entry;
+    long          params;
+    k_function_t *next;
+};
+
+struct k_env_s {
+    _k_interp_t  *interp;
+    k_function_t *functions;
+    _k_host_t    *hosts;
+};
+
+/* A thread of a pool, with its context and the tiles it has left, the first in the low half of range and the end in the high.  */
+typedef struct {
+    k_pool_t      *pool;
+    k_context_t   *ctx;
+    unsigned long  range;
+    long           tiles;
+    long           stolen;
+} _k_worker_t;
+
+/*
+ *    Threads each running a context of one module, and the loop they
+ *    are running: its function, calls, arguments and results, split into
+ *    tiles of grain calls. The thread calling into the pool is its first
+ *    worker, and the others wait for each new generation of work.
+ */
+struct k_pool_s {
+    long              threads;
+    _k_worker_t      *workers;
+
+    k_function_t     *fn;
+    long              n;
+    long              grain;
+    const k_value_t **in;
+    k_value_t        *out;
+    int               failed;
+
+#ifdef _K_PTHREAD
+    pthread_t        *ids;
+    pthread_mutex_t   lock;
+    pthread_cond_t    start;
+    pthread_cond_t    done;
+    long              generation;
+    long              running;
+    int               stop;
+#endif
+};
+
+typedef struct {
+    char *name;
+    int (*func)(_k_interp_t *, char *, char *, char *);
+} _k_inst_t;
+
+typedef struct {
+    short op;
+    short length;
+    short ops[4];
+} _k_fusion_t;
+
+typedef enum {
+    _K_INST_PUSHR,
+    _K_INST_POPRR,
+    _K_INST_LEAVE,
+    _K_INST_MOVRN,
+    _K_INST_MOVRR,
+    _K_INST_CALLF,
+    _K_INST_ADDRR,
+    _K_INST_SUBRR,
+    _K_INST_MULRR,
+    _K_INST_DIVRR,
+    _K_INST_LESRR,
+    _K_INST_GRERR,
+    _K_INST_EQURR,
+    _K_INST_CMPRD,
+    _K_INST_JMPEQ,
+    _K_INST_JMPAL,
+    _K_INST_DEREF,
+    _K_INST_SAVEA,
+    _K_INST_NEGRR,
+    _K_INST_LEQRR,
+    _K_INST_GEQRR,
+    _K_INST_NEQRR,
+    _K_INST_JLTRR,
+    _K_INST_JGTRR,
+    _K_INST_JLERR,
+    _K_INST_JGERR,
+    _K_INST_JEQRR,
+    _K_INST_JNERR,
+    _K_INST_JLTRN,
+    _K_INST_JGTRN,
+    _K_INST_JLERN,
+    _K_INST_JGERN,
+    _K_INST_JEQRN,
+    _K_INST_JNERN,
+    _K_INST_JLTRF,
+    _K_INST_JGTRF,
+    _K_INST_JLERF,
+    _K_INST_JGERF,
+    _K_INST_JEQRF,
+    _K_INST_JNERF,
+    _K_INST_ADDII,
+    _K_INST_ADDFF,
+    _K_INST_SUBII,
+    _K_INST_SUBFF,
+    _K_INST_MULII,
+    _K_INST_MULFF,
+    _K_INST_DIVII,
+    _K_INST_DIVFF,
+    _K_INST_LESII,
+    _K_INST_LESFF,
+    _K_INST_GREII,
+    _K_INST_GREFF,
+    _K_INST_LEQII,
+    _K_INST_LEQFF,
+    _K_INST_GEQII,
+    _K_INST_GEQFF,
+    _K_INST_EQUII,
+    _K_INST_EQUFF,
+    _K_INST_NEQII,
+    _K_INST_NEQFF,
+    _K_INST_NEGII,
+    _K_INST_NEGFF,
+    _K_INST_ITOFR,
+    _K_INST_FTOIR,
+    _K_INST_RTOFR,
+    _K_INST_RTOIR,
+    _K_INST_JLTII,
+    _K_INST_JGTII,
+    _K_INST_JLEII,
+    _K_INST_JGEII,
+    _K_INST_JEQII,
+    _K_INST_JNEII,
+    _K_INST_JLTFF,
+    _K_INST_JGTFF,
+    _K_INST_JLEFF,
+    _K_INST_JGEFF,
+    _K_INST_JEQFF,
+    _K_INST_JNEFF,
+    _K_INST_JLTIN,
+    _K_INST_JGTIN,
+    _K_INST_JLEIN,
+    _K_INST_JGEIN,
+    _K_INST_JEQIN,
+    _K_INST_JNEIN,
+    _K_INST_JLTFN,
+    _K_INST_JGTFN,
+    _K_INST_JLEFN,
+    _K_INST_JGEFN,
+    _K_INST_JEQFN,
+    _K_INST_JNEFN,
+    _K_INST_ADDWW,
+    _K_INST_ADDSS,
+    _K_INST_SUBWW,
+    _K_INST_SUBSS,
+    _K_INST_MULWW,
+    _K_INST_MULSS,
+    _K_INST_DIVWW,
+    _K_INST_DIVSS,
+    _K_INST_NEGWW,
+    _K_INST_ITOWR,
+    _K_INST_FTOSR,
+    _K_INST_DERII,
+    _K_INST_DERFF,
+    _K_INST_DERWW,
+    _K_INST_DERSS,
+    _K_INST_SAVII,
+    _K_INST_SAVFF,
+    _K_INST_SAVWW,
+    _K_INST_SAVSS,
+    _K_INST_MOVRF,
+    _K_INST_FRAME,
+    _K_INST_LODII,
+    _K_INST_LODFF,
+    _K_INST_LODWW,
+    _K_INST_LODHH,
+    _K_INST_LODSS,
+    _K_INST_STOII,
+    _K_INST_STOWW,
+    _K_INST_STOSS,
+    _K_INST_REFSL,
+    _K_INST_ADDQI,
+    _K_INST_ADDQF,
+    _K_INST_SUBQI,
+    _K_INST_SUBQF,
+    _K_INST_MULQI,
+    _K_INST_MULQF,
+    _K_INST_DIVQI,
+    _K_INST_DIVQF,
+    _K_INST_LESQI,
+    _K_INST_LESQF,
+    _K_INST_GREQI,
+    _K_INST_GREQF,
+    _K_INST_LEQQI,
+    _K_INST_LEQQF,
+    _K_INST_GEQQI,
+    _K_INST_GEQQF,
+    _K_INST_EQUQI,
+    _K_INST_EQUQF,
+    _K_INST_NEQQI,
+    _K_INST_NEQQF,
+    _K_INST_NEGQI,
+    _K_INST_NEGQF,
+    _K_INST_ARGRR,
+    _K_INST_CALLR,
+    _K_INST_CALLN,
+    _K_INST_FRNAT,
+    _K_INST_LOOPB,
+    _K_INST_LOOPT,
+    _K_INST_LOOPI,
+    _K_INST_HOSTC,
+    _K_INST_LDINC,
+    _K_INST_LLJGE,
+    _K_INST_LLMSS,
+    _K_INST_LDLII,
+    _K_INST_LDSTI,
+    _K_INST_ADSTI,
+    _K_INST_STJMP,
+    _K_INST_LDDSS,
+    _K_INST_PUSHC,
+    _K_INST_FRPOP,
+    _K_INST_MVLEA,
+    _K_INST_COUNT
+} _k_inst_e;
+
+/* Instructions from _K_INST_INTERNAL on are only made by the loader, superinstructions last.  */
+#define _K_INST_INTERNAL _K_INST_ADDQI
+#define _K_INST_FUSED    _K_INST_LDINC
+
+/* Guard failures an instruction takes before it stays generic.  */
+#define _K_DEOPTS 4
+
+/* Calls and back-edges a function takes before it is promoted to native code. Counts stop there, so contexts on other cores stop writing them.  */
+#define _K_TIER_HOT 1000
+
+/* Counts a run of an instruction, shared by contexts on other cores, and tells whether this run made it hot.  */
+#define _K_HEAT(i) (__atomic_load_n(&(i)->heat, __ATOMIC_RELAXED) < _K_TIER_HOT && __atomic_add_fetch(&(i)->heat, 1, __ATOMIC_RELAXED) == _K_TIER_HOT)
+
+extern const _k_inst_t   _k_inst_list[];
+extern const _k_fusion_t _k_fusion_list[];
+
+/* The loop, its instructions and the loader, in libk_interpret.c.  */
+int    _k_cmprr(_k_reg_t *r0, _k_reg_t *r1);
+short  _k_base_op(short op);
+void   _k_print_location(_k_interp_t *interp, _k_inst2_t *inst);
+double loop(_k_interp_t *interp, _k_frame_t *start);
+double _k_loop_calls(_k_interp_t *interp, _k_frame_t *start, long *count, _k_grams_t *grams);
+int    _k_batch_next(_k_interp_t *interp, _k_batch_t *batch);
+
+/* Loading a module into an interpreter of its own, and calling into it by name, also in libk_interpret.c.  */
+_k_interp_t *_k_load_source(char *source, const _k_host_t *hosts);
+_k_interp_t *_k_load(const char *path, const _k_host_t *hosts);
+void         _k_unload(_k_interp_t *interp);
+int          push(_k_interp_t *interp, void *data, long size);
+int          call(_k_interp_t *interp, char *func);
+
+/* The compiler and tracer, in libk_interpret_jit.c, where a build without them keeps only their entry points.  */
+long   _k_jit(_k_interp_t *interp);
+void   _k_tier(_k_interp_t *interp, _k_inst2_t *entry);
+int    _k_trace(_k_interp_t *interp, _k_inst2_t *loop);
+
+#ifdef _K_JIT
+/* Native code keeps the frame's registers in rbx, its slots in r12, the interpreter in r13, the frame in r14 and memory in r15.  */
+#define _K_RAX 0
+#define _K_RCX 1
+#define _K_RDX 2
+#define _K_RBX 3
+#define _K_RSP 4
+#define _K_RBP 5
+#define _K_RSI 6
+#define _K_RDI 7
+#define _K_R12 12
+#define _K_R13 13
+#define _K_R14 14
+#define _K_R15 15
+
+/* Encoding, which the lanes' compiler shares.  */
+void _k_jit_byte(_k_jit_t *jit, long byte);
+void _k_jit_bytes(_k_jit_t *jit, long value, int count);
+void _k_jit_head(_k_jit_t *jit, int prefix, int wide, int op, int reg, int rm);
+void _k_jit_mem(_k_jit_t *jit, int prefix, int wide, int op, int reg, int base, long disp);
+void _k_jit_reg(_k_jit_t *jit, int prefix, int wide, int op, int reg, int rm);
+void _k_jit_imm(_k_jit_t *jit, int reg, long value);
+void _k_jit_fixup(_k_jit_t *jit, long target);
+void _k_jit_jump(_k_jit_t *jit, int cc, long target);
+long _k_jit_forward(_k_jit_t *jit, int cc);
+void _k_jit_land(_k_jit_t *jit, long at);
+void _k_jit_call_c(_k_jit_t *jit, void *func);
+int  _k_jit_open(_k_interp_t *interp, _k_jit_t *jit, long size);
+int  _k_jit_close(_k_interp_t *interp, _k_jit_t *jit, long size);
+#endif
+
+#ifdef _K_LANES
+/* Lanes, and where there is a compiler their native code, in libk_interpret_lanes.c.  */
+unsigned    _k_lane_bits(const _k_lanei_t *cond);
+void        _k_lane_mask(_k_lanei_t *mask, unsigned bits);
+_k_lanes_t *_k_lanes_open(_k_interp_t *interp);
+int         _k_lanes_check(_k_interp_t *interp, _k_inst2_t *entry);
+_k_inst2_t *_k_lanes_pick(_k_inst2_t **pc, unsigned live, unsigned *bits, _k_inst2_t **wait, _k_inst2_t *end);
+int         _k_lanes_call(_k_interp_t *interp, k_function_t *fn, const k_value_t **in, long i, long count, k_value_t *out);
+
+#ifdef _K_JIT
+int         _k_lanes_enter(_k_interp_t *interp, _k_lane_frame_t *frame, _k_inst2_t *ip, unsigned live, _k_lane_t *ret);
+#endif
+#endif
+
+#endif
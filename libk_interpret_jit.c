@@ -0,0 +1,1213 @@
+/*
+ *    libk_interpret_jit.c    --    source for KAPPA's x86-64 compiler and tracer.
+ *
+ *    Authored by Karl "p0lyh3dron" Kreuze on October 18, 2026
+ *
+ *    This file is part of the KAPPA project.
+ *
+ *    This file compiles hot functions, and the loops they trace, from the
+ *    interpreter's instructions to x86-64, and holds the tiering entry
+ *    points the loop calls. Built without the compiler, only those entry
+ *    points remain, and they leave everything interpreted.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libk_interpret_internal.h"
+
+#ifdef _K_JIT
+/* Displacements of a register's value and kind from rbx, and of a frame field from r14.  */
+#define _K_JREG(a)   ((long)sizeof(_k_reg_t) * (long)(a))
+#define _K_JKIND(a)  (_K_JREG(a) + (long)offsetof(_k_reg_t, rf))
+#define _K_JFRAME(f) ((long)offsetof(_k_frame_t, f))
+
+/* Most bytes of native code any instruction takes.  */
+#define _K_JIT_INST 256
+
+/* Condition codes of lt, gt, le, ge, eq and ne, comparing integers and comparing floats.  */
+const int _k_jit_icc[6] = { 0xC, 0xF, 0xE, 0xD, 0x4, 0x5 };
+const int _k_jit_fcc[6] = { 0x7, 0x7, 0x6, 0x6, 0x4, 0x5 };
+
+void _k_jit_byte(_k_jit_t *jit, long byte) {
+    jit->code[jit->length++] = (unsigned char)byte;
+}
+
+void _k_jit_bytes(_k_jit_t *jit, long value, int count) {
+    for (int k = 0; k < count; ++k) _k_jit_byte(jit, value >> (8 * k));
+}
+
+/*
+ *    Emits an instruction's prefix, REX byte and opcode.
+ *
+ *    @param _k_jit_t *jit    The code being emitted.
+ *    @param int prefix       A mandatory prefix, or 0.
+ *    @param int wide         Whether the operands are 64 bits wide.
+ *    @param int op           The opcode, two byte opcodes written 0x0Fxx.
+ *    @param int reg          The register, or opcode extension, of the ModRM byte.
+ *    @param int rm           The register or base of the ModRM byte.
+ */
+void _k_jit_head(_k_jit_t *jit, int prefix, int wide, int op, int reg, int rm) {
+    if (prefix) _k_jit_byte(jit, prefix);
+
+    if (wide || reg >= 8 || rm >= 8) _k_jit_byte(jit, 0x40 | wide << 3 | (reg >> 3) << 2 | rm >> 3);
+
+    if (op > 0xFF) _k_jit_byte(jit, op >> 8);
+
+    _k_jit_byte(jit, op);
+}
+
+/* Emits an instruction on a register and [base + disp32].  */
+void _k_jit_mem(_k_jit_t *jit, int prefix, int wide, int op, int reg, int base, long disp) {
+    _k_jit_head(jit, prefix, wide, op, reg, base);
+    _k_jit_byte(jit, 0x80 | (reg & 7) << 3 | (base & 7));
+
+    if ((base & 7) == _K_RSP) _k_jit_byte(jit, 0x24);
+
+    _k_jit_bytes(jit, disp, 4);
+}
+
+/* Emits an instruction on two registers.  */
+void _k_jit_reg(_k_jit_t *jit, int prefix, int wide, int op, int reg, int rm) {
+    _k_jit_head(jit, prefix, wide, op, reg, rm);
+    _k_jit_byte(jit, 0xC0 | (reg & 7) << 3 | (rm & 7));
+}
+
+void _k_jit_imm(_k_jit_t *jit, int reg, long value) {
+    _k_jit_head(jit, 0, 1, 0xB8 + (reg & 7), 0, reg);
+    _k_jit_bytes(jit, value, 8);
+}
+
+/* Emits a rel32 to an instruction, patched once every instruction has its offset.  */
+void _k_jit_fixup(_k_jit_t *jit, long target) {
+    jit->fixups[2 * jit->fixup_count]     = jit->length;
+    jit->fixups[2 * jit->fixup_count + 1] = target;
+    jit->fixup_count++;
+
+    _k_jit_bytes(jit, 0, 4);
+}
+
+/* Emits a jump to an instruction, conditional unless cc is negative.  */
+void _k_jit_jump(_k_jit_t *jit, int cc, long target) {
+    if (cc < 0) {
+        _k_jit_byte(jit, 0xE9);
+    } else {
+        _k_jit_byte(jit, 0x0F);
+        _k_jit_byte(jit, 0x80 + cc);
+    }
+
+    _k_jit_fixup(jit, target);
+}
+
+/* Emits a jump forward within an instruction, returning where to patch it with _k_jit_land.  */
+long _k_jit_forward(_k_jit_t *jit, int cc) {
+    if (cc < 0) {
+        _k_jit_byte(jit, 0xE9);
+    } else {
+        _k_jit_byte(jit, 0x0F);
+        _k_jit_byte(jit, 0x80 + cc);
+    }
+
+    _k_jit_bytes(jit, 0, 4);
+
+    return jit->length - 4;
+}
+
+void _k_jit_land(_k_jit_t *jit, long at) {
+    long rel = jit->length - (at + 4);
+
+    memcpy(jit->code + at, &rel, 4);
+}
+
+void _k_jit_load(_k_jit_t *jit, int reg, long a) {
+    _k_jit_mem(jit, 0, 1, 0x8B, reg, _K_RBX, _K_JREG(a));
+}
+
+void _k_jit_store(_k_jit_t *jit, int reg, long a, int kind) {
+    _k_jit_mem(jit, 0, 1, 0x89, reg, _K_RBX, _K_JREG(a));
+    _k_jit_mem(jit, 0, 0, 0xC6, 0, _K_RBX, _K_JKIND(a));
+    _k_jit_byte(jit, kind);
+}
+
+void _k_jit_loadf(_k_jit_t *jit, int xmm, long a) {
+    if (xmm == 0 && a == jit->held) return;
+
+    _k_jit_mem(jit, 0xF2, 0, 0x0F10, xmm, _K_RBX, _K_JREG(a));
+}
+
+void _k_jit_storef(_k_jit_t *jit, int xmm, long a) {
+    _k_jit_mem(jit, 0xF2, 0, 0x0F11, xmm, _K_RBX, _K_JREG(a));
+    _k_jit_mem(jit, 0, 0, 0xC6, 0, _K_RBX, _K_JKIND(a));
+    _k_jit_byte(jit, 1);
+}
+
+/* Copies a register from index src to index dst of the window, its kind as the byte it was stored as.  */
+void _k_jit_copy(_k_jit_t *jit, long dst, long src) {
+    _k_jit_mem(jit, 0, 1, 0x8B, _K_RAX, _K_RBX, _K_JREG(src));
+    _k_jit_mem(jit, 0, 1, 0x89, _K_RAX, _K_RBX, _K_JREG(dst));
+    _k_jit_mem(jit, 0, 0, 0x8A, _K_RAX, _K_RBX, _K_JKIND(src));
+    _k_jit_mem(jit, 0, 0, 0x88, _K_RAX, _K_RBX, _K_JKIND(dst));
+}
+
+/* Rounds xmm0 to single precision, as f32 arithmetic does.  */
+void _k_jit_single(_k_jit_t *jit) {
+    _k_jit_reg(jit, 0xF2, 0, 0x0F5A, 0, 0);
+    _k_jit_reg(jit, 0xF3, 0, 0x0F5A, 0, 0);
+}
+
+/* Compares xmm0 with xmm1 for condition k, swapping them for lt and ge so unordered compares go as _k_cmprr's do.  */
+void _k_jit_fcmp(_k_jit_t *jit, int k) {
+    if (k == 0 || k == 3) _k_jit_reg(jit, 0x66, 0, 0x0F2E, 1, 0);
+    else                  _k_jit_reg(jit, 0x66, 0, 0x0F2E, 0, 1);
+}
+
+/* Calls a C function, keeping the stack aligned, and returns its nonzero status.  */
+void _k_jit_call_c(_k_jit_t *jit, void *func) {
+    _k_jit_reg(jit, 0, 1, 0x83, 5, _K_RSP);
+    _k_jit_byte(jit, 8);
+    _k_jit_imm(jit, _K_RAX, (long)func);
+    _k_jit_reg(jit, 0, 0, 0xFF, 2, _K_RAX);
+    _k_jit_reg(jit, 0, 1, 0x83, 0, _K_RSP);
+    _k_jit_byte(jit, 8);
+}
+
+/* Counts a back-edge or call against the context's budget, leaving for the interpreter to park at the instruction once it runs out.  */
+void _k_jit_budget(_k_jit_t *jit, _k_inst2_t *at) {
+    _k_jit_mem(jit, 0, 1, 0x83, 5, _K_R13, (long)offsetof(_k_interp_t, budget));
+    _k_jit_byte(jit, 1);
+
+    long over = _k_jit_forward(jit, 0x9);
+
+    _k_jit_imm(jit, _K_RAX, (long)at);
+    _k_jit_mem(jit, 0, 1, 0x89, _K_RAX, _K_R14, _K_JFRAME(cur));
+    _k_jit_byte(jit, 0xB8);
+    _k_jit_bytes(jit, 3, 4);
+    _k_jit_byte(jit, 0xC3);
+    _k_jit_land(jit, over);
+}
+
+void _k_jit_check(_k_jit_t *jit) {
+    _k_jit_reg(jit, 0, 0, 0x85, _K_RAX, _K_RAX);
+    _k_jit_byte(jit, 0x74);
+    _k_jit_byte(jit, 0x01);
+    _k_jit_byte(jit, 0xC3);
+}
+
+/*
+ *    Makes a call from native code the way the interpreter would, running
+ *    the callee on a nested loop.
+ *
+ *    @param _k_interp_t *interp    The interpreter.
+ *    @param _k_inst2_t *ip         The call.
+ *
+ *    @return int                   0, 1 on an unreported error, 2 on one already reported, or 3 if the callee parked out of budget.
+ */
+int _k_jit_call(_k_interp_t *interp, _k_inst2_t *ip) {
+    _k_frame_t *caller = interp->frame;
+    _k_inst2_t *entry  = (_k_inst2_t*)ip->a0;
+
+    caller->cur = ip;
+
+    /* Register calls enter past the frame, so count toward promoting the callee here.  */
+    if (__atomic_load_n(&ip->op, __ATOMIC_ACQUIRE) == _K_INST_CALLR && _K_HEAT(entry)) _k_tier(interp, entry);
+
+    /* Register calls may be bound to native code meanwhile, which rewrites a1.  */
+    if (ip->func(interp, ip->a0, __atomic_load_n(&ip->a1, __ATOMIC_ACQUIRE), ip->a2)) return 1;
+
+    interp->frame->cur++;
+
+    loop(interp, caller);
+
+    if (interp->frame == caller) return 0;
+
+    return interp->budget < 0 ? 3 : 2;
+}
+
+/*
+ *    Makes a host call from native code, which parks the run past it if
+ *    the host leaves it in flight.
+ *
+ *    @param _k_interp_t *interp    The interpreter.
+ *    @param _k_inst2_t *ip         The host call.
+ *
+ *    @return int                   0, 1 on an unreported error, or 3 if the run parked.
+ */
+int _k_jit_host(_k_interp_t *interp, _k_inst2_t *ip) {
+    interp->frame->cur = ip;
+
+    if (ip->func(interp, ip->a0, ip->a1, ip->a2)) return 1;
+
+    if (interp->budget >= 0) return 0;
+
+    interp->frame->cur = ip + 1;
+
+    return 3;
+}
+
+/*
+ *    Emits a typed conditional jump's compare, and a jump to the target if
+ *    it holds.
+ *
+ *    @param _k_jit_t *jit    The code being emitted.
+ *    @param short op         The jump, from jltii to jnefn.
+ *    @param long a0          The register compared.
+ *    @param long a1          The register or constant it is compared with.
+ *    @param long target      What the jump is fixed up to.
+ */
+void _k_jit_branch(_k_jit_t *jit, short op, long a0, long a1, long target) {
+    int k = (op - _K_INST_JLTII) % 6;
+
+    if (op <= _K_INST_JNEII || (op >= _K_INST_JLTIN && op <= _K_INST_JNEIN)) {
+        _k_jit_load(jit, _K_RAX, a0);
+
+        if (op >= _K_INST_JLTIN) {
+            _k_jit_imm(jit, _K_RCX, a1);
+            _k_jit_reg(jit, 0, 1, 0x3B, _K_RAX, _K_RCX);
+        } else {
+            _k_jit_mem(jit, 0, 1, 0x3B, _K_RAX, _K_RBX, _K_JREG(a1));
+        }
+
+        _k_jit_jump(jit, _k_jit_icc[k], target);
+        return;
+    }
+
+    _k_jit_loadf(jit, 0, a0);
+
+    if (op >= _K_INST_JLTFN) {
+        _k_jit_imm(jit, _K_RAX, a1);
+        _k_jit_reg(jit, 0x66, 1, 0x0F6E, 1, _K_RAX);
+    } else {
+        _k_jit_loadf(jit, 1, a1);
+    }
+
+    _k_jit_fcmp(jit, k);
+    _k_jit_jump(jit, _k_jit_fcc[k], target);
+}
+
+/*
+ *    Emits the frame setup of a register call, leaving the pinned
+ *    registers on the callee's frame. Overflows jump forward, to be landed
+ *    where the caller reports them.
+ *
+ *    @param _k_jit_t *jit          The code being emitted.
+ *    @param _k_interp_t *interp    The interpreter.
+ *    @param _k_inst2_t *inst       The call.
+ *    @param long entry             The caller's frame instruction.
+ *    @param long *slow             Where the two overflow jumps are patched.
+ */
+void _k_jit_enter(_k_jit_t *jit, _k_interp_t *interp, _k_inst2_t *inst, long entry, long *slow) {
+    _k_inst2_t *callee = (_k_inst2_t*)inst->a0;
+
+    /* Code is shared by every context, so the end of the frame stack is the running one's.  */
+    _k_jit_mem(jit, 0, 1, 0x8B, _K_RAX, _K_R13, (long)offsetof(_k_interp_t, frames));
+    _k_jit_mem(jit, 0, 1, 0x8D, _K_RAX, _K_RAX, (long)sizeof(_k_frame_t) * (_K_STACK_DEPTH - 1));
+    _k_jit_reg(jit, 0, 1, 0x3B, _K_R14, _K_RAX);
+    slow[0] = _k_jit_forward(jit, 0x3);
+    _k_jit_mem(jit, 0, 1, 0x8B, _K_RAX, _K_R14, _K_JFRAME(sp));
+    _k_jit_reg(jit, 0, 1, 0x81, 7, _K_RAX);
+    _k_jit_bytes(jit, (long)callee->a0, 4);
+    slow[1] = _k_jit_forward(jit, 0xC);
+
+    _k_jit_imm(jit, _K_RCX, (long)inst);
+    _k_jit_mem(jit, 0, 1, 0x89, _K_RCX, _K_R14, _K_JFRAME(cur));
+    _k_jit_mem(jit, 0, 1, 0x89, _K_RAX, _K_R14, sizeof(_k_frame_t) + _K_JFRAME(ap));
+    _k_jit_reg(jit, 0, 1, 0x81, 5, _K_RAX);
+    _k_jit_bytes(jit, (long)callee->a0, 4);
+    _k_jit_reg(jit, 0, 1, 0x83, 4, _K_RAX);
+    _k_jit_byte(jit, 0xF8);
+    _k_jit_mem(jit, 0, 1, 0x89, _K_RAX, _K_R14, sizeof(_k_frame_t) + _K_JFRAME(sp));
+    _k_jit_mem(jit, 0, 1, 0x89, _K_RAX, _K_R14, sizeof(_k_frame_t) + _K_JFRAME(bp));
+    _k_jit_mem(jit, 0, 1, 0x8D, _K_RCX, _K_RBX, _K_JREG(interp->module->insts[entry].a1));
+    _k_jit_mem(jit, 0, 1, 0x89, _K_RCX, _K_R14, sizeof(_k_frame_t) + _K_JFRAME(r));
+    _k_jit_mem(jit, 0, 1, 0xC7, 0, _K_R14, sizeof(_k_frame_t) + _K_JFRAME(regs));
+    _k_jit_bytes(jit, (long)callee->a1, 4);
+    _k_jit_reg(jit, 0, 1, 0x81, 0, _K_R14);
+    _k_jit_bytes(jit, sizeof(_k_frame_t), 4);
+    _k_jit_mem(jit, 0, 1, 0x89, _K_R14, _K_R13, (long)offsetof(_k_interp_t, frame));
+    _k_jit_reg(jit, 0, 1, 0x89, _K_RCX, _K_RBX);
+    _k_jit_reg(jit, 0, 1, 0x89, _K_RAX, _K_R12);
+    _k_jit_reg(jit, 0, 1, 0x01, _K_R15, _K_R12);
+}
+
+/*
+ *    Emits the return of a register's callee to its caller, leaving the
+ *    pinned registers on the caller's frame.
+ */
+void _k_jit_leave(_k_jit_t *jit) {
+    _k_jit_mem(jit, 0, 1, 0x8D, _K_RAX, _K_R14, -(long)sizeof(_k_frame_t));
+    _k_jit_mem(jit, 0, 1, 0x8B, _K_RCX, _K_RAX, _K_JFRAME(r));
+    _k_jit_mem(jit, 0, 1, 0x8B, _K_RDX, _K_RBX, 0);
+    _k_jit_mem(jit, 0, 1, 0x89, _K_RDX, _K_RCX, 0);
+    _k_jit_mem(jit, 0, 0, 0x8A, _K_RDX, _K_RBX, _K_JKIND(0));
+    _k_jit_mem(jit, 0, 0, 0x88, _K_RDX, _K_RCX, _K_JKIND(0));
+    _k_jit_mem(jit, 0, 1, 0x8B, _K_RDX, _K_R14, _K_JFRAME(ap));
+    _k_jit_mem(jit, 0, 1, 0x89, _K_RDX, _K_RAX, _K_JFRAME(sp));
+    _k_jit_mem(jit, 0, 1, 0x89, _K_RAX, _K_R13, (long)offsetof(_k_interp_t, frame));
+    _k_jit_reg(jit, 0, 1, 0x89, _K_RAX, _K_R14);
+    _k_jit_reg(jit, 0, 1, 0x89, _K_RCX, _K_RBX);
+    _k_jit_mem(jit, 0, 1, 0x8B, _K_R12, _K_R14, _K_JFRAME(bp));
+    _k_jit_reg(jit, 0, 1, 0x01, _K_R15, _K_R12);
+}
+
+/*
+ *    Emits the native code of one instruction of a function.
+ *
+ *    @param _k_jit_t *jit          The code being emitted.
+ *    @param _k_interp_t *interp    The interpreter.
+ *    @param long entry             The function's frame instruction.
+ *    @param long end               The instruction after the function.
+ *    @param long i                 The instruction.
+ *    @param short op               What it runs as, usually the instruction it was loaded as.
+ *
+ *    @return int                   1 if the instruction has no native template.
+ */
+int _k_jit_inst(_k_jit_t *jit, _k_interp_t *interp, long entry, long end, long i, short op) {
+    _k_inst2_t *inst = &interp->module->insts[i];
+    long        a0   = (long)inst->a0;
+    long        a1   = (long)inst->a1;
+    long        a2   = (long)inst->a2;
+    long        jump = -1;
+
+    /* Jumps stay within the function's body.  */
+    if (op == _K_INST_JMPAL || (op >= _K_INST_JLTII && op <= _K_INST_JNEFN)) {
+        jump = (_k_inst2_t*)(op == _K_INST_JMPAL ? inst->a0 : inst->a2) - interp->module->insts;
+
+        if (jump <= entry || jump >= end) return 1;
+    }
+
+    switch (op) {
+        case _K_INST_PUSHR:
+            _k_jit_mem(jit, 0, 1, 0x83, 5, _K_R14, _K_JFRAME(sp));
+            _k_jit_byte(jit, sizeof(long));
+            _k_jit_mem(jit, 0, 1, 0x8B, _K_RAX, _K_R14, _K_JFRAME(sp));
+            _k_jit_reg(jit, 0, 1, 0x01, _K_R15, _K_RAX);
+            _k_jit_load(jit, _K_RCX, a0);
+            _k_jit_mem(jit, 0, 1, 0x89, _K_RCX, _K_RAX, 0);
+            return 0;
+
+        case _K_INST_POPRR:
+            _k_jit_mem(jit, 0, 1, 0x8B, _K_RAX, _K_R14, _K_JFRAME(ap));
+            _k_jit_mem(jit, 0, 1, 0x83, 0, _K_R14, _K_JFRAME(ap));
+            _k_jit_byte(jit, sizeof(long));
+            _k_jit_reg(jit, 0, 1, 0x01, _K_R15, _K_RAX);
+            _k_jit_mem(jit, 0, 1, 0x8B, _K_RCX, _K_RAX, 0);
+            _k_jit_mem(jit, 0, 1, 0x89, _K_RCX, _K_RBX, _K_JREG(a0));
+            return 0;
+
+        case _K_INST_MOVRN:
+        case _K_INST_MOVRF:
+            _k_jit_imm(jit, _K_RAX, a1);
+            _k_jit_store(jit, _K_RAX, a0, op == _K_INST_MOVRF);
+            return 0;
+
+        case _K_INST_MOVRR:
+            _k_jit_copy(jit, a0, a1);
+            return 0;
+
+        case _K_INST_ADDII: case _K_INST_SUBII: case _K_INST_MULII:
+        case _K_INST_ADDWW: case _K_INST_SUBWW: case _K_INST_MULWW:
+            _k_jit_load(jit, _K_RAX, a1);
+            _k_jit_mem(jit, 0, 1, op == _K_INST_ADDII || op == _K_INST_ADDWW ? 0x03 : op == _K_INST_SUBII || op == _K_INST_SUBWW ? 0x2B : 0x0FAF, _K_RAX, _K_RBX, _K_JREG(a2));
+
+            if (op == _K_INST_ADDWW || op == _K_INST_SUBWW || op == _K_INST_MULWW) _k_jit_reg(jit, 0, 0, 0x89, _K_RAX, _K_RAX);
+
+            _k_jit_store(jit, _K_RAX, a0, 0);
+            return 0;
+
+        case _K_INST_DIVII:
+        case _K_INST_DIVWW:
+            _k_jit_load(jit, _K_RAX, a1);
+            _k_jit_head(jit, 0, 1, 0x99, 0, 0);
+            _k_jit_mem(jit, 0, 1, 0xF7, 7, _K_RBX, _K_JREG(a2));
+
+            if (op == _K_INST_DIVWW) _k_jit_reg(jit, 0, 0, 0x89, _K_RAX, _K_RAX);
+
+            _k_jit_store(jit, _K_RAX, a0, 0);
+            return 0;
+
+        case _K_INST_ADDFF: case _K_INST_SUBFF: case _K_INST_MULFF: case _K_INST_DIVFF:
+        case _K_INST_ADDSS: case _K_INST_SUBSS: case _K_INST_MULSS: case _K_INST_DIVSS:
+            _k_jit_loadf(jit, 0, a1);
+            _k_jit_mem(jit, 0xF2, 0, op == _K_INST_ADDFF || op == _K_INST_ADDSS ? 0x0F58 : op == _K_INST_SUBFF || op == _K_INST_SUBSS ? 0x0F5C :
+                                     op == _K_INST_MULFF || op == _K_INST_MULSS ? 0x0F59 : 0x0F5E, 0, _K_RBX, _K_JREG(a2));
+
+            if (op == _K_INST_ADDSS || op == _K_INST_SUBSS || op == _K_INST_MULSS || op == _K_INST_DIVSS) _k_jit_single(jit);
+
+            _k_jit_storef(jit, 0, a0);
+            return 0;
+
+        case _K_INST_LESII: case _K_INST_GREII: case _K_INST_LEQII: case _K_INST_GEQII: case _K_INST_EQUII: case _K_INST_NEQII:
+            _k_jit_load(jit, _K_RAX, a1);
+            _k_jit_mem(jit, 0, 1, 0x3B, _K_RAX, _K_RBX, _K_JREG(a2));
+            _k_jit_reg(jit, 0, 0, 0x0F90 + _k_jit_icc[(op - _K_INST_LESII) / 2], 0, _K_RAX);
+            _k_jit_reg(jit, 0, 0, 0x0FB6, _K_RAX, _K_RAX);
+            _k_jit_store(jit, _K_RAX, a0, 0);
+            return 0;
+
+        case _K_INST_LESFF: case _K_INST_GREFF: case _K_INST_LEQFF: case _K_INST_GEQFF: case _K_INST_EQUFF: case _K_INST_NEQFF: {
+            int k = (op - _K_INST_LESII) / 2;
+
+            _k_jit_loadf(jit, 0, a1);
+            _k_jit_loadf(jit, 1, a2);
+            _k_jit_fcmp(jit, k);
+            _k_jit_reg(jit, 0, 0, 0x0F90 + _k_jit_fcc[k], 0, _K_RAX);
+            _k_jit_reg(jit, 0, 0, 0x0FB6, _K_RAX, _K_RAX);
+            _k_jit_store(jit, _K_RAX, a0, 0);
+            return 0;
+        }
+
+        case _K_INST_NEGII:
+        case _K_INST_NEGWW:
+            _k_jit_load(jit, _K_RAX, a1);
+            _k_jit_reg(jit, 0, 1, 0xF7, 3, _K_RAX);
+
+            if (op == _K_INST_NEGWW) _k_jit_reg(jit, 0, 0, 0x89, _K_RAX, _K_RAX);
+
+            _k_jit_store(jit, _K_RAX, a0, 0);
+            return 0;
+
+        case _K_INST_NEGFF:
+            _k_jit_load(jit, _K_RAX, a1);
+            _k_jit_reg(jit, 0, 1, 0x0FBA, 7, _K_RAX);
+            _k_jit_byte(jit, 63);
+            _k_jit_store(jit, _K_RAX, a0, 1);
+            return 0;
+
+        case _K_INST_ITOFR:
+            _k_jit_mem(jit, 0xF2, 1, 0x0F2A, 0, _K_RBX, _K_JREG(a1));
+            _k_jit_storef(jit, 0, a0);
+            return 0;
+
+        case _K_INST_FTOIR:
+            _k_jit_mem(jit, 0xF2, 1, 0x0F2C, _K_RAX, _K_RBX, _K_JREG(a1));
+            _k_jit_store(jit, _K_RAX, a0, 0);
+            return 0;
+
+        case _K_INST_ITOWR:
+            _k_jit_mem(jit, 0, 0, 0x8B, _K_RAX, _K_RBX, _K_JREG(a1));
+            _k_jit_store(jit, _K_RAX, a0, 0);
+            return 0;
+
+        case _K_INST_FTOSR:
+            _k_jit_loadf(jit, 0, a1);
+            _k_jit_single(jit);
+            _k_jit_storef(jit, 0, a0);
+            return 0;
+
+        case _K_INST_DERII:
+        case _K_INST_DERFF:
+        case _K_INST_DERWW:
+            _k_jit_load(jit, _K_RAX, a1);
+            _k_jit_mem(jit, 0, op != _K_INST_DERWW, 0x8B, _K_RAX, _K_RAX, 0);
+            _k_jit_store(jit, _K_RAX, a0, op == _K_INST_DERFF);
+            return 0;
+
+        case _K_INST_DERSS:
+            _k_jit_load(jit, _K_RAX, a1);
+            _k_jit_mem(jit, 0xF3, 0, 0x0F5A, 0, _K_RAX, 0);
+            _k_jit_storef(jit, 0, a0);
+            return 0;
+
+        case _K_INST_SAVII:
+        case _K_INST_SAVFF:
+        case _K_INST_SAVWW:
+            _k_jit_load(jit, _K_RAX, a0);
+            _k_jit_load(jit, _K_RCX, a1);
+            _k_jit_mem(jit, 0, op != _K_INST_SAVWW, 0x89, _K_RCX, _K_RAX, 0);
+            return 0;
+
+        case _K_INST_SAVSS:
+            _k_jit_load(jit, _K_RAX, a0);
+            _k_jit_loadf(jit, 0, a1);
+            _k_jit_reg(jit, 0xF2, 0, 0x0F5A, 0, 0);
+            _k_jit_mem(jit, 0xF3, 0, 0x0F11, 0, _K_RAX, 0);
+            return 0;
+
+        case _K_INST_LODII:
+        case _K_INST_LODFF:
+        case _K_INST_LODWW:
+        case _K_INST_LODHH:
+            _k_jit_mem(jit, 0, op != _K_INST_LODWW, op == _K_INST_LODHH ? 0x63 : 0x8B, _K_RAX, _K_R12, a1);
+            _k_jit_store(jit, _K_RAX, a0, op == _K_INST_LODFF);
+            return 0;
+
+        case _K_INST_LODSS:
+            _k_jit_mem(jit, 0xF3, 0, 0x0F5A, 0, _K_R12, a1);
+            _k_jit_storef(jit, 0, a0);
+            return 0;
+
+        case _K_INST_STOII:
+        case _K_INST_STOWW:
+            _k_jit_load(jit, _K_RAX, a1);
+            _k_jit_mem(jit, 0, op == _K_INST_STOII, 0x89, _K_RAX, _K_R12, a0);
+            return 0;
+
+        case _K_INST_STOSS:
+            _k_jit_loadf(jit, 0, a1);
+            _k_jit_reg(jit, 0xF2, 0, 0x0F5A, 0, 0);
+            _k_jit_mem(jit, 0xF3, 0, 0x0F11, 0, _K_R12, a0);
+            return 0;
+
+        case _K_INST_REFSL:
+            _k_jit_mem(jit, 0, 1, 0x8D, _K_RAX, _K_R12, a1);
+            _k_jit_store(jit, _K_RAX, a0, 0);
+            return 0;
+
+        case _K_INST_JMPAL:
+            if (jump <= i) _k_jit_budget(jit, inst);
+
+            _k_jit_jump(jit, -1, jump);
+            return 0;
+
+        case _K_INST_JLTII: case _K_INST_JGTII: case _K_INST_JLEII: case _K_INST_JGEII: case _K_INST_JEQII: case _K_INST_JNEII:
+        case _K_INST_JLTIN: case _K_INST_JGTIN: case _K_INST_JLEIN: case _K_INST_JGEIN: case _K_INST_JEQIN: case _K_INST_JNEIN:
+        case _K_INST_JLTFF: case _K_INST_JGTFF: case _K_INST_JLEFF: case _K_INST_JGEFF: case _K_INST_JEQFF: case _K_INST_JNEFF:
+        case _K_INST_JLTFN: case _K_INST_JGTFN: case _K_INST_JLEFN: case _K_INST_JGEFN: case _K_INST_JEQFN: case _K_INST_JNEFN:
+            _k_jit_branch(jit, op, a0, a1, jump);
+            return 0;
+
+        case _K_INST_ARGRR:
+            _k_jit_copy(jit, (long)interp->module->insts[entry].a1 + a0, a1);
+            return 0;
+
+        case _K_INST_CALLR: {
+            _k_inst2_t *callee = (_k_inst2_t*)inst->a0;
+            long        target = callee - interp->module->insts;
+            long        slow[3] = { 0, 0, 0 };
+            long        done;
+
+            _k_jit_budget(jit, inst);
+
+            /* Callees compiled apart are called through their entry in native_at, set once they are.  */
+            if (!jit->compiled[target]) {
+                _k_jit_imm(jit, _K_RDX, (long)&interp->module->native_at[target + 1 + a2]);
+                _k_jit_mem(jit, 0, 1, 0x8B, _K_RDX, _K_RDX, 0);
+                _k_jit_reg(jit, 0, 1, 0x85, _K_RDX, _K_RDX);
+                slow[2] = _k_jit_forward(jit, 0x4);
+            }
+
+            /* Enters a compiled callee here, leaving overflows to the slow path to report.  */
+            _k_jit_enter(jit, interp, inst, entry, slow);
+
+            _k_jit_reg(jit, 0, 1, 0x83, 5, _K_RSP);
+            _k_jit_byte(jit, 8);
+
+            if (jit->compiled[target]) {
+                _k_jit_byte(jit, 0xE8);
+                _k_jit_fixup(jit, target + 1 + a2);
+            } else {
+                _k_jit_reg(jit, 0, 0, 0xFF, 2, _K_RDX);
+            }
+
+            _k_jit_reg(jit, 0, 1, 0x83, 0, _K_RSP);
+            _k_jit_byte(jit, 8);
+            _k_jit_check(jit);
+            done = _k_jit_forward(jit, -1);
+
+            _k_jit_land(jit, slow[0]);
+            _k_jit_land(jit, slow[1]);
+
+            if (!jit->compiled[target]) _k_jit_land(jit, slow[2]);
+
+            _k_jit_reg(jit, 0, 1, 0x89, _K_R13, _K_RDI);
+            _k_jit_imm(jit, _K_RSI, (long)inst);
+            _k_jit_call_c(jit, (void*)_k_jit_call);
+            _k_jit_check(jit);
+            _k_jit_land(jit, done);
+            return 0;
+        }
+
+        case _K_INST_LEAVE:
+            _k_jit_leave(jit);
+            _k_jit_reg(jit, 0, 0, 0x31, _K_RAX, _K_RAX);
+            _k_jit_byte(jit, 0xC3);
+            return 0;
+
+        case _K_INST_CALLF:
+            break;
+
+        /* Host calls left in flight park the run, which the interpreter resumes past them.  */
+        case _K_INST_HOSTC:
+            _k_jit_reg(jit, 0, 1, 0x89, _K_R13, _K_RDI);
+            _k_jit_imm(jit, _K_RSI, (long)inst);
+            _k_jit_call_c(jit, (void*)_k_jit_host);
+            _k_jit_check(jit);
+            return 0;
+
+        default:
+            return 1;
+    }
+
+    /* Calls into functions run by the interpreter, or through the stack, go through _k_jit_call.  */
+
+    _k_jit_reg(jit, 0, 1, 0x89, _K_R13, _K_RDI);
+    _k_jit_imm(jit, _K_RSI, (long)inst);
+    _k_jit_call_c(jit, (void*)_k_jit_call);
+    _k_jit_check(jit);
+
+    return 0;
+}
+
+/*
+ *    Emits a function's body, the instructions after its frame.
+ *
+ *    @return int    1 if any instruction has no native template.
+ */
+int _k_jit_function(_k_jit_t *jit, _k_interp_t *interp, long entry, long end) {
+    short last = _k_base_op(interp->module->insts[end - 1].op);
+
+    /* Falling off the end would run into the next function.  */
+    if (end - 1 <= entry || (last != _K_INST_LEAVE && last != _K_INST_JMPAL)) return 1;
+
+    for (long i = entry + 1; i < end; ++i) {
+        jit->at[i] = jit->length;
+
+        if (_k_jit_inst(jit, interp, entry, end, i, _k_base_op(interp->module->insts[i].op))) return 1;
+    }
+
+    return 0;
+}
+
+/*
+ *    Emits the entry the interpreter calls native code through. It saves
+ *    the host's registers, loads the pinned ones from the current frame,
+ *    and calls the function body at its second argument.
+ */
+void _k_jit_stub(_k_jit_t *jit) {
+    int saved[6] = { _K_RBX, _K_RBP, _K_R12, _K_R13, _K_R14, _K_R15 };
+
+    for (int k = 0; k < 6; ++k) _k_jit_head(jit, 0, 0, 0x50 + (saved[k] & 7), 0, saved[k]);
+
+    _k_jit_reg(jit, 0, 1, 0x83, 5, _K_RSP);
+    _k_jit_byte(jit, 8);
+    _k_jit_reg(jit, 0, 1, 0x89, _K_RDI, _K_R13);
+    _k_jit_mem(jit, 0, 1, 0x8B, _K_R14, _K_R13, (long)offsetof(_k_interp_t, frame));
+    _k_jit_mem(jit, 0, 1, 0x8B, _K_R15, _K_R13, (long)offsetof(_k_interp_t, mem));
+    _k_jit_mem(jit, 0, 1, 0x8B, _K_RBX, _K_R14, _K_JFRAME(r));
+    _k_jit_mem(jit, 0, 1, 0x8B, _K_R12, _K_R14, _K_JFRAME(bp));
+    _k_jit_reg(jit, 0, 1, 0x01, _K_R15, _K_R12);
+    _k_jit_reg(jit, 0, 0, 0xFF, 2, _K_RSI);
+    _k_jit_reg(jit, 0, 1, 0x83, 0, _K_RSP);
+    _k_jit_byte(jit, 8);
+
+    for (int k = 5; k >= 0; --k) _k_jit_head(jit, 0, 0, 0x58 + (saved[k] & 7), 0, saved[k]);
+
+    _k_jit_byte(jit, 0xC3);
+}
+
+/*
+ *    Maps a buffer for native code. Each mapping starts with the one
+ *    before it, for unloading, and the first also holds the entry stub.
+ *
+ *    @param _k_interp_t *interp    The interpreter.
+ *    @param _k_jit_t *jit          The code to emit, into the new buffer.
+ *    @param long size              The buffer's size, in whole pages.
+ *
+ *    @return int                   1 if the buffer could not be mapped.
+ */
+int _k_jit_open(_k_interp_t *interp, _k_jit_t *jit, long size) {
+    jit->code   = mmap((void*)0x0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    jit->length = 0;
+
+    if (jit->code == MAP_FAILED) return 1;
+
+    _k_jit_bytes(jit, (long)interp->module->native_code, sizeof(unsigned char*));
+    _k_jit_bytes(jit, interp->module->native_size, sizeof(long));
+
+    if (interp->module->native == (int(*)(void*,void*))0x0) {
+        interp->module->native = (int(*)(void*,void*))(jit->code + jit->length);
+
+        _k_jit_stub(jit);
+    }
+
+    return 0;
+}
+
+/*
+ *    Resolves the jumps in a buffer, makes it executable, and chains it
+ *    in as the interpreter's newest mapping. The code is written before
+ *    it is made executable, and never both at once.
+ *
+ *    @param _k_interp_t *interp    The interpreter.
+ *    @param _k_jit_t *jit          The code emitted into the buffer.
+ *    @param long size              The buffer's size, in whole pages.
+ *
+ *    @return int                   1 if the buffer could not be made executable, and was unmapped.
+ */
+int _k_jit_close(_k_interp_t *interp, _k_jit_t *jit, long size) {
+    for (long k = 0; k < jit->fixup_count; ++k) {
+        long rel = jit->at[jit->fixups[2 * k + 1]] - (jit->fixups[2 * k] + 4);
+
+        memcpy(jit->code + jit->fixups[2 * k], &rel, 4);
+    }
+
+    if (mprotect(jit->code, size, PROT_READ | PROT_EXEC) != 0) {
+        /* The entry stub goes with its mapping, and the next mapping opened holds it instead.  */
+        if ((unsigned char*)interp->module->native >= jit->code && (unsigned char*)interp->module->native < jit->code + size) interp->module->native = (int(*)(void*,void*))0x0;
+
+        munmap(jit->code, size);
+
+        return 1;
+    }
+
+    interp->module->native_code = jit->code;
+    interp->module->native_size = size;
+
+    return 0;
+}
+
+/*
+ *    Compiles the functions starting between two instructions that have
+ *    not been tried yet into a mapping of their own. Calls between them
+ *    are direct, and calls to functions compiled before or after through
+ *    native_at.
+ *
+ *    @param _k_interp_t *interp    The interpreter.
+ *    @param long from              The first instruction.
+ *    @param long to                The instruction after the last.
+ *
+ *    @return long                  The number of functions compiled.
+ */
+long _k_jit_range(_k_interp_t *interp, long from, long to) {
+    long compiled = 0;
+
+    if (interp->module->native_at == (void**)0x0) __atomic_store_n(&interp->module->native_at, calloc(interp->module->inst_count + 1, sizeof(void*)), __ATOMIC_RELEASE);
+
+    if (interp->module->native_at == (void**)0x0) return 0;
+
+    long     size = (_K_JIT_INST * (to - from + 1) + 4095) & ~4095L;
+    _k_jit_t jit  = {
+        (unsigned char*)0x0, 0,
+        calloc(interp->module->inst_count + 1, sizeof(long)), malloc(sizeof(long) * 4 * (to - from + 1)), 0,
+        calloc(interp->module->inst_count + 1, 1), -1, 0, 0, 0
+    };
+
+    if (jit.at == (long*)0x0 || jit.fixups == (long*)0x0 || jit.compiled == (char*)0x0 || _k_jit_open(interp, &jit, size)) {
+        free(jit.at);
+        free(jit.fixups);
+        free(jit.compiled);
+
+        return 0;
+    }
+
+    /* Finds which functions compile first, so the calls between them can be direct.  */
+    for (int pass = 0; pass < 2; ++pass) {
+        for (long entry = from, end = from; entry < to; entry = end) {
+            for (end = entry + 1; end < interp->module->inst_count && _k_base_op(interp->module->insts[end].op) != _K_INST_FRAME; ++end);
+
+            if (_k_base_op(interp->module->insts[entry].op) != _K_INST_FRAME || interp->module->native_at[entry + 1] != (void*)0x0) continue;
+            if (pass == 1 && !jit.compiled[entry]) continue;
+
+            long length = jit.length;
+            long fixups = jit.fixup_count;
+            int  failed = _k_jit_function(&jit, interp, entry, end);
+
+            if (pass == 0) {
+                __atomic_store_n(&interp->module->insts[entry].flags, 1, __ATOMIC_RELAXED);
+
+                jit.compiled[entry] = !failed;
+                jit.length          = length;
+                jit.fixup_count     = fixups;
+            } else {
+                compiled++;
+            }
+        }
+    }
+
+    /* Functions that cannot be made executable stay interpreted, tried already.  */
+    if (_k_jit_close(interp, &jit, size)) {
+        free(jit.at);
+        free(jit.fixups);
+        free(jit.compiled);
+
+        return 0;
+    }
+
+    for (long entry = from, end = from; entry < to; entry = end) {
+        for (end = entry + 1; end < interp->module->inst_count && _k_base_op(interp->module->insts[end].op) != _K_INST_FRAME; ++end);
+
+        if (!jit.compiled[entry]) continue;
+
+        for (long i = entry + 1; i < end; ++i) __atomic_store_n(&interp->module->native_at[i], jit.code + jit.at[i], __ATOMIC_RELEASE);
+    }
+
+    /* Host calls and stack calls enter at the frame, register calls past the poprr's. Operands are set before the instruction changes, as other contexts may be running it.  */
+    for (long i = 0; i < interp->module->inst_count; ++i) {
+        _k_inst2_t *inst = &interp->module->insts[i];
+
+        if (jit.compiled[i]) {
+            __atomic_store_n(&inst->a2, interp->module->native_at[i + 1], __ATOMIC_RELEASE);
+            __atomic_store_n(&inst->op, _K_INST_FRNAT, __ATOMIC_RELEASE);
+        } else if (inst->op == _K_INST_CALLR) {
+            void *native = interp->module->native_at[(_k_inst2_t*)inst->a0 - interp->module->insts + 1 + (long)inst->a2];
+
+            if (native == (void*)0x0) continue;
+
+            __atomic_store_n(&inst->a1, native, __ATOMIC_RELEASE);
+            __atomic_store_n(&inst->op, _K_INST_CALLN, __ATOMIC_RELEASE);
+        }
+    }
+
+    __atomic_store_n(&interp->module->threaded, 0, __ATOMIC_RELEASE);
+
+    free(jit.at);
+    free(jit.fixups);
+    free(jit.compiled);
+
+    return compiled;
+}
+
+/* What the polymorphic instructions run as in a trace, for integer and float operands; 0 where a trace has no form for them.  */
+const short _k_trace_typed[_K_INST_COUNT][2] = {
+    [_K_INST_ADDRR] = { _K_INST_ADDII, _K_INST_ADDFF },
+    [_K_INST_SUBRR] = { _K_INST_SUBII, _K_INST_SUBFF },
+    [_K_INST_MULRR] = { _K_INST_MULII, _K_INST_MULFF },
+    [_K_INST_DIVRR] = { _K_INST_DIVII, _K_INST_DIVFF },
+    [_K_INST_LESRR] = { _K_INST_LESII, _K_INST_LESFF },
+    [_K_INST_GRERR] = { _K_INST_GREII, _K_INST_GREFF },
+    [_K_INST_LEQRR] = { _K_INST_LEQII, 0 },
+    [_K_INST_GEQRR] = { _K_INST_GEQII, 0 },
+    [_K_INST_EQURR] = { _K_INST_EQUII, _K_INST_EQUFF },
+    [_K_INST_NEQRR] = { _K_INST_NEQII, 0 },
+    [_K_INST_NEGRR] = { _K_INST_NEGII, _K_INST_NEGFF },
+};
+
+/*
+ *    Runs one iteration of a loop an instruction at a time, from the top
+ *    of its body back to its back-edge, recording each instruction with
+ *    the kind of its polymorphic operands or whether it jumped. Register
+ *    calls are followed into. Recording stops short, before running the
+ *    instruction, at anything a trace cannot hold: stack calls, returns
+ *    out of the loop's function, inner loops, and polymorphic operands of
+ *    mixed kinds.
+ *
+ *    @param _k_interp_t *interp    The interpreter, stopped at the back-edge.
+ *    @param _k_inst2_t *loop       The back-edge.
+ *    @param _k_trace_t *trace      The trace, closed if the iteration got back to the back-edge.
+ *
+ *    @return int                   1 if an instruction failed.
+ */
+int _k_trace_record(_k_interp_t *interp, _k_inst2_t *loop, _k_trace_t *trace) {
+    _k_frame_t *base  = interp->frame;
+    long        depth = 0;
+
+    trace->length = 0;
+    trace->closed = 0;
+
+    base->cur = (_k_inst2_t*)loop->a0;
+
+    for (;;) {
+        _k_inst2_t *ip   = interp->frame->cur;
+        short       raw  = __atomic_load_n(&ip->op, __ATOMIC_ACQUIRE);
+        short       op   = _k_base_op(raw);
+        char        info = 0;
+
+        if (ip == loop && depth == 0) {
+            trace->closed = 1;
+
+            return 0;
+        }
+
+        if (trace->length == _K_TRACE_LENGTH || raw == _K_INST_LOOPB || raw == _K_INST_LOOPT) return 0;
+
+        if (op == _K_INST_CALLR) {
+            if (++depth > _K_TRACE_DEPTH) return 0;
+        } else if (op == _K_INST_LEAVE) {
+            if (--depth < 0) return 0;
+        } else if (_k_trace_typed[op][0]) {
+            info = interp->frame->r[(long)ip->a1].rf;
+
+            if (op != _K_INST_NEGRR && interp->frame->r[(long)ip->a2].rf != info) return 0;
+            if (info < 0 || info > 1 || !_k_trace_typed[op][(int)info]) return 0;
+        } else if (op == _K_INST_CALLF || op == _K_INST_HOSTC || op == _K_INST_FRAME || op == _K_INST_CMPRD || op == _K_INST_JMPEQ) {
+            return 0;
+        } else if (op >= _K_INST_JLTRR && op <= _K_INST_JNERF) {
+            return 0;
+        }
+
+        if (ip->func(interp, ip->a0, __atomic_load_n(&ip->a1, __ATOMIC_ACQUIRE), __atomic_load_n(&ip->a2, __ATOMIC_ACQUIRE))) return 1;
+
+        interp->frame->cur++;
+
+        if (op >= _K_INST_JLTII && op <= _K_INST_JNEFN) info = interp->frame->cur != ip + 1;
+
+        trace->insts[trace->length]  = ip;
+        trace->info[trace->length++] = info;
+    }
+}
+
+/*
+ *    Compiles a closed trace to straight-line native code that runs the
+ *    loop for as long as it keeps taking the recorded path. Jumps become
+ *    guards, register calls are inlined into frame setup, and polymorphic
+ *    instructions check their operands' kinds and run typed. A guard that
+ *    fails takes a side exit, which leaves the frame's current instruction
+ *    where the interpreter is to carry on, and returns 3.
+ *
+ *    @param _k_interp_t *interp    The interpreter.
+ *    @param _k_inst2_t *loop       The back-edge.
+ *    @param _k_trace_t *trace      The trace.
+ *
+ *    @return void *                The trace's code, or NULL if it has instructions with no native template.
+ */
+void *_k_trace_compile(_k_interp_t *interp, _k_inst2_t *loop, _k_trace_t *trace) {
+    long         length = trace->length;
+    long         size   = ((_K_JIT_INST + 32) * (length + 1) + 4095) & ~4095L;
+    long         entries[_K_TRACE_DEPTH + 1];
+    long         depth  = 0;
+    int          failed = 0;
+    void        *code;
+    _k_inst2_t **exits  = calloc(length, sizeof(_k_inst2_t*));
+    long        *slow   = calloc(2 * length, sizeof(long));
+
+    /* Position k's side exit is at 2k, the path on past its guard at 2k + 1, and the top of the loop at 2 * length.  */
+    _k_jit_t jit = {
+        (unsigned char*)0x0, 0, calloc(2 * length + 1, sizeof(long)), malloc(sizeof(long) * 6 * (length + 1)), 0, (char*)0x0, -1, 0, 0, 0
+    };
+
+    if (exits == (_k_inst2_t**)0x0 || slow == (long*)0x0 || jit.at == (long*)0x0 || jit.fixups == (long*)0x0 || _k_jit_open(interp, &jit, size)) {
+        free(jit.at);
+        free(jit.fixups);
+        free(exits);
+        free(slow);
+
+        return (void*)0x0;
+    }
+
+    code               = jit.code + jit.length;
+    jit.at[2 * length] = jit.length;
+    entries[0]         = (_k_inst2_t*)loop->a1 - interp->module->insts;
+
+    for (long k = 0; k < length && !failed; ++k) {
+        _k_inst2_t *inst = trace->insts[k];
+        short       op   = _k_base_op(inst->op);
+        int         info = trace->info[k];
+
+        if (_k_trace_typed[op][0]) {
+            _k_jit_mem(&jit, 0, 0, 0x80, 7, _K_RBX, _K_JKIND((long)inst->a1));
+            _k_jit_byte(&jit, info);
+            _k_jit_jump(&jit, 0x5, 2 * k);
+
+            if (op != _K_INST_NEGRR) {
+                _k_jit_mem(&jit, 0, 0, 0x80, 7, _K_RBX, _K_JKIND((long)inst->a2));
+                _k_jit_byte(&jit, info);
+                _k_jit_jump(&jit, 0x5, 2 * k);
+            }
+
+            exits[k] = inst;
+            op       = _k_trace_typed[op][info];
+        }
+
+        switch (op) {
+            case _K_INST_JMPAL:
+                break;
+
+            case _K_INST_JLTII: case _K_INST_JGTII: case _K_INST_JLEII: case _K_INST_JGEII: case _K_INST_JEQII: case _K_INST_JNEII:
+            case _K_INST_JLTIN: case _K_INST_JGTIN: case _K_INST_JLEIN: case _K_INST_JGEIN: case _K_INST_JEQIN: case _K_INST_JNEIN:
+            case _K_INST_JLTFF: case _K_INST_JGTFF: case _K_INST_JLEFF: case _K_INST_JGEFF: case _K_INST_JEQFF: case _K_INST_JNEFF:
+            case _K_INST_JLTFN: case _K_INST_JGTFN: case _K_INST_JLEFN: case _K_INST_JGEFN: case _K_INST_JEQFN: case _K_INST_JNEFN:
+                if (info) {
+                    _k_jit_branch(&jit, op, (long)inst->a0, (long)inst->a1, 2 * k + 1);
+                    _k_jit_jump(&jit, -1, 2 * k);
+
+                    jit.at[2 * k + 1] = jit.length;
+                    exits[k]          = inst + 1;
+                } else {
+                    _k_jit_branch(&jit, op, (long)inst->a0, (long)inst->a1, 2 * k);
+
+                    exits[k] = (_k_inst2_t*)inst->a2;
+                }
+                break;
+
+            /* Overflows leave at the call, for the interpreter to report.  */
+            case _K_INST_CALLR:
+                _k_jit_enter(&jit, interp, inst, entries[depth], &slow[2 * k]);
+
+                exits[k]         = inst;
+                entries[++depth] = (_k_inst2_t*)inst->a0 - interp->module->insts;
+                break;
+
+            case _K_INST_LEAVE:
+                _k_jit_leave(&jit);
+
+                depth--;
+                break;
+
+            default:
+                failed = _k_jit_inst(&jit, interp, entries[depth], 0, inst - interp->module->insts, op);
+        }
+
+        /* Float results are left in xmm0, so an instruction using one straight after needs no reload.  */
+        switch (op) {
+            case _K_INST_ADDFF: case _K_INST_SUBFF: case _K_INST_MULFF: case _K_INST_DIVFF:
+            case _K_INST_ADDSS: case _K_INST_SUBSS: case _K_INST_MULSS: case _K_INST_DIVSS:
+            case _K_INST_LODSS: case _K_INST_ITOFR: case _K_INST_FTOSR: case _K_INST_DERSS:
+                jit.held = (long)inst->a0;
+                break;
+
+            default:
+                jit.held = -1;
+        }
+    }
+
+    _k_jit_budget(&jit, loop);
+    _k_jit_jump(&jit, -1, 2 * length);
+
+    for (long k = 0; k < length; ++k) {
+        if (exits[k] == (_k_inst2_t*)0x0) continue;
+
+        jit.at[2 * k] = jit.length;
+
+        if (_k_base_op(trace->insts[k]->op) == _K_INST_CALLR) {
+            _k_jit_land(&jit, slow[2 * k]);
+            _k_jit_land(&jit, slow[2 * k + 1]);
+        }
+
+        _k_jit_imm(&jit, _K_RAX, (long)exits[k]);
+        _k_jit_mem(&jit, 0, 1, 0x89, _K_RAX, _K_R14, _K_JFRAME(cur));
+        _k_jit_byte(&jit, 0xB8);
+        _k_jit_bytes(&jit, 3, 4);
+        _k_jit_byte(&jit, 0xC3);
+    }
+
+    /* A trace that fails to compile still maps its buffer, which is simply never entered.  */
+    if (_k_jit_close(interp, &jit, size)) failed = 1;
+
+    free(jit.at);
+    free(jit.fixups);
+    free(exits);
+    free(slow);
+
+    return failed ? (void*)0x0 : code;
+}
+
+#endif
+
+/*
+ *    Compiles every function whose instructions all have native templates
+ *    to x86-64, and points its entry, and the register calls into it, at
+ *    the native code. Registers stay in the frame's window, so compiled
+ *    and interpreted functions call each other freely.
+ *
+ *    @param _k_interp_t *interp    The interpreter, before or between runs.
+ *
+ *    @return long                  The number of functions compiled.
+ */
+long _k_jit(_k_interp_t *interp) {
+#ifdef _K_JIT
+    _K_LOCK(interp->module);
+
+    long compiled = _k_jit_range(interp, 0, interp->module->inst_count);
+
+    _K_UNLOCK(interp->module);
+
+    return compiled;
+#else
+    return 0;
+#endif
+}
+
+/*
+ *    Promotes a function the interpreter found hot to native code, the
+ *    first time it is found hot. Modules with tiering turned off stay
+ *    interpreted.
+ *
+ *    @param _k_interp_t *interp    The interpreter.
+ *    @param _k_inst2_t *entry      The function's frame instruction.
+ */
+void _k_tier(_k_interp_t *interp, _k_inst2_t *entry) {
+    _k_module_t *module = interp->module;
+
+    if (__atomic_load_n(&entry->flags, __ATOMIC_RELAXED)) return;
+
+    /* Contexts finding the function hot at once promote it once, and the others wait until it is.  */
+    _K_LOCK(module);
+
+    if (__atomic_load_n(&entry->flags, __ATOMIC_RELAXED)) {
+        _K_UNLOCK(module);
+
+        return;
+    }
+
+    __atomic_store_n(&entry->flags, 1, __ATOMIC_RELAXED);
+
+#ifdef _K_JIT
+    if (module->tiered) {
+        long from = entry - module->insts;
+        long to   = from + 1;
+
+        while (to < module->inst_count && _k_base_op(module->insts[to].op) != _K_INST_FRAME) to++;
+
+        _k_jit_range(interp, from, to);
+    }
+#endif
+
+    _K_UNLOCK(module);
+}
+
+/*
+ *    Traces a hot loop of a function left interpreted: records the path
+ *    one iteration takes, running it, and compiles that path to native
+ *    code entered from then on at the back-edge. Loops whose traces fail
+ *    to record or compile are tried again the next time round, until they
+ *    have failed _K_DEOPTS times, and are then left interpreted.
+ *
+ *    @param _k_interp_t *interp    The interpreter, stopped at the back-edge.
+ *    @param _k_inst2_t *loop       The back-edge.
+ *
+ *    @return int                   1 if an instruction failed while recording.
+ */
+int _k_trace(_k_interp_t *interp, _k_inst2_t *loop) {
+#ifdef _K_JIT
+    _k_trace_t *trace = malloc(sizeof(_k_trace_t));
+    void       *code  = (void*)0x0;
+
+    /* Without memory to record in, the loop stays interpreted.  */
+    if (trace == (_k_trace_t*)0x0) {
+        interp->frame->cur = loop;
+        __atomic_store_n(&loop->flags, _K_DEOPTS, __ATOMIC_RELAXED);
+
+        return 0;
+    }
+
+    if (_k_trace_record(interp, loop, trace)) {
+        free(trace);
+
+        return 1;
+    }
+
+    /* Another context may have traced the loop while this one was recording it.  */
+    _K_LOCK(interp->module);
+
+    if (__atomic_load_n(&loop->op, __ATOMIC_ACQUIRE) == _K_INST_LOOPT) {
+        _K_UNLOCK(interp->module);
+
+        free(trace);
+
+        return 0;
+    }
+
+    if (trace->closed) code = _k_trace_compile(interp, loop, trace);
+
+    free(trace);
+
+    if (code != (void*)0x0) {
+        __atomic_store_n(&loop->a2, code, __ATOMIC_RELEASE);
+        __atomic_store_n(&loop->op, _K_INST_LOOPT, __ATOMIC_RELEASE);
+        __atomic_store_n(&interp->module->threaded, 0, __ATOMIC_RELEASE);
+
+        _K_UNLOCK(interp->module);
+
+        return 0;
+    }
+
+    _K_UNLOCK(interp->module);
+
+    __atomic_add_fetch(&loop->flags, 1, __ATOMIC_RELAXED);
+#else
+    interp->frame->cur = loop;
+    __atomic_store_n(&loop->flags, _K_DEOPTS, __ATOMIC_RELAXED);
+#endif
+
+    return 0;
+}
@@ -0,0 +1,1662 @@
+/*
+ *    libk_interpret_lanes.c    --    source for KAPPA's SIMD lanes.
+ *
+ *    Authored by Karl "p0lyh3dron" Kreuze on October 18, 2026
+ *
+ *    This file is part of the KAPPA project.
+ *
+ *    This file runs a batch's calls of one function across _K_LANES
+ *    lanes at once, interpreting each instruction over the lanes still
+ *    running it, and where there is a compiler, compiling the function
+ *    to AVX2 first. Builds without lanes run batches one call at a time.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libk_interpret_internal.h"
+
+#ifdef _K_LANES
+/* Lanes run in AVX2 where the processor has it, the loader picking once which version to call.  */
+#if defined(__x86_64__) && defined(__unix__)
+#define _K_LANE_TARGET __attribute__((target_clones("avx2", "default")))
+#else
+#define _K_LANE_TARGET
+#endif
+
+/* The lanes a comparison holds in, one bit each.  */
+unsigned _k_lane_bits(const _k_lanei_t *cond) {
+    unsigned bits = 0;
+
+    for (int l = 0; l < _K_LANES; ++l) bits |= (unsigned)((*cond)[l] & 1) << l;
+
+    return bits;
+}
+
+/* Widens the bits of lanes into a mask with every bit of each lane set or clear.  */
+void _k_lane_mask(_k_lanei_t *mask, unsigned bits) {
+    for (int l = 0; l < _K_LANES; ++l) (*mask)[l] = -(long)(bits >> l & 1);
+}
+
+/* Where a reference may point: into the lane's own variables, at what a parameter does, or anywhere.  */
+#define _K_REF_OWN    1UL
+#define _K_REF_ANY    (1UL << 63)
+#define _K_REF_ARG(k) ((k) < 62 ? 2UL << (k) : _K_REF_ANY)
+
+/*
+ *    Finds the parameters a function stores through, itself or by passing
+ *    them on to functions that do. References are followed through
+ *    registers and variables; stores through any others, which lanes
+ *    may share, set _K_REF_ANY.
+ *
+ *    @param _k_module_t *module    The module, with lane_refs of the others.
+ *    @param long         first     The function's frame.
+ *    @param long         end       The instruction past the function.
+ *
+ *    @return unsigned long    _K_REF_ARG of each parameter stored through,
+ *                             and _K_REF_ANY if a store may be shared.
+ */
+unsigned long _k_lanes_refs(_k_module_t *module, long first, long end) {
+    long           size   = (long)module->insts[first].a0 + sizeof(long);
+    unsigned long *vars   = calloc(size, sizeof(unsigned long));
+    unsigned long *pushed = malloc(sizeof(unsigned long) * (end - first));
+    unsigned long *passed = malloc(sizeof(unsigned long) * _K_FRAME_REGS);
+    char          *target = calloc(end - first, 1);
+    unsigned long  refs   = 0;
+    int            again  = 1;
+
+    for (long i = first + 1; i < end; ++i) {
+        short op = module->lane_ops[i];
+        long  to = -1;
+
+        if (op == _K_INST_JMPAL || op == _K_INST_JMPEQ)      to = (_k_inst2_t*)module->insts[i].a0 - module->insts;
+        else if (op >= _K_INST_JLTII && op <= _K_INST_JNEFN) to = (_k_inst2_t*)module->insts[i].a2 - module->insts;
+
+        if (to > first && to < end) target[to - first] = 1;
+    }
+
+    /* Variables gather every reference stored to them, so passes run until none gathers more.  */
+    while (again) {
+        unsigned long r[_K_FRAME_REGS];
+        long          pops   = 0;
+        long          pushes = 0;
+
+        again = 0;
+
+        for (int k = 0; k < _K_FRAME_REGS; ++k) r[k] = _K_REF_ANY;
+        for (int k = 0; k < _K_FRAME_REGS; ++k) passed[k] = _K_REF_ANY;
+
+        for (long i = first + 1; i < end; ++i) {
+            _k_inst2_t *ip = &module->insts[i];
+            short       op = module->lane_ops[i];
+            long        a0 = (long)ip->a0;
+            long        a1 = (long)ip->a1;
+
+            /* Registers may hold anything where branches meet.  */
+            if (target[i - first]) {
+                for (int k = 0; k < _K_FRAME_REGS; ++k) r[k] = _K_REF_ANY;
+            }
+
+            unsigned long ref = a1 >= 0 && a1 < _K_FRAME_REGS ? r[a1] : _K_REF_ANY;
+
+            switch (op) {
+                case _K_INST_POPRR: ref = _K_REF_ARG(pops); pops++; break;
+                case _K_INST_MOVRR: break;
+                case _K_INST_REFSL: ref = _K_REF_OWN; break;
+
+                case _K_INST_LODII: case _K_INST_LODFF: case _K_INST_LODWW: case _K_INST_LODHH: case _K_INST_LODSS:
+                    ref = _K_REF_ANY;
+
+                    if (a1 >= 0 && a1 + (long)sizeof(long) <= size) {
+                        ref = 0;
+
+                        for (long b = a1; b < a1 + (long)sizeof(long); ++b) ref |= vars[b];
+                    }
+                    break;
+
+                case _K_INST_STOII: case _K_INST_STOWW: case _K_INST_STOSS:
+                    for (long b = a0; b < a0 + (long)sizeof(long); ++b) {
+                        if (b < 0 || b >= size) { refs |= _K_REF_ANY; break; }
+
+                        again  |= (vars[b] | ref) != vars[b];
+                        vars[b] |= ref;
+                    }
+                    continue;
+
+                case _K_INST_SAVII: case _K_INST_SAVFF: case _K_INST_SAVWW: case _K_INST_SAVSS: case _K_INST_SAVEA:
+                    refs |= (a0 >= 0 && a0 < _K_FRAME_REGS ? r[a0] : _K_REF_ANY) & ~_K_REF_OWN;
+                    continue;
+
+                case _K_INST_PUSHR:
+                    pushed[pushes++] = a0 >= 0 && a0 < _K_FRAME_REGS ? r[a0] : _K_REF_ANY;
+                    continue;
+
+                case _K_INST_ARGRR:
+                    if (a0 >= 0 && a0 < _K_FRAME_REGS) passed[a0] = ref;
+                    continue;
+
+                /* Arguments that callees store through are stored through here.  */
+                case _K_INST_CALLF:
+                case _K_INST_CALLR: {
+                    long          callee = (_k_inst2_t*)ip->a0 - module->insts;
+                    unsigned long stores = module->lane_refs[callee];
+
+                    refs |= stores & _K_REF_ANY;
+
+                    for (long k = 0; callee + 1 + k < module->inst_count && module->lane_ops[callee + 1 + k] == _K_INST_POPRR; ++k) {
+                        long at = (long)module->insts[callee + 1 + k].a0;
+
+                        if (!(stores & _K_REF_ARG(k))) continue;
+
+                        if (op == _K_INST_CALLF) refs |= (k < pushes ? pushed[pushes - 1 - k] : _K_REF_ANY) & ~_K_REF_OWN;
+                        else                     refs |= (at >= 0 && at < _K_FRAME_REGS ? passed[at] : _K_REF_ANY) & ~_K_REF_OWN;
+                    }
+
+                    pushes = 0;
+                    r[0]   = _K_REF_ANY;
+
+                    for (int k = 0; k < _K_FRAME_REGS; ++k) passed[k] = _K_REF_ANY;
+                    continue;
+                }
+
+                case _K_INST_LEAVE: case _K_INST_CMPRD: case _K_INST_JMPEQ: case _K_INST_JMPAL:
+                    continue;
+
+                default:
+                    if (op >= _K_INST_JLTII && op <= _K_INST_JNEFN) continue;
+
+                    ref = _K_REF_ANY;
+            }
+
+            if (a0 >= 0 && a0 < _K_FRAME_REGS) r[a0] = ref;
+        }
+    }
+
+    free(vars);
+    free(pushed);
+    free(passed);
+    free(target);
+
+    return refs;
+}
+
+/*
+ *    Finds what every function of a module stores through, until the
+ *    functions calling others have seen all that those do.
+ *
+ *    @param _k_module_t *module    The module, with its lane_ops.
+ */
+void _k_lanes_refs_all(_k_module_t *module) {
+    int again = 1;
+
+    module->lane_refs = calloc(module->inst_count + 1, sizeof(unsigned long));
+
+    while (again) {
+        again = 0;
+
+        for (long first = 0, end = 0; first < module->inst_count; first = end) {
+            for (end = first + 1; end < module->inst_count && module->lane_ops[end] != _K_INST_FRAME; ++end);
+
+            if (module->lane_ops[first] != _K_INST_FRAME) continue;
+
+            unsigned long refs = _k_lanes_refs(module, first, end);
+
+            again |= refs != module->lane_refs[first];
+
+            module->lane_refs[first] = refs;
+        }
+    }
+}
+
+/*
+ *    Prepares a context to run across lanes, and its module, the first
+ *    time either is asked to.
+ *
+ *    @param _k_interp_t *interp    The interpreter.
+ *
+ *    @return _k_lanes_t *          The context's lanes.
+ */
+_k_lanes_t *_k_lanes_open(_k_interp_t *interp) {
+    _k_module_t *module = interp->module;
+
+    if (interp->lanes != (_k_lanes_t*)0x0) return interp->lanes;
+
+    _k_lanes_t *lanes = malloc(sizeof(_k_lanes_t));
+
+    /* Each frame's registers follow its caller's, and each lane's stack is interleaved with the others'.  */
+    lanes->regs   = aligned_alloc(sizeof(_k_lane_t), sizeof(_k_lane_t) * _K_FRAME_REGS * (_K_LANE_DEPTH + 1));
+    lanes->mem    = aligned_alloc(sizeof(_k_lane_t), 2 * _K_LANES * _K_LANE_STACK);
+    lanes->frames = aligned_alloc(sizeof(_k_lane_t), sizeof(_k_lane_frame_t) * _K_LANE_DEPTH);
+
+    _K_LOCK(module);
+
+    if (module->lane_ops == (short*)0x0) {
+        module->lane_checked = calloc(module->inst_count + 1, 1);
+        module->lane_ops     = malloc(sizeof(short) * (module->inst_count + 1));
+
+        for (long i = 0; i < module->inst_count; ++i) module->lane_ops[i] = _k_base_op(module->insts[i].op);
+
+        _k_lanes_refs_all(module);
+    }
+
+    _K_UNLOCK(module);
+
+    interp->lanes = lanes;
+
+    return lanes;
+}
+
+/*
+ *    Checks that a function, and every function it calls, can run across
+ *    lanes. Lanes can run the instructions with typed operands, stores
+ *    through references to their own variables, and calls whose
+ *    arguments are pushed in a straight line.
+ *
+ *    @param _k_interp_t *interp    The interpreter, with its lanes open.
+ *    @param _k_inst2_t  *entry     The function's entry.
+ *
+ *    @return int    0 if the function can run across lanes, 1 if not.
+ */
+int _k_lanes_check(_k_interp_t *interp, _k_inst2_t *entry) {
+    _k_module_t *module = interp->module;
+    long         first  = entry - module->insts;
+    long         end    = first + 1;
+    long         pushes = 0;
+    int          failed = 0;
+
+    if (module->lane_ops[first] != _K_INST_FRAME) return 1;
+
+    /* Lanes storing through the same reference would each read it, then each store over the others.  */
+    if (module->lane_refs[first] & _K_REF_ANY) return 1;
+
+    /* The lock is taken again by the functions this one calls, and by compiling lane code.  */
+    _K_LOCK(module);
+
+    /* Functions being checked, as a recursive one finds itself, are taken to run.  */
+    if (module->lane_checked[first] != 0) {
+        failed = module->lane_checked[first] != 1;
+
+        _K_UNLOCK(module);
+
+        return failed;
+    }
+
+    module->lane_checked[first] = 1;
+
+    while (end < module->inst_count && module->lane_ops[end] != _K_INST_FRAME) end++;
+
+    /* Falling off the end would run into the next function.  */
+    if (end - 1 <= first || (module->lane_ops[end - 1] != _K_INST_LEAVE && module->lane_ops[end - 1] != _K_INST_JMPAL)) {
+        module->lane_checked[first] = 2;
+
+        _K_UNLOCK(module);
+
+        return 1;
+    }
+
+    char *target = calloc(end - first, 1);
+
+    for (long i = first + 1; i < end; ++i) {
+        short       op = module->lane_ops[i];
+        _k_inst2_t *to = (_k_inst2_t*)0x0;
+
+        if (op == _K_INST_JMPAL || op == _K_INST_JMPEQ)        to = (_k_inst2_t*)module->insts[i].a0;
+        else if (op >= _K_INST_JLTII && op <= _K_INST_JNEFN)   to = (_k_inst2_t*)module->insts[i].a2;
+
+        if (to == (_k_inst2_t*)0x0) continue;
+
+        if (to <= entry || to >= module->insts + end) failed = 1;
+        else                                   target[to - entry] = 1;
+    }
+
+    for (long i = first + 1; i < end && !failed; ++i) {
+        short op = module->lane_ops[i];
+
+        /* Lanes share a stack pointer, so those pushing arguments must not branch apart or be joined before the call.  */
+        if (pushes > 0 && (target[i - first] || op == _K_INST_LEAVE || op == _K_INST_JMPAL || op == _K_INST_JMPEQ ||
+                           (op >= _K_INST_JLTII && op <= _K_INST_JNEFN))) failed = 1;
+
+        switch (op) {
+            case _K_INST_PUSHR:
+                pushes++;
+                break;
+
+            case _K_INST_CALLF:
+            case _K_INST_CALLR:
+                failed = _k_lanes_check(interp, (_k_inst2_t*)module->insts[i].a0);
+                pushes = 0;
+                break;
+
+            case _K_INST_POPRR: case _K_INST_MOVRN: case _K_INST_MOVRF: case _K_INST_MOVRR: case _K_INST_ARGRR: case _K_INST_LEAVE:
+            case _K_INST_ADDII: case _K_INST_ADDFF: case _K_INST_ADDWW: case _K_INST_ADDSS:
+            case _K_INST_SUBII: case _K_INST_SUBFF: case _K_INST_SUBWW: case _K_INST_SUBSS:
+            case _K_INST_MULII: case _K_INST_MULFF: case _K_INST_MULWW: case _K_INST_MULSS:
+            case _K_INST_DIVII: case _K_INST_DIVFF: case _K_INST_DIVWW: case _K_INST_DIVSS:
+            case _K_INST_LESII: case _K_INST_LESFF: case _K_INST_GREII: case _K_INST_GREFF:
+            case _K_INST_LEQII: case _K_INST_LEQFF: case _K_INST_GEQII: case _K_INST_GEQFF:
+            case _K_INST_EQUII: case _K_INST_EQUFF: case _K_INST_NEQII: case _K_INST_NEQFF:
+            case _K_INST_NEGII: case _K_INST_NEGFF: case _K_INST_NEGWW:
+            case _K_INST_ITOFR: case _K_INST_FTOIR: case _K_INST_ITOWR: case _K_INST_FTOSR:
+            case _K_INST_DERII: case _K_INST_DERFF: case _K_INST_DERWW: case _K_INST_DERSS:
+            case _K_INST_SAVII: case _K_INST_SAVFF: case _K_INST_SAVWW: case _K_INST_SAVSS:
+            case _K_INST_LODII: case _K_INST_LODFF: case _K_INST_LODWW: case _K_INST_LODHH: case _K_INST_LODSS:
+            case _K_INST_STOII: case _K_INST_STOWW: case _K_INST_STOSS: case _K_INST_REFSL:
+            case _K_INST_CMPRD: case _K_INST_JMPEQ: case _K_INST_JMPAL:
+                break;
+
+            default:
+                if (op < _K_INST_JLTII || op > _K_INST_JNEFN) failed = 1;
+        }
+    }
+
+    free(target);
+
+    module->lane_checked[first] = failed ? 2 : 1;
+
+    _K_UNLOCK(module);
+
+    return failed;
+}
+
+/*
+ *    Picks the lanes to run next: those furthest behind, at the lowest
+ *    instruction. Lanes that branched apart so meet again where their
+ *    paths join.
+ *
+ *    @param _k_inst2_t **pc      The instruction each lane waits at.
+ *    @param unsigned     live    The lanes still in the function.
+ *    @param unsigned    *bits    Set to the lanes picked.
+ *    @param _k_inst2_t **wait    Set to the lowest instruction another lane waits at, or end.
+ *    @param _k_inst2_t  *end     The end of the module's instructions.
+ *
+ *    @return _k_inst2_t *        The instruction the picked lanes run from.
+ */
+_k_inst2_t *_k_lanes_pick(_k_inst2_t **pc, unsigned live, unsigned *bits, _k_inst2_t **wait, _k_inst2_t *end) {
+    _k_inst2_t *ip = end;
+
+    for (int l = 0; l < _K_LANES; ++l) {
+        if ((live >> l & 1) && pc[l] < ip) ip = pc[l];
+    }
+
+    *bits = 0;
+    *wait = end;
+
+    for (int l = 0; l < _K_LANES; ++l) {
+        if (!(live >> l & 1)) continue;
+
+        if (pc[l] == ip)        *bits |= 1u << l;
+        else if (pc[l] < *wait) *wait  = pc[l];
+    }
+
+    return ip;
+}
+
+#define _K_L(a)       (frame->r[(long)ip->a])
+#define _K_LAT(x)     (*(_k_lanei_t*)(lanes->mem + 2 * _K_LANES * (x)))
+#define _K_LSET(d, v) { _k_lanei_t _v = (v); (d) = (_v & mask) | ((d) & ~mask); }
+#define _K_SINGLE(v)  __builtin_convertvector(__builtin_convertvector((v), _k_halff_t), _k_lanef_t)
+#define _K_EACH(l)    for (int l = 0; l < _K_LANES; ++l) if (bits >> l & 1)
+
+/* Integer lanes wrap, lanes left out holding anything, so they add, subtract and multiply unsigned.  */
+#define _K_LWRAP(x, o, y) ((_k_lanei_t)((_k_laneu_t)(x) o (_k_laneu_t)(y)))
+
+/*
+ *    Runs a function across lanes until every lane that entered it has
+ *    left. All lanes run the same instruction, each on its own values,
+ *    and only the lanes in the mask keep its result. Where lanes branch
+ *    apart, the rest wait at their next instruction until the running
+ *    ones reach it.
+ *
+ *    Lane l of the variable at x in a frame is at mem + 2 * _K_LANES * x
+ *    + sizeof(long) * l, so a variable's lanes load and store as one
+ *    vector, and references to them work as in the loop.
+ *
+ *    @param _k_interp_t     *interp    The interpreter, with its lanes open.
+ *    @param _k_lane_frame_t *frame     The function's frame.
+ *    @param _k_inst2_t      *ip        The instruction to start from.
+ *    @param unsigned         live      The lanes entering the function.
+ *    @param _k_lane_t       *ret       Where each lane's result goes as it leaves.
+ *    @param int              depth     The calls the function is nested in.
+ *
+ *    @return int    0 on success, 1 if the stack overflowed.
+ */
+_K_LANE_TARGET
+int _k_lanes_run(_k_interp_t *interp, _k_lane_frame_t *frame, _k_inst2_t *ip, unsigned live, _k_lane_t *ret, int depth) {
+    _k_lanes_t *lanes = interp->lanes;
+    short      *ops   = interp->module->lane_ops;
+    _k_inst2_t *end   = interp->module->insts + interp->module->inst_count;
+    _k_inst2_t *wait  = end;
+    _k_inst2_t *pc[_K_LANES];
+    _k_inst2_t *target;
+    unsigned    bits  = live;
+    _k_lanei_t  mask;
+    _k_lanei_t  cond;
+
+    _k_lane_mask(&mask, bits);
+
+    for (;;) {
+        /* Lanes reaching others waiting join them, and lanes jumping past them wait in turn.  */
+        if (ip >= wait) {
+            _K_EACH(l) pc[l] = ip;
+
+            ip = _k_lanes_pick(pc, live, &bits, &wait, end);
+
+            _k_lane_mask(&mask, bits);
+        }
+
+        switch (ops[ip - interp->module->insts]) {
+            case _K_INST_PUSHR: frame->sp -= sizeof(long); _K_LSET(_K_LAT(frame->sp), _K_L(a0).i); break;
+            case _K_INST_POPRR: _K_LSET(_K_L(a0).i, _K_LAT(frame->ap)); frame->ap += sizeof(long); break;
+            case _K_INST_MOVRN:
+            case _K_INST_MOVRF: _K_LSET(_K_L(a0).i, (_k_lanei_t){0} + (long)ip->a1); break;
+            case _K_INST_MOVRR: _K_LSET(_K_L(a0).i, _K_L(a1).i); break;
+            case _K_INST_ARGRR: _K_LSET(frame->r[frame->regs + (long)ip->a0].i, _K_L(a1).i); break;
+
+            case _K_INST_ADDII: _K_LSET(_K_L(a0).i, _K_LWRAP(_K_L(a1).i, +, _K_L(a2).i));                  break;
+            case _K_INST_ADDFF: _K_LSET(_K_L(a0).i, (_k_lanei_t)(_K_L(a1).f + _K_L(a2).f));                break;
+            case _K_INST_ADDWW: _K_LSET(_K_L(a0).i, _K_LWRAP(_K_L(a1).i, +, _K_L(a2).i) & 0xFFFFFFFF);     break;
+            case _K_INST_ADDSS: _K_LSET(_K_L(a0).i, (_k_lanei_t)_K_SINGLE(_K_L(a1).f + _K_L(a2).f));       break;
+            case _K_INST_SUBII: _K_LSET(_K_L(a0).i, _K_LWRAP(_K_L(a1).i, -, _K_L(a2).i));                  break;
+            case _K_INST_SUBFF: _K_LSET(_K_L(a0).i, (_k_lanei_t)(_K_L(a1).f - _K_L(a2).f));                break;
+            case _K_INST_SUBWW: _K_LSET(_K_L(a0).i, _K_LWRAP(_K_L(a1).i, -, _K_L(a2).i) & 0xFFFFFFFF);     break;
+            case _K_INST_SUBSS: _K_LSET(_K_L(a0).i, (_k_lanei_t)_K_SINGLE(_K_L(a1).f - _K_L(a2).f));       break;
+            case _K_INST_MULII: _K_LSET(_K_L(a0).i, _K_LWRAP(_K_L(a1).i, *, _K_L(a2).i));                  break;
+            case _K_INST_MULFF: _K_LSET(_K_L(a0).i, (_k_lanei_t)(_K_L(a1).f * _K_L(a2).f));                break;
+            case _K_INST_MULWW: _K_LSET(_K_L(a0).i, _K_LWRAP(_K_L(a1).i, *, _K_L(a2).i) & 0xFFFFFFFF);     break;
+            case _K_INST_MULSS: _K_LSET(_K_L(a0).i, (_k_lanei_t)_K_SINGLE(_K_L(a1).f * _K_L(a2).f));       break;
+            case _K_INST_DIVFF: _K_LSET(_K_L(a0).i, (_k_lanei_t)(_K_L(a1).f / _K_L(a2).f));                break;
+            case _K_INST_DIVSS: _K_LSET(_K_L(a0).i, (_k_lanei_t)_K_SINGLE(_K_L(a1).f / _K_L(a2).f));       break;
+
+            /* Lanes left out may hold zeroes, so integers divide one lane at a time.  */
+            case _K_INST_DIVII: _K_EACH(l) _K_L(a0).i[l] = _K_L(a1).i[l] / _K_L(a2).i[l];                  break;
+            case _K_INST_DIVWW: _K_EACH(l) _K_L(a0).i[l] = (unsigned int)(_K_L(a1).i[l] / _K_L(a2).i[l]);  break;
+
+            case _K_INST_LESII: _K_LSET(_K_L(a0).i, (_K_L(a1).i <  _K_L(a2).i) & 1); break;
+            case _K_INST_LESFF: _K_LSET(_K_L(a0).i, (_K_L(a1).f <  _K_L(a2).f) & 1); break;
+            case _K_INST_GREII: _K_LSET(_K_L(a0).i, (_K_L(a1).i >  _K_L(a2).i) & 1); break;
+            case _K_INST_GREFF: _K_LSET(_K_L(a0).i, (_K_L(a1).f >  _K_L(a2).f) & 1); break;
+            case _K_INST_LEQII: _K_LSET(_K_L(a0).i, (_K_L(a1).i <= _K_L(a2).i) & 1); break;
+            case _K_INST_LEQFF: _K_LSET(_K_L(a0).i, ~(_K_L(a1).f >  _K_L(a2).f) & 1); break;
+            case _K_INST_GEQII: _K_LSET(_K_L(a0).i, (_K_L(a1).i >= _K_L(a2).i) & 1); break;
+            case _K_INST_GEQFF: _K_LSET(_K_L(a0).i, ~(_K_L(a1).f <  _K_L(a2).f) & 1); break;
+            case _K_INST_EQUII: _K_LSET(_K_L(a0).i, (_K_L(a1).i == _K_L(a2).i) & 1); break;
+            case _K_INST_EQUFF: _K_LSET(_K_L(a0).i, ~((_K_L(a1).f < _K_L(a2).f) | (_K_L(a1).f > _K_L(a2).f)) & 1); break;
+            case _K_INST_NEQII: _K_LSET(_K_L(a0).i, (_K_L(a1).i != _K_L(a2).i) & 1); break;
+            case _K_INST_NEQFF: _K_LSET(_K_L(a0).i, ((_K_L(a1).f < _K_L(a2).f) | (_K_L(a1).f > _K_L(a2).f)) & 1); break;
+
+            case _K_INST_NEGII: _K_LSET(_K_L(a0).i, -_K_L(a1).i);                                                  break;
+            case _K_INST_NEGFF: _K_LSET(_K_L(a0).i, (_k_lanei_t)-_K_L(a1).f);                                      break;
+            case _K_INST_NEGWW: _K_LSET(_K_L(a0).i, -_K_L(a1).i & 0xFFFFFFFF);                                     break;
+            case _K_INST_ITOFR: _K_LSET(_K_L(a0).i, (_k_lanei_t)__builtin_convertvector(_K_L(a1).i, _k_lanef_t));  break;
+            case _K_INST_FTOIR: _K_LSET(_K_L(a0).i, __builtin_convertvector(_K_L(a1).f, _k_lanei_t));              break;
+            case _K_INST_ITOWR: _K_LSET(_K_L(a0).i, _K_L(a1).i & 0xFFFFFFFF);                                      break;
+            case _K_INST_FTOSR: _K_LSET(_K_L(a0).i, (_k_lanei_t)_K_SINGLE(_K_L(a1).f));                            break;
+
+            /* References may point anywhere, so each lane follows its own.  */
+            case _K_INST_DERII: _K_EACH(l) _K_L(a0).i[l] = *(long*)_K_L(a1).i[l];          break;
+            case _K_INST_DERFF: _K_EACH(l) _K_L(a0).f[l] = *(double*)_K_L(a1).i[l];        break;
+            case _K_INST_DERWW: _K_EACH(l) _K_L(a0).i[l] = *(unsigned int*)_K_L(a1).i[l];  break;
+            case _K_INST_DERSS: _K_EACH(l) _K_L(a0).f[l] = *(float*)_K_L(a1).i[l];         break;
+            case _K_INST_SAVII: _K_EACH(l) *(long*)_K_L(a0).i[l]         = _K_L(a1).i[l];  break;
+            case _K_INST_SAVFF: _K_EACH(l) *(double*)_K_L(a0).i[l]       = _K_L(a1).f[l];  break;
+            case _K_INST_SAVWW: _K_EACH(l) *(unsigned int*)_K_L(a0).i[l] = _K_L(a1).i[l];  break;
+            case _K_INST_SAVSS: _K_EACH(l) *(float*)_K_L(a0).i[l]        = _K_L(a1).f[l];  break;
+
+            /* Narrow variables sit in the low half of each lane's cell.  */
+            case _K_INST_LODII:
+            case _K_INST_LODFF: _K_LSET(_K_L(a0).i, _K_LAT(frame->bp + (long)ip->a1));                      break;
+            case _K_INST_LODWW: _K_LSET(_K_L(a0).i, _K_LAT(frame->bp + (long)ip->a1) & 0xFFFFFFFF);         break;
+            case _K_INST_LODHH: _K_LSET(_K_L(a0).i, _K_LAT(frame->bp + (long)ip->a1) << 32 >> 32);          break;
+            case _K_INST_LODSS: {
+                _k_halff_t single = (_k_halff_t)__builtin_convertvector(_K_LAT(frame->bp + (long)ip->a1), _k_halfi_t);
+
+                _K_LSET(_K_L(a0).i, (_k_lanei_t)__builtin_convertvector(single, _k_lanef_t));
+                break;
+            }
+            case _K_INST_STOII:
+            case _K_INST_STOWW: _K_LSET(_K_LAT(frame->bp + (long)ip->a0), _K_L(a1).i); break;
+            case _K_INST_STOSS: {
+                _k_halfi_t single = (_k_halfi_t)__builtin_convertvector(_K_L(a1).f, _k_halff_t);
+
+                _K_LSET(_K_LAT(frame->bp + (long)ip->a0), __builtin_convertvector(single, _k_lanei_t));
+                break;
+            }
+            case _K_INST_REFSL: {
+                _k_lanei_t at;
+
+                for (int l = 0; l < _K_LANES; ++l) at[l] = (long)&_K_LAT(frame->bp + (long)ip->a1) + (long)sizeof(long) * l;
+
+                _K_LSET(_K_L(a0).i, at);
+                break;
+            }
+
+            case _K_INST_FRAME:
+                if (frame->sp < (long)ip->a0) {
+                    fprintf(stderr, "Stack overflow!\n");
+
+                    return 1;
+                }
+
+                frame->ap   = frame->sp;
+                frame->sp   = (frame->sp - (long)ip->a0) & ~(long)(sizeof(long) - 1);
+                frame->bp   = frame->sp;
+                frame->regs = (long)ip->a1;
+                break;
+
+            /* Calls run the callee across the calling lanes, each getting its result as it leaves.  */
+            case _K_INST_CALLF:
+            case _K_INST_CALLR: {
+                _k_inst2_t     *entry = (_k_inst2_t*)ip->a0;
+                _k_lane_frame_t callee;
+
+                if (depth + 1 == _K_LANE_DEPTH) {
+                    fprintf(stderr, "Call stack overflow!\n");
+
+                    return 1;
+                }
+
+                callee.sp   = frame->sp;
+                callee.bp   = frame->sp;
+                callee.ap   = frame->sp;
+                callee.regs = _K_FRAME_REGS;
+                callee.r    = frame->r + frame->regs;
+
+                /* Register calls have their frame set up here, and enter past the poprr's.  */
+                if (ops[ip - interp->module->insts] == _K_INST_CALLR) {
+                    if (callee.sp < (long)entry->a0) {
+                        fprintf(stderr, "Stack overflow!\n");
+
+                        return 1;
+                    }
+
+                    callee.sp   = (callee.sp - (long)entry->a0) & ~(long)(sizeof(long) - 1);
+                    callee.bp   = callee.sp;
+                    callee.regs = (long)entry->a1;
+                    entry      += 1 + (long)ip->a2;
+                }
+
+                if (_k_lanes_run(interp, &callee, entry, bits, &frame->r[0], depth + 1)) return 1;
+
+                frame->sp = callee.ap;
+                break;
+            }
+
+            case _K_INST_LEAVE:
+                _K_LSET(ret->i, frame->r[0].i);
+
+                if ((live &= ~bits) == 0) return 0;
+
+                ip = _k_lanes_pick(pc, live, &bits, &wait, end);
+
+                _k_lane_mask(&mask, bits);
+
+                continue;
+
+            case _K_INST_CMPRD: _K_LSET(frame->cmp, _K_L(a0).i == (long)ip->a1); break;
+            case _K_INST_JMPEQ: cond = frame->cmp; target = (_k_inst2_t*)ip->a0; goto lane_branch;
+            case _K_INST_JMPAL: ip = (_k_inst2_t*)ip->a0; continue;
+
+            case _K_INST_JLTII: cond = _K_L(a0).i <  _K_L(a1).i; target = (_k_inst2_t*)ip->a2; goto lane_branch;
+            case _K_INST_JGTII: cond = _K_L(a0).i >  _K_L(a1).i; target = (_k_inst2_t*)ip->a2; goto lane_branch;
+            case _K_INST_JLEII: cond = _K_L(a0).i <= _K_L(a1).i; target = (_k_inst2_t*)ip->a2; goto lane_branch;
+            case _K_INST_JGEII: cond = _K_L(a0).i >= _K_L(a1).i; target = (_k_inst2_t*)ip->a2; goto lane_branch;
+            case _K_INST_JEQII: cond = _K_L(a0).i == _K_L(a1).i; target = (_k_inst2_t*)ip->a2; goto lane_branch;
+            case _K_INST_JNEII: cond = _K_L(a0).i != _K_L(a1).i; target = (_k_inst2_t*)ip->a2; goto lane_branch;
+            case _K_INST_JLTFF: cond = (_K_L(a0).f <  _K_L(a1).f); target = (_k_inst2_t*)ip->a2; goto lane_branch;
+            case _K_INST_JGTFF: cond = (_K_L(a0).f >  _K_L(a1).f); target = (_k_inst2_t*)ip->a2; goto lane_branch;
+            case _K_INST_JLEFF: cond = ~(_K_L(a0).f >  _K_L(a1).f); target = (_k_inst2_t*)ip->a2; goto lane_branch;
+            case _K_INST_JGEFF: cond = ~(_K_L(a0).f <  _K_L(a1).f); target = (_k_inst2_t*)ip->a2; goto lane_branch;
+            case _K_INST_JEQFF: cond = ~((_K_L(a0).f < _K_L(a1).f) | (_K_L(a0).f > _K_L(a1).f)); target = (_k_inst2_t*)ip->a2; goto lane_branch;
+            case _K_INST_JNEFF: cond = ((_K_L(a0).f < _K_L(a1).f) | (_K_L(a0).f > _K_L(a1).f)); target = (_k_inst2_t*)ip->a2; goto lane_branch;
+            case _K_INST_JLTIN: cond = _K_L(a0).i <  (long)ip->a1; target = (_k_inst2_t*)ip->a2; goto lane_branch;
+            case _K_INST_JGTIN: cond = _K_L(a0).i >  (long)ip->a1; target = (_k_inst2_t*)ip->a2; goto lane_branch;
+            case _K_INST_JLEIN: cond = _K_L(a0).i <= (long)ip->a1; target = (_k_inst2_t*)ip->a2; goto lane_branch;
+            case _K_INST_JGEIN: cond = _K_L(a0).i >= (long)ip->a1; target = (_k_inst2_t*)ip->a2; goto lane_branch;
+            case _K_INST_JEQIN: cond = _K_L(a0).i == (long)ip->a1; target = (_k_inst2_t*)ip->a2; goto lane_branch;
+            case _K_INST_JNEIN: cond = _K_L(a0).i != (long)ip->a1; target = (_k_inst2_t*)ip->a2; goto lane_branch;
+            case _K_INST_JLTFN: cond = (_K_L(a0).f <  *(double*)&ip->a1); target = (_k_inst2_t*)ip->a2; goto lane_branch;
+            case _K_INST_JGTFN: cond = (_K_L(a0).f >  *(double*)&ip->a1); target = (_k_inst2_t*)ip->a2; goto lane_branch;
+            case _K_INST_JLEFN: cond = ~(_K_L(a0).f >  *(double*)&ip->a1); target = (_k_inst2_t*)ip->a2; goto lane_branch;
+            case _K_INST_JGEFN: cond = ~(_K_L(a0).f <  *(double*)&ip->a1); target = (_k_inst2_t*)ip->a2; goto lane_branch;
+            case _K_INST_JEQFN: cond = ~((_K_L(a0).f < *(double*)&ip->a1) | (_K_L(a0).f > *(double*)&ip->a1)); target = (_k_inst2_t*)ip->a2; goto lane_branch;
+            case _K_INST_JNEFN: cond = ((_K_L(a0).f < *(double*)&ip->a1) | (_K_L(a0).f > *(double*)&ip->a1)); target = (_k_inst2_t*)ip->a2; goto lane_branch;
+
+            default:
+                fprintf(stderr, "Instruction can't run across lanes!\n");
+
+                _k_print_location(interp, ip);
+
+                return 1;
+        }
+
+        ip++;
+
+        continue;
+
+    /* Branches that split the lanes leave each waiting at where it goes.  */
+    lane_branch: {
+            unsigned taken = _k_lane_bits(&cond) & bits;
+
+            if (taken == bits) {
+                ip = target;
+            } else if (taken == 0) {
+                ip++;
+            } else {
+                _K_EACH(l) pc[l] = taken >> l & 1 ? target : ip + 1;
+
+                ip = _k_lanes_pick(pc, live, &bits, &wait, end);
+
+                _k_lane_mask(&mask, bits);
+            }
+        }
+    }
+}
+
+#undef _K_L
+#undef _K_LAT
+#undef _K_LSET
+#undef _K_SINGLE
+#undef _K_EACH
+#undef _K_LWRAP
+
+/*
+ *    Calls a function with up to _K_LANES sets of arguments at once,
+ *    from an index into a batch.
+ *
+ *    @param _k_interp_t      *interp    The interpreter, with its lanes open.
+ *    @param k_function_t     *fn        The function.
+ *    @param const k_value_t **in        One array of arguments per parameter.
+ *    @param long              i         The index of the first call.
+ *    @param long              count     The number of calls, at most _K_LANES.
+ *    @param k_value_t        *out       The array of results, or NULL.
+ *
+ *    @return int    0 on success, 1 if a call failed.
+ */
+int _k_lanes_call(_k_interp_t *interp, k_function_t *fn, const k_value_t **in, long i, long count, k_value_t *out) {
+    _k_inst2_t      *entry = fn->entry;
+    _k_inst2_t      *ip    = entry + 1 + fn->params;
+    _k_lane_frame_t *frame = interp->lanes->frames;
+    _k_lane_t        ret;
+
+    frame->ap   = _K_LANE_STACK;
+    frame->sp   = (_K_LANE_STACK - (long)entry->a0) & ~(long)(sizeof(long) - 1);
+    frame->bp   = frame->sp;
+    frame->regs = (long)entry->a1;
+    frame->r    = interp->lanes->regs;
+
+    if (frame->sp < 0) {
+        fprintf(stderr, "Stack overflow!\n");
+
+        return 1;
+    }
+
+    /* The last argument is the first the callee pops.  */
+    for (long k = 0; k < fn->params; ++k) {
+        _k_lane_t *reg = &frame->r[(long)entry[fn->params - k].a0];
+
+        for (long l = 0; l < count; ++l) reg->i[l] = in[k][i + l].i;
+    }
+
+#ifdef _K_JIT
+    int failed = _k_lanes_enter(interp, frame, ip, (1u << count) - 1, &ret);
+
+    /* Functions the lanes have no native code for are interpreted.  */
+    if (failed < 0) failed = _k_lanes_run(interp, frame, ip, (1u << count) - 1, &ret, 0);
+#else
+    int failed = _k_lanes_run(interp, frame, ip, (1u << count) - 1, &ret, 0);
+#endif
+
+    if (failed) return 1;
+
+    if (out != (k_value_t*)0x0) {
+        for (long l = 0; l < count; ++l) out[i + l].i = ret.i[l];
+    }
+
+    return 0;
+}
+
+#ifdef _K_JIT
+/* An AVX instruction's prefix (none, 66, F3 or F2, as 0 to 3), opcode map (0F, 0F38 or 0F3A, as 1 to 3), VEX.W, VEX.L and opcode.  */
+#define _K_VEX(pp, map, w, l, op) ((long)(pp) << 20 | (long)(map) << 16 | (long)(w) << 13 | (long)(l) << 12 | (op))
+
+#define _K_VMOVAPD    _K_VEX(1, 1, 0, 1, 0x28)
+#define _K_VSTOAPD    _K_VEX(1, 1, 0, 1, 0x29)
+#define _K_VADDPD     _K_VEX(1, 1, 0, 1, 0x58)
+#define _K_VMULPD     _K_VEX(1, 1, 0, 1, 0x59)
+#define _K_VSUBPD     _K_VEX(1, 1, 0, 1, 0x5C)
+#define _K_VDIVPD     _K_VEX(1, 1, 0, 1, 0x5E)
+#define _K_VXORPD     _K_VEX(1, 1, 0, 1, 0x57)
+#define _K_VCVTPD2PS  _K_VEX(1, 1, 0, 1, 0x5A)
+#define _K_VCVTPS2PD  _K_VEX(0, 1, 0, 1, 0x5A)
+#define _K_VCMPPD     _K_VEX(1, 1, 0, 1, 0xC2)
+#define _K_VMOVMSKPD  _K_VEX(1, 1, 0, 1, 0x50)
+#define _K_VPADDQ     _K_VEX(1, 1, 0, 1, 0xD4)
+#define _K_VPSUBQ     _K_VEX(1, 1, 0, 1, 0xFB)
+#define _K_VPAND      _K_VEX(1, 1, 0, 1, 0xDB)
+#define _K_VPXOR      _K_VEX(1, 1, 0, 1, 0xEF)
+#define _K_VPMULUDQ   _K_VEX(1, 1, 0, 1, 0xF4)
+#define _K_VPSRLQ     _K_VEX(1, 1, 0, 1, 0x73)
+#define _K_VPCMPEQQ   _K_VEX(1, 2, 0, 1, 0x29)
+#define _K_VPCMPGTQ   _K_VEX(1, 2, 0, 1, 0x37)
+#define _K_VPERMD     _K_VEX(1, 2, 0, 1, 0x36)
+#define _K_VPMOVSXDQ  _K_VEX(1, 2, 0, 1, 0x25)
+#define _K_VPBROADQ   _K_VEX(1, 2, 0, 1, 0x59)
+#define _K_VBLENDVPD  _K_VEX(1, 3, 0, 1, 0x4B)
+#define _K_VMOVQ      _K_VEX(1, 1, 1, 0, 0x6E)
+#define _K_VMOVSD     _K_VEX(3, 1, 0, 0, 0x10)
+#define _K_VSTOSD     _K_VEX(3, 1, 0, 0, 0x11)
+#define _K_VMOVSS     _K_VEX(2, 1, 0, 0, 0x10)
+#define _K_VSTOSS     _K_VEX(2, 1, 0, 0, 0x11)
+#define _K_VCVTSS2SD  _K_VEX(2, 1, 0, 0, 0x5A)
+#define _K_VCVTSD2SS  _K_VEX(3, 1, 0, 0, 0x5A)
+#define _K_VCVTSI2SD  _K_VEX(3, 1, 1, 0, 0x2A)
+#define _K_VCVTTSD2SI _K_VEX(3, 1, 1, 0, 0x2C)
+
+/* Lane code keeps the frame's registers in rbx, its slots in r12, the lane frame in r13, the interpreter in r14, lane memory in r15 and _k_lane_consts in rbp.  */
+#define _K_LREG(a)   ((long)sizeof(_k_lane_t) * (long)(a))
+#define _K_LSLOT(x)  (2L * _K_LANES * (long)(x))
+#define _K_LFRAME(f) ((long)offsetof(_k_lane_frame_t, f))
+
+/* Registers hold their lanes in this many ymm registers, from ymm0, with ymm12 and ymm13 for operands and ymm15 for the mask.  */
+#define _K_LANE_YMMS (_K_LANES / 4)
+
+/* Registers from r1 on are homed in the ymm registers left, within a block.  */
+#define _K_LANE_HOMES ((12 - _K_LANE_YMMS) / _K_LANE_YMMS)
+#define _K_LHOME(r)   (_K_LANE_YMMS * (int)(r))
+
+/* Offsets into _k_lane_consts: ones, the low word of each lane, the sign bit, each lane's offset into four cells, and the cells' low words for vpermd.  */
+#define _K_LONES  0
+#define _K_LLOW   32
+#define _K_LSIGN  64
+#define _K_LOFFS  96
+#define _K_LWORDS 128
+
+/* Most bytes of lane code any instruction takes.  */
+#define _K_LANE_INST (64 * _K_LANES)
+
+const long _k_lane_consts[20] __attribute__((aligned(32))) = {
+    1, 1, 1, 1,
+    0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF,
+    (long)0x8000000000000000UL, (long)0x8000000000000000UL, (long)0x8000000000000000UL, (long)0x8000000000000000UL,
+    0, 8, 16, 24,
+    0x200000000L, 0x600000004L, 0, 0
+};
+
+/* Predicates of vcmppd for lt, gt, le, ge, eq and ne, unordered lanes going as _k_cmprr's do.  */
+const int _k_lane_fcmp[6] = { 0x11, 0x1E, 0x1A, 0x15, 0x08, 0x0C };
+
+/* Reports an overflow in lane code, which then unwinds to its entry.  */
+void _k_lanes_fail(_k_interp_t *interp, int kind) {
+    fprintf(stderr, kind ? "Call stack overflow!\n" : "Stack overflow!\n");
+}
+
+/*
+ *    Parks the lanes lane code was running, those in taken at target and
+ *    the rest at at, unless at is NULL as they left, and picks the lanes
+ *    to run next.
+ *
+ *    @param _k_interp_t *interp       The interpreter.
+ *    @param _k_lane_frame_t *frame    The frame the lanes run in.
+ *    @param _k_inst2_t *at            Where the lanes not taken wait, or NULL.
+ *    @param unsigned taken            The lanes that go to target.
+ *    @param _k_inst2_t *target        Where they wait.
+ *
+ *    @return void *                   The lane code of the instruction the picked lanes run from.
+ */
+void *_k_lanes_park(_k_interp_t *interp, _k_lane_frame_t *frame, _k_inst2_t *at, unsigned taken, _k_inst2_t *target) {
+    if (at != (_k_inst2_t*)0x0) {
+        for (int l = 0; l < _K_LANES; ++l) {
+            if (frame->bits >> l & 1) frame->pc[l] = taken >> l & 1 ? target : at;
+        }
+    }
+
+    _k_inst2_t *ip = _k_lanes_pick(frame->pc, frame->live, &frame->bits, &frame->wait, interp->module->insts + interp->module->inst_count);
+
+    _k_lane_mask(&frame->keep, ~frame->bits);
+
+    return __atomic_load_n(&interp->module->lane_native, __ATOMIC_ACQUIRE)[ip - interp->module->insts];
+}
+
+/* Emits an AVX instruction's three byte VEX prefix and opcode, on the register reg, the source src and the register or base rm.  */
+void _k_jit_vhead(_k_jit_t *jit, long op, int reg, int src, int rm) {
+    _k_jit_byte(jit, 0xC4);
+    _k_jit_byte(jit, (~reg & 8) << 4 | 0x40 | (~rm & 8) << 2 | (op >> 16 & 0xF));
+    _k_jit_byte(jit, (op >> 13 & 1) << 7 | (~src & 0xF) << 3 | (op >> 12 & 1) << 2 | (op >> 20 & 3));
+    _k_jit_byte(jit, op);
+}
+
+/* Emits an AVX instruction on a register, a source and [base + disp32].  */
+void _k_jit_vmem(_k_jit_t *jit, long op, int reg, int src, int base, long disp) {
+    _k_jit_vhead(jit, op, reg, src, base);
+    _k_jit_byte(jit, 0x80 | (reg & 7) << 3 | (base & 7));
+
+    if ((base & 7) == _K_RSP) _k_jit_byte(jit, 0x24);
+
+    _k_jit_bytes(jit, disp, 4);
+}
+
+/* Emits an AVX instruction on three registers.  */
+void _k_jit_vreg(_k_jit_t *jit, long op, int reg, int src, int rm) {
+    _k_jit_vhead(jit, op, reg, src, rm);
+    _k_jit_byte(jit, 0xC0 | (reg & 7) << 3 | (rm & 7));
+}
+
+/* Broadcasts a constant into every lane of ymm y.  */
+void _k_lanes_jit_splat(_k_jit_t *jit, int y, long value) {
+    _k_jit_imm(jit, _K_RAX, value);
+    _k_jit_vreg(jit, _K_VMOVQ, y, 0, _K_RAX);
+    _k_jit_vreg(jit, _K_VPBROADQ, y, 0, y);
+}
+
+/* Stores the lanes in ymm y and on to [base + disp], blending in what the lanes left out held.  */
+void _k_lanes_jit_blend(_k_jit_t *jit, int y, int base, long disp) {
+    for (int h = 0; h < _K_LANE_YMMS; ++h) {
+        _k_jit_vmem(jit, _K_VMOVAPD, 15, 0, _K_R13, _K_LFRAME(keep) + 32 * h);
+        _k_jit_vmem(jit, _K_VBLENDVPD, y + h, y + h, base, disp + 32 * h);
+        _k_jit_byte(jit, 15 << 4);
+        _k_jit_vmem(jit, _K_VSTOAPD, y + h, 0, base, disp + 32 * h);
+    }
+}
+
+/*
+ *    Finds the home of the register at [base + disp], loading the
+ *    register into it unless it holds it already or load is 0.
+ *
+ *    @return int    The first ymm register of its home, or 0 if it has none.
+ */
+int _k_lanes_jit_home(_k_jit_t *jit, int base, long disp, int load) {
+    long r = disp / (long)sizeof(_k_lane_t);
+
+    if (base != _K_RBX || disp % (long)sizeof(_k_lane_t) || r < 1 || r > jit->homes) return 0;
+
+    if (load && !(jit->homed >> r & 1)) {
+        for (int h = 0; h < _K_LANE_YMMS; ++h) _k_jit_vmem(jit, _K_VMOVAPD, _K_LHOME(r) + h, 0, base, disp + 32 * h);
+
+        jit->homed |= 1u << r;
+    }
+
+    return _K_LHOME(r);
+}
+
+/* Stores the registers changed in their homes, which hold them no longer once code may come in from elsewhere.  */
+void _k_lanes_jit_flush(_k_jit_t *jit) {
+    for (long r = 1; r <= jit->homes; ++r) {
+        if (jit->dirty >> r & 1) _k_lanes_jit_blend(jit, _K_LHOME(r), _K_RBX, _K_LREG(r));
+    }
+
+    jit->dirty = 0;
+}
+
+/* Loads the lanes at [base + disp] into ymm0 and on, four to each.  */
+void _k_lanes_jit_get(_k_jit_t *jit, int base, long disp) {
+    int home = _k_lanes_jit_home(jit, base, disp, 1);
+
+    for (int h = 0; h < _K_LANE_YMMS; ++h) {
+        if (home) _k_jit_vreg(jit, _K_VMOVAPD, h, 0, home + h);
+        else      _k_jit_vmem(jit, _K_VMOVAPD, h, 0, base, disp + 32 * h);
+    }
+}
+
+/* Stores ymm0 and on to [base + disp], or to its home until the block ends.  */
+void _k_lanes_jit_put(_k_jit_t *jit, int base, long disp) {
+    int home = _k_lanes_jit_home(jit, base, disp, 0);
+
+    if (!home) {
+        _k_lanes_jit_blend(jit, 0, base, disp);
+        return;
+    }
+
+    for (int h = 0; h < _K_LANE_YMMS; ++h) _k_jit_vreg(jit, _K_VMOVAPD, home + h, 0, h);
+
+    jit->homed |= 1u << disp / (long)sizeof(_k_lane_t);
+    jit->dirty |= 1u << disp / (long)sizeof(_k_lane_t);
+}
+
+/* Applies op to every lane, with a register or the constant at [rbp + disp] as its second operand.  */
+void _k_lanes_jit_both(_k_jit_t *jit, long op, int base, long disp) {
+    int home = _k_lanes_jit_home(jit, base, disp, 1);
+
+    for (int h = 0; h < _K_LANE_YMMS; ++h) {
+        if (home) _k_jit_vreg(jit, op, h, h, home + h);
+        else      _k_jit_vmem(jit, op, h, h, base, base == _K_RBP ? disp : disp + 32 * h);
+    }
+}
+
+/* Rounds every lane to single precision, as f32 arithmetic does.  */
+void _k_lanes_jit_single(_k_jit_t *jit) {
+    for (int h = 0; h < _K_LANE_YMMS; ++h) {
+        _k_jit_vreg(jit, _K_VCVTPD2PS, h, 0, h);
+        _k_jit_vreg(jit, _K_VCVTPS2PD, h, 0, h);
+    }
+}
+
+/* Calls a C function from lane code, clearing the upper halves of the ymm registers first.  */
+void _k_lanes_jit_call_c(_k_jit_t *jit, void *func) {
+    _k_jit_byte(jit, 0xC5);
+    _k_jit_byte(jit, 0xF8);
+    _k_jit_byte(jit, 0x77);
+    _k_jit_call_c(jit, func);
+}
+
+/*
+ *    Emits a compare of every lane of a register with a register or a
+ *    constant, leaving a mask of the lanes it holds in, or of those it
+ *    fails in, in ymm0 and on.
+ *
+ *    @param _k_jit_t *jit    The code being emitted.
+ *    @param int k            The compare: lt, gt, le, ge, eq or ne.
+ *    @param int fl           Whether it compares floats.
+ *    @param int constant     Whether b is a constant instead of a register.
+ *    @param long a           The register compared.
+ *    @param long b           The register or constant it is compared with.
+ *
+ *    @return int             1 if the mask is of the lanes it fails in.
+ */
+int _k_lanes_jit_cmp(_k_jit_t *jit, int k, int fl, int constant, long a, long b) {
+    if (constant) _k_lanes_jit_splat(jit, 12, b);
+
+    int home = constant ? 0 : _k_lanes_jit_home(jit, _K_RBX, _K_LREG(b), 1);
+
+    _k_lanes_jit_get(jit, _K_RBX, _K_LREG(a));
+
+    for (int h = 0; h < _K_LANE_YMMS; ++h) {
+        int with = constant ? 12 : home ? home + h : 13;
+
+        if (!constant && !home) _k_jit_vmem(jit, _K_VMOVAPD, 13, 0, _K_RBX, _K_LREG(b) + 32 * h);
+
+        if (fl) {
+            _k_jit_vreg(jit, _K_VCMPPD, h, h, with);
+            _k_jit_byte(jit, _k_lane_fcmp[k]);
+        } else if (k == 0 || k == 3) {
+            _k_jit_vreg(jit, _K_VPCMPGTQ, h, with, h);
+        } else if (k == 1 || k == 2) {
+            _k_jit_vreg(jit, _K_VPCMPGTQ, h, h, with);
+        } else {
+            _k_jit_vreg(jit, _K_VPCMPEQQ, h, h, with);
+        }
+    }
+
+    /* Integers have no le, ge or ne, which fail where gt, lt and eq hold.  */
+    return !fl && (k == 2 || k == 3 || k == 5);
+}
+
+/*
+ *    Emits the park of the running lanes, and the jump to the lanes that
+ *    run next. Lanes in ecx go to target, the rest to at, or leave when
+ *    at is NULL.
+ */
+void _k_lanes_jit_park(_k_jit_t *jit, _k_inst2_t *at, _k_inst2_t *target) {
+    _k_jit_reg(jit, 0, 1, 0x89, _K_R14, _K_RDI);
+    _k_jit_reg(jit, 0, 1, 0x89, _K_R13, _K_RSI);
+    _k_jit_imm(jit, _K_RDX, (long)at);
+    _k_jit_imm(jit, 8, (long)target);
+    _k_lanes_jit_call_c(jit, (void*)_k_lanes_park);
+    _k_jit_reg(jit, 0, 0, 0xFF, 4, _K_RAX);
+}
+
+/*
+ *    Emits a branch on the mask in ymm0 and on. Running lanes that all
+ *    agree jump or fall through together, and those that don't are parked
+ *    apart.
+ *
+ *    @param _k_jit_t *jit          The code being emitted.
+ *    @param _k_interp_t *interp    The interpreter.
+ *    @param long i                 The branch.
+ *    @param long target            Where the lanes in the mask go.
+ *    @param int inv                Whether the mask is of the lanes that don't.
+ */
+void _k_lanes_jit_branch(_k_jit_t *jit, _k_interp_t *interp, long i, long target, int inv) {
+    _k_jit_vreg(jit, _K_VMOVMSKPD, _K_RAX, 0, 0);
+
+    for (int h = 1; h < _K_LANE_YMMS; ++h) {
+        _k_jit_vreg(jit, _K_VMOVMSKPD, _K_RCX, 0, h);
+        _k_jit_reg(jit, 0, 0, 0xC1, 4, _K_RCX);
+        _k_jit_byte(jit, 4 * h);
+        _k_jit_reg(jit, 0, 0, 0x09, _K_RCX, _K_RAX);
+    }
+
+    if (inv) _k_jit_reg(jit, 0, 0, 0xF7, 2, _K_RAX);
+
+    _k_jit_mem(jit, 0, 0, 0x23, _K_RAX, _K_R13, _K_LFRAME(bits));
+    _k_jit_mem(jit, 0, 0, 0x3B, _K_RAX, _K_R13, _K_LFRAME(bits));
+    _k_jit_jump(jit, 0x4, target);
+    _k_jit_reg(jit, 0, 0, 0x85, _K_RAX, _K_RAX);
+    _k_jit_jump(jit, 0x4, i + 1);
+    _k_jit_reg(jit, 0, 0, 0x89, _K_RAX, _K_RCX);
+    _k_lanes_jit_park(jit, &interp->module->insts[i + 1], &interp->module->insts[target]);
+}
+
+/* Emits a jump to the routine at fail, reporting a stack overflow (0) or a call stack overflow (1).  */
+void _k_lanes_jit_fail(_k_jit_t *jit, long fail, int kind) {
+    _k_jit_byte(jit, 0xBE);
+    _k_jit_bytes(jit, kind, 4);
+    _k_jit_byte(jit, 0xE9);
+    _k_jit_bytes(jit, fail - (jit->length + 4), 4);
+}
+
+/* Points r12 at the slots of the frame in r13.  */
+void _k_lanes_jit_slots(_k_jit_t *jit) {
+    _k_jit_mem(jit, 0, 1, 0x8B, _K_R12, _K_R13, _K_LFRAME(bp));
+    _k_jit_reg(jit, 0, 1, 0xC1, 4, _K_R12);
+    _k_jit_byte(jit, __builtin_ctz(_K_LSLOT(1)));
+    _k_jit_reg(jit, 0, 1, 0x01, _K_R15, _K_R12);
+}
+
+/* Points rax at the cell of every lane of the stack pointer field f.  */
+void _k_lanes_jit_cell(_k_jit_t *jit, long f) {
+    _k_jit_mem(jit, 0, 1, 0x8B, _K_RAX, _K_R13, f);
+    _k_jit_reg(jit, 0, 1, 0xC1, 4, _K_RAX);
+    _k_jit_byte(jit, __builtin_ctz(_K_LSLOT(1)));
+    _k_jit_reg(jit, 0, 1, 0x01, _K_R15, _K_RAX);
+}
+
+/*
+ *    Emits an instruction that has no vector form once for each running
+ *    lane, skipping the lanes left out.
+ *
+ *    @param _k_jit_t *jit    The code being emitted.
+ *    @param short op         The instruction.
+ *    @param long a0          Its first operand.
+ *    @param long a1          Its second operand.
+ *    @param long a2          Its third operand.
+ */
+void _k_lanes_jit_each(_k_jit_t *jit, short op, long a0, long a1, long a2) {
+    for (int l = 0; l < _K_LANES; ++l) {
+        long d = _K_LREG(a0) + (long)sizeof(long) * l;
+        long s = _K_LREG(a1) + (long)sizeof(long) * l;
+        long t = _K_LREG(a2) + (long)sizeof(long) * l;
+
+        _k_jit_mem(jit, 0, 0, 0xF7, 0, _K_R13, _K_LFRAME(bits));
+        _k_jit_bytes(jit, 1L << l, 4);
+
+        long skip = _k_jit_forward(jit, 0x4);
+        int  rax  = 1;
+
+        switch (op) {
+            case _K_INST_MULII:
+                _k_jit_mem(jit, 0, 1, 0x8B, _K_RAX, _K_RBX, s);
+                _k_jit_mem(jit, 0, 1, 0x0FAF, _K_RAX, _K_RBX, t);
+                break;
+
+            case _K_INST_DIVII:
+            case _K_INST_DIVWW:
+                _k_jit_mem(jit, 0, 1, 0x8B, _K_RAX, _K_RBX, s);
+                _k_jit_byte(jit, 0x48);
+                _k_jit_byte(jit, 0x99);
+                _k_jit_mem(jit, 0, 1, 0xF7, 7, _K_RBX, t);
+
+                if (op == _K_INST_DIVWW) _k_jit_reg(jit, 0, 0, 0x89, _K_RAX, _K_RAX);
+                break;
+
+            case _K_INST_ITOFR:
+                _k_jit_vmem(jit, _K_VCVTSI2SD, 0, 0, _K_RBX, s);
+                _k_jit_vmem(jit, _K_VSTOSD, 0, 0, _K_RBX, d);
+                rax = 0;
+                break;
+
+            case _K_INST_FTOIR:
+                _k_jit_vmem(jit, _K_VCVTTSD2SI, _K_RAX, 0, _K_RBX, s);
+                break;
+
+            case _K_INST_LODHH:
+                _k_jit_mem(jit, 0, 1, 0x63, _K_RAX, _K_R12, _K_LSLOT(a1) + (long)sizeof(long) * l);
+                break;
+
+            case _K_INST_DERII:
+            case _K_INST_DERFF:
+            case _K_INST_DERWW:
+                _k_jit_mem(jit, 0, 1, 0x8B, _K_RAX, _K_RBX, s);
+                _k_jit_mem(jit, 0, op != _K_INST_DERWW, 0x8B, _K_RAX, _K_RAX, 0);
+                break;
+
+            case _K_INST_DERSS:
+                _k_jit_mem(jit, 0, 1, 0x8B, _K_RAX, _K_RBX, s);
+                _k_jit_vmem(jit, _K_VMOVSS, 0, 0, _K_RAX, 0);
+                _k_jit_vreg(jit, _K_VCVTSS2SD, 0, 0, 0);
+                _k_jit_vmem(jit, _K_VSTOSD, 0, 0, _K_RBX, d);
+                rax = 0;
+                break;
+
+            case _K_INST_SAVII:
+            case _K_INST_SAVFF:
+            case _K_INST_SAVWW:
+                _k_jit_mem(jit, 0, 1, 0x8B, _K_RAX, _K_RBX, d);
+                _k_jit_mem(jit, 0, op != _K_INST_SAVWW, 0x8B, _K_RCX, _K_RBX, s);
+                _k_jit_mem(jit, 0, op != _K_INST_SAVWW, 0x89, _K_RCX, _K_RAX, 0);
+                rax = 0;
+                break;
+
+            case _K_INST_SAVSS:
+                _k_jit_mem(jit, 0, 1, 0x8B, _K_RAX, _K_RBX, d);
+                _k_jit_vmem(jit, _K_VMOVSD, 0, 0, _K_RBX, s);
+                _k_jit_vreg(jit, _K_VCVTSD2SS, 0, 0, 0);
+                _k_jit_vmem(jit, _K_VSTOSS, 0, 0, _K_RAX, 0);
+                rax = 0;
+                break;
+        }
+
+        /* Integer results are left in rax.  */
+        if (rax) _k_jit_mem(jit, 0, 1, 0x89, _K_RAX, _K_RBX, d);
+
+        _k_jit_land(jit, skip);
+    }
+}
+
+/*
+ *    Emits the lane code of one instruction of a function.
+ *
+ *    @param _k_jit_t *jit          The code being emitted.
+ *    @param _k_interp_t *interp    The interpreter, with its lanes open.
+ *    @param long entry             The function's frame instruction.
+ *    @param long i                 The instruction.
+ *    @param long fail              Where the routine reporting overflows starts.
+ */
+void _k_lanes_jit_inst(_k_jit_t *jit, _k_interp_t *interp, long entry, long i, long fail) {
+    _k_inst2_t *inst  = &interp->module->insts[i];
+    short       op    = interp->module->lane_ops[i];
+    long        a0    = (long)inst->a0;
+    long        a1    = (long)inst->a1;
+    long        a2    = (long)inst->a2;
+    long        nregs = (long)interp->module->insts[entry].a1;
+
+    switch (op) {
+        case _K_INST_PUSHR:
+            _k_jit_mem(jit, 0, 1, 0x83, 5, _K_R13, _K_LFRAME(sp));
+            _k_jit_byte(jit, sizeof(long));
+            _k_lanes_jit_cell(jit, _K_LFRAME(sp));
+            _k_lanes_jit_get(jit, _K_RBX, _K_LREG(a0));
+            _k_lanes_jit_put(jit, _K_RAX, 0);
+            return;
+
+        case _K_INST_POPRR:
+            _k_lanes_jit_cell(jit, _K_LFRAME(ap));
+            _k_lanes_jit_get(jit, _K_RAX, 0);
+            _k_lanes_jit_put(jit, _K_RBX, _K_LREG(a0));
+            _k_jit_mem(jit, 0, 1, 0x83, 0, _K_R13, _K_LFRAME(ap));
+            _k_jit_byte(jit, sizeof(long));
+            return;
+
+        case _K_INST_MOVRN:
+        case _K_INST_MOVRF:
+            _k_lanes_jit_splat(jit, 0, a1);
+
+            for (int h = 1; h < _K_LANE_YMMS; ++h) _k_jit_vreg(jit, _K_VMOVAPD, h, 0, 0);
+
+            _k_lanes_jit_put(jit, _K_RBX, _K_LREG(a0));
+            return;
+
+        /* Arguments go past the frame's registers, so never into their homes.  */
+        case _K_INST_MOVRR:
+        case _K_INST_ARGRR:
+            _k_lanes_jit_get(jit, _K_RBX, _K_LREG(a1));
+            _k_lanes_jit_put(jit, _K_RBX, _K_LREG(op == _K_INST_ARGRR ? nregs + a0 : a0));
+            return;
+
+        case _K_INST_ADDII: case _K_INST_SUBII: case _K_INST_ADDWW: case _K_INST_SUBWW: case _K_INST_MULWW:
+        case _K_INST_ADDFF: case _K_INST_SUBFF: case _K_INST_MULFF: case _K_INST_DIVFF:
+        case _K_INST_ADDSS: case _K_INST_SUBSS: case _K_INST_MULSS: case _K_INST_DIVSS: {
+            long vop = _K_VPADDQ;
+
+            if (op == _K_INST_SUBII || op == _K_INST_SUBWW)                           vop = _K_VPSUBQ;
+            else if (op == _K_INST_MULWW)                                             vop = _K_VPMULUDQ;
+            else if (op == _K_INST_ADDFF || op == _K_INST_ADDSS)                      vop = _K_VADDPD;
+            else if (op == _K_INST_SUBFF || op == _K_INST_SUBSS)                      vop = _K_VSUBPD;
+            else if (op == _K_INST_MULFF || op == _K_INST_MULSS)                      vop = _K_VMULPD;
+            else if (op == _K_INST_DIVFF || op == _K_INST_DIVSS)                      vop = _K_VDIVPD;
+
+            _k_lanes_jit_get(jit, _K_RBX, _K_LREG(a1));
+            _k_lanes_jit_both(jit, vop, _K_RBX, _K_LREG(a2));
+
+            if (op >= _K_INST_ADDWW && op <= _K_INST_DIVSS) {
+                if (op == _K_INST_ADDSS || op == _K_INST_SUBSS || op == _K_INST_MULSS || op == _K_INST_DIVSS) _k_lanes_jit_single(jit);
+                else                                                                                         _k_lanes_jit_both(jit, _K_VPAND, _K_RBP, _K_LLOW);
+            }
+
+            _k_lanes_jit_put(jit, _K_RBX, _K_LREG(a0));
+            return;
+        }
+
+        case _K_INST_MULII: case _K_INST_DIVII: case _K_INST_DIVWW: case _K_INST_ITOFR: case _K_INST_FTOIR:
+        case _K_INST_DERII: case _K_INST_DERFF: case _K_INST_DERWW: case _K_INST_DERSS:
+        case _K_INST_SAVII: case _K_INST_SAVFF: case _K_INST_SAVWW: case _K_INST_SAVSS:
+        case _K_INST_LODHH:
+            _k_lanes_jit_flush(jit);
+            _k_lanes_jit_each(jit, op, a0, a1, a2);
+
+            jit->homed = 0;
+            return;
+
+        case _K_INST_LESII: case _K_INST_LESFF: case _K_INST_GREII: case _K_INST_GREFF:
+        case _K_INST_LEQII: case _K_INST_LEQFF: case _K_INST_GEQII: case _K_INST_GEQFF:
+        case _K_INST_EQUII: case _K_INST_EQUFF: case _K_INST_NEQII: case _K_INST_NEQFF: {
+            int inv = _k_lanes_jit_cmp(jit, (op - _K_INST_LESII) / 2, (op - _K_INST_LESII) & 1, 0, a1, a2);
+
+            /* Masks are all ones where they hold, which is -1, so failed compares are one more.  */
+            for (int h = 0; h < _K_LANE_YMMS; ++h) {
+                if (inv) {
+                    _k_jit_vmem(jit, _K_VPADDQ, h, h, _K_RBP, _K_LONES);
+                } else {
+                    _k_jit_vreg(jit, _K_VPSRLQ, 2, h, h);
+                    _k_jit_byte(jit, 63);
+                }
+            }
+
+            _k_lanes_jit_put(jit, _K_RBX, _K_LREG(a0));
+            return;
+        }
+
+        case _K_INST_NEGII:
+        case _K_INST_NEGWW:
+            _k_lanes_jit_get(jit, _K_RBX, _K_LREG(a1));
+            _k_jit_vreg(jit, _K_VPXOR, 12, 12, 12);
+
+            for (int h = 0; h < _K_LANE_YMMS; ++h) _k_jit_vreg(jit, _K_VPSUBQ, h, 12, h);
+
+            if (op == _K_INST_NEGWW) _k_lanes_jit_both(jit, _K_VPAND, _K_RBP, _K_LLOW);
+
+            _k_lanes_jit_put(jit, _K_RBX, _K_LREG(a0));
+            return;
+
+        case _K_INST_NEGFF:
+        case _K_INST_ITOWR:
+        case _K_INST_FTOSR:
+            _k_lanes_jit_get(jit, _K_RBX, _K_LREG(a1));
+
+            if (op == _K_INST_NEGFF)      _k_lanes_jit_both(jit, _K_VXORPD, _K_RBP, _K_LSIGN);
+            else if (op == _K_INST_ITOWR) _k_lanes_jit_both(jit, _K_VPAND, _K_RBP, _K_LLOW);
+            else                          _k_lanes_jit_single(jit);
+
+            _k_lanes_jit_put(jit, _K_RBX, _K_LREG(a0));
+            return;
+
+        /* Narrow variables sit in the low half of each lane's cell.  */
+        case _K_INST_LODII:
+        case _K_INST_LODFF:
+        case _K_INST_LODWW:
+            _k_lanes_jit_get(jit, _K_R12, _K_LSLOT(a1));
+
+            if (op == _K_INST_LODWW) _k_lanes_jit_both(jit, _K_VPAND, _K_RBP, _K_LLOW);
+
+            _k_lanes_jit_put(jit, _K_RBX, _K_LREG(a0));
+            return;
+
+        case _K_INST_LODSS:
+            _k_jit_vmem(jit, _K_VMOVAPD, 12, 0, _K_RBP, _K_LWORDS);
+
+            for (int h = 0; h < _K_LANE_YMMS; ++h) {
+                _k_jit_vmem(jit, _K_VPERMD, h, 12, _K_R12, _K_LSLOT(a1) + 32 * h);
+                _k_jit_vreg(jit, _K_VCVTPS2PD, h, 0, h);
+            }
+
+            _k_lanes_jit_put(jit, _K_RBX, _K_LREG(a0));
+            return;
+
+        case _K_INST_STOII:
+        case _K_INST_STOWW:
+        case _K_INST_STOSS:
+            _k_lanes_jit_get(jit, _K_RBX, _K_LREG(a1));
+
+            for (int h = 0; h < _K_LANE_YMMS && op == _K_INST_STOSS; ++h) {
+                _k_jit_vreg(jit, _K_VCVTPD2PS, h, 0, h);
+                _k_jit_vreg(jit, _K_VPMOVSXDQ, h, 0, h);
+            }
+
+            _k_lanes_jit_put(jit, _K_R12, _K_LSLOT(a0));
+            return;
+
+        case _K_INST_REFSL:
+            for (int h = 0; h < _K_LANE_YMMS; ++h) {
+                _k_jit_mem(jit, 0, 1, 0x8D, _K_RAX, _K_R12, _K_LSLOT(a1) + 32 * h);
+                _k_jit_vreg(jit, _K_VMOVQ, h, 0, _K_RAX);
+                _k_jit_vreg(jit, _K_VPBROADQ, h, 0, h);
+                _k_jit_vmem(jit, _K_VPADDQ, h, h, _K_RBP, _K_LOFFS);
+            }
+
+            _k_lanes_jit_put(jit, _K_RBX, _K_LREG(a0));
+            return;
+
+        case _K_INST_FRAME: {
+            _k_jit_mem(jit, 0, 1, 0x8B, _K_RAX, _K_R13, _K_LFRAME(sp));
+            _k_jit_reg(jit, 0, 1, 0x81, 7, _K_RAX);
+            _k_jit_bytes(jit, a0, 4);
+
+            long ok = _k_jit_forward(jit, 0xD);
+
+            _k_lanes_jit_fail(jit, fail, 0);
+            _k_jit_land(jit, ok);
+            _k_jit_mem(jit, 0, 1, 0x89, _K_RAX, _K_R13, _K_LFRAME(ap));
+            _k_jit_reg(jit, 0, 1, 0x81, 5, _K_RAX);
+            _k_jit_bytes(jit, a0, 4);
+            _k_jit_reg(jit, 0, 1, 0x83, 4, _K_RAX);
+            _k_jit_byte(jit, 0xF8);
+            _k_jit_mem(jit, 0, 1, 0x89, _K_RAX, _K_R13, _K_LFRAME(sp));
+            _k_jit_mem(jit, 0, 1, 0x89, _K_RAX, _K_R13, _K_LFRAME(bp));
+            _k_lanes_jit_slots(jit);
+            return;
+        }
+
+        /* Calls run the callee in the next frame, across the calling lanes.  */
+        case _K_INST_CALLF:
+        case _K_INST_CALLR: {
+            _k_inst2_t *callee = (_k_inst2_t*)inst->a0;
+            long        next   = (long)sizeof(_k_lane_frame_t);
+
+            _k_lanes_jit_flush(jit);
+
+            jit->homed = 0;
+
+            _k_jit_mem(jit, 0, 1, 0x8B, _K_RAX, _K_R14, (long)offsetof(_k_interp_t, lanes));
+            _k_jit_mem(jit, 0, 1, 0x8B, _K_RAX, _K_RAX, (long)offsetof(_k_lanes_t, frames));
+            _k_jit_mem(jit, 0, 1, 0x8D, _K_RAX, _K_RAX, (long)sizeof(_k_lane_frame_t) * (_K_LANE_DEPTH - 1));
+            _k_jit_reg(jit, 0, 1, 0x3B, _K_R13, _K_RAX);
+
+            long deep = _k_jit_forward(jit, 0x2);
+
+            _k_lanes_jit_fail(jit, fail, 1);
+            _k_jit_land(jit, deep);
+            _k_jit_mem(jit, 0, 1, 0x8B, _K_RAX, _K_R13, _K_LFRAME(sp));
+            _k_jit_mem(jit, 0, 1, 0x89, _K_RAX, _K_R13, next + _K_LFRAME(ap));
+
+            /* Register calls have their frame set up here, and enter past the poprr's.  */
+            if (op == _K_INST_CALLR) {
+                _k_jit_reg(jit, 0, 1, 0x81, 7, _K_RAX);
+                _k_jit_bytes(jit, (long)callee->a0, 4);
+
+                long ok = _k_jit_forward(jit, 0xD);
+
+                _k_lanes_jit_fail(jit, fail, 0);
+                _k_jit_land(jit, ok);
+                _k_jit_reg(jit, 0, 1, 0x81, 5, _K_RAX);
+                _k_jit_bytes(jit, (long)callee->a0, 4);
+                _k_jit_reg(jit, 0, 1, 0x83, 4, _K_RAX);
+                _k_jit_byte(jit, 0xF8);
+            }
+
+            _k_jit_mem(jit, 0, 1, 0x89, _K_RAX, _K_R13, next + _K_LFRAME(sp));
+            _k_jit_mem(jit, 0, 1, 0x89, _K_RAX, _K_R13, next + _K_LFRAME(bp));
+            _k_jit_mem(jit, 0, 1, 0x8D, _K_RCX, _K_RBX, _K_LREG(nregs));
+            _k_jit_mem(jit, 0, 1, 0x89, _K_RCX, _K_R13, next + _K_LFRAME(r));
+            _k_jit_mem(jit, 0, 1, 0x89, _K_RBX, _K_R13, next + _K_LFRAME(ret));
+            _k_jit_mem(jit, 0, 0, 0x8B, _K_RAX, _K_R13, _K_LFRAME(bits));
+            _k_jit_mem(jit, 0, 0, 0x89, _K_RAX, _K_R13, next + _K_LFRAME(bits));
+            _k_jit_mem(jit, 0, 0, 0x89, _K_RAX, _K_R13, next + _K_LFRAME(live));
+            _k_jit_imm(jit, _K_RAX, (long)(interp->module->insts + interp->module->inst_count));
+            _k_jit_mem(jit, 0, 1, 0x89, _K_RAX, _K_R13, next + _K_LFRAME(wait));
+            _k_lanes_jit_get(jit, _K_R13, _K_LFRAME(keep));
+
+            for (int h = 0; h < _K_LANE_YMMS; ++h) _k_jit_vmem(jit, _K_VSTOAPD, h, 0, _K_R13, next + _K_LFRAME(keep) + 32 * h);
+
+            _k_jit_reg(jit, 0, 1, 0x81, 0, _K_R13);
+            _k_jit_bytes(jit, next, 4);
+            _k_jit_reg(jit, 0, 1, 0x89, _K_RCX, _K_RBX);
+
+            if (op == _K_INST_CALLR) _k_lanes_jit_slots(jit);
+
+            _k_jit_reg(jit, 0, 1, 0x83, 5, _K_RSP);
+            _k_jit_byte(jit, 8);
+            _k_jit_byte(jit, 0xE8);
+            _k_jit_fixup(jit, callee - interp->module->insts + (op == _K_INST_CALLR ? 1 + a2 : 0));
+            _k_jit_reg(jit, 0, 1, 0x83, 0, _K_RSP);
+            _k_jit_byte(jit, 8);
+
+            /* The callee's frame is left as it returned, with the caller's stack pointer where its arguments began.  */
+            _k_jit_reg(jit, 0, 1, 0x81, 5, _K_R13);
+            _k_jit_bytes(jit, next, 4);
+            _k_jit_mem(jit, 0, 1, 0x8B, _K_RBX, _K_R13, _K_LFRAME(r));
+            _k_lanes_jit_slots(jit);
+            _k_jit_mem(jit, 0, 1, 0x8B, _K_RAX, _K_R13, next + _K_LFRAME(ap));
+            _k_jit_mem(jit, 0, 1, 0x89, _K_RAX, _K_R13, _K_LFRAME(sp));
+            return;
+        }
+
+        /* Leaving lanes give their result, and the function returns once no lane is left in it.  */
+        case _K_INST_LEAVE: {
+            _k_lanes_jit_flush(jit);
+            _k_lanes_jit_get(jit, _K_RBX, _K_LREG(0));
+            _k_jit_mem(jit, 0, 1, 0x8B, _K_RAX, _K_R13, _K_LFRAME(ret));
+            _k_lanes_jit_put(jit, _K_RAX, 0);
+            _k_jit_mem(jit, 0, 0, 0x8B, _K_RAX, _K_R13, _K_LFRAME(bits));
+            _k_jit_reg(jit, 0, 0, 0xF7, 2, _K_RAX);
+            _k_jit_mem(jit, 0, 0, 0x21, _K_RAX, _K_R13, _K_LFRAME(live));
+
+            long more = _k_jit_forward(jit, 0x5);
+
+            _k_jit_byte(jit, 0xC3);
+            _k_jit_land(jit, more);
+            _k_lanes_jit_park(jit, (_k_inst2_t*)0x0, (_k_inst2_t*)0x0);
+            return;
+        }
+
+        case _K_INST_CMPRD:
+            _k_lanes_jit_get(jit, _K_RBX, _K_LREG(a0));
+            _k_lanes_jit_splat(jit, 12, a1);
+
+            for (int h = 0; h < _K_LANE_YMMS; ++h) _k_jit_vreg(jit, _K_VPCMPEQQ, h, h, 12);
+
+            _k_lanes_jit_put(jit, _K_R13, _K_LFRAME(cmp));
+            return;
+
+        case _K_INST_JMPEQ:
+            _k_lanes_jit_get(jit, _K_R13, _K_LFRAME(cmp));
+            _k_lanes_jit_flush(jit);
+            _k_lanes_jit_branch(jit, interp, i, (_k_inst2_t*)inst->a0 - interp->module->insts, 0);
+            return;
+
+        case _K_INST_JMPAL:
+            _k_lanes_jit_flush(jit);
+            _k_jit_jump(jit, -1, (_k_inst2_t*)inst->a0 - interp->module->insts);
+            return;
+
+        default: {
+            int k        = (op - _K_INST_JLTII) % 6;
+            int fl       = (op >= _K_INST_JLTFF && op <= _K_INST_JNEFF) || op >= _K_INST_JLTFN;
+            int constant = op >= _K_INST_JLTIN;
+            int inv      = _k_lanes_jit_cmp(jit, k, fl, constant, a0, a1);
+
+            _k_lanes_jit_flush(jit);
+            _k_lanes_jit_branch(jit, interp, i, (_k_inst2_t*)inst->a2 - interp->module->insts, inv);
+            return;
+        }
+    }
+}
+
+/*
+ *    Emits the entry host code calls lane code through, as
+ *    enter(frame, code, interp), and after it the routine overflows jump
+ *    to, which reports them and unwinds to the entry.
+ *
+ *    @return long    Where the routine starts.
+ */
+long _k_lanes_jit_stub(_k_jit_t *jit) {
+    int saved[6] = { _K_RBX, _K_RBP, _K_R12, _K_R13, _K_R14, _K_R15 };
+
+    for (int k = 0; k < 6; ++k) _k_jit_head(jit, 0, 0, 0x50 + (saved[k] & 7), 0, saved[k]);
+
+    _k_jit_reg(jit, 0, 1, 0x83, 5, _K_RSP);
+    _k_jit_byte(jit, 8);
+    _k_jit_reg(jit, 0, 1, 0x89, _K_RDI, _K_R13);
+    _k_jit_reg(jit, 0, 1, 0x89, _K_RDX, _K_R14);
+    _k_jit_mem(jit, 0, 1, 0x8B, _K_RAX, _K_R14, (long)offsetof(_k_interp_t, lanes));
+    _k_jit_mem(jit, 0, 1, 0x89, _K_RSP, _K_RAX, (long)offsetof(_k_lanes_t, stack));
+    _k_jit_mem(jit, 0, 1, 0x8B, _K_R15, _K_RAX, (long)offsetof(_k_lanes_t, mem));
+    _k_jit_imm(jit, _K_RBP, (long)_k_lane_consts);
+    _k_jit_mem(jit, 0, 1, 0x8B, _K_RBX, _K_R13, _K_LFRAME(r));
+    _k_lanes_jit_slots(jit);
+    _k_jit_reg(jit, 0, 0, 0xFF, 2, _K_RSI);
+    _k_jit_reg(jit, 0, 0, 0x31, _K_RAX, _K_RAX);
+
+    long exit = jit->length;
+
+    _k_jit_byte(jit, 0xC5);
+    _k_jit_byte(jit, 0xF8);
+    _k_jit_byte(jit, 0x77);
+    _k_jit_reg(jit, 0, 1, 0x83, 0, _K_RSP);
+    _k_jit_byte(jit, 8);
+
+    for (int k = 5; k >= 0; --k) _k_jit_head(jit, 0, 0, 0x58 + (saved[k] & 7), 0, saved[k]);
+
+    _k_jit_byte(jit, 0xC3);
+
+    long fail = jit->length;
+
+    _k_jit_mem(jit, 0, 1, 0x8B, _K_RAX, _K_R14, (long)offsetof(_k_interp_t, lanes));
+    _k_jit_mem(jit, 0, 1, 0x8B, _K_RSP, _K_RAX, (long)offsetof(_k_lanes_t, stack));
+    _k_jit_reg(jit, 0, 1, 0x89, _K_R14, _K_RDI);
+    _k_jit_byte(jit, 0xC5);
+    _k_jit_byte(jit, 0xF8);
+    _k_jit_byte(jit, 0x77);
+    _k_jit_imm(jit, _K_RAX, (long)_k_lanes_fail);
+    _k_jit_reg(jit, 0, 0, 0xFF, 2, _K_RAX);
+    _k_jit_byte(jit, 0xB8);
+    _k_jit_bytes(jit, 1, 4);
+    _k_jit_byte(jit, 0xE9);
+    _k_jit_bytes(jit, exit - (jit->length + 4), 4);
+
+    return fail;
+}
+
+/*
+ *    Compiles every function that can run across lanes to AVX2 code, the
+ *    first time a module runs across lanes with tiering on. Each register
+ *    holds its lanes in ymm registers, four to each, and branches test the running
+ *    lanes' mask, parking the lanes that go apart through _k_lanes_park.
+ *    Processors without AVX2 leave every function interpreted.
+ *
+ *    @param _k_interp_t *interp    The interpreter, with its lanes open.
+ *
+ *    @return void **               The lane code of each instruction, or NULL where it has none.
+ */
+void **_k_lanes_jit(_k_interp_t *interp) {
+    _k_module_t *module = interp->module;
+    void       **native = calloc(module->inst_count + 1, sizeof(void*));
+
+    if (native == (void**)0x0 || !__builtin_cpu_supports("avx2")) return native;
+
+    long     size = (_K_LANE_INST * (module->inst_count + 2) + 4095) & ~4095L;
+    _k_jit_t jit  = {
+        (unsigned char*)0x0, 0,
+        calloc(module->inst_count + 1, sizeof(long)), malloc(sizeof(long) * 6 * (module->inst_count + 1)), 0,
+        calloc(module->inst_count + 1, 1), -1, 0, 0, 0
+    };
+    char    *starts = calloc(module->inst_count + 1, 1);
+
+    if (jit.at == (long*)0x0 || jit.fixups == (long*)0x0 || jit.compiled == (char*)0x0 || starts == (char*)0x0 || _k_jit_open(interp, &jit, size)) {
+        free(jit.at);
+        free(jit.fixups);
+        free(jit.compiled);
+        free(starts);
+
+        return native;
+    }
+
+    long stub = jit.length;
+    long fail = _k_lanes_jit_stub(&jit);
+
+    /* Lanes wait only where a branch goes, or falls through to, so only there do running lanes check for them.  */
+    for (long i = 0; i < module->inst_count; ++i) {
+        short op = module->lane_ops[i];
+
+        if (op == _K_INST_JMPAL || op == _K_INST_JMPEQ) starts[(_k_inst2_t*)module->insts[i].a0 - module->insts] = 1;
+        if (op >= _K_INST_JLTII && op <= _K_INST_JNEFN) starts[(_k_inst2_t*)module->insts[i].a2 - module->insts] = 1;
+        if (op == _K_INST_JMPEQ || (op >= _K_INST_JLTII && op <= _K_INST_JNEFN)) starts[i + 1] = 1;
+
+        /* Batches and register calls enter past the poprr's, with the arguments in registers already.  */
+        if (op == _K_INST_POPRR && i + 1 < module->inst_count && module->lane_ops[i + 1] != _K_INST_POPRR) starts[i + 1] = 1;
+    }
+
+    for (long entry = 0, end = 0; entry < module->inst_count; entry = end) {
+        for (end = entry + 1; end < module->inst_count && module->lane_ops[end] != _K_INST_FRAME; ++end);
+
+        if (module->lane_ops[entry] != _K_INST_FRAME || _k_lanes_check(interp, &module->insts[entry])) continue;
+
+        /* Homes stop short of the frame's last register, past which calls pass their arguments.  */
+        jit.homes = (long)module->insts[entry].a1 - 1 < _K_LANE_HOMES ? (long)module->insts[entry].a1 - 1 : _K_LANE_HOMES;
+        jit.homed = 0;
+        jit.dirty = 0;
+
+        for (long i = entry; i < end; ++i) {
+            /* Blocks start with every register stored, as lanes come in from elsewhere.  */
+            if (starts[i]) _k_lanes_jit_flush(&jit);
+
+            jit.at[i] = jit.length;
+
+            if (starts[i]) {
+                jit.homed = 0;
+
+                _k_jit_imm(&jit, _K_RAX, (long)&module->insts[i]);
+                _k_jit_mem(&jit, 0, 1, 0x39, _K_RAX, _K_R13, _K_LFRAME(wait));
+
+                long ahead = _k_jit_forward(&jit, 0x7);
+
+                _k_jit_reg(&jit, 0, 0, 0x31, _K_RCX, _K_RCX);
+                _k_lanes_jit_park(&jit, &module->insts[i], (_k_inst2_t*)0x0);
+                _k_jit_land(&jit, ahead);
+            }
+
+            _k_lanes_jit_inst(&jit, interp, entry, i, fail);
+        }
+
+        for (long i = entry; i < end; ++i) jit.compiled[i] = 1;
+    }
+
+    /* Without executable code every function runs across lanes interpreted.  */
+    if (_k_jit_close(interp, &jit, size) == 0) {
+        for (long i = 0; i < module->inst_count; ++i) {
+            if (jit.compiled[i]) native[i] = jit.code + jit.at[i];
+        }
+
+        module->lane_enter = (int(*)(_k_lane_frame_t*, void*, void*))(jit.code + stub);
+    }
+
+    free(jit.at);
+    free(jit.fixups);
+    free(jit.compiled);
+    free(starts);
+
+    return native;
+}
+
+/*
+ *    Runs a function across lanes in lane code, compiling the module's
+ *    lanes the first time if it tiers.
+ *
+ *    @param _k_interp_t *interp       The interpreter, with its lanes open.
+ *    @param _k_lane_frame_t *frame    The function's frame, its arguments in its registers.
+ *    @param _k_inst2_t *ip            The instruction to start from.
+ *    @param unsigned live             The lanes entering the function.
+ *    @param _k_lane_t *ret            Where each lane's result goes.
+ *
+ *    @return int                      0 on success, 1 if the stack overflowed, or -1 if the function has no lane code.
+ */
+int _k_lanes_enter(_k_interp_t *interp, _k_lane_frame_t *frame, _k_inst2_t *ip, unsigned live, _k_lane_t *ret) {
+    _k_module_t *module = interp->module;
+    void       **native = __atomic_load_n(&module->lane_native, __ATOMIC_ACQUIRE);
+
+    if (!module->tiered) return -1;
+
+    /* The first context to get here compiles, and the others wait for it, then see the code whole.  */
+    if (native == (void**)0x0) {
+        _K_LOCK(module);
+
+        if ((native = module->lane_native) == (void**)0x0) {
+            native = _k_lanes_jit(interp);
+
+            __atomic_store_n(&module->lane_native, native, __ATOMIC_RELEASE);
+        }
+
+        _K_UNLOCK(module);
+    }
+
+    if (native == (void**)0x0 || native[ip - module->insts] == (void*)0x0) return -1;
+
+    frame->ret  = ret;
+    frame->bits = live;
+    frame->live = live;
+    frame->wait = module->insts + module->inst_count;
+
+    _k_lane_mask(&frame->keep, ~live);
+
+    return module->lane_enter(frame, native[ip - module->insts], interp);
+}
+#endif
+#endif
@@ -0,0 +1,299 @@
+/*
+ *    libk_interpret_pool.c    --    source for KAPPA's thread pool.
+ *
+ *    Authored by Karl "p0lyh3dron" Kreuze on October 18, 2026
+ *
+ *    This file is part of the KAPPA project.
+ *
+ *    This file runs k_parallel_for over threads each holding a context
+ *    of the environment's module, which split the calls into tiles and
+ *    steal them from each other once their own run out. Builds without
+ *    threads run every tile on the caller's.
+ */
+#include <stdlib.h>
+
+#include "libk_interpret_internal.h"
+
+/*
+ *    Takes the next tile of a worker's own range.
+ *
+ *    @param _k_worker_t *worker    The worker.
+ *
+ *    @return long    The tile, or -1 if the range is empty.
+ */
+long _k_worker_take(_k_worker_t *worker) {
+    unsigned long range = __atomic_load_n(&worker->range, __ATOMIC_ACQUIRE);
+
+    /* Thieves only ever lower the end, so the first tile is taken once the end is still past it.  */
+    while ((range & 0xFFFFFFFF) < range >> 32) {
+        if (__atomic_compare_exchange_n(&worker->range, &range, range + 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) return range & 0xFFFFFFFF;
+    }
+
+    return -1;
+}
+
+/*
+ *    Steals the back half of another worker's range, once a worker's own
+ *    is empty, going round the others from the one after it.
+ *
+ *    @param _k_worker_t *worker    The worker, with its range empty.
+ *
+ *    @return long    The first tile stolen, the rest becoming the worker's range, or -1 if every range is empty.
+ */
+long _k_worker_steal(_k_worker_t *worker) {
+    k_pool_t *pool = worker->pool;
+    long      self = worker - pool->workers;
+
+    for (long k = 1; k < pool->threads; ++k) {
+        _k_worker_t  *victim = &pool->workers[(self + k) % pool->threads];
+        unsigned long range  = __atomic_load_n(&victim->range, __ATOMIC_ACQUIRE);
+
+        for (;;) {
+            unsigned long first = range & 0xFFFFFFFF;
+            unsigned long end   = range >> 32;
+            unsigned long mid   = end - (end - first) / 2;
+
+            /* A single tile is left to its owner, who is about to take it.  */
+            if (end - first < 2) break;
+
+            if (!__atomic_compare_exchange_n(&victim->range, &range, mid << 32 | first, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) continue;
+
+            __atomic_store_n(&worker->range, end << 32 | (mid + 1), __ATOMIC_RELEASE);
+
+            worker->stolen += end - mid;
+
+            return mid;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ *    Runs tiles of a pool's loop on one of its workers until none are
+ *    left anywhere, or a call failed.
+ *
+ *    @param _k_worker_t *worker    The worker.
+ */
+void _k_worker_run(_k_worker_t *worker) {
+    k_pool_t        *pool = worker->pool;
+    const k_value_t *in[_K_FRAME_REGS];
+    long             tile;
+
+    while (!__atomic_load_n(&pool->failed, __ATOMIC_RELAXED) && ((tile = _k_worker_take(worker)) >= 0 || (tile = _k_worker_steal(worker)) >= 0)) {
+        long first = tile * pool->grain;
+        long count = pool->n - first < pool->grain ? pool->n - first : pool->grain;
+
+        for (long k = 0; k < pool->fn->params; ++k) in[k] = pool->in[k] + first;
+
+        if (k_context_call_batch(worker->ctx, pool->fn, count, in, pool->out != (k_value_t*)0x0 ? pool->out + first : (k_value_t*)0x0)) {
+            __atomic_store_n(&pool->failed, 1, __ATOMIC_RELAXED);
+        }
+
+        worker->tiles++;
+    }
+}
+
+#ifdef _K_PTHREAD
+/*
+ *    Runs a worker of a pool on its own thread, one generation of work
+ *    at a time, until the pool is destroyed.
+ *
+ *    @param void *arg    The worker.
+ *
+ *    @return void *      NULL.
+ */
+void *_k_worker_main(void *arg) {
+    _k_worker_t *worker = arg;
+    k_pool_t    *pool   = worker->pool;
+    long         seen   = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+
+        while (pool->generation == seen && !pool->stop) pthread_cond_wait(&pool->start, &pool->lock);
+
+        seen = pool->generation;
+
+        if (pool->stop) {
+            pthread_mutex_unlock(&pool->lock);
+
+            return (void*)0x0;
+        }
+
+        pthread_mutex_unlock(&pool->lock);
+
+        _k_worker_run(worker);
+
+        pthread_mutex_lock(&pool->lock);
+
+        if (--pool->running == 0) pthread_cond_signal(&pool->done);
+
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+#endif
+
+/*
+ *    Frees a pool whose threads never started, destroying its contexts.
+ *
+ *    @param k_pool_t *pool    The pool.
+ */
+void _k_pool_free(k_pool_t *pool) {
+    if (pool->workers != (_k_worker_t*)0x0) {
+        for (long t = 0; t < pool->threads; ++t) k_destroy_context(pool->workers[t].ctx);
+    }
+
+    free(pool->workers);
+    free(pool);
+}
+
+/*
+ *    Creates a pool of threads running an environment's module. A pool
+ *    whose threads do not all start runs on those that did.
+ *
+ *    @param k_env_t *env        The environment.
+ *    @param long     threads    The number of threads, the caller's included.
+ *
+ *    @return k_pool_t *    The pool, or NULL if the environment has no module loaded or the
+ *                          pool could not be allocated.
+ */
+k_pool_t *k_new_pool(k_env_t *env, long threads) {
+    if (env->interp == (_k_interp_t*)0x0) return (k_pool_t*)0x0;
+
+    k_pool_t *pool = malloc(sizeof(k_pool_t));
+
+    if (pool == (k_pool_t*)0x0) return (k_pool_t*)0x0;
+
+#ifndef _K_PTHREAD
+    threads = 1;
+#endif
+
+    pool->threads = threads < 1 ? 1 : threads;
+    pool->workers = calloc(pool->threads, sizeof(_k_worker_t));
+    pool->failed  = 0;
+
+    if (pool->workers == (_k_worker_t*)0x0) { _k_pool_free(pool); return (k_pool_t*)0x0; }
+
+    for (long t = 0; t < pool->threads; ++t) {
+        pool->workers[t].pool = pool;
+        pool->workers[t].ctx  = k_new_context(env);
+
+        if (pool->workers[t].ctx == (k_context_t*)0x0) { _k_pool_free(pool); return (k_pool_t*)0x0; }
+    }
+
+#ifdef _K_PTHREAD
+    pool->ids        = malloc(pool->threads * sizeof(pthread_t));
+    pool->generation = 0;
+    pool->running    = 0;
+    pool->stop       = 0;
+
+    if (pool->ids == (pthread_t*)0x0) { _k_pool_free(pool); return (k_pool_t*)0x0; }
+
+    pthread_mutex_init(&pool->lock, (pthread_mutexattr_t*)0x0);
+    pthread_cond_init(&pool->start, (pthread_condattr_t*)0x0);
+    pthread_cond_init(&pool->done, (pthread_condattr_t*)0x0);
+
+    for (long t = 1; t < pool->threads; ++t) {
+        if (pthread_create(&pool->ids[t], (pthread_attr_t*)0x0, _k_worker_main, &pool->workers[t]) == 0) continue;
+
+        /* The pool shrinks to the threads that started, and the tiles are split among them alone.  */
+        for (long k = t; k < pool->threads; ++k) k_destroy_context(pool->workers[k].ctx);
+
+        pool->threads = t;
+    }
+#endif
+
+    return pool;
+}
+
+/*
+ *    Calls a function over arrays of arguments across a pool's threads.
+ *
+ *    @param k_pool_t         *pool     The pool.
+ *    @param k_function_t     *fn       A function of the pool's module.
+ *    @param long              n        The number of calls.
+ *    @param long              grain    The calls in each tile.
+ *    @param const k_value_t **in       One array of n arguments per parameter.
+ *    @param k_value_t        *out      The array of n results, or NULL.
+ *
+ *    @return int    0 on success, 1 if a call failed.
+ */
+int k_parallel_for(k_pool_t *pool, k_function_t *fn, long n, long grain, const k_value_t **in, k_value_t *out) {
+    if (grain < 1) grain = 1;
+
+    long tiles = (n + grain - 1) / grain;
+
+    if (n <= 0) return 0;
+
+    /* Ranges pack two tile numbers into one word.  */
+    if (tiles > 0xFFFFFFFFL) return 1;
+
+    pool->fn     = fn;
+    pool->n      = n;
+    pool->grain  = grain;
+    pool->in     = in;
+    pool->out    = out;
+    pool->failed = 0;
+
+    /* Each worker starts on an equal share of the tiles, and steals from the others once it is through its own.  */
+    for (long t = 0; t < pool->threads; ++t) {
+        unsigned long first = tiles * t / pool->threads;
+        unsigned long end   = tiles * (t + 1) / pool->threads;
+
+        pool->workers[t].range = end << 32 | first;
+    }
+
+#ifdef _K_PTHREAD
+    pthread_mutex_lock(&pool->lock);
+
+    pool->running = pool->threads - 1;
+    pool->generation++;
+
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+#endif
+
+    _k_worker_run(&pool->workers[0]);
+
+#ifdef _K_PTHREAD
+    pthread_mutex_lock(&pool->lock);
+
+    while (pool->running > 0) pthread_cond_wait(&pool->done, &pool->lock);
+
+    pthread_mutex_unlock(&pool->lock);
+#endif
+
+    return pool->failed;
+}
+
+/*
+ *    Destroys a pool, stopping its threads and destroying their contexts.
+ *
+ *    @param k_pool_t *pool    The pool.
+ */
+void k_destroy_pool(k_pool_t *pool) {
+    if (pool == (k_pool_t*)0x0) return;
+
+#ifdef _K_PTHREAD
+    pthread_mutex_lock(&pool->lock);
+
+    pool->stop = 1;
+
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (long t = 1; t < pool->threads; ++t) pthread_join(pool->ids[t], (void**)0x0);
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->done);
+
+    free(pool->ids);
+#endif
+
+    for (long t = 0; t < pool->threads; ++t) k_destroy_context(pool->workers[t].ctx);
+
+    free(pool->workers);
+    free(pool);
+}
@@ -9,11 +9,12 @@
  */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include "libk.h"
 
-int main() {
+int main(int argc, char **argv) {
     char source[0xFFFF];
     char c;
     int  i = 0;
@@ -22,6 +23,29 @@ int main() {
 
     source[i] = '\0';
 
+    /* Lowers the source to C instead, with -c.  */
+    if (argc > 1 && strcmp(argv[argc - 1], "-c") == 0) {
+        if (k_build_c(source, 1) < 0) {
+            fprintf(stderr, "\e[31m\033[1mError\e[0m\033[0m: %s\n", k_get_error_message(k_get_error_code()));
+            return 1;
+        }
+
+        return 0;
+    }
+
+    /* Names the source in the line table.  */
+    if (argc > 1 && argv[1][0] != '-') k_set_source_name(argv[1]);
+
+    /* Writes x86-64 assembly instead, with -S.  */
+    if (argc > 1 && strcmp(argv[argc - 1], "-S") == 0) {
+        if (k_build_x86(source, 1) < 0) {
+            fprintf(stderr, "\e[31m\033[1mError\e[0m\033[0m: %s\n", k_get_error_message(k_get_error_code()));
+            return 1;
+        }
+
+        return 0;
+    }
+
     char *result = k_build(source, 1);
 
     const char *error = k_get_error_message(k_get_error_code());
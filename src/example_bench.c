@@ -0,0 +1,77 @@
+/*
+ *    example_bench.c    --    assembler throughput benchmark
+ *
+ *    Authored by Karl "p0lyh3dron" Kreuze on October 18, 2026
+ * 
+ *    This file is part of the KAPPA project.
+ * 
+ *    Builds a KAPPA source file repeatedly and reports how many
+ *    instructions per second the compiler and assembler emit, not
+ *    counting lexical analysis.
+ * 
+ *    Usage: example_bench [file.k] [copies] [runs]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "libk.h"
+#include "libk_compile.h"
+#include "libk_parse.h"
+
+int main(int argc, char **argv) {
+    const char *path   = argc > 1 ? argv[1] : "fractal.k";
+    long        copies = argc > 2 ? atol(argv[2]) : 100;
+    long        runs   = argc > 3 ? atol(argv[3]) : 10;
+
+    FILE *fp = fopen(path, "r");
+
+    if (fp == (FILE*)0x0) {
+        fprintf(stderr, "Failed to open %s!\n", path);
+        return 1;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    long fsize = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    char *source = malloc(fsize * copies + 1);
+
+    fread(source, fsize, 1, fp);
+    fclose(fp);
+
+    /* A large module is the same source repeated.  */
+    for (long i = 1; i < copies; i++) memcpy(source + fsize * i, source, fsize);
+
+    source[fsize * copies] = '\0';
+
+    long            insts   = 0;
+    double          seconds = 0.0;
+    struct timespec start;
+    struct timespec end;
+
+    for (long i = 0; i < runs; i++) {
+        _k_token_t *tokens = _k_lexical_analysis(source);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+
+        char *result = _k_compile(tokens, 0);
+
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        seconds += (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+        for (char *c = result; *c != '\0'; c++) {
+            if (*c == '\t') insts++;
+        }
+
+        free(result);
+    }
+
+    printf("%ld instructions in %.3f s: %.0f instructions/s\n", insts, seconds, insts / seconds);
+
+    free(source);
+
+    return 0;
+}
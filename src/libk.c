@@ -18,6 +18,7 @@
 
 #include "builtin.h"
 
+#include "libk_assemble.h"
 #include "libk_compile.h"
 #include "libk_parse.h"
 
@@ -33,6 +34,124 @@ char *k_build(const char *source, int flags) {
     return _k_compile(_k_lexical_analysis(source), flags);
 }
 
+/*
+ *    Builds a KAPPA source file, writing the IR to a file descriptor.
+ *
+ *    @param const char *source    The source to compile.
+ *    @param int         fd        The file descriptor to write to.
+ *    @param int         flags     The compilation flags.
+ * 
+ *    @return long    The number of bytes written, or -1 on a write error.
+ */
+long k_build_fd(const char *source, int fd, int flags) {
+    char         buf[0x4000];
+    _k_emitter_t out;
+
+    _k_emit_open(&out, buf, sizeof(buf), fd);
+
+    _k_compile_to(_k_lexical_analysis(source), &out, flags);
+
+    return out.error ? -1 : (long)out.total;
+}
+
+/*
+ *    Builds a KAPPA source file into a caller provided buffer.
+ *
+ *    @param const char    *source    The source to compile.
+ *    @param char          *buf       The buffer to write to.
+ *    @param unsigned long  size      The size of the buffer.
+ *    @param int            flags     The compilation flags.
+ * 
+ *    @return unsigned long    The length of the whole IR.
+ */
+unsigned long k_build_buffer(const char *source, char *buf, unsigned long size, int flags) {
+    _k_emitter_t out;
+
+    _k_emit_open(&out, buf, size, -1);
+
+    _k_compile_to(_k_lexical_analysis(source), &out, flags);
+
+    return out.total;
+}
+
+/*
+ *    Writes a build held in memory to a file descriptor and frees it.
+ *    A failed build writes nothing.
+ *
+ *    @param _k_emitter_t *out    The emitter the build went to.
+ *    @param int           fd     The file descriptor to write to.
+ *
+ *    @return long    The number of bytes written, or -1 if the build
+ *                    or the write failed.
+ */
+long _k_build_write(_k_emitter_t *out, int fd) {
+    long ret = out->error || _k_get_error_code() != 0 ? -1 : (long)out->total;
+
+    if (ret >= 0) {
+        out->fd = fd;
+
+        _k_emit_flush(out);
+
+        if (out->error) ret = -1;
+    }
+
+    free(out->buf);
+
+    return ret;
+}
+
+/*
+ *    Builds a KAPPA source file ahead of time, writing it as C to a
+ *    file descriptor.
+ *
+ *    @param const char *source    The source to compile.
+ *    @param int         fd        The file descriptor to write to.
+ * 
+ *    @return long    The number of bytes written, or -1 on a write error
+ *                    or if the source does not lower to C.
+ */
+long k_build_c(const char *source, int fd) {
+    _k_emitter_t out;
+
+    /* The C is held until it is whole, so a failed build writes none of it.  */
+    _k_emit_open(&out, (char*)0x0, 0, -1);
+
+    _k_compile_c(_k_lexical_analysis(source), &out, 0);
+
+    return _k_build_write(&out, fd);
+}
+
+/*
+ *    Builds a KAPPA source file ahead of time, writing it as x86-64
+ *    assembly to a file descriptor.
+ *
+ *    @param const char *source    The source to compile.
+ *    @param int         fd        The file descriptor to write to.
+ * 
+ *    @return long    The number of bytes written, or -1 on a write error
+ *                    or if the source does not translate to x86-64.
+ */
+long k_build_x86(const char *source, int fd) {
+    _k_emitter_t out;
+
+    /* As with C, a failed build writes none of its assembly.  */
+    _k_emit_open(&out, (char*)0x0, 0, -1);
+
+    _k_compile_x86(_k_lexical_analysis(source), &out, 0);
+
+    return _k_build_write(&out, fd);
+}
+
+/*
+ *    Sets the name of the source file the line table of the next
+ *    build refers to.
+ *
+ *    @param const char *name    The name of the source file, or null.
+ */
+void k_set_source_name(const char *name) {
+    _k_assemble_source(name);
+}
+
 /*
  *    Gets the error code.
  *
@@ -54,6 +173,10 @@ const char *k_get_error_message(int error_code) {
         case 0: return (const char *)0x0;
         case 1: return "Unexpected literal following literal";
         case 2: return "Keyword statement cannot exist in expression";
+        case 3: return "Construct cannot be lowered to C";
+        case 4: return "Instruction has no x86-64 translation";
+        case 5: return "Expression cannot be assembled";
+        case 6: return "Variable declared again with another type";
     }
 
     return "Unknown error";
@@ -28,6 +28,76 @@
  */
 char *k_build(const char *source, int flags);
 
+/*
+ *    Builds a KAPPA source file, writing the IR to a file descriptor.
+ *
+ *    @param const char *source    The source to compile.
+ *    @param int         fd        The file descriptor to write to.
+ *    @param int         flags     The compilation flags.
+ * 
+ *    @return long    The number of bytes written, or -1 on a write error.
+ */
+long k_build_fd(const char *source, int fd, int flags);
+
+/*
+ *    Builds a KAPPA source file into a caller provided buffer.
+ *
+ *    The IR is always null terminated, and cut short if the buffer
+ *    is too small.
+ *
+ *    @param const char    *source    The source to compile.
+ *    @param char          *buf       The buffer to write to.
+ *    @param unsigned long  size      The size of the buffer.
+ *    @param int            flags     The compilation flags.
+ * 
+ *    @return unsigned long    The length of the whole IR, which does not
+ *                             fit when it is not less than the size.
+ */
+unsigned long k_build_buffer(const char *source, char *buf, unsigned long size, int flags);
+
+/*
+ *    Builds a KAPPA source file ahead of time, writing it as C to a
+ *    file descriptor.
+ *
+ *    Every KAPPA function becomes a C function of the same name behind
+ *    a kappa_ prefix, taking and returning its native C types, so the
+ *    output can be built into a shared object and loaded at runtime.
+ *    Nothing is written if the source does not lower.
+ *
+ *    @param const char *source    The source to compile.
+ *    @param int         fd        The file descriptor to write to.
+ * 
+ *    @return long    The number of bytes written, or -1 on a write error
+ *                    or if the source does not lower to C.
+ */
+long k_build_c(const char *source, int fd);
+
+/*
+ *    Builds a KAPPA source file ahead of time, writing it as GNU
+ *    assembler x86-64 code to a file descriptor.
+ *
+ *    Functions are exported under the same names as with k_build_c
+ *    and follow the System V calling convention, so the output can be
+ *    assembled and linked straight into a C program. Modules that
+ *    declare types, or use values whose type is only known at runtime,
+ *    do not translate.
+ *
+ *    @param const char *source    The source to compile.
+ *    @param int         fd        The file descriptor to write to.
+ * 
+ *    @return long    The number of bytes written, or -1 on a write error
+ *                    or if the source does not translate to x86-64.
+ */
+long k_build_x86(const char *source, int fd);
+
+/*
+ *    Sets the name of the source file the line table of the next
+ *    build refers to.
+ *
+ *    @param const char *name    The name of the source file, or null.
+ */
+void k_set_source_name(const char *name);
+
 /*
  *    Gets the error code.
  *
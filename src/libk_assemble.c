@@ -15,24 +15,466 @@
 #include <stdlib.h>
 #include <unistd.h>
 
+typedef struct {
+    char      *name;
+    char      *type;
+} _k_symbol_t;
+
+typedef struct {
+    char          *name;
+    _k_kind_e      ret;
+    _k_kind_e     *params;
+    unsigned long  param_count;
+} _k_signature_t;
+
+/* What the assembler knows of the value a register holds: its kind, its declared type, and the literal it was loaded with.  */
+typedef struct {
+    _k_kind_e kind;
+    char      type[32];
+    char      constant;
+    char      lit[64];
+} _k_reg_info_t;
+
+_k_reg_info_t  *_k_regs            = (_k_reg_info_t*)0x0;
+long            _k_reg_cap         = 0;
+_k_reg_info_t   _k_reg_spare;
+int             _k_assemble_failed = 0;
+int             _k_redeclared      = 0;
+
+_k_symbol_t    *_k_vars      = (_k_symbol_t*)0x0;
+unsigned long   _k_var_count = 0;
+
+_k_signature_t *_k_funcs      = (_k_signature_t*)0x0;
+unsigned long   _k_func_count = 0;
+_k_signature_t *_k_func       = (_k_signature_t*)0x0;
+
+const char     *_k_source = (const char*)0x0;
+unsigned long   _k_line   = 0;
+
+/*
+ *    Sets the name of the source file recorded in the line table.
+ *
+ *    @param const char *name    The name of the source file, or null.
+ */
+void _k_assemble_source(const char *name) {
+    _k_source = name;
+}
+
+/*
+ *    Gets what is known of a register. Registers that were never taken,
+ *    as an operator missing an operand refers to, fail the build.
+ *
+ *    @param int reg    The register.
+ *
+ *    @return _k_reg_info_t *    The register, valid until the next is taken.
+ */
+_k_reg_info_t *_k_reg(int reg) {
+    if (reg >= 0 && reg < _k_reg_cap) return &_k_regs[reg];
+
+    _k_assemble_failed = 1;
+
+    return &_k_reg_spare;
+}
+
+/*
+ *    Grows the registers to hold at least a number of them.
+ *
+ *    @param long count    The number of registers.
+ *
+ *    @return int    0 on success, 1 if they could not be grown.
+ */
+int _k_reg_room(long count) {
+    if (count <= _k_reg_cap) return 0;
+
+    long           cap  = count > 2 * _k_reg_cap ? count : 2 * _k_reg_cap;
+    _k_reg_info_t *regs = realloc(_k_regs, sizeof(_k_reg_info_t) * cap);
+
+    if (regs == (_k_reg_info_t*)0x0) return 1;
+
+    memset(regs + _k_reg_cap, 0, sizeof(_k_reg_info_t) * (cap - _k_reg_cap));
+
+    _k_regs    = regs;
+    _k_reg_cap = cap;
+
+    return 0;
+}
+
+/*
+ *    Takes the register after the last, growing the registers to hold it.
+ *
+ *    @param int *r    The last register taken.
+ *
+ *    @return int    The register.
+ */
+int _k_next_reg(int *r) {
+    if (_k_reg_room((long)*r + 2)) _k_assemble_failed = 1;
+
+    return ++*r;
+}
+
+/*
+ *    Tells whether the assembler failed on the module so far.
+ *
+ *    @return int    5 if an expression could not be assembled, 6 if a
+ *                   variable was declared again with another type, 0 if
+ *                   neither.
+ */
+int _k_assemble_error() {
+    if (_k_assemble_failed) return 5;
+
+    return _k_redeclared ? 6 : 0;
+}
+
+/*
+ *    Resets the assembler state between modules.
+ */
+void _k_assemble_reset() {
+    _k_assemble_restart();
+
+    for (unsigned long i = 0; i < _k_func_count; i++) free(_k_funcs[i].params);
+
+    free(_k_funcs);
+
+    _k_funcs      = (_k_signature_t*)0x0;
+    _k_func_count = 0;
+}
+
+/*
+ *    Resets the assembler state for another pass over the same module, keeping the signatures seen so far.
+ */
+void _k_assemble_restart() {
+    for (unsigned long i = 0; i < _k_var_count; i++) free(_k_vars[i].type);
+
+    free(_k_vars);
+
+    _k_func            = (_k_signature_t*)0x0;
+    _k_vars            = (_k_symbol_t*)0x0;
+    _k_var_count       = 0;
+    _k_line            = 0;
+    _k_redeclared      = 0;
+    _k_assemble_failed = _k_reg_room(32);
+}
+
+/*
+ *    Gets the kind of value a declared type holds.
+ *
+ *    Only u32 and f32 are narrow, i32 is held and stored as a 64-bit
+ *    integer.
+ *
+ *    @param const char *type    The type string.
+ *
+ *    @return _k_kind_e    The kind of the type.
+ */
+_k_kind_e _k_kind_of(const char *type) {
+    int narrow = strlen(type) > 2 && strcmp(type + strlen(type) - 2, "32") == 0;
+
+    if (type[0] == '*') return _K_KIND_INT;
+    if (type[0] == 'f') return narrow ? _K_KIND_SINGLE : _K_KIND_FLOAT;
+    if (type[0] == 'u') return narrow ? _K_KIND_WORD : _K_KIND_INT;
+    if (type[0] == 'i' || type[0] == 's') return _K_KIND_INT;
+
+    return _K_KIND_UNKNOWN;
+}
+
+/*
+ *    Gets the 64-bit kind a 32-bit kind is held in.
+ *
+ *    @param _k_kind_e kind    The kind.
+ *
+ *    @return _k_kind_e    The wide kind.
+ */
+_k_kind_e _k_wide(_k_kind_e kind) {
+    if (kind == _K_KIND_WORD)   return _K_KIND_INT;
+    if (kind == _K_KIND_SINGLE) return _K_KIND_FLOAT;
+
+    return kind;
+}
+
+/*
+ *    Gets the operand suffix of an instruction working on a kind.
+ *
+ *    @param _k_kind_e kind    The kind of the operands.
+ *
+ *    @return const char *    The suffix.
+ */
+const char *_k_kind_suffix(_k_kind_e kind) {
+    switch (kind) {
+        case _K_KIND_INT:    return "ii";
+        case _K_KIND_FLOAT:  return "ff";
+        case _K_KIND_WORD:   return "ww";
+        case _K_KIND_SINGLE: return "ss";
+        default:             return "rr";
+    }
+}
+
+/*
+ *    Sets the kind of a register that holds a computed value.
+ *
+ *    @param int       reg     The register.
+ *    @param _k_kind_e kind    The kind of the value.
+ */
+void _k_set_kind(int reg, _k_kind_e kind) {
+    _k_reg(reg)->kind     = kind;
+    _k_reg(reg)->type[0]  = '\0';
+    _k_reg(reg)->constant = 0;
+}
+
+/*
+ *    Sets the declared type of the value a register holds.
+ *
+ *    @param int         reg     The register.
+ *    @param const char *type    The type, or null if it is not known.
+ */
+void _k_set_type(int reg, const char *type) {
+    _k_set_kind(reg, type != (const char*)0x0 ? _k_kind_of(type) : _K_KIND_UNKNOWN);
+
+    if (type != (const char*)0x0) snprintf(_k_reg(reg)->type, sizeof(_k_reg(reg)->type), "%s", type);
+}
+
+/*
+ *    Gets the type a register points to.
+ *
+ *    Values not declared as pointers are taken to point to their own
+ *    type.
+ *
+ *    @param int reg    The register.
+ *
+ *    @return const char *    The type pointed to, or null if it is not known.
+ */
+const char *_k_pointee(int reg) {
+    if (_k_reg(reg)->type[0] == '\0') return (const char*)0x0;
+
+    return _k_reg(reg)->type[0] == '*' ? _k_reg(reg)->type + 1 : _k_reg(reg)->type;
+}
+
+/*
+ *    Reads a declarator's type, cut to 31 characters.
+ *
+ *    @param _k_tree_t *root    The declarator.
+ *    @param char      *type    The buffer to write the type to, of 32 bytes.
+ */
+void _k_declared_type(_k_tree_t *root, char *type) {
+    _k_tree_t    *node  = root->children[0];
+    unsigned long depth = 0;
+
+    memset(type, 0, 32);
+
+    while (strcmp(node->token->str, "*") == 0) {
+        if (depth < 31) type[depth++] = '*';
+
+        node = node->children[0];
+    }
+
+    snprintf(type + depth, 32 - depth, "%s", node->token->str);
+}
+
+/*
+ *    Gets the type of a variable in the current function.
+ *
+ *    @param const char *name    The name of the variable.
+ *
+ *    @return const char *    The type of the variable, or null if it is not declared.
+ */
+const char *_k_var_type(const char *name) {
+    for (unsigned long i = _k_var_count; i > 0; i--) {
+        if (strcmp(_k_vars[i - 1].name, name) == 0) return _k_vars[i - 1].type;
+    }
+
+    return (const char*)0x0;
+}
+
+/*
+ *    Declares a variable in the current function.
+ *
+ *    A variable has one slot for the whole function, so declaring it
+ *    again with another type fails the build.
+ *
+ *    @param const char *name    The name of the variable.
+ *    @param const char *type    The type of the variable.
+ */
+void _k_declare_var(const char *name, const char *type) {
+    const char *declared = _k_var_type(name);
+
+    if (declared != (const char*)0x0 && strcmp(declared, type) != 0) _k_redeclared = 1;
+
+    _k_vars = realloc(_k_vars, sizeof(_k_symbol_t) * (_k_var_count + 1));
+
+    _k_vars[_k_var_count].name = (char*)name;
+    _k_vars[_k_var_count].type = strdup(type);
+
+    _k_var_count++;
+}
+
+/*
+ *    Gets the kind of a variable in the current function.
+ *
+ *    @param const char *name    The name of the variable.
+ *
+ *    @return _k_kind_e    The kind of the variable.
+ */
+_k_kind_e _k_var_kind(const char *name) {
+    const char *type = _k_var_type(name);
+
+    return type != (const char*)0x0 ? _k_kind_of(type) : _K_KIND_UNKNOWN;
+}
+
+/*
+ *    Finds the signature of a function.
+ *
+ *    @param const char *name    The name of the function.
+ *
+ *    @return _k_signature_t *    The signature, or null if it is not yet known.
+ */
+_k_signature_t *_k_find_func(const char *name) {
+    for (unsigned long i = 0; i < _k_func_count; i++) {
+        if (strcmp(_k_funcs[i].name, name) == 0) return &_k_funcs[i];
+    }
+
+    return (_k_signature_t*)0x0;
+}
+
+/*
+ *    Records the source position of a node in the line table.
+ *
+ *    Only the first node assembled on each source line starts a new
+ *    entry, so the table stays one entry per line of code.
+ *
+ *    @param _k_tree_t    *root    The node.
+ *    @param _k_emitter_t *out     The emitter.
+ */
+void _k_assemble_line(_k_tree_t *root, _k_emitter_t *out) {
+    if (root->token->line == _k_line) return;
+
+    if (_k_line == 0 && _k_source != (const char*)0x0) _k_emit_file(out, _k_source);
+
+    _k_line = root->token->line;
+
+    _k_emit_line(out, root->token->line, root->token->column);
+}
+
+/*
+ *    Converts a literal to a kind.
+ *
+ *    The converted value is loaded again in place of a conversion, and
+ *    only if it differs from the literal.
+ *
+ *    @param int        reg     The register holding the literal.
+ *    @param _k_kind_e  kind    The kind to convert to.
+ *    @param _k_emitter_t *out    The emitter.
+ */
+void _k_assemble_literal(int reg, _k_kind_e kind, _k_emitter_t *out) {
+    int    real  = _k_wide(_k_reg(reg)->kind) == _K_KIND_FLOAT;
+    long   lit   = (long)strtoul(_k_reg(reg)->lit, (char**)0x0, 10);
+    double num   = real ? strtod(_k_reg(reg)->lit, (char**)0x0) : (double)lit;
+    long   whole = real ? (long)num : lit;
+
+    if (_k_wide(kind) == _K_KIND_FLOAT) {
+        double conv = kind == _K_KIND_SINGLE ? (double)(float)num : num;
+
+        if (real && conv == num) return;
+
+        snprintf(_k_reg(reg)->lit, sizeof(_k_reg(reg)->lit), "%.17g", conv);
+        _k_emit_ra(out, "movrf", reg, _k_reg(reg)->lit);
+
+        return;
+    }
+
+    if (kind == _K_KIND_WORD) whole = (unsigned int)whole;
+
+    if (!real && whole == lit) return;
+
+    snprintf(_k_reg(reg)->lit, sizeof(_k_reg(reg)->lit), "%ld", whole);
+    _k_emit_ra(out, "movrn", reg, _k_reg(reg)->lit);
+}
+
+/*
+ *    Converts a register to a kind.
+ *
+ *    Conversions between known kinds are static, a register of unknown
+ *    kind is converted by the interpreter depending on what it holds.
+ *
+ *    @param int        reg     The register to convert.
+ *    @param _k_kind_e  kind    The kind to convert to.
+ *    @param _k_emitter_t *out    The emitter.
+ */
+void _k_assemble_convert(int reg, _k_kind_e kind, _k_emitter_t *out) {
+    _k_kind_e from = _k_reg(reg)->kind;
+    _k_kind_e wide = _k_wide(kind);
+
+    if (kind == _K_KIND_UNKNOWN || kind == from) return;
+
+    if (_k_reg(reg)->constant) {
+        _k_assemble_literal(reg, kind, out);
+
+        _k_reg(reg)->kind = kind;
+
+        return;
+    }
+
+    if (from == _K_KIND_UNKNOWN)    _k_emit_rr(out, wide == _K_KIND_FLOAT ? "rtofr" : "rtoir", (const char*)0x0, reg, reg);
+    else if (_k_wide(from) != wide) _k_emit_rr(out, wide == _K_KIND_FLOAT ? "itofr" : "ftoir", (const char*)0x0, reg, reg);
+
+    /* 32-bit values are held wrapped or rounded in their 64-bit register.  */
+    if (kind == _K_KIND_WORD   && from != _K_KIND_WORD)   _k_emit_rr(out, "itowr", (const char*)0x0, reg, reg);
+    if (kind == _K_KIND_SINGLE && from != _K_KIND_SINGLE) _k_emit_rr(out, "ftosr", (const char*)0x0, reg, reg);
+
+    _k_reg(reg)->kind = kind;
+}
+
+/*
+ *    Brings two registers to a common kind, promoting integers to floats.
+ *
+ *    Between a 32-bit and a 64-bit kind of the same family the wider one
+ *    wins, unless the 64-bit operand is a literal, which takes on the
+ *    width of the other operand.
+ *
+ *    @param int   a      The first register.
+ *    @param int   b      The second register.
+ *    @param _k_emitter_t *out    The emitter.
+ *
+ *    @return _k_kind_e    The common kind, unknown if either register is.
+ */
+_k_kind_e _k_assemble_promote(int a, int b, _k_emitter_t *out) {
+    if (_k_reg(a)->kind == _K_KIND_UNKNOWN || _k_reg(b)->kind == _K_KIND_UNKNOWN) return _K_KIND_UNKNOWN;
+
+    if (_k_wide(_k_reg(a)->kind) != _k_wide(_k_reg(b)->kind)) {
+        if (_k_wide(_k_reg(a)->kind) == _K_KIND_INT) _k_assemble_convert(a, _K_KIND_FLOAT, out);
+        if (_k_wide(_k_reg(b)->kind) == _K_KIND_INT) _k_assemble_convert(b, _K_KIND_FLOAT, out);
+    }
+
+    if (_k_reg(a)->kind == _k_reg(b)->kind) return _k_reg(a)->kind;
+
+    if (_k_reg(a)->constant) return _k_reg(b)->kind;
+    if (_k_reg(b)->constant) return _k_reg(a)->kind;
+
+    return _k_wide(_k_reg(a)->kind);
+}
+
 /*
  *    Compiles a binary operation.
  *
  *    @param _k_token_t *token    The token to compile.
  *    @param int        *r        The register to compile to.
- *    @param FILE       *out      The output file.
+ *    @param _k_emitter_t *out    The emitter.
  */
-void _k_assemble_bin_op(_k_token_t *token, int *r, FILE *out) {
-    if (strcmp(token->str, "<") == 0)  { fprintf(out, "\tlesrr: r%d r%d r%d\n", *r - 1, *r - 1, *r); --*r; }
-    if (strcmp(token->str, ">") == 0)  { fprintf(out, "\tgrerr: r%d r%d r%d\n", *r - 1, *r - 1, *r); --*r; }
-    if (strcmp(token->str, "<=") == 0) { fprintf(out, "\tleqrr: r%d r%d r%d\n", *r - 1, *r - 1, *r); --*r; }
-    if (strcmp(token->str, ">=") == 0) { fprintf(out, "\tgeqrr: r%d r%d r%d\n", *r - 1, *r - 1, *r); --*r; }
-    if (strcmp(token->str, "==") == 0) { fprintf(out, "\tequrr: r%d r%d r%d\n", *r - 1, *r - 1, *r); --*r; }
-    if (strcmp(token->str, "+") == 0)  { fprintf(out, "\taddrr: r%d r%d r%d\n", *r - 1, *r - 1, *r); --*r; }
-    if (strcmp(token->str, "-") == 0)  { fprintf(out, "\tsubrr: r%d r%d r%d\n", *r - 1, *r - 1, *r); --*r; }
-    if (strcmp(token->str, "*") == 0)  { fprintf(out, "\tmulrr: r%d r%d r%d\n", *r - 1, *r - 1, *r); --*r; }
-    if (strcmp(token->str, "/") == 0)  { fprintf(out, "\tdivrr: r%d r%d r%d\n", *r - 1, *r - 1, *r); --*r; }
-    if (strcmp(token->str, ",") == 0)  { fprintf(out, "\tpushr: r%d\n", *r); --*r; }
+void _k_assemble_bin_op(_k_token_t *token, int *r, _k_emitter_t *out) {
+    const char *ops[]   = { "<",   ">",   "<=",  ">=",  "==",  "!=",  "+",   "-",   "*",   "/" };
+    const char *names[] = { "les", "gre", "leq", "geq", "equ", "neq", "add", "sub", "mul", "div" };
+
+    for (int i = 0; i < 10; i++) {
+        if (strcmp(token->str, ops[i]) != 0) continue;
+
+        _k_kind_e kind = _k_assemble_promote(*r - 1, *r, out);
+
+        /* Comparisons do not depend on the width of their operands.  */
+        if (i < 6) kind = _k_wide(kind);
+
+        _k_emit_rrr(out, names[i], _k_kind_suffix(kind), *r - 1, *r - 1, *r); --*r;
+
+        _k_set_kind(*r, i < 6 && kind != _K_KIND_UNKNOWN ? _K_KIND_INT : kind);
+    }
+
+    if (strcmp(token->str, ",") == 0)  { _k_emit_r(out, "pushr", (const char*)0x0, *r); --*r; }
 }
 
 /*
@@ -40,11 +482,37 @@ void _k_assemble_bin_op(_k_token_t *token, int *r, FILE *out) {
  *
  *    @param _k_token_t *token    The token to compile.
  *    @param int        *r        The register to compile to.
- *    @param FILE       *out      The output file.
+ *    @param _k_emitter_t *out    The emitter.
  */
-void _k_assemble_un_op(_k_token_t *token, int *r, FILE *out) {
-    if (strcmp(token->str, "-") == 0) { fprintf(out, "\tnegrr: r%d r%d\n", *r, *r); }
-    if (strcmp(token->str, "*") == 0) { fprintf(out, "\tderef: r%d r%d\n", *r, *r); }
+void _k_assemble_un_op(_k_token_t *token, int *r, _k_emitter_t *out) {
+    _k_kind_e kind = _k_reg(*r)->kind;
+
+    if (strcmp(token->str, "-") == 0) {
+        _k_emit_rr(out, "neg", _k_kind_suffix(kind == _K_KIND_SINGLE ? _K_KIND_FLOAT : kind), *r, *r);
+
+        _k_set_kind(*r, kind);
+    }
+
+    if (strcmp(token->str, "*") == 0) {
+        const char *pointee = _k_pointee(*r);
+
+        /* Untyped addresses are read whole and keep their register's kind.  */
+        if (pointee == (const char*)0x0 || _k_kind_of(pointee) == _K_KIND_UNKNOWN) {
+            _k_emit_rr(out, "deref", (const char*)0x0, *r, *r);
+
+            _k_set_kind(*r, kind);
+
+            return;
+        }
+
+        char type[32];
+
+        snprintf(type, sizeof(type), "%s", pointee);
+
+        _k_emit_rr(out, "der", _k_kind_suffix(_k_kind_of(type)), *r, *r);
+
+        _k_set_type(*r, type);
+    }
 }
 
 /*
@@ -53,22 +521,15 @@ void _k_assemble_un_op(_k_token_t *token, int *r, FILE *out) {
  *    @param _k_tree_t *root       The root of the tree.
  *    @param int       *r          The register to compile to.
  *    @param int       *s          The stack to compile to.
- *    @param FILE      *out        The output file.
+ *    @param _k_emitter_t *out    The emitter.
  */
-void _k_assemble_declarator(_k_tree_t *root, int *r, int *s, FILE *out) {
+void _k_assemble_declarator(_k_tree_t *root, int *r, int *s, _k_emitter_t *out) {
     char type[32];
-    memset(type, 0, 32);
-    _k_tree_t *node = root->children[0];
-
-    while (strcmp(node->token->str, "*") == 0) {
-        strcat(type, "*");
-        node = node->children[0];
-    }
 
-    strcat(type, node->token->str);
+    _k_declared_type(root, type);
 
     if (strcmp(root->children[0]->token->str, "type") == 0) {
-        fprintf(out, "%s: \n", root->children[1]->token->str);
+        _k_emit_label(out, root->children[1]->token->str, 0);
 
         for (unsigned long i = 0; i < root->children[1]->child_count; i++) {
             _k_assemble_tree(root->children[1]->children[i], r, s, out);
@@ -79,21 +540,55 @@ void _k_assemble_declarator(_k_tree_t *root, int *r, int *s, FILE *out) {
         char *name  = root->children[1]->token->str;
         char *count = root->children[1]->children[0]->children[0]->token->str;
 
-        fprintf(out, "\tnewav: %s %s %d\n", type, name, atoi(count));
+        _k_emit_inst(out, "newav", (const char*)0x0);
+        _k_emit_arg(out, type);
+        _k_emit_arg(out, name);
+        _k_emit_num(out, atoi(count));
+        _k_emit_end(out);
     }
     
     if (root->children[1]->child_count > 0 && root->children[1]->children[0]->token->tokenable->type == _K_TOKEN_TYPE_NEWEXPRESSION) {
-        char *name = root->children[1]->token->str;
+        char      *name   = root->children[1]->token->str;
+        _k_tree_t *params = root->children[1]->children[0];
+
+        _k_funcs = realloc(_k_funcs, sizeof(_k_signature_t) * (_k_func_count + 1));
+
+        _k_func              = &_k_funcs[_k_func_count++];
+        _k_func->name        = name;
+        _k_func->ret         = _k_kind_of(type);
+        _k_func->params      = malloc(sizeof(_k_kind_e) * (params->child_count + 1));
+        _k_func->param_count = params->child_count;
+
+        char types[512] = "";
 
-        fprintf(out, "\n%s: \n", name);
+        for (unsigned long i = 0; i < params->child_count; i++) {
+            char param[32];
+
+            _k_declared_type(params->children[i], param);
+
+            _k_func->params[i] = _k_kind_of(param);
+
+            if (strlen(types) + strlen(param) + 2 < sizeof(types)) {
+                if (i > 0) strcat(types, " ");
+
+                strcat(types, param);
+            }
+        }
+
+        for (unsigned long i = 0; i < _k_var_count; i++) free(_k_vars[i].type);
+
+        _k_var_count = 0;
+
+        _k_emit_end(out);
+        _k_emit_func(out, name, type, types);
 
         for (unsigned long i = 0; i < root->children[1]->children[0]->child_count; i++) {
-            fprintf(out, "\tpoprr: r%d\n", ++*r);
+            _k_emit_r(out, "poprr", (const char*)0x0, _k_next_reg(r));
         }
 
         for (unsigned long i = 0; i < root->children[1]->children[0]->child_count; i++) {
             _k_assemble_tree(root->children[1]->children[0]->children[i], r, s, out);
-            fprintf(out, "\tsaver: %s r%d\n", root->children[1]->children[0]->children[i]->children[1]->token->str, (*r)--);
+            _k_emit_ar(out, "saver", root->children[1]->children[0]->children[i]->children[1]->token->str, (*r)--);
         }
 
         for (unsigned long i = 0; i < root->children[1]->children[1]->child_count; i++) {
@@ -106,7 +601,12 @@ void _k_assemble_declarator(_k_tree_t *root, int *r, int *s, FILE *out) {
     if (root->child_count > 1 && root->children[1]->token->tokenable->type == _K_TOKEN_TYPE_IDENTIFIER) {
         char *name = root->children[1]->token->str;
 
-        fprintf(out, "\tnewsv: %s %s\n", type, name);
+        _k_emit_inst(out, "newsv", (const char*)0x0);
+        _k_emit_arg(out, type);
+        _k_emit_arg(out, name);
+        _k_emit_end(out);
+
+        _k_declare_var(name, type);
 
         return;
     }
@@ -114,7 +614,12 @@ void _k_assemble_declarator(_k_tree_t *root, int *r, int *s, FILE *out) {
     if (root->child_count > 1 && (root->children[1]->token->tokenable->type == _K_TOKEN_TYPE_OPERATOR || root->children[1]->token->tokenable->type == _K_TOKEN_TYPE_ASSIGNMENT)) {
         char *name = root->children[1]->children[0]->token->str;
 
-        fprintf(out, "\tnewsv: %s %s\n", type, name);
+        _k_emit_inst(out, "newsv", (const char*)0x0);
+        _k_emit_arg(out, type);
+        _k_emit_arg(out, name);
+        _k_emit_end(out);
+
+        _k_declare_var(name, type);
 
         _k_assemble_tree(root->children[1], r, s, out);
 
@@ -130,33 +635,47 @@ void _k_assemble_declarator(_k_tree_t *root, int *r, int *s, FILE *out) {
  *    @param _k_tree_t *root       The root of the tree.
  *    @param int       *r          The register to compile to.
  *    @param int       *s          The stack to compile to.
- *    @param FILE      *out        The output file.
+ *    @param _k_emitter_t *out    The emitter.
  */
-void _k_assemble_identifier(_k_tree_t *root, int *r, int *s, FILE *out) {
+void _k_assemble_identifier(_k_tree_t *root, int *r, int *s, _k_emitter_t *out) {
     if (root->child_count > 0 && root->children[0]->token->tokenable->type == _K_TOKEN_TYPE_NEWEXPRESSION) {
+        _k_signature_t *func = _k_find_func(root->token->str);
+
         for (unsigned long i = 0; i < root->children[0]->child_count; i++) {
             _k_assemble_tree(root->children[0]->children[i], r, s, out);
-            fprintf(out, "\tpushr: r%d\n", (*r)--);
+
+            if (func != (_k_signature_t*)0x0 && i < func->param_count) _k_assemble_convert(*r, _k_wide(func->params[i]), out);
+
+            _k_emit_r(out, "pushr", (const char*)0x0, (*r)--);
         }
 
-        fprintf(out, "\tcallf: %s\n", root->token->str);
-        fprintf(out, "\tmovrr: r%d r0\n", ++*r);
+        _k_emit_inst(out, "callf", (const char*)0x0);
+        _k_emit_arg(out, root->token->str);
+        _k_emit_end(out);
+        _k_emit_rr(out, "movrr", (const char*)0x0, _k_next_reg(r), 0);
+
+        _k_set_kind(*r, func != (_k_signature_t*)0x0 ? func->ret : _K_KIND_UNKNOWN);
 
         return;
     }
 
     if (root->child_count > 0 && root->children[0]->token->tokenable->type == _K_TOKEN_TYPE_NEWINDEX) {
-        fprintf(out, "\tloadr: r%d %s\n", ++*r, root->token->str);
+        _k_emit_ra(out, "loadr", _k_next_reg(r), root->token->str);
+        _k_set_type(*r, _k_var_type(root->token->str));
         _k_assemble_tree(root->children[0]->children[0], r, s, out);
-        fprintf(out, "\taddrr: r%d r%d r%d\n", *r - 1, *r - 1, *r);
-        fprintf(out, "\tderef: r%d r%d\n", *r - 1, *r - 1);
+        _k_emit_rrr(out, "addrr", (const char*)0x0, *r - 1, *r - 1, *r);
+        _k_emit_rr(out, "deref", (const char*)0x0, *r - 1, *r - 1);
 
         *r -= 1;
 
+        _k_set_kind(*r, _K_KIND_UNKNOWN);
+
         return;
     }
 
-    fprintf(out, "\tloadr: r%d %s\n", ++*r, root->token->str);
+    _k_emit_ra(out, "loadr", _k_next_reg(r), root->token->str);
+
+    _k_set_type(*r, _k_var_type(root->token->str));
 }
 
 /*
@@ -165,10 +684,15 @@ void _k_assemble_identifier(_k_tree_t *root, int *r, int *s, FILE *out) {
  *    @param _k_tree_t *root       The root of the tree.
  *    @param int       *r          The register to compile to.
  *    @param int       *s          The stack to compile to.
- *    @param FILE      *out        The output file.
+ *    @param _k_emitter_t *out    The emitter.
  */
-void _k_assemble_number(_k_tree_t *root, int *r, int *s, FILE *out) {
-    fprintf(out, "\tmovrn: r%d %s\n", ++*r, root->token->str);
+void _k_assemble_number(_k_tree_t *root, int *r, int *s, _k_emitter_t *out) {
+    _k_emit_ra(out, "movrn", _k_next_reg(r), root->token->str);
+
+    _k_reg(*r)->kind     = _K_KIND_INT;
+    _k_reg(*r)->constant = 1;
+
+    snprintf(_k_reg(*r)->lit, sizeof(_k_reg(*r)->lit), "%s", root->token->str);
 }
 
 /*
@@ -177,20 +701,20 @@ void _k_assemble_number(_k_tree_t *root, int *r, int *s, FILE *out) {
  *    @param _k_tree_t *root       The root of the tree.
  *    @param int       *r          The register to compile to.
  *    @param int       *s          The stack to compile to.
- *    @param FILE      *out        The output file.
+ *    @param _k_emitter_t *out    The emitter.
  */
-void _k_assemble_assignment(_k_tree_t *root, int *r, int *s, FILE *out) {
+void _k_assemble_assignment(_k_tree_t *root, int *r, int *s, _k_emitter_t *out) {
     _k_tree_t *temp = root->children[0];
     int        ptrcnt = 0;
     int        memcnt = 0;
     int        arrcnt = 0;
 
     if (temp->child_count > 0 && strcmp(temp->children[0]->token->str, "[") == 0) {
-        fprintf(out, "\tloadr: r%d %s\n", ++(*r), temp->token->str);
+        _k_emit_ra(out, "loadr", ++(*r), temp->token->str);
 
         _k_assemble_tree(temp->children[0]->children[0], r, s, out);
 
-        fprintf(out, "\taddrr: r%d r%d r%d\n", *r - 1, *r - 1, *r);
+        _k_emit_rrr(out, "addrr", (const char*)0x0, *r - 1, *r - 1, *r);
 
         *r -= 1;
 
@@ -204,13 +728,17 @@ void _k_assemble_assignment(_k_tree_t *root, int *r, int *s, FILE *out) {
     }
 
     if (memcnt > 0) {
-        fprintf(out, "\tloadr: r%d %s\n", ++(*r), temp->token->str);
+        _k_emit_ra(out, "loadr", ++(*r), temp->token->str);
     }
 
     for (int i = 0; i < memcnt; i++) {
         temp = temp->parent;
 
-        fprintf(out, "\tadszr: r%d r%d %s\n", *r, *r, temp->children[1]->token->str);
+        _k_emit_inst(out, "adszr", (const char*)0x0);
+        _k_emit_reg(out, *r);
+        _k_emit_reg(out, *r);
+        _k_emit_arg(out, temp->children[1]->token->str);
+        _k_emit_end(out);
     }
 
     while (strcmp(temp->token->str, "*") == 0) {
@@ -219,21 +747,35 @@ void _k_assemble_assignment(_k_tree_t *root, int *r, int *s, FILE *out) {
         ptrcnt++;
     }
 
-    if (ptrcnt > 0) fprintf(out, "\tloadr: r%d %s\n", ++(*r), temp->token->str);
+    if (ptrcnt > 0) _k_emit_ra(out, "loadr", ++(*r), temp->token->str);
 
     for (int i = 0; i < ptrcnt - 1; i++) {
-        fprintf(out, "\tderef: r%d r%d\n", *r, *r);
+        _k_emit_rr(out, "deref", (const char*)0x0, *r, *r);
     }
     
     _k_assemble_tree(root->children[1], r, s, out);
 
-    if (ptrcnt > 0) { fprintf(out, "\tsavea: r%d r%d\n", *r - 1, *r); *r -= 2; return; }
+    if (ptrcnt == 1 && memcnt == 0 && arrcnt == 0 && _k_var_type(temp->token->str) != (const char*)0x0) {
+        const char *type = _k_var_type(temp->token->str);
+        _k_kind_e   kind = _k_kind_of(type[0] == '*' ? type + 1 : type);
 
-    if (memcnt > 0) { fprintf(out, "\tsavea: r%d r%d\n", *r - 1, *r); *r -= 2; return; }
+        if (kind != _K_KIND_UNKNOWN) {
+            _k_assemble_convert(*r, _k_wide(kind), out);
 
-    if (arrcnt > 0) { fprintf(out, "\tsavea: r%d r%d\n", *r - 1, *r); *r -= 2; return; }
+            _k_emit_rr(out, "sav", _k_kind_suffix(kind), *r - 1, *r); *r -= 2; return;
+        }
+    }
+
+    if (ptrcnt > 0) { _k_emit_rr(out, "savea", (const char*)0x0, *r - 1, *r); *r -= 2; return; }
+
+    if (memcnt > 0) { _k_emit_rr(out, "savea", (const char*)0x0, *r - 1, *r); *r -= 2; return; }
+
+    if (arrcnt > 0) { _k_emit_rr(out, "savea", (const char*)0x0, *r - 1, *r); *r -= 2; return; }
 
-    fprintf(out, "\tsaver: %s r%d\n", root->children[0]->token->str, (*r)--);
+    /* Stores narrow 32-bit values themselves.  */
+    _k_assemble_convert(*r, _k_wide(_k_var_kind(root->children[0]->token->str)), out);
+
+    _k_emit_ar(out, "saver", root->children[0]->token->str, (*r)--);
 }
 
 /*
@@ -242,21 +784,37 @@ void _k_assemble_assignment(_k_tree_t *root, int *r, int *s, FILE *out) {
  *    @param _k_tree_t *root       The root of the tree.
  *    @param int       *r          The register to compile to.
  *    @param int       *s          The stack to compile to.
- *    @param FILE      *out        The output file.
+ *    @param _k_emitter_t *out    The emitter.
  */
-void _k_assemble_operator(_k_tree_t *root, int *r, int *s, FILE *out) {
+void _k_assemble_operator(_k_tree_t *root, int *r, int *s, _k_emitter_t *out) {
     if (root->child_count > 1) {
         if (strcmp(root->token->str, ".") == 0) {
             if (root->children[0]->token->tokenable->type == _K_TOKEN_TYPE_NUMBER) {
-                fprintf(out, "\tmovrf: r%d %s.%s\n", ++*r, root->children[0]->token->str, root->children[1]->token->str);
+                _k_emit_inst(out, "movrf", (const char*)0x0);
+                _k_emit_reg(out, _k_next_reg(r));
+                _k_emit_arg(out, root->children[0]->token->str);
+                _k_emit_write(out, ".", 1);
+                _k_emit_str(out, root->children[1]->token->str);
+                _k_emit_end(out);
+
+                _k_reg(*r)->kind     = _K_KIND_FLOAT;
+                _k_reg(*r)->constant = 1;
+
+                snprintf(_k_reg(*r)->lit, sizeof(_k_reg(*r)->lit), "%s.%s", root->children[0]->token->str, root->children[1]->token->str);
 
                 return;
             }
 
             _k_assemble_tree(root->children[0], r, s, out);
 
-            fprintf(out, "\tadszr: r%d r%d %s\n", *r, *r, root->children[1]->token->str);
-            fprintf(out, "\tderef: r%d r%d\n", *r, *r);
+            _k_emit_inst(out, "adszr", (const char*)0x0);
+            _k_emit_reg(out, *r);
+            _k_emit_reg(out, *r);
+            _k_emit_arg(out, root->children[1]->token->str);
+            _k_emit_end(out);
+            _k_emit_rr(out, "deref", (const char*)0x0, *r, *r);
+
+            _k_set_kind(*r, _K_KIND_UNKNOWN);
 
             return;
         }
@@ -266,7 +824,14 @@ void _k_assemble_operator(_k_tree_t *root, int *r, int *s, FILE *out) {
         _k_assemble_bin_op(root->token, r, out);
     } else {
         if (strcmp(root->token->str, "&") == 0) {
-            fprintf(out, "\trefsv: r%d %s\n", ++(*r), root->children[0]->token->str);
+            const char *type = _k_var_type(root->children[0]->token->str);
+            char        pointer[32];
+
+            _k_emit_ra(out, "refsv", ++(*r), root->children[0]->token->str);
+
+            snprintf(pointer, 32, "*%s", type != (const char*)0x0 ? type : "");
+
+            _k_set_type(*r, type != (const char*)0x0 ? pointer : (const char*)0x0);
 
             return;
         }
@@ -281,9 +846,9 @@ void _k_assemble_operator(_k_tree_t *root, int *r, int *s, FILE *out) {
  *    @param _k_tree_t *root       The root of the tree.
  *    @param int       *r          The register to compile to.
  *    @param int       *s          The stack to compile to.
- *    @param FILE      *out        The output file.
+ *    @param _k_emitter_t *out    The emitter.
  */
-void _k_assemble_new_expression(_k_tree_t *root, int *r, int *s, FILE *out) {
+void _k_assemble_new_expression(_k_tree_t *root, int *r, int *s, _k_emitter_t *out) {
     for (unsigned long i = 0; i < root->child_count; i++) {
         _k_assemble_tree(root->children[i], r, s, out);
     }
@@ -295,56 +860,156 @@ void _k_assemble_new_expression(_k_tree_t *root, int *r, int *s, FILE *out) {
  *    @param _k_tree_t *root       The root of the tree.
  *    @param int       *r          The register to compile to.
  *    @param int       *s          The stack to compile to.
- *    @param FILE      *out        The output file.
+ *    @param _k_emitter_t *out    The emitter.
  */
-void _k_assemble_new_statement(_k_tree_t *root, int *r, int *s, FILE *out) {
+void _k_assemble_new_statement(_k_tree_t *root, int *r, int *s, _k_emitter_t *out) {
     for (unsigned long i = 0; i < root->child_count; i++) {
         _k_assemble_tree(root->children[i], r, s, out);
     }
 }
 
+/*
+ *    Assembles a condition that branches to a label when it is false.
+ *
+ *    Comparisons are fused into a single conditional jump on two
+ *    registers, or on a register and an immediate when the right hand
+ *    side is a literal. The jump is typed when the kinds of its operands
+ *    are known. Any other condition is materialized and tested against
+ *    zero.
+ *
+ *    @param _k_tree_t *root       The condition.
+ *    @param int       *r          The register to compile to.
+ *    @param int       *s          The stack to compile to.
+ *    @param int        label      The label to jump to.
+ *    @param _k_emitter_t *out    The emitter.
+ */
+void _k_assemble_condition(_k_tree_t *root, int *r, int *s, int label, _k_emitter_t *out) {
+    const char *ops[]  = { "<",   ">",   "<=",  ">=",  "==",  "!=" };
+    const char *jmps[] = { "jge", "jle", "jgt", "jlt", "jne", "jeq" };
+
+    while (root->token->tokenable->type == _K_TOKEN_TYPE_NEWEXPRESSION && root->child_count == 1) {
+        root = root->children[0];
+    }
+
+    for (int i = 0; root->token->tokenable->type == _K_TOKEN_TYPE_OPERATOR && root->child_count == 2 && i < 6; i++) {
+        if (strcmp(root->token->str, ops[i]) != 0) continue;
+
+        _k_tree_t *rhs = root->children[1];
+
+        _k_assemble_tree(root->children[0], r, s, out);
+
+        _k_kind_e kind = _k_wide(_k_reg(*r)->kind);
+
+        if (rhs->token->tokenable->type == _K_TOKEN_TYPE_NUMBER) {
+            const char *form = kind == _K_KIND_INT ? "in" : kind == _K_KIND_FLOAT ? "fn" : "rn";
+
+            _k_emit_inst(out, jmps[i], form);
+            _k_emit_reg(out, (*r)--);
+            _k_emit_arg(out, rhs->token->str);
+            _k_emit_jump(out, label);
+            _k_emit_end(out);
+
+            return;
+        }
+
+        if (strcmp(rhs->token->str, ".") == 0 && rhs->child_count == 2 && rhs->children[0]->token->tokenable->type == _K_TOKEN_TYPE_NUMBER) {
+            if (kind != _K_KIND_UNKNOWN) _k_assemble_convert(*r, _K_KIND_FLOAT, out);
+
+            _k_emit_inst(out, jmps[i], kind == _K_KIND_UNKNOWN ? "rf" : "fn");
+            _k_emit_reg(out, (*r)--);
+            _k_emit_arg(out, rhs->children[0]->token->str);
+            _k_emit_write(out, ".", 1);
+            _k_emit_str(out, rhs->children[1]->token->str);
+            _k_emit_jump(out, label);
+            _k_emit_end(out);
+
+            return;
+        }
+
+        _k_assemble_tree(rhs, r, s, out);
+
+        _k_kind_e common = _k_wide(_k_assemble_promote(*r - 1, *r, out));
+
+        _k_emit_inst(out, jmps[i], _k_kind_suffix(common));
+        _k_emit_reg(out, *r - 1);
+        _k_emit_reg(out, *r);
+        _k_emit_jump(out, label);
+        _k_emit_end(out);
+
+        *r -= 2;
+
+        return;
+    }
+
+    _k_assemble_tree(root, r, s, out);
+
+    _k_emit_inst(out, "cmprd", (const char*)0x0);
+    _k_emit_reg(out, (*r)--);
+    _k_emit_num(out, 0);
+    _k_emit_end(out);
+    _k_emit_inst(out, "jmpeq", (const char*)0x0);
+    _k_emit_jump(out, label);
+    _k_emit_end(out);
+}
+
 /*
  *    Assembles a keyword.
  *
  *    @param _k_tree_t *root       The root of the tree.
  *    @param int       *r          The register to compile to.
  *    @param int       *s          The stack to compile to.
- *    @param FILE      *out        The output file.
+ *    @param _k_emitter_t *out    The emitter.
  */
-void _k_assemble_keyword(_k_tree_t *root, int *r, int *s, FILE *out) {
+void _k_assemble_keyword(_k_tree_t *root, int *r, int *s, _k_emitter_t *out) {
     if (strcmp(root->token->str, "return") == 0) {
         if (root->child_count > 0) {
             _k_assemble_tree(root->children[0], r, s, out);
-            fprintf(out, "\tmovrr: r0 r%d\n", *r);
+
+            if (_k_func != (_k_signature_t*)0x0) _k_assemble_convert(*r, _k_func->ret, out);
+
+            _k_emit_rr(out, "movrr", (const char*)0x0, 0, *r);
         }
 
-        fprintf(out, "\tleave: \n", (*r)--);
+        _k_emit_inst(out, "leave", (const char*)0x0);
+        _k_emit_write(out, " ", 1);
+        _k_emit_end(out);
+
+        (*r)--;
 
         return;
     }
 
     if (strcmp(root->token->str, "if") == 0) {
-        _k_assemble_tree(root->children[0], r, s, out);
+        int end = ++*s;
 
-        fprintf(out, "\tcmprd: r%d 0\n\tjmpeq: S%d\n", (*r)--, ++*s, out);
+        _k_assemble_condition(root->children[0], r, s, end, out);
 
         _k_assemble_tree(root->children[1], r, s, out);
 
-        fprintf(out, "S%d: \n", *s, out);
+        _k_emit_label(out, (const char*)0x0, end);
 
         return;
     }
 
     if (strcmp(root->token->str, "while") == 0) {
-        fprintf(out, "S%d: \n", ++*s, out);
+        int start = ++*s;
+        int end   = ++*s;
 
-        _k_assemble_tree(root->children[0], r, s, out);
+        _k_emit_label(out, (const char*)0x0, start);
 
-        fprintf(out, "\tcmprd: r%d 0\n\tjmpeq: S%d\n", (*r)--, ++*s, out);
+        _k_assemble_condition(root->children[0], r, s, end, out);
 
         _k_assemble_tree(root->children[1], r, s, out);
 
-        fprintf(out, "\tjmpal: S%d\nS%d: \n", *s - 1, *s, out);
+        /* The jump back belongs to the loop header.  */
+        _k_line = root->token->line;
+
+        _k_emit_line(out, root->token->line, root->token->column);
+
+        _k_emit_inst(out, "jmpal", (const char*)0x0);
+        _k_emit_jump(out, start);
+        _k_emit_end(out);
+        _k_emit_label(out, (const char*)0x0, end);
 
         return;
     }
@@ -356,9 +1021,11 @@ void _k_assemble_keyword(_k_tree_t *root, int *r, int *s, FILE *out) {
  *    @param k_env_t    *env       The environment to compile the tree in.
  *    @param _k_tree_t *root       The root of the tree.
  */
-void _k_assemble_tree(_k_tree_t *root, int *r, int *s, FILE *out) {
+void _k_assemble_tree(_k_tree_t *root, int *r, int *s, _k_emitter_t *out) {
     if (root == (_k_tree_t*)0x0) return;
 
+    _k_assemble_line(root, out);
+
     switch (root->token->tokenable->type) {
         case _K_TOKEN_TYPE_DECLARATOR:    { _k_assemble_declarator(root, r, s, out);     break; }
         case _K_TOKEN_TYPE_IDENTIFIER:    { _k_assemble_identifier(root, r, s, out);     break; }
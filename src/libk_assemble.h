@@ -11,9 +11,66 @@
 #ifndef _LIBK_ASSEMBLE_H
 #define _LIBK_ASSEMBLE_H
 
-#include <stdio.h>
-
 #include "types.h"
+#include "libk_emit.h"
+
+typedef enum {
+    _K_KIND_UNKNOWN = 0,
+    _K_KIND_INT,
+    _K_KIND_FLOAT,
+    _K_KIND_WORD,
+    _K_KIND_SINGLE,
+} _k_kind_e;
+
+/*
+ *    Resets the assembler state between modules.
+ */
+void _k_assemble_reset();
+
+/*
+ *    Resets the assembler state for another pass over the same module, keeping the signatures seen so far.
+ */
+void _k_assemble_restart();
+
+/*
+ *    Tells whether the assembler failed on the module so far.
+ *
+ *    @return int    1 if it failed, 0 if not.
+ */
+int _k_assemble_error();
+
+/*
+ *    Sets the name of the source file recorded in the line table.
+ *
+ *    @param const char *name    The name of the source file, or null.
+ */
+void _k_assemble_source(const char *name);
+
+/*
+ *    Gets the kind of value a declared type holds.
+ *
+ *    @param const char *type    The type string.
+ *
+ *    @return _k_kind_e    The kind of the type.
+ */
+_k_kind_e _k_kind_of(const char *type);
+
+/*
+ *    Gets the 64-bit kind a 32-bit kind is held in.
+ *
+ *    @param _k_kind_e kind    The kind.
+ *
+ *    @return _k_kind_e    The wide kind.
+ */
+_k_kind_e _k_wide(_k_kind_e kind);
+
+/*
+ *    Reads a declarator's type.
+ *
+ *    @param _k_tree_t *root    The declarator.
+ *    @param char      *type    The buffer to write the type to.
+ */
+void _k_declared_type(_k_tree_t *root, char *type);
 
 /*
  *    Compiles a tree.
@@ -21,6 +78,6 @@
  *    @param k_env_t    *env       The environment to compile the tree in.
  *    @param _k_tree_t *root       The root of the tree.
  */
-void _k_assemble_tree(_k_tree_t *root, int *r, int *s, FILE *out);
+void _k_assemble_tree(_k_tree_t *root, int *r, int *s, _k_emitter_t *out);
 
 #endif /* _LIBK_ASSEMBLE_H  */
\ No newline at end of file
@@ -18,11 +18,16 @@
 #include "builtin.h"
 
 #include "libk_assemble.h"
+#include "libk_lower.h"
 #include "libk_parse.h"
+#include "libk_x86.h"
 
 int _k_build_error = 0;
 int _s = -1;
 
+/* Set while a module is lowered to C instead of assembled.  */
+int _k_lowering = 0;
+
 /*
  *    Gets the error code.
  *
@@ -44,6 +49,7 @@ char _k_get_prec(char *op) {
     if (strcmp(op, "=") == 0)  return 2;
     if (strcmp(op, "<") == 0)  return 3; if (strcmp(op, ">") == 0)  return 3;
     if (strcmp(op, "<=") == 0) return 3; if (strcmp(op, ">=") == 0) return 3; if (strcmp(op, "==") == 0) return 3;
+    if (strcmp(op, "!=") == 0) return 3;
     if (strcmp(op, "+") == 0)  return 4; if (strcmp(op, "-") == 0)  return 4;
     if (strcmp(op, "*") == 0)  return 5; if (strcmp(op, "/") == 0)  return 5; 
     if (strcmp(op, "^") == 0)  return 6;
@@ -260,9 +266,9 @@ void _k_compile_separator(_k_tree_t **node, _k_token_t *token) {
  *    @param _k_tree_t **node    The start node.
  *    @param _k_tree_t  *root    The root of the tree.
  *    @param _k_token_t**token   The token to compile.
- *    @param FILE       *out     The output file.
+ *    @param _k_emitter_t *out   The emitter.
  */
-void _k_compile_endline(_k_tree_t **node, _k_tree_t *root, _k_token_t **token, FILE *out) {
+void _k_compile_endline(_k_tree_t **node, _k_tree_t *root, _k_token_t **token, _k_emitter_t *out) {
     /* Find next scope.  */
     while ((*node)->token->tokenable->type != _K_TOKEN_TYPE_NEWSTATEMENT && 
             (*node)->parent != (_k_tree_t*)0x0) { (*node) = (*node)->parent; }
@@ -270,7 +276,10 @@ void _k_compile_endline(_k_tree_t **node, _k_tree_t *root, _k_token_t **token, F
     if ((*node)->parent == (_k_tree_t*)0x0) {
         int r = 0;
 
-        _k_assemble_tree(root, &r, &_s, out);
+        if (_k_lowering) _k_lower_tree(root);
+        else             _k_assemble_tree(root, &r, &_s, out);
+
+        if (!_k_lowering && _k_build_error == 0) _k_build_error = _k_assemble_error();
 
         //_k_free_tree(root);
         (*token)++;
@@ -354,7 +363,7 @@ void _k_compile_operator(_k_tree_t **node, _k_token_t *token) {
  *
  *    @return k_build_error_t    The error code.
  */
-void _k_compile_tree(_k_token_t *token, FILE *out, int flags) {
+void _k_compile_tree(_k_token_t *token, _k_emitter_t *out, int flags) {
     _k_tree_t *root = (_k_tree_t*)0x0;
     _k_tree_t *node  = (_k_tree_t*)0x0;
 
@@ -395,6 +404,90 @@ void _k_compile_tree(_k_token_t *token, FILE *out, int flags) {
     } while (token++->tokenable->type != _K_TOKEN_TYPE_EOF);
 }
 
+/*
+ *    Compiles a KAPPA source file through an emitter.
+ *
+ *    @param _k_token_t   *tokens    The tokens to compile.
+ *    @param _k_emitter_t *out       The emitter to write the IR to.
+ *    @param int           flags     The compilation flags.
+ */
+void _k_compile_to(_k_token_t *tokens, _k_emitter_t *out, int flags) {
+    _s             = -1;
+    _k_build_error = 0;
+
+    _k_assemble_reset();
+
+    _k_compile_tree(tokens, out, flags);
+
+    _k_emit_close(out);
+
+    free(tokens);
+}
+
+/*
+ *    Compiles a KAPPA source file to C through an emitter.
+ *
+ *    @param _k_token_t   *tokens    The tokens to compile.
+ *    @param _k_emitter_t *out       The emitter to write the C source to.
+ *    @param int           flags     The compilation flags.
+ */
+void _k_compile_c(_k_token_t *tokens, _k_emitter_t *out, int flags) {
+    _s             = -1;
+    _k_build_error = 0;
+
+    _k_lower_reset();
+
+    _k_lowering = 1;
+
+    _k_compile_tree(tokens, out, flags);
+
+    _k_lowering = 0;
+
+    /* The trees point into the tokens, so the module is lowered before they are freed.  */
+    if (_k_build_error == 0) {
+        int lowered = _k_lower_module(out);
+
+        if (lowered != 0) _k_build_error = lowered == 2 ? 6 : 3;
+    }
+
+    _k_emit_close(out);
+
+    free(tokens);
+}
+
+/*
+ *    Compiles a KAPPA source file to x86-64 assembly through an emitter.
+ *
+ *    @param _k_token_t   *tokens    The tokens to compile.
+ *    @param _k_emitter_t *out       The emitter to write the assembly to.
+ *    @param int           flags     The compilation flags.
+ */
+void _k_compile_x86(_k_token_t *tokens, _k_emitter_t *out, int flags) {
+    _s             = -1;
+    _k_build_error = 0;
+
+    _k_assemble_reset();
+
+    /* A first pass collects the signatures, so calls to functions defined further down are typed.  */
+    _k_emitter_t discard;
+    char         none[1];
+
+    _k_emit_open(&discard, none, sizeof(none), -1);
+    _k_compile_tree(tokens, &discard, 0);
+
+    _s = -1;
+
+    _k_assemble_restart();
+
+    _k_x86_open(out);
+
+    if (_k_build_error == 0) _k_compile_tree(tokens, out, flags);
+
+    if (_k_emit_close(out) != 0 && _k_build_error == 0) _k_build_error = 4;
+
+    free(tokens);
+}
+
 /*
  *    Compiles a KAPPA source file.
  *
@@ -404,17 +497,11 @@ void _k_compile_tree(_k_token_t *token, FILE *out, int flags) {
  *    @return k_build_error_t    The error code.
  */
 char *_k_compile(_k_token_t *tokens, int flags) {
-    char   *out;
-    size_t  size;
-    FILE   *f = open_memstream(&out, &size);
-
-    _s = -1;
+    _k_emitter_t out;
 
-    _k_compile_tree(tokens, f, flags);
+    _k_emit_open(&out, (char*)0x0, 0, -1);
 
-    fclose(f);
-
-    free(tokens);
+    _k_compile_to(tokens, &out, flags);
 
-    return out;
+    return out.buf;
 }
\ No newline at end of file
@@ -11,6 +11,34 @@
 #define _LIBK_COMPILE_H
 
 #include "types.h"
+#include "libk_emit.h"
+
+/*
+ *    Compiles a KAPPA source file through an emitter.
+ *
+ *    @param _k_token_t   *tokens    The tokens to compile.
+ *    @param _k_emitter_t *out       The emitter to write the IR to.
+ *    @param int           flags     The compilation flags.
+ */
+void _k_compile_to(_k_token_t *tokens, _k_emitter_t *out, int flags);
+
+/*
+ *    Compiles a KAPPA source file to C through an emitter.
+ *
+ *    @param _k_token_t   *tokens    The tokens to compile.
+ *    @param _k_emitter_t *out       The emitter to write the C source to.
+ *    @param int           flags     The compilation flags.
+ */
+void _k_compile_c(_k_token_t *tokens, _k_emitter_t *out, int flags);
+
+/*
+ *    Compiles a KAPPA source file to x86-64 assembly through an emitter.
+ *
+ *    @param _k_token_t   *tokens    The tokens to compile.
+ *    @param _k_emitter_t *out       The emitter to write the assembly to.
+ *    @param int           flags     The compilation flags.
+ */
+void _k_compile_x86(_k_token_t *tokens, _k_emitter_t *out, int flags);
 
 /*
  *    Compiles a KAPPA source file.
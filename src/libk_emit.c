@@ -0,0 +1,381 @@
+/*
+ *    libk_emit.c    --    Source for the KAPPA IR emitter
+ *
+ *    Authored by Karl "p0lyh3dron" Kreuze on October 18, 2026
+ * 
+ *    This file is part of the KAPPA project.
+ * 
+ *    This file defines the buffered writer the assembler emits
+ *    its IR through. Operands are formatted by hand rather than
+ *    through stdio.
+ */
+#include "libk_emit.h"
+#include "libk_x86.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ *    Opens an emitter.
+ *
+ *    @param _k_emitter_t  *out    The emitter.
+ *    @param char          *buf    The buffer to write to, or null.
+ *    @param unsigned long  cap    The size of the buffer.
+ *    @param int            fd     The file descriptor to write to, or -1.
+ */
+void _k_emit_open(_k_emitter_t *out, char *buf, unsigned long cap, int fd) {
+    out->fixed = buf != (char*)0x0;
+    out->cap   = cap > 0 || out->fixed ? cap : 0x1000;
+    out->buf   = out->fixed ? buf : malloc(out->cap);
+    out->len   = 0;
+    out->total = 0;
+    out->insts = 0;
+    out->fd    = fd;
+    out->error = out->buf == (char*)0x0;
+
+    out->x86   = (struct _k_x86_s*)0x0;
+}
+
+/*
+ *    Writes the buffer to the file descriptor.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ */
+void _k_emit_flush(_k_emitter_t *out) {
+    unsigned long done = 0;
+
+    while (out->fd >= 0 && done < out->len) {
+        long ret = write(out->fd, out->buf + done, out->len - done);
+
+        if (ret <= 0) { out->error = 1; break; }
+
+        done += ret;
+    }
+
+    if (out->fd >= 0) out->len = 0;
+}
+
+/*
+ *    Flushes the emitter and null terminates its buffer.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ *
+ *    @return int    0 on success, 1 if the target could not translate
+ *                   the IR.
+ */
+int _k_emit_close(_k_emitter_t *out) {
+    int failed = 0;
+
+    if (out->x86 != (struct _k_x86_s*)0x0) failed = _k_x86_close(out);
+
+    _k_emit_flush(out);
+
+    if (out->buf != (char*)0x0 && out->cap > 0) out->buf[out->len < out->cap ? out->len : out->cap - 1] = '\0';
+
+    return failed;
+}
+
+/*
+ *    Writes raw bytes to the output, past any target.
+ *
+ *    @param _k_emitter_t  *out     The emitter.
+ *    @param const char    *data    The bytes to write.
+ *    @param unsigned long  n       The number of bytes.
+ */
+void _k_emit_bytes(_k_emitter_t *out, const char *data, unsigned long n) {
+    out->total += n;
+
+    if (out->error) return;
+
+    /* Keep a byte free for the terminator.  */
+    if (out->len + n + 1 > out->cap) {
+        _k_emit_flush(out);
+
+        if (out->len + n + 1 > out->cap && out->fd >= 0) {
+            while (n > 0) {
+                long ret = write(out->fd, data, n);
+
+                if (ret <= 0) { out->error = 1; return; }
+
+                data += ret;
+                n    -= ret;
+            }
+
+            return;
+        }
+
+        if (out->len + n + 1 > out->cap && !out->fixed) {
+            unsigned long cap = out->cap;
+
+            while (out->len + n + 1 > cap) cap *= 2;
+
+            char *buf = realloc(out->buf, cap);
+
+            if (buf == (char*)0x0) { out->error = 1; return; }
+
+            out->buf = buf;
+            out->cap = cap;
+        }
+
+        /* A caller's buffer keeps what fits.  */
+        if (out->len + n + 1 > out->cap) n = out->cap > out->len + 1 ? out->cap - out->len - 1 : 0;
+    }
+
+    memcpy(out->buf + out->len, data, n);
+
+    out->len += n;
+}
+
+/*
+ *    Writes raw bytes.
+ *
+ *    @param _k_emitter_t  *out     The emitter.
+ *    @param const char    *data    The bytes to write.
+ *    @param unsigned long  n       The number of bytes.
+ */
+void _k_emit_write(_k_emitter_t *out, const char *data, unsigned long n) {
+    if (out->x86 == (struct _k_x86_s*)0x0) { _k_emit_bytes(out, data, n); return; }
+
+    _k_x86_write(out, data, n);
+}
+
+/*
+ *    Writes a string.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ *    @param const char   *str    The string to write.
+ */
+void _k_emit_str(_k_emitter_t *out, const char *str) {
+    _k_emit_write(out, str, strlen(str));
+}
+
+/*
+ *    Starts an instruction, writing its mnemonic.
+ *
+ *    @param _k_emitter_t *out       The emitter.
+ *    @param const char   *op        The operation.
+ *    @param const char   *suffix    The operand suffix, or null.
+ */
+void _k_emit_inst(_k_emitter_t *out, const char *op, const char *suffix) {
+    char          buf[16];
+    unsigned long n = 0;
+
+    buf[n++] = '\t';
+
+    while (*op != '\0' && n < 12) buf[n++] = *op++;
+
+    while (suffix != (const char*)0x0 && *suffix != '\0' && n < 14) buf[n++] = *suffix++;
+
+    buf[n++] = ':';
+
+    _k_emit_write(out, buf, n);
+
+    out->insts++;
+}
+
+/*
+ *    Formats a number.
+ *
+ *    @param char *buf    The end of the buffer to format into.
+ *    @param long  num    The number.
+ *
+ *    @return char *    The start of the formatted number.
+ */
+char *_k_format_num(char *buf, long num) {
+    unsigned long val = num < 0 ? -(unsigned long)num : (unsigned long)num;
+
+    do {
+        *--buf = '0' + val % 10;
+        val   /= 10;
+    } while (val > 0);
+
+    if (num < 0) *--buf = '-';
+
+    return buf;
+}
+
+/*
+ *    Writes a register operand.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ *    @param long          reg    The register.
+ */
+void _k_emit_reg(_k_emitter_t *out, long reg) {
+    char  buf[24];
+    char *start = _k_format_num(buf + sizeof(buf), reg);
+
+    *--start = 'r';
+    *--start = ' ';
+
+    _k_emit_write(out, start, buf + sizeof(buf) - start);
+}
+
+/*
+ *    Writes a number operand.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ *    @param long          num    The number.
+ */
+void _k_emit_num(_k_emitter_t *out, long num) {
+    char  buf[24];
+    char *start = _k_format_num(buf + sizeof(buf), num);
+
+    *--start = ' ';
+
+    _k_emit_write(out, start, buf + sizeof(buf) - start);
+}
+
+/*
+ *    Writes a symbolic operand.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ *    @param const char   *arg    The operand.
+ */
+void _k_emit_arg(_k_emitter_t *out, const char *arg) {
+    _k_emit_write(out, " ", 1);
+    _k_emit_str(out, arg);
+}
+
+/*
+ *    Writes a statement label operand.
+ *
+ *    @param _k_emitter_t *out      The emitter.
+ *    @param long          label    The label.
+ */
+void _k_emit_jump(_k_emitter_t *out, long label) {
+    char  buf[24];
+    char *start = _k_format_num(buf + sizeof(buf), label);
+
+    *--start = 'S';
+    *--start = ' ';
+
+    _k_emit_write(out, start, buf + sizeof(buf) - start);
+}
+
+/*
+ *    Ends an instruction.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ */
+void _k_emit_end(_k_emitter_t *out) {
+    _k_emit_write(out, "\n", 1);
+}
+
+/*
+ *    Writes a label.
+ *
+ *    @param _k_emitter_t *out      The emitter.
+ *    @param const char   *name     The name of the label, or null for a statement label.
+ *    @param long          label    The statement label.
+ */
+void _k_emit_label(_k_emitter_t *out, const char *name, long label) {
+    if (name != (const char*)0x0) {
+        _k_emit_str(out, name);
+    } else {
+        char  buf[24];
+        char *start = _k_format_num(buf + sizeof(buf), label);
+
+        *--start = 'S';
+
+        _k_emit_write(out, start, buf + sizeof(buf) - start);
+    }
+
+    _k_emit_write(out, ": \n", 3);
+}
+
+/*
+ *    Writes the label a function starts at, behind a .func entry naming
+ *    it and its signature.
+ *
+ *    @param _k_emitter_t *out       The emitter.
+ *    @param const char   *name      The name of the function.
+ *    @param const char   *ret       The type the function returns.
+ *    @param const char   *params    The types of its parameters, separated by spaces.
+ */
+void _k_emit_func(_k_emitter_t *out, const char *name, const char *ret, const char *params) {
+    _k_emit_write(out, ".func:", 6);
+    _k_emit_arg(out, name);
+    _k_emit_arg(out, ret);
+
+    if (params[0] != '\0') _k_emit_arg(out, params);
+
+    _k_emit_end(out);
+    _k_emit_label(out, name, 0);
+}
+
+/*
+ *    Writes a line table entry for the instructions that follow.
+ *
+ *    @param _k_emitter_t *out       The emitter.
+ *    @param long          line      The source line.
+ *    @param long          column    The source column.
+ */
+void _k_emit_line(_k_emitter_t *out, long line, long column) {
+    _k_emit_write(out, ".line:", 6);
+    _k_emit_num(out, line);
+    _k_emit_num(out, column);
+    _k_emit_end(out);
+}
+
+/*
+ *    Writes the name of the source file the line table refers to.
+ *
+ *    @param _k_emitter_t *out     The emitter.
+ *    @param const char   *name    The name of the source file.
+ */
+void _k_emit_file(_k_emitter_t *out, const char *name) {
+    _k_emit_write(out, ".file:", 6);
+    _k_emit_arg(out, name);
+    _k_emit_end(out);
+}
+
+/*
+ *    Emits an instruction on one register.
+ */
+void _k_emit_r(_k_emitter_t *out, const char *op, const char *suffix, long a) {
+    _k_emit_inst(out, op, suffix);
+    _k_emit_reg(out, a);
+    _k_emit_end(out);
+}
+
+/*
+ *    Emits an instruction on two registers.
+ */
+void _k_emit_rr(_k_emitter_t *out, const char *op, const char *suffix, long a, long b) {
+    _k_emit_inst(out, op, suffix);
+    _k_emit_reg(out, a);
+    _k_emit_reg(out, b);
+    _k_emit_end(out);
+}
+
+/*
+ *    Emits an instruction on three registers.
+ */
+void _k_emit_rrr(_k_emitter_t *out, const char *op, const char *suffix, long a, long b, long c) {
+    _k_emit_inst(out, op, suffix);
+    _k_emit_reg(out, a);
+    _k_emit_reg(out, b);
+    _k_emit_reg(out, c);
+    _k_emit_end(out);
+}
+
+/*
+ *    Emits an instruction on a register and a symbolic operand.
+ */
+void _k_emit_ra(_k_emitter_t *out, const char *op, long a, const char *arg) {
+    _k_emit_inst(out, op, (const char*)0x0);
+    _k_emit_reg(out, a);
+    _k_emit_arg(out, arg);
+    _k_emit_end(out);
+}
+
+/*
+ *    Emits an instruction on a symbolic operand and a register.
+ */
+void _k_emit_ar(_k_emitter_t *out, const char *op, const char *arg, long a) {
+    _k_emit_inst(out, op, (const char*)0x0);
+    _k_emit_arg(out, arg);
+    _k_emit_reg(out, a);
+    _k_emit_end(out);
+}
@@ -0,0 +1,200 @@
+/*
+ *    libk_emit.h    --    Header for the KAPPA IR emitter
+ *
+ *    Authored by Karl "p0lyh3dron" Kreuze on October 18, 2026
+ * 
+ *    This file is part of the KAPPA project.
+ * 
+ *    This file declares the buffered writer the assembler emits
+ *    its IR through, either into memory or to a file descriptor.
+ */
+#ifndef _LIBK_EMIT_H
+#define _LIBK_EMIT_H
+
+struct _k_x86_s;
+
+typedef struct {
+    char          *buf;
+    unsigned long  len;
+    unsigned long  cap;
+
+    unsigned long  total;
+    unsigned long  insts;
+
+    int            fd;
+    int            fixed;
+    int            error;
+
+    /* With a target, the IR is translated rather than written.  */
+    struct _k_x86_s *x86;
+} _k_emitter_t;
+
+/*
+ *    Opens an emitter.
+ *
+ *    Without a buffer, one is allocated and grown as needed. A caller
+ *    provided buffer is never grown, output past its end is counted
+ *    but dropped. With a file descriptor, the buffer is flushed to it
+ *    whenever it fills up.
+ *
+ *    @param _k_emitter_t  *out    The emitter.
+ *    @param char          *buf    The buffer to write to, or null.
+ *    @param unsigned long  cap    The size of the buffer.
+ *    @param int            fd     The file descriptor to write to, or -1.
+ */
+void _k_emit_open(_k_emitter_t *out, char *buf, unsigned long cap, int fd);
+
+/*
+ *    Writes the buffer to the file descriptor, if any.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ */
+void _k_emit_flush(_k_emitter_t *out);
+
+/*
+ *    Flushes the emitter and null terminates its buffer.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ *
+ *    @return int    0 on success, 1 if the target could not translate
+ *                   the IR.
+ */
+int _k_emit_close(_k_emitter_t *out);
+
+/*
+ *    Writes raw bytes to the output, past any target.
+ *
+ *    @param _k_emitter_t  *out     The emitter.
+ *    @param const char    *data    The bytes to write.
+ *    @param unsigned long  n       The number of bytes.
+ */
+void _k_emit_bytes(_k_emitter_t *out, const char *data, unsigned long n);
+
+/*
+ *    Writes raw bytes.
+ *
+ *    @param _k_emitter_t  *out     The emitter.
+ *    @param const char    *data    The bytes to write.
+ *    @param unsigned long  n       The number of bytes.
+ */
+void _k_emit_write(_k_emitter_t *out, const char *data, unsigned long n);
+
+/*
+ *    Writes a string.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ *    @param const char   *str    The string to write.
+ */
+void _k_emit_str(_k_emitter_t *out, const char *str);
+
+/*
+ *    Starts an instruction, writing its mnemonic.
+ *
+ *    @param _k_emitter_t *out       The emitter.
+ *    @param const char   *op        The operation.
+ *    @param const char   *suffix    The operand suffix, or null.
+ */
+void _k_emit_inst(_k_emitter_t *out, const char *op, const char *suffix);
+
+/*
+ *    Writes a register operand.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ *    @param long          reg    The register.
+ */
+void _k_emit_reg(_k_emitter_t *out, long reg);
+
+/*
+ *    Writes a number operand.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ *    @param long          num    The number.
+ */
+void _k_emit_num(_k_emitter_t *out, long num);
+
+/*
+ *    Writes a symbolic operand.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ *    @param const char   *arg    The operand.
+ */
+void _k_emit_arg(_k_emitter_t *out, const char *arg);
+
+/*
+ *    Writes a statement label operand.
+ *
+ *    @param _k_emitter_t *out      The emitter.
+ *    @param long          label    The label.
+ */
+void _k_emit_jump(_k_emitter_t *out, long label);
+
+/*
+ *    Ends an instruction.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ */
+void _k_emit_end(_k_emitter_t *out);
+
+/*
+ *    Writes a label.
+ *
+ *    @param _k_emitter_t *out      The emitter.
+ *    @param const char   *name     The name of the label, or null for a statement label.
+ *    @param long          label    The statement label.
+ */
+void _k_emit_label(_k_emitter_t *out, const char *name, long label);
+
+/*
+ *    Writes the label a function starts at, behind a .func entry naming
+ *    it and its signature.
+ *
+ *    @param _k_emitter_t *out       The emitter.
+ *    @param const char   *name      The name of the function.
+ *    @param const char   *ret       The type the function returns.
+ *    @param const char   *params    The types of its parameters, separated by spaces.
+ */
+void _k_emit_func(_k_emitter_t *out, const char *name, const char *ret, const char *params);
+
+/*
+ *    Writes a line table entry for the instructions that follow.
+ *
+ *    @param _k_emitter_t *out       The emitter.
+ *    @param long          line      The source line.
+ *    @param long          column    The source column.
+ */
+void _k_emit_line(_k_emitter_t *out, long line, long column);
+
+/*
+ *    Writes the name of the source file the line table refers to.
+ *
+ *    @param _k_emitter_t *out     The emitter.
+ *    @param const char   *name    The name of the source file.
+ */
+void _k_emit_file(_k_emitter_t *out, const char *name);
+
+/*
+ *    Emits an instruction on one register.
+ */
+void _k_emit_r(_k_emitter_t *out, const char *op, const char *suffix, long a);
+
+/*
+ *    Emits an instruction on two registers.
+ */
+void _k_emit_rr(_k_emitter_t *out, const char *op, const char *suffix, long a, long b);
+
+/*
+ *    Emits an instruction on three registers.
+ */
+void _k_emit_rrr(_k_emitter_t *out, const char *op, const char *suffix, long a, long b, long c);
+
+/*
+ *    Emits an instruction on a register and a symbolic operand.
+ */
+void _k_emit_ra(_k_emitter_t *out, const char *op, long a, const char *arg);
+
+/*
+ *    Emits an instruction on a symbolic operand and a register.
+ */
+void _k_emit_ar(_k_emitter_t *out, const char *op, const char *arg, long a);
+
+#endif /* _LIBK_EMIT_H  */
@@ -0,0 +1,959 @@
+/*
+ *    libk_lower.c    --    Source for the KAPPA to C lowering
+ *
+ *    Authored by Karl "p0lyh3dron" Kreuze on October 18, 2026
+ *
+ *    This file is part of the KAPPA project.
+ *
+ *    This file defines how compiled KAPPA source trees are lowered
+ *    to portable C, one C function per KAPPA function, so that a C
+ *    compiler can build them into a shared object ahead of time.
+ *
+ *    Values follow the same typing the assembler gives the IR, so
+ *    lowered functions compute the same results as the interpreter:
+ *    64-bit integers are signed longs, u32 values wrap to 32 bits,
+ *    and f32 arithmetic is rounded to single precision after every
+ *    operation, with literals kept at double precision.
+ */
+#include "libk_lower.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libk_assemble.h"
+
+typedef struct {
+    _k_kind_e  kind;
+    int        constant;
+    char       type[32];
+} _k_value_t;
+
+typedef struct {
+    char      *name;
+    char       ret[32];
+    _k_tree_t *params;
+    _k_tree_t *body;
+} _k_prototype_t;
+
+typedef struct {
+    char *name;
+    char  type[32];
+} _k_local_t;
+
+_k_tree_t      *_k_lower_trees      = (_k_tree_t*)0x0;
+unsigned long   _k_lower_tree_count = 0;
+
+_k_prototype_t *_k_lower_funcs      = (_k_prototype_t*)0x0;
+unsigned long   _k_lower_func_count = 0;
+_k_prototype_t *_k_lower_func       = (_k_prototype_t*)0x0;
+
+_k_local_t     *_k_lower_locals      = (_k_local_t*)0x0;
+unsigned long   _k_lower_local_count = 0;
+
+int             _k_lower_failed     = 0;
+int             _k_lower_redeclared = 0;
+
+/*
+ *    Resets the lowering state between modules.
+ */
+void _k_lower_reset() {
+    free(_k_lower_trees);
+    free(_k_lower_funcs);
+    free(_k_lower_locals);
+
+    _k_lower_trees       = (_k_tree_t*)0x0;
+    _k_lower_tree_count  = 0;
+    _k_lower_funcs       = (_k_prototype_t*)0x0;
+    _k_lower_func_count  = 0;
+    _k_lower_func        = (_k_prototype_t*)0x0;
+    _k_lower_locals      = (_k_local_t*)0x0;
+    _k_lower_local_count = 0;
+    _k_lower_failed      = 0;
+    _k_lower_redeclared  = 0;
+}
+
+/*
+ *    Records a top level tree of the module to lower.
+ *
+ *    Trees are lowered once the whole module is known, so that calls
+ *    to functions defined further down are typed. The compiler reuses
+ *    the root node for the next statement, so it is copied.
+ *
+ *    @param _k_tree_t *root    The root of the tree.
+ */
+void _k_lower_tree(_k_tree_t *root) {
+    _k_lower_trees = realloc(_k_lower_trees, sizeof(_k_tree_t) * (_k_lower_tree_count + 1));
+
+    _k_lower_trees[_k_lower_tree_count++] = *root;
+}
+
+/*
+ *    Writes the C type a declared type is held in.
+ *
+ *    @param const char *type    The type string.
+ *    @param char       *buf     The buffer to write the C type to.
+ */
+void _k_lower_ctype(const char *type, char *buf) {
+    unsigned long depth = strspn(type, "*");
+    const char   *base  = type + depth;
+    const char   *ctype = "long";
+
+    switch (_k_kind_of(base)) {
+        case _K_KIND_SINGLE: ctype = "float";        break;
+        case _K_KIND_FLOAT:  ctype = "double";       break;
+        case _K_KIND_WORD:   ctype = "unsigned int"; break;
+        case _K_KIND_INT:    ctype = "long";         break;
+        default:             ctype = depth > 0 ? "void" : "long"; break;
+    }
+
+    snprintf(buf, 64, "%s%.*s", ctype, (int)depth, "********************************");
+}
+
+/*
+ *    Finds the prototype of a function in the module.
+ *
+ *    @param const char *name    The name of the function.
+ *
+ *    @return _k_prototype_t *    The prototype, or null if it is not defined.
+ */
+_k_prototype_t *_k_lower_find_func(const char *name) {
+    for (unsigned long i = 0; i < _k_lower_func_count; i++) {
+        if (strcmp(_k_lower_funcs[i].name, name) == 0) return &_k_lower_funcs[i];
+    }
+
+    return (_k_prototype_t*)0x0;
+}
+
+/*
+ *    Gets the declared type of a local of the current function.
+ *
+ *    @param const char *name    The name of the local.
+ *
+ *    @return const char *    The type, or null if it is not declared.
+ */
+const char *_k_lower_local_type(const char *name) {
+    for (unsigned long i = 0; i < _k_lower_local_count; i++) {
+        if (strcmp(_k_lower_locals[i].name, name) == 0) return _k_lower_locals[i].type;
+    }
+
+    return (const char*)0x0;
+}
+
+/*
+ *    Declares a local of the current function, once per name. Declaring
+ *    it again with another type fails the lowering.
+ *
+ *    @param const char *name    The name of the local.
+ *    @param const char *type    The type of the local.
+ */
+void _k_lower_declare(const char *name, const char *type) {
+    const char *declared = _k_lower_local_type(name);
+
+    if (declared != (const char*)0x0) {
+        if (strcmp(declared, type) != 0) _k_lower_redeclared = 1;
+
+        return;
+    }
+
+    _k_lower_locals = realloc(_k_lower_locals, sizeof(_k_local_t) * (_k_lower_local_count + 1));
+
+    _k_lower_locals[_k_lower_local_count].name = (char*)name;
+
+    snprintf(_k_lower_locals[_k_lower_local_count].type, sizeof(_k_lower_locals[_k_lower_local_count].type), "%s", type);
+
+    _k_lower_local_count++;
+}
+
+/*
+ *    Sets a value to hold a declared type.
+ *
+ *    @param _k_value_t *v       The value.
+ *    @param const char *type    The type.
+ */
+void _k_lower_typed(_k_value_t *v, const char *type) {
+    snprintf(v->type, sizeof(v->type), "%s", type);
+
+    v->kind = _k_kind_of(type);
+}
+
+/*
+ *    Gets the index of a binary operator, comparisons first.
+ *
+ *    @param const char *op    The operator.
+ *
+ *    @return int    The index, or -1 if it is not one the IR has.
+ */
+int _k_lower_bin_op(const char *op) {
+    const char *ops[] = { "<", ">", "<=", ">=", "==", "!=", "+", "-", "*", "/" };
+
+    for (int i = 0; i < 10; i++) {
+        if (strcmp(op, ops[i]) == 0) return i;
+    }
+
+    return -1;
+}
+
+/*
+ *    Tells whether a node is a float literal.
+ *
+ *    @param _k_tree_t *root    The node.
+ *
+ *    @return int    1 if the node is a float literal.
+ */
+int _k_lower_is_float(_k_tree_t *root) {
+    return strcmp(root->token->str, ".") == 0 && root->child_count == 2 && root->children[0]->token->tokenable->type == _K_TOKEN_TYPE_NUMBER;
+}
+
+/*
+ *    Brings two values to the kind the assembler would operate on them in.
+ *
+ *    @param _k_value_t *a    The first value.
+ *    @param _k_value_t *b    The second value.
+ *
+ *    @return _k_kind_e    The common kind, unknown if either value is.
+ */
+_k_kind_e _k_lower_promote(_k_value_t *a, _k_value_t *b) {
+    _k_kind_e ka = a->kind;
+    _k_kind_e kb = b->kind;
+
+    if (ka == _K_KIND_UNKNOWN || kb == _K_KIND_UNKNOWN) return _K_KIND_UNKNOWN;
+
+    if (_k_wide(ka) != _k_wide(kb)) {
+        if (_k_wide(ka) == _K_KIND_INT) ka = _K_KIND_FLOAT;
+        if (_k_wide(kb) == _K_KIND_INT) kb = _K_KIND_FLOAT;
+    }
+
+    if (ka == kb) return ka;
+
+    if (a->constant) return kb;
+    if (b->constant) return ka;
+
+    return _k_wide(ka);
+}
+
+/*
+ *    Types an expression without lowering it.
+ *
+ *    @param _k_tree_t  *root    The expression.
+ *    @param _k_value_t *v       The value to fill in, of unknown kind
+ *                               if the expression has no C lowering.
+ */
+void _k_lower_value(_k_tree_t *root, _k_value_t *v) {
+    memset(v, 0, sizeof(_k_value_t));
+
+    switch (root->token->tokenable->type) {
+        case _K_TOKEN_TYPE_NEWEXPRESSION: {
+            if (root->child_count == 1) _k_lower_value(root->children[0], v);
+
+            return;
+        }
+        case _K_TOKEN_TYPE_NUMBER: {
+            v->kind     = _K_KIND_INT;
+            v->constant = 1;
+
+            return;
+        }
+        case _K_TOKEN_TYPE_IDENTIFIER: {
+            if (root->child_count > 0 && root->children[0]->token->tokenable->type == _K_TOKEN_TYPE_NEWEXPRESSION) {
+                _k_prototype_t *func = _k_lower_find_func(root->token->str);
+
+                if (func != (_k_prototype_t*)0x0 && func->params->child_count == root->children[0]->child_count) _k_lower_typed(v, func->ret);
+
+                return;
+            }
+
+            const char *type = _k_lower_local_type(root->token->str);
+
+            if (root->child_count == 0 && type != (const char*)0x0) _k_lower_typed(v, type);
+
+            return;
+        }
+        case _K_TOKEN_TYPE_OPERATOR: {
+            if (_k_lower_is_float(root)) {
+                v->kind     = _K_KIND_FLOAT;
+                v->constant = 1;
+
+                return;
+            }
+
+            if (root->child_count == 2) {
+                int        op = _k_lower_bin_op(root->token->str);
+                _k_value_t a;
+                _k_value_t b;
+
+                if (op < 0) return;
+
+                _k_lower_value(root->children[0], &a);
+                _k_lower_value(root->children[1], &b);
+
+                v->kind = _k_lower_promote(&a, &b);
+
+                /* Comparisons give an integer.  */
+                if (op < 6 && v->kind != _K_KIND_UNKNOWN) v->kind = _K_KIND_INT;
+
+                return;
+            }
+
+            if (root->child_count != 1) return;
+
+            if (strcmp(root->token->str, "&") == 0) {
+                const char *type = _k_lower_local_type(root->children[0]->token->str);
+
+                if (root->children[0]->token->tokenable->type != _K_TOKEN_TYPE_IDENTIFIER || type == (const char*)0x0) return;
+
+                /* Types are at most 31 characters, the pointer's included.  */
+                snprintf(v->type, sizeof(v->type), "*%.*s", (int)sizeof(v->type) - 2, type);
+
+                v->kind = _K_KIND_INT;
+
+                return;
+            }
+
+            _k_lower_value(root->children[0], v);
+
+            if (strcmp(root->token->str, "-") == 0) {
+                v->constant = 0;
+                v->type[0]  = '\0';
+
+                return;
+            }
+
+            /* Values not declared as pointers point to their own type.  */
+            if (strcmp(root->token->str, "*") == 0 && v->type[0] != '\0') {
+                char pointee[32];
+
+                snprintf(pointee, sizeof(pointee), "%s", v->type[0] == '*' ? v->type + 1 : v->type);
+
+                memset(v, 0, sizeof(_k_value_t));
+
+                if (_k_kind_of(pointee) != _K_KIND_UNKNOWN) _k_lower_typed(v, pointee);
+
+                return;
+            }
+
+            memset(v, 0, sizeof(_k_value_t));
+
+            return;
+        }
+        default: return;
+    }
+}
+
+/*
+ *    Writes the indentation of a statement.
+ *
+ *    @param _k_emitter_t *out      The emitter.
+ *    @param int           depth    The nesting depth.
+ */
+void _k_lower_indent(_k_emitter_t *out, int depth) {
+    for (int i = 0; i < depth; i++) _k_emit_write(out, "    ", 4);
+}
+
+void _k_lower_expression(_k_tree_t *root, _k_emitter_t *out);
+
+/*
+ *    Lowers an operand of an operation of a given kind.
+ *
+ *    Integers are widened to doubles for float operations, the way
+ *    the assembler converts them, and narrow values are widened to
+ *    the 64-bit registers they would be held in.
+ *
+ *    @param _k_tree_t    *root    The operand.
+ *    @param _k_value_t   *v       The type of the operand.
+ *    @param _k_kind_e     kind    The kind of the operation.
+ *    @param _k_emitter_t *out     The emitter.
+ */
+void _k_lower_operand(_k_tree_t *root, _k_value_t *v, _k_kind_e kind, _k_emitter_t *out) {
+    const char *cast = (const char*)0x0;
+    char        ctype[64];
+
+    _k_lower_ctype(v->type[0] != '\0' ? v->type : "u64", ctype);
+
+    if (_k_wide(v->kind) == _K_KIND_INT && _k_wide(kind) == _K_KIND_FLOAT) cast = "(double)(";
+    else if (kind == _K_KIND_FLOAT && v->kind == _K_KIND_SINGLE)           cast = "(double)(";
+    else if (kind == _K_KIND_INT && (v->kind == _K_KIND_WORD || strcmp(ctype, "long") != 0)) cast = "(long)(";
+
+    if (cast != (const char*)0x0) _k_emit_str(out, cast);
+
+    _k_lower_expression(root, out);
+
+    if (cast != (const char*)0x0) _k_emit_str(out, ")");
+}
+
+/*
+ *    Lowers an expression converted to a kind.
+ *
+ *    Conversions match the assembler's, converting between integers
+ *    and floats and rounding or wrapping values to 32 bits. Casts of
+ *    literals are folded by the C compiler.
+ *
+ *    @param _k_tree_t    *root    The expression.
+ *    @param _k_kind_e     kind    The kind to convert to.
+ *    @param _k_emitter_t *out     The emitter.
+ */
+void _k_lower_convert(_k_tree_t *root, _k_kind_e kind, _k_emitter_t *out) {
+    _k_value_t v;
+    int        close = 0;
+
+    _k_lower_value(root, &v);
+
+    if (kind != _K_KIND_UNKNOWN && kind != v.kind && v.kind != _K_KIND_UNKNOWN) {
+        if (kind == _K_KIND_WORD   && v.kind != _K_KIND_WORD)   { _k_emit_str(out, "(unsigned int)("); close++; }
+        if (kind == _K_KIND_SINGLE && v.kind != _K_KIND_SINGLE) { _k_emit_str(out, "(float)(");        close++; }
+
+        if (_k_wide(v.kind) != _k_wide(kind)) { _k_emit_str(out, _k_wide(kind) == _K_KIND_FLOAT ? "(double)(" : "(long)("); close++; }
+    }
+
+    _k_lower_expression(root, out);
+
+    while (close-- > 0) _k_emit_str(out, ")");
+}
+
+/*
+ *    Lowers an expression converted to a declared type, for a store.
+ *
+ *    @param _k_tree_t    *root    The expression.
+ *    @param const char   *type    The type stored to.
+ *    @param _k_emitter_t *out     The emitter.
+ */
+void _k_lower_store(_k_tree_t *root, const char *type, _k_emitter_t *out) {
+    _k_value_t v;
+    char       ctype[64];
+
+    _k_lower_value(root, &v);
+
+    if (type[0] != '*' || strcmp(v.type, type) == 0) {
+        _k_lower_convert(root, _k_wide(_k_kind_of(type)), out);
+
+        return;
+    }
+
+    /* Addresses are stored whole.  */
+    _k_lower_ctype(type, ctype);
+
+    _k_emit_str(out, "(");
+    _k_emit_str(out, ctype);
+    _k_emit_str(out, ")(");
+    _k_lower_convert(root, _K_KIND_INT, out);
+    _k_emit_str(out, ")");
+}
+
+/*
+ *    Lowers a call to a function of the module.
+ *
+ *    @param _k_tree_t    *root    The call.
+ *    @param _k_emitter_t *out     The emitter.
+ */
+void _k_lower_call(_k_tree_t *root, _k_emitter_t *out) {
+    _k_prototype_t *func = _k_lower_find_func(root->token->str);
+    _k_tree_t      *args = root->children[0];
+
+    if (func == (_k_prototype_t*)0x0 || func->params->child_count != args->child_count) { _k_lower_failed = 1; return; }
+
+    _k_emit_str(out, _K_LOWER_PREFIX);
+    _k_emit_str(out, root->token->str);
+    _k_emit_str(out, "(");
+
+    for (unsigned long i = 0; i < args->child_count; i++) {
+        char param[32];
+
+        _k_declared_type(func->params->children[i], param);
+
+        if (i > 0) _k_emit_str(out, ", ");
+
+        _k_lower_store(args->children[i], param, out);
+    }
+
+    _k_emit_str(out, ")");
+}
+
+/*
+ *    Lowers an expression.
+ *
+ *    @param _k_tree_t    *root    The expression.
+ *    @param _k_emitter_t *out     The emitter.
+ */
+void _k_lower_expression(_k_tree_t *root, _k_emitter_t *out) {
+    const char *ops[] = { "<", ">", "<=", ">=", "==", "!=", "+", "-", "*", "/" };
+    _k_value_t  v;
+
+    _k_lower_value(root, &v);
+
+    if (v.kind == _K_KIND_UNKNOWN) { _k_lower_failed = 1; return; }
+
+    switch (root->token->tokenable->type) {
+        case _K_TOKEN_TYPE_NEWEXPRESSION: {
+            _k_lower_expression(root->children[0], out);
+
+            return;
+        }
+        case _K_TOKEN_TYPE_NUMBER: {
+            _k_emit_str(out, root->token->str);
+
+            return;
+        }
+        case _K_TOKEN_TYPE_IDENTIFIER: {
+            if (root->child_count > 0) _k_lower_call(root, out);
+            else                       _k_emit_str(out, root->token->str);
+
+            return;
+        }
+        default: break;
+    }
+
+    if (_k_lower_is_float(root)) {
+        _k_emit_str(out, root->children[0]->token->str);
+        _k_emit_str(out, ".");
+        _k_emit_str(out, root->children[1]->token->str);
+
+        return;
+    }
+
+    if (root->child_count == 2) {
+        int        op = _k_lower_bin_op(root->token->str);
+        _k_value_t a;
+        _k_value_t b;
+
+        _k_lower_value(root->children[0], &a);
+        _k_lower_value(root->children[1], &b);
+
+        _k_kind_e kind = _k_lower_promote(&a, &b);
+
+        /* Comparisons do not depend on the width of their operands.  */
+        if (op < 6) kind = _k_wide(kind);
+
+        /* 32-bit results are rounded or wrapped, the operands are not.  */
+        if (op >= 6 && kind == _K_KIND_SINGLE) _k_emit_str(out, "(float)");
+        if (op >= 6 && kind == _K_KIND_WORD)   _k_emit_str(out, "(unsigned int)");
+
+        /* Float comparisons go through _k_cmpf, for NaNs to compare as in the interpreter.  */
+        if (op < 6 && kind == _K_KIND_FLOAT) {
+            _k_emit_str(out, "(_k_cmpf(");
+            _k_lower_operand(root->children[0], &a, kind, out);
+            _k_emit_str(out, ", ");
+            _k_lower_operand(root->children[1], &b, kind, out);
+            _k_emit_str(out, ") ");
+            _k_emit_str(out, ops[op]);
+            _k_emit_str(out, " 0)");
+
+            return;
+        }
+
+        /* Integers wrap as they do in the interpreter, which signed overflow in C need not.  */
+        if (op >= 6 && op < 9 && kind == _K_KIND_INT) {
+            _k_emit_str(out, "(long)((unsigned long)");
+            _k_lower_operand(root->children[0], &a, kind, out);
+            _k_emit_str(out, " ");
+            _k_emit_str(out, ops[op]);
+            _k_emit_str(out, " (unsigned long)");
+            _k_lower_operand(root->children[1], &b, kind, out);
+            _k_emit_str(out, ")");
+
+            return;
+        }
+
+        _k_emit_str(out, "(");
+        _k_lower_operand(root->children[0], &a, kind, out);
+        _k_emit_str(out, " ");
+        _k_emit_str(out, ops[op]);
+        _k_emit_str(out, " ");
+        _k_lower_operand(root->children[1], &b, kind, out);
+        _k_emit_str(out, ")");
+
+        return;
+    }
+
+    if (strcmp(root->token->str, "&") == 0) {
+        _k_emit_str(out, "(&");
+        _k_emit_str(out, root->children[0]->token->str);
+        _k_emit_str(out, ")");
+
+        return;
+    }
+
+    _k_value_t child;
+
+    _k_lower_value(root->children[0], &child);
+
+    if (strcmp(root->token->str, "-") == 0) {
+        _k_emit_str(out, child.kind == _K_KIND_INT ? "(long)(0UL - (unsigned long)" : "(-");
+        _k_lower_operand(root->children[0], &child, child.kind, out);
+        _k_emit_str(out, ")");
+
+        return;
+    }
+
+    /* Addresses that are not declared as pointers are cast to one.  */
+    if (child.type[0] != '*') {
+        char ctype[64];
+
+        _k_lower_ctype(v.type, ctype);
+
+        _k_emit_str(out, "(*(");
+        _k_emit_str(out, ctype);
+        _k_emit_str(out, "*)");
+        _k_lower_operand(root->children[0], &child, _K_KIND_INT, out);
+        _k_emit_str(out, ")");
+
+        return;
+    }
+
+    _k_emit_str(out, "(*");
+    _k_lower_expression(root->children[0], out);
+    _k_emit_str(out, ")");
+}
+
+/*
+ *    Lowers a condition to the C test of the branch the IR falls through.
+ *
+ *    Float conditions compare through _k_cmpf, which orders values as
+ *    the interpreter does, a NaN being equal to anything.
+ *
+ *    @param _k_tree_t    *root    The condition.
+ *    @param _k_emitter_t *out     The emitter.
+ */
+void _k_lower_condition(_k_tree_t *root, _k_emitter_t *out) {
+    const char *ops[] = { "<", ">", "<=", ">=", "==", "!=" };
+
+    while (root->token->tokenable->type == _K_TOKEN_TYPE_NEWEXPRESSION && root->child_count == 1) {
+        root = root->children[0];
+    }
+
+    int op = _k_lower_bin_op(root->token->str);
+
+    if (root->token->tokenable->type != _K_TOKEN_TYPE_OPERATOR || root->child_count != 2 || op < 0 || op >= 6) {
+        _k_emit_str(out, "(");
+        _k_lower_expression(root, out);
+        _k_emit_str(out, ") != 0");
+
+        return;
+    }
+
+    _k_tree_t *rhs = root->children[1];
+    _k_value_t a;
+    _k_value_t b;
+    _k_kind_e  kind;
+
+    _k_lower_value(root->children[0], &a);
+    _k_lower_value(rhs, &b);
+
+    /* Literals are compared against the register as it is held.  */
+    if (rhs->token->tokenable->type == _K_TOKEN_TYPE_NUMBER) kind = _k_wide(a.kind);
+    else if (_k_lower_is_float(rhs))                        kind = _K_KIND_FLOAT;
+    else                                                     kind = _k_wide(_k_lower_promote(&a, &b));
+
+    if (a.kind == _K_KIND_UNKNOWN || kind == _K_KIND_UNKNOWN) { _k_lower_failed = 1; return; }
+
+    if (kind == _K_KIND_FLOAT) {
+        _k_emit_str(out, "_k_cmpf(");
+        _k_lower_operand(root->children[0], &a, kind, out);
+        _k_emit_str(out, ", ");
+        _k_lower_operand(rhs, &b, kind, out);
+        _k_emit_str(out, ") ");
+        _k_emit_str(out, ops[op]);
+        _k_emit_str(out, " 0");
+
+        return;
+    }
+
+    _k_lower_operand(root->children[0], &a, kind, out);
+    _k_emit_str(out, " ");
+    _k_emit_str(out, ops[op]);
+    _k_emit_str(out, " ");
+    _k_lower_operand(rhs, &b, kind, out);
+}
+
+/*
+ *    Lowers an assignment.
+ *
+ *    @param _k_tree_t    *root     The assignment.
+ *    @param _k_emitter_t *out      The emitter.
+ *    @param int           depth    The nesting depth.
+ */
+void _k_lower_assignment(_k_tree_t *root, _k_emitter_t *out, int depth) {
+    _k_tree_t *target = root->children[0];
+    _k_value_t v;
+
+    _k_lower_value(target, &v);
+
+    /* Only locals and typed single dereferences are stored to directly.  */
+    int direct = target->token->tokenable->type == _K_TOKEN_TYPE_IDENTIFIER && target->child_count == 0;
+    int deref  = strcmp(target->token->str, "*") == 0 && target->child_count == 1 && target->children[0]->token->tokenable->type == _K_TOKEN_TYPE_IDENTIFIER;
+
+    if (root->child_count != 2 || v.kind == _K_KIND_UNKNOWN || (!direct && !deref)) { _k_lower_failed = 1; return; }
+
+    _k_lower_indent(out, depth);
+    _k_lower_expression(target, out);
+    _k_emit_str(out, " = ");
+    _k_lower_store(root->children[1], v.type, out);
+    _k_emit_str(out, ";\n");
+}
+
+void _k_lower_statement(_k_tree_t *root, _k_emitter_t *out, int depth);
+
+/*
+ *    Lowers the body of a branch or loop as a block.
+ *
+ *    @param _k_tree_t    *root     The keyword.
+ *    @param _k_emitter_t *out      The emitter.
+ *    @param int           depth    The nesting depth.
+ */
+void _k_lower_block(_k_tree_t *root, _k_emitter_t *out, int depth) {
+    if (root->child_count != 2) { _k_lower_failed = 1; return; }
+
+    _k_lower_indent(out, depth);
+    _k_emit_str(out, strcmp(root->token->str, "if") == 0 ? "if (" : "while (");
+    _k_lower_condition(root->children[0], out);
+    _k_emit_str(out, ") {\n");
+    _k_lower_statement(root->children[1], out, depth + 1);
+    _k_lower_indent(out, depth);
+    _k_emit_str(out, "}\n");
+}
+
+/*
+ *    Lowers a statement.
+ *
+ *    @param _k_tree_t    *root     The statement.
+ *    @param _k_emitter_t *out      The emitter.
+ *    @param int           depth    The nesting depth.
+ */
+void _k_lower_statement(_k_tree_t *root, _k_emitter_t *out, int depth) {
+    switch (root->token->tokenable->type) {
+        case _K_TOKEN_TYPE_NEWSTATEMENT: {
+            for (unsigned long i = 0; i < root->child_count; i++) {
+                _k_lower_statement(root->children[i], out, depth);
+            }
+
+            return;
+        }
+        case _K_TOKEN_TYPE_DECLARATOR: {
+            /* Locals are declared at the top of the function.  */
+            if (root->child_count > 1 && root->children[1]->token->tokenable->type == _K_TOKEN_TYPE_IDENTIFIER && root->children[1]->child_count == 0) return;
+
+            if (root->child_count > 1 && strcmp(root->children[1]->token->str, "=") == 0) {
+                _k_lower_assignment(root->children[1], out, depth);
+
+                return;
+            }
+
+            _k_lower_failed = 1;
+
+            return;
+        }
+        case _K_TOKEN_TYPE_KEYWORD: {
+            if (strcmp(root->token->str, "return") == 0) {
+                _k_lower_indent(out, depth);
+
+                if (root->child_count == 0) {
+                    _k_emit_str(out, "return 0;\n");
+
+                    return;
+                }
+
+                _k_value_t v;
+                _k_kind_e  kind = _k_kind_of(_k_lower_func->ret);
+
+                _k_lower_value(root->children[0], &v);
+
+                _k_emit_str(out, "return ");
+
+                if (_k_lower_func->ret[0] == '*') _k_lower_store(root->children[0], _k_lower_func->ret, out);
+                else                              _k_lower_convert(root->children[0], kind, out);
+
+                _k_emit_str(out, ";\n");
+
+                return;
+            }
+
+            if (strcmp(root->token->str, "if") == 0 || strcmp(root->token->str, "while") == 0) {
+                _k_lower_block(root, out, depth);
+
+                return;
+            }
+
+            _k_lower_failed = 1;
+
+            return;
+        }
+        default: break;
+    }
+
+    if (strcmp(root->token->str, "=") == 0) {
+        _k_lower_assignment(root, out, depth);
+
+        return;
+    }
+
+    _k_lower_indent(out, depth);
+    _k_lower_expression(root, out);
+    _k_emit_str(out, ";\n");
+}
+
+/*
+ *    Declares the locals of a function body.
+ *
+ *    KAPPA gives every local one slot for the whole function, so they
+ *    are all hoisted to its top.
+ *
+ *    @param _k_tree_t *root    The body, or a statement within it.
+ */
+void _k_lower_collect(_k_tree_t *root) {
+    if (root->token->tokenable->type == _K_TOKEN_TYPE_DECLARATOR && root->child_count > 1) {
+        _k_tree_t *name = root->children[1];
+        char       type[32];
+
+        if (strcmp(name->token->str, "=") == 0 && name->child_count > 0) name = name->children[0];
+
+        if (name->token->tokenable->type == _K_TOKEN_TYPE_IDENTIFIER) {
+            _k_declared_type(root, type);
+            _k_lower_declare(name->token->str, type);
+        }
+
+        return;
+    }
+
+    for (unsigned long i = 0; i < root->child_count; i++) {
+        _k_lower_collect(root->children[i]);
+    }
+}
+
+/*
+ *    Writes the C prototype of a function.
+ *
+ *    @param _k_prototype_t *func    The function.
+ *    @param _k_emitter_t   *out     The emitter.
+ */
+void _k_lower_prototype(_k_prototype_t *func, _k_emitter_t *out) {
+    char ctype[64];
+
+    _k_lower_ctype(func->ret, ctype);
+
+    _k_emit_str(out, ctype);
+    _k_emit_str(out, " " _K_LOWER_PREFIX);
+    _k_emit_str(out, func->name);
+    _k_emit_str(out, "(");
+
+    for (unsigned long i = 0; i < func->params->child_count; i++) {
+        _k_tree_t *param = func->params->children[i];
+        char       type[32];
+
+        if (param->child_count < 2) { _k_lower_failed = 1; return; }
+
+        _k_declared_type(param, type);
+        _k_lower_ctype(type, ctype);
+
+        if (i > 0) _k_emit_str(out, ", ");
+
+        _k_emit_str(out, ctype);
+        _k_emit_str(out, " ");
+        _k_emit_str(out, param->children[1]->token->str);
+    }
+
+    _k_emit_str(out, func->params->child_count == 0 ? "void)" : ")");
+}
+
+/*
+ *    Lowers a function.
+ *
+ *    @param _k_prototype_t *func    The function.
+ *    @param _k_emitter_t   *out     The emitter.
+ */
+void _k_lower_function(_k_prototype_t *func, _k_emitter_t *out) {
+    _k_lower_func        = func;
+    _k_lower_local_count = 0;
+
+    for (unsigned long i = 0; i < func->params->child_count; i++) {
+        char type[32];
+
+        _k_declared_type(func->params->children[i], type);
+        _k_lower_declare(func->params->children[i]->children[1]->token->str, type);
+    }
+
+    unsigned long params = _k_lower_local_count;
+
+    _k_lower_collect(func->body);
+
+    _k_emit_str(out, "\n");
+    _k_lower_prototype(func, out);
+    _k_emit_str(out, " {\n");
+
+    for (unsigned long i = params; i < _k_lower_local_count; i++) {
+        char ctype[64];
+
+        _k_lower_ctype(_k_lower_locals[i].type, ctype);
+
+        _k_lower_indent(out, 1);
+        _k_emit_str(out, ctype);
+        _k_emit_str(out, " ");
+        _k_emit_str(out, _k_lower_locals[i].name);
+        _k_emit_str(out, " = 0;\n");
+    }
+
+    if (_k_lower_local_count > params) _k_emit_str(out, "\n");
+
+    _k_lower_statement(func->body, out, 1);
+
+    _k_tree_t *last = func->body->child_count > 0 ? func->body->children[func->body->child_count - 1] : (_k_tree_t*)0x0;
+
+    /* Functions that run off their end return nothing in particular.  */
+    if (last == (_k_tree_t*)0x0 || strcmp(last->token->str, "return") != 0) {
+        _k_lower_indent(out, 1);
+        _k_emit_str(out, "return 0;\n");
+    }
+
+    _k_emit_str(out, "}\n");
+}
+
+/*
+ *    Lowers the recorded module to C.
+ *
+ *    Every function is declared up front, then defined. Statements
+ *    outside of functions only run when the interpreter loads the
+ *    module, and are not lowered.
+ *
+ *    @param _k_emitter_t *out    The emitter to write the C source to.
+ *
+ *    @return int    0 on success, 1 if the module uses a construct
+ *                   with no C equivalent, 2 if a function declares a
+ *                   local again with another type.
+ */
+int _k_lower_module(_k_emitter_t *out) {
+    for (unsigned long i = 0; i < _k_lower_tree_count; i++) {
+        _k_tree_t *root = &_k_lower_trees[i];
+
+        if (root->token->tokenable->type != _K_TOKEN_TYPE_DECLARATOR || root->child_count < 2) continue;
+
+        _k_tree_t *name = root->children[1];
+
+        if (name->child_count < 2 || name->children[0]->token->tokenable->type != _K_TOKEN_TYPE_NEWEXPRESSION) continue;
+
+        if (_k_lower_find_func(name->token->str) != (_k_prototype_t*)0x0) return 1;
+
+        _k_lower_funcs = realloc(_k_lower_funcs, sizeof(_k_prototype_t) * (_k_lower_func_count + 1));
+
+        _k_prototype_t *func = &_k_lower_funcs[_k_lower_func_count++];
+
+        func->name   = name->token->str;
+        func->params = name->children[0];
+        func->body   = name->children[1];
+
+        _k_declared_type(root, func->ret);
+    }
+
+    _k_emit_str(out, "/*\n *    Lowered from KAPPA source by k_build_c.\n */\n");
+
+    /* Orders floats as _k_cmprr does, a NaN being neither less nor greater than anything.  */
+    _k_emit_str(out, "static inline int _k_cmpf(double a, double b) { return (a > b) - (a < b); }\n");
+
+    for (unsigned long i = 0; i < _k_lower_func_count; i++) {
+        _k_lower_prototype(&_k_lower_funcs[i], out);
+        _k_emit_str(out, ";\n");
+    }
+
+    for (unsigned long i = 0; i < _k_lower_func_count && !_k_lower_failed; i++) {
+        _k_lower_function(&_k_lower_funcs[i], out);
+    }
+
+    return _k_lower_redeclared ? 2 : _k_lower_failed;
+}
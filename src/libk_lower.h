@@ -0,0 +1,43 @@
+/*
+ *    libk_lower.h    --    Header for the KAPPA to C lowering
+ *
+ *    Authored by Karl "p0lyh3dron" Kreuze on October 18, 2026
+ *
+ *    This file is part of the KAPPA project.
+ *
+ *    This file declares the backend that lowers compiled KAPPA
+ *    source trees to portable C, ahead of time.
+ */
+#ifndef _LIBK_LOWER_H
+#define _LIBK_LOWER_H
+
+#include "types.h"
+#include "libk_emit.h"
+
+/* Lowered functions are named after their KAPPA function, behind this prefix.  */
+#define _K_LOWER_PREFIX "kappa_"
+
+/*
+ *    Resets the lowering state between modules.
+ */
+void _k_lower_reset();
+
+/*
+ *    Records a top level tree of the module to lower.
+ *
+ *    @param _k_tree_t *root    The root of the tree.
+ */
+void _k_lower_tree(_k_tree_t *root);
+
+/*
+ *    Lowers the recorded module to C.
+ *
+ *    @param _k_emitter_t *out    The emitter to write the C source to.
+ *
+ *    @return int    0 on success, 1 if the module uses a construct
+ *                   with no C equivalent, 2 if a function declares a
+ *                   local again with another type.
+ */
+int _k_lower_module(_k_emitter_t *out);
+
+#endif /* _LIBK_LOWER_H  */
@@ -0,0 +1,937 @@
+/*
+ *    libk_x86.c    --    Source for the KAPPA x86-64 target
+ *
+ *    Authored by Karl "p0lyh3dron" Kreuze on October 18, 2026
+ *
+ *    This file is part of the KAPPA project.
+ *
+ *    This file defines the emitter target that translates the IR
+ *    into GNU assembler x86-64 code, so that modules can be linked
+ *    into C programs with no interpreter. The IR is held until the
+ *    module ends and then translated in two passes, the first of
+ *    which collects every function's signature from its .func entry,
+ *    so calls may go to functions defined further on.
+ *
+ *    Every function keeps the IR's registers in 8-byte slots below
+ *    its frame pointer, followed by its variables, laid out as the
+ *    interpreter lays out a frame. Floats are computed with SSE2 at
+ *    double precision, and f32 results rounded through a single, so
+ *    functions give the same results as the interpreter. Functions
+ *    are exported behind the same kappa_ prefix as the C backend,
+ *    taking and returning their native types in System V registers.
+ */
+#include "libk_x86.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libk_lower.h"
+
+/* The IR's registers take the top of every frame.  */
+#define _K_X86_REGS     32
+#define _K_X86_INT_ARGS 6
+#define _K_X86_SSE_ARGS 8
+
+typedef struct {
+    char  name[64];
+    char  ret[32];
+    char  params[_K_X86_INT_ARGS + _K_X86_SSE_ARGS][32];
+    int   param_count;
+} _k_x86_sig_t;
+
+typedef struct {
+    char  name[64];
+    char  type[32];
+    long  disp;
+} _k_x86_var_t;
+
+struct _k_x86_s {
+    char          *ir;
+    unsigned long  ir_len;
+    unsigned long  ir_cap;
+
+    _k_x86_sig_t  *sigs;
+    unsigned long  sig_count;
+    long           func;
+    long           started;
+
+    _k_x86_var_t  *vars;
+    unsigned long  var_count;
+    long           frame;
+
+    long           pops;
+    long           pushes;
+
+    long           loc_line;
+    long           loc_column;
+    int            loc;
+
+    int            file;
+    int            failed;
+};
+
+const char *_k_x86_int_regs[] = { "rdi", "rsi", "rdx", "rcx", "r8", "r9" };
+
+/*
+ *    Writes a line of assembly.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ *    @param const char   *fmt    The format of the line.
+ */
+void _k_x86_emit(_k_emitter_t *out, const char *fmt, ...) {
+    char    buf[256];
+    char   *line = buf;
+    va_list args;
+
+    va_start(args, fmt);
+
+    int n = vsnprintf(buf, sizeof(buf), fmt, args);
+
+    va_end(args);
+
+    if (n < 0) { out->x86->failed = 1; return; }
+
+    /* Lines that do not fit are formatted again whole rather than cut.  */
+    if (n >= (int)sizeof(buf)) {
+        line = malloc(n + 1);
+
+        if (line == (char*)0x0) { out->x86->failed = 1; return; }
+
+        va_start(args, fmt);
+        vsnprintf(line, n + 1, fmt, args);
+        va_end(args);
+    }
+
+    line[n] = '\n';
+
+    _k_emit_bytes(out, line, n + 1);
+
+    if (line != buf) free(line);
+}
+
+/*
+ *    Formats the slot of a register.
+ *
+ *    @param char *buf    The buffer to format into, of at least 32 bytes.
+ *    @param long  reg    The register.
+ *
+ *    @return const char *    The slot.
+ */
+const char *_k_x86_reg(char *buf, long reg) {
+    snprintf(buf, 32, "%ld(%%rbp)", -8 * (reg + 1));
+
+    return buf;
+}
+
+/*
+ *    Parses a register operand.
+ *
+ *    @param const char *arg    The operand.
+ *
+ *    @return long    The register, or -1 if the operand is not one.
+ */
+long _k_x86_parse_reg(const char *arg) {
+    if (arg == (const char*)0x0 || arg[0] != 'r' || arg[1] < '0' || arg[1] > '9') return -1;
+
+    long reg = atol(arg + 1);
+
+    return reg < _K_X86_REGS ? reg : -1;
+}
+
+/*
+ *    Gets the size a variable of a type takes in the frame.
+ *
+ *    @param const char *type    The type.
+ *
+ *    @return long    The size.
+ */
+long _k_x86_size(const char *type) {
+    long len = strlen(type);
+
+    return (type[0] == 'u' || type[0] == 'f') && len > 2 && strcmp(type + len - 2, "32") == 0 ? 4 : 8;
+}
+
+/*
+ *    Finds the signature of a function of the module.
+ *
+ *    @param struct _k_x86_s *x86     The target.
+ *    @param const char      *name    The name of the function.
+ *
+ *    @return _k_x86_sig_t *    The signature, or null if it is not yet known.
+ */
+_k_x86_sig_t *_k_x86_find_sig(struct _k_x86_s *x86, const char *name) {
+    for (unsigned long i = 0; i < x86->sig_count; i++) {
+        if (strcmp(x86->sigs[i].name, name) == 0) return &x86->sigs[i];
+    }
+
+    return (_k_x86_sig_t*)0x0;
+}
+
+/*
+ *    Finds a variable of the current function.
+ *
+ *    @param struct _k_x86_s *x86     The target.
+ *    @param const char      *name    The name of the variable.
+ *
+ *    @return _k_x86_var_t *    The variable, or null if it is not declared.
+ */
+_k_x86_var_t *_k_x86_find_var(struct _k_x86_s *x86, const char *name) {
+    for (unsigned long i = 0; name != (const char*)0x0 && i < x86->var_count; i++) {
+        if (strcmp(x86->vars[i].name, name) == 0) return &x86->vars[i];
+    }
+
+    return (_k_x86_var_t*)0x0;
+}
+
+/*
+ *    Gets the register a parameter is passed in.
+ *
+ *    @param _k_x86_sig_t *sig      The signature.
+ *    @param int           param    The parameter.
+ *    @param char         *buf      The buffer to write the register to.
+ *
+ *    @return int    1 if the parameter is passed in an SSE register.
+ */
+int _k_x86_param_reg(_k_x86_sig_t *sig, int param, char *buf) {
+    int ints = 0;
+    int sses = 0;
+
+    for (int i = 0; i < param; i++) {
+        if (sig->params[i][0] == 'f') sses++;
+        else                          ints++;
+    }
+
+    if (sig->params[param][0] == 'f') {
+        snprintf(buf, 16, "xmm%d", sses);
+
+        return 1;
+    }
+
+    snprintf(buf, 16, "%s", _k_x86_int_regs[ints]);
+
+    return 0;
+}
+
+/*
+ *    Ends the current function, sizing its frame.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ */
+void _k_x86_end_func(_k_emitter_t *out) {
+    struct _k_x86_s *x86 = out->x86;
+
+    if (x86->func < 0) return;
+
+    _k_x86_emit(out, "\t.set .Lframe%ld, %ld", x86->func, (8 * _K_X86_REGS + x86->frame + 15) & ~15L);
+    _k_x86_emit(out, "\t.size " _K_LOWER_PREFIX "%s, .-" _K_LOWER_PREFIX "%s", x86->sigs[x86->func].name, x86->sigs[x86->func].name);
+
+    x86->func = -1;
+}
+
+/*
+ *    Starts translating an emitter's output to x86-64.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ */
+void _k_x86_open(_k_emitter_t *out) {
+    out->x86 = calloc(1, sizeof(struct _k_x86_s));
+
+    if (out->x86 == (struct _k_x86_s*)0x0) { out->error = 1; return; }
+
+    out->x86->func = -1;
+
+    _k_x86_emit(out, "\t.text");
+}
+
+/*
+ *    Collects the signature of a function from its .func entry.
+ *
+ *    @param struct _k_x86_s *x86     The target.
+ *    @param const char      *line    The entry, naming the function, its return type and its parameter types.
+ */
+void _k_x86_sig(struct _k_x86_s *x86, const char *line) {
+    int           ints = 0;
+    int           sses = 0;
+    const char   *p    = line + strcspn(line, " \t");
+
+    x86->sigs = realloc(x86->sigs, sizeof(_k_x86_sig_t) * (x86->sig_count + 1));
+
+    if (x86->sigs == (_k_x86_sig_t*)0x0) { x86->sig_count = 0; x86->failed = 1; return; }
+
+    _k_x86_sig_t *sig      = &x86->sigs[x86->sig_count];
+    char         *field[2] = { sig->name, sig->ret };
+
+    memset(sig, 0, sizeof(_k_x86_sig_t));
+
+    /* Names and types too long for the signature would be cut, and are refused instead.  */
+    for (int i = 0; i < 2; i++) {
+        p += strspn(p, " \t");
+
+        unsigned long len = strcspn(p, " \t");
+
+        if (len == 0 || len >= (i == 0 ? sizeof(sig->name) : sizeof(sig->ret))) { x86->failed = 1; return; }
+
+        memcpy(field[i], p, len);
+
+        p += len;
+    }
+
+    if (_k_x86_find_sig(x86, sig->name) != (_k_x86_sig_t*)0x0) { x86->failed = 1; return; }
+
+    for (p += strspn(p, " \t"); *p != '\0'; p += strspn(p, " \t")) {
+        unsigned long len = strcspn(p, " \t");
+
+        /* Parameters past the argument registers would be passed on the stack.  */
+        if (sig->param_count == _K_X86_INT_ARGS + _K_X86_SSE_ARGS || len >= sizeof(sig->params[0])) { x86->failed = 1; return; }
+
+        memcpy(sig->params[sig->param_count], p, len);
+
+        if (p[0] == 'f') sses++;
+        else             ints++;
+
+        sig->param_count++;
+
+        p += len;
+    }
+
+    if (ints > _K_X86_INT_ARGS || sses > _K_X86_SSE_ARGS) { x86->failed = 1; return; }
+
+    x86->sig_count++;
+}
+
+/*
+ *    Writes the line table entry for the code that follows, if one is
+ *    waiting.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ */
+void _k_x86_loc(_k_emitter_t *out) {
+    struct _k_x86_s *x86 = out->x86;
+
+    if (x86->loc && x86->file) _k_x86_emit(out, "\t.loc 1 %ld %ld", x86->loc_line, x86->loc_column);
+
+    x86->loc = 0;
+}
+
+/*
+ *    Starts the next function, whose signature was collected already.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ */
+void _k_x86_start(_k_emitter_t *out) {
+    struct _k_x86_s *x86 = out->x86;
+
+    _k_x86_end_func(out);
+
+    if (x86->started >= (long)x86->sig_count) { x86->failed = 1; return; }
+
+    const char *name = x86->sigs[x86->started].name;
+
+    x86->func      = x86->started++;
+    x86->var_count = 0;
+    x86->frame     = 0;
+    x86->pops      = 0;
+    x86->pushes    = 0;
+
+    _k_x86_emit(out, "");
+    _k_x86_emit(out, "\t.globl " _K_LOWER_PREFIX "%s", name);
+    _k_x86_emit(out, "\t.type " _K_LOWER_PREFIX "%s, @function", name);
+    _k_x86_emit(out, _K_LOWER_PREFIX "%s:", name);
+
+    /* The function's entry came before its label, and belongs past it.  */
+    _k_x86_loc(out);
+
+    _k_x86_emit(out, "\tpushq %%rbp");
+    _k_x86_emit(out, "\tmovq %%rsp, %%rbp");
+    _k_x86_emit(out, "\tsubq $.Lframe%ld, %%rsp", x86->func);
+}
+
+/*
+ *    Declares a variable of the current function.
+ *
+ *    @param struct _k_x86_s *x86     The target.
+ *    @param const char      *type    The type of the variable.
+ *    @param const char      *name    The name of the variable.
+ */
+void _k_x86_declare(struct _k_x86_s *x86, const char *type, const char *name) {
+    if (type == (const char*)0x0 || name == (const char*)0x0) { x86->failed = 1; return; }
+
+    if (_k_x86_find_var(x86, name) != (_k_x86_var_t*)0x0) return;
+
+    long size   = _k_x86_size(type);
+    long offset = (x86->frame + size - 1) & ~(size - 1);
+
+    /* Names and types too long for a variable would be cut, and are refused instead.  */
+    if (strlen(name) >= sizeof(((_k_x86_var_t*)0x0)->name) || strlen(type) >= sizeof(((_k_x86_var_t*)0x0)->type)) { x86->failed = 1; return; }
+
+    x86->vars = realloc(x86->vars, sizeof(_k_x86_var_t) * (x86->var_count + 1));
+
+    if (x86->vars == (_k_x86_var_t*)0x0) { x86->var_count = 0; x86->failed = 1; return; }
+
+    _k_x86_var_t *var = &x86->vars[x86->var_count++];
+
+    snprintf(var->name, sizeof(var->name), "%s", name);
+    snprintf(var->type, sizeof(var->type), "%s", type);
+
+    var->disp  = -(8 * _K_X86_REGS + offset + size);
+    x86->frame = offset + size;
+}
+
+/*
+ *    Loads a float operand into an SSE register.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ *    @param const char   *arg    The register or number operand.
+ *    @param int           sse    The SSE register to load into.
+ */
+void _k_x86_load_float(_k_emitter_t *out, const char *arg, int sse) {
+    char   buf[32];
+    long   reg = _k_x86_parse_reg(arg);
+    double num = arg != (const char*)0x0 ? atof(arg) : 0.0;
+    long   bits;
+
+    if (reg >= 0) {
+        _k_x86_emit(out, "\tmovsd %s, %%xmm%d", _k_x86_reg(buf, reg), sse);
+
+        return;
+    }
+
+    memcpy(&bits, &num, sizeof(long));
+
+    _k_x86_emit(out, "\tmovabsq $%ld, %%rax", bits);
+    _k_x86_emit(out, "\tmovq %%rax, %%xmm%d", sse);
+}
+
+/*
+ *    Translates a conditional jump.
+ *
+ *    Integer forms compare signed, float forms compare at double
+ *    precision and take a NaN as equal to anything, as in the interpreter.
+ *
+ *    @param _k_emitter_t *out      The emitter.
+ *    @param const char   *cond     The condition: lt, gt, le, ge, eq or ne.
+ *    @param int           real     1 if the operands are floats.
+ *    @param char        **args     The operands and the label.
+ */
+void _k_x86_jump(_k_emitter_t *out, const char *cond, int real, char **args) {
+    struct _k_x86_s *x86 = out->x86;
+    char             buf[32];
+    long             a   = _k_x86_parse_reg(args[0]);
+    long             b   = _k_x86_parse_reg(args[1]);
+
+    if (a < 0 || args[1] == (char*)0x0 || args[2] == (char*)0x0 || args[2][0] != 'S') { x86->failed = 1; return; }
+
+    const char *label = args[2] + 1;
+
+    if (!real) {
+        const char *jcc[] = { "lt", "jl", "gt", "jg", "le", "jle", "ge", "jge", "eq", "je", "ne", "jne" };
+
+        _k_x86_emit(out, "\tmovq %s, %%rax", _k_x86_reg(buf, a));
+
+        if (b >= 0) {
+            _k_x86_emit(out, "\tcmpq %s, %%rax", _k_x86_reg(buf, b));
+        } else {
+            _k_x86_emit(out, "\tmovabsq $%ld, %%rcx", atol(args[1]));
+            _k_x86_emit(out, "\tcmpq %%rcx, %%rax");
+        }
+
+        for (int i = 0; i < 12; i += 2) {
+            if (strcmp(cond, jcc[i]) == 0) _k_x86_emit(out, "\t%s .LS%s", jcc[i + 1], label);
+        }
+
+        return;
+    }
+
+    /* Unordered operands compare equal, as in the interpreter: lt and ge swap the operands to test above or below-or-equal.  */
+    int swap = strcmp(cond, "lt") == 0 || strcmp(cond, "ge") == 0;
+
+    _k_x86_load_float(out, args[0], swap ? 1 : 0);
+    _k_x86_load_float(out, args[1], swap ? 0 : 1);
+
+    _k_x86_emit(out, "\tucomisd %%xmm1, %%xmm0");
+
+    if (strcmp(cond, "lt") == 0 || strcmp(cond, "gt") == 0) _k_x86_emit(out, "\tja .LS%s", label);
+    if (strcmp(cond, "le") == 0 || strcmp(cond, "ge") == 0) _k_x86_emit(out, "\tjbe .LS%s", label);
+    if (strcmp(cond, "eq") == 0)                            _k_x86_emit(out, "\tje .LS%s", label);
+    if (strcmp(cond, "ne") == 0)                            _k_x86_emit(out, "\tjne .LS%s", label);
+}
+
+/*
+ *    Translates an arithmetic or comparison instruction on three registers.
+ *
+ *    @param _k_emitter_t *out       The emitter.
+ *    @param const char   *op        The operation.
+ *    @param const char   *suffix    The operand suffix: ii, ff, ww or ss.
+ *    @param long         *regs      The registers.
+ *
+ *    @return int    1 if the instruction was translated.
+ */
+int _k_x86_arith(_k_emitter_t *out, const char *op, const char *suffix, long *regs) {
+    const char *ops[]   = { "add",  "sub",  "mul",   "div",  "les", "gre", "leq", "geq", "equ", "neq" };
+    const char *ints[]  = { "addq", "subq", "imulq", "",     "l",   "g",   "le",  "ge",  "e",   "ne" };
+    const char *reals[] = { "addsd", "subsd", "mulsd", "divsd" };
+    char        a[32];
+    char        b[32];
+    char        c[32];
+    int         i;
+
+    for (i = 0; i < 10 && strncmp(op, ops[i], 3) != 0; i++);
+
+    if (i == 10 || regs[0] < 0 || regs[1] < 0 || regs[2] < 0) return 0;
+
+    int real = suffix[0] == 'f' || suffix[0] == 's';
+
+    _k_x86_reg(a, regs[0]);
+    _k_x86_reg(b, regs[1]);
+    _k_x86_reg(c, regs[2]);
+
+    if (i >= 4 && real) {
+        /* Comparisons set a 0 or 1 integer, unordered operands comparing equal as in jumps.  */
+        int swap = i == 4 || i == 7;
+
+        _k_x86_emit(out, "\tmovsd %s, %%xmm0", swap ? c : b);
+        _k_x86_emit(out, "\tucomisd %s, %%xmm0", swap ? b : c);
+
+        if (i == 4 || i == 5) _k_x86_emit(out, "\tseta %%al");
+        if (i == 6 || i == 7) _k_x86_emit(out, "\tsetbe %%al");
+        if (i == 8)           _k_x86_emit(out, "\tsete %%al");
+        if (i == 9)           _k_x86_emit(out, "\tsetne %%al");
+
+        _k_x86_emit(out, "\tmovzbq %%al, %%rax");
+        _k_x86_emit(out, "\tmovq %%rax, %s", a);
+
+        return 1;
+    }
+
+    if (i >= 4) {
+        _k_x86_emit(out, "\tmovq %s, %%rax", b);
+        _k_x86_emit(out, "\tcmpq %s, %%rax", c);
+        _k_x86_emit(out, "\tset%s %%al", ints[i]);
+        _k_x86_emit(out, "\tmovzbq %%al, %%rax");
+        _k_x86_emit(out, "\tmovq %%rax, %s", a);
+
+        return 1;
+    }
+
+    if (real) {
+        _k_x86_emit(out, "\tmovsd %s, %%xmm0", b);
+        _k_x86_emit(out, "\t%s %s, %%xmm0", reals[i], c);
+
+        /* Singles are rounded after every operation.  */
+        if (suffix[0] == 's') {
+            _k_x86_emit(out, "\tcvtsd2ss %%xmm0, %%xmm0");
+            _k_x86_emit(out, "\tcvtss2sd %%xmm0, %%xmm0");
+        }
+
+        _k_x86_emit(out, "\tmovsd %%xmm0, %s", a);
+
+        return 1;
+    }
+
+    _k_x86_emit(out, "\tmovq %s, %%rax", b);
+
+    if (i == 3) {
+        _k_x86_emit(out, "\tcqto");
+        _k_x86_emit(out, "\tidivq %s", c);
+    } else {
+        _k_x86_emit(out, "\t%s %s, %%rax", ints[i], c);
+    }
+
+    /* Words wrap to 32 bits.  */
+    if (suffix[0] == 'w') _k_x86_emit(out, "\tmovl %%eax, %%eax");
+
+    _k_x86_emit(out, "\tmovq %%rax, %s", a);
+
+    return 1;
+}
+
+/*
+ *    Translates a call to a function of the module.
+ *
+ *    The arguments the IR pushed are popped into the registers the
+ *    callee takes them in, and its result is left in r0 as the IR
+ *    holds it.
+ *
+ *    @param _k_emitter_t *out     The emitter.
+ *    @param const char   *name    The function.
+ */
+void _k_x86_call(_k_emitter_t *out, const char *name) {
+    struct _k_x86_s *x86 = out->x86;
+    _k_x86_sig_t    *sig = name != (const char*)0x0 ? _k_x86_find_sig(x86, name) : (_k_x86_sig_t*)0x0;
+    char             buf[32];
+    char             reg[16];
+
+    if (sig == (_k_x86_sig_t*)0x0 || sig->param_count > x86->pushes) { x86->failed = 1; return; }
+
+    for (int i = sig->param_count - 1; i >= 0; i--) {
+        if (!_k_x86_param_reg(sig, i, reg)) { _k_x86_emit(out, "\tpopq %%%s", reg); continue; }
+
+        _k_x86_emit(out, "\tpopq %%rax");
+        _k_x86_emit(out, "\tmovq %%rax, %%%s", reg);
+
+        if (strcmp(sig->params[i], "f32") == 0) _k_x86_emit(out, "\tcvtsd2ss %%%s, %%%s", reg, reg);
+    }
+
+    x86->pushes -= sig->param_count;
+
+    /* Arguments still pushed for an outer call would misalign the stack.  */
+    if (x86->pushes % 2) _k_x86_emit(out, "\tsubq $8, %%rsp");
+
+    _k_x86_emit(out, "\tcall " _K_LOWER_PREFIX "%s@PLT", name);
+
+    if (x86->pushes % 2) _k_x86_emit(out, "\taddq $8, %%rsp");
+
+    _k_x86_reg(buf, 0);
+
+    if (strcmp(sig->ret, "f32") == 0) {
+        _k_x86_emit(out, "\tcvtss2sd %%xmm0, %%xmm0");
+        _k_x86_emit(out, "\tmovsd %%xmm0, %s", buf);
+    } else if (sig->ret[0] == 'f') {
+        _k_x86_emit(out, "\tmovsd %%xmm0, %s", buf);
+    } else if (strcmp(sig->ret, "u32") == 0) {
+        _k_x86_emit(out, "\tmovl %%eax, %%eax");
+        _k_x86_emit(out, "\tmovq %%rax, %s", buf);
+    } else {
+        _k_x86_emit(out, "\tmovq %%rax, %s", buf);
+    }
+}
+
+/*
+ *    Translates a function's return.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ */
+void _k_x86_return(_k_emitter_t *out) {
+    struct _k_x86_s *x86 = out->x86;
+    _k_x86_sig_t    *sig = &x86->sigs[x86->func];
+    char             buf[32];
+
+    _k_x86_reg(buf, 0);
+
+    if (sig->ret[0] == 'f') {
+        _k_x86_emit(out, "\tmovsd %s, %%xmm0", buf);
+
+        if (strcmp(sig->ret, "f32") == 0) _k_x86_emit(out, "\tcvtsd2ss %%xmm0, %%xmm0");
+    } else {
+        _k_x86_emit(out, "\tmovq %s, %%rax", buf);
+    }
+
+    _k_x86_emit(out, "\tleave");
+    _k_x86_emit(out, "\tret");
+}
+
+/*
+ *    Translates an instruction.
+ *
+ *    @param _k_emitter_t *out     The emitter.
+ *    @param char         *op      The mnemonic.
+ *    @param char        **args    The operands, null past the last.
+ */
+void _k_x86_inst(_k_emitter_t *out, char *op, char **args) {
+    struct _k_x86_s *x86 = out->x86;
+    long             regs[3];
+    char             a[32];
+    char             b[32];
+    unsigned long    len = strlen(op);
+
+    for (int i = 0; i < 3; i++) regs[i] = _k_x86_parse_reg(args[i]);
+
+    if (len != 5) { x86->failed = 1; return; }
+
+    const char *suffix = op + 3;
+
+    if (regs[0] >= 0) _k_x86_reg(a, regs[0]);
+    if (regs[1] >= 0) _k_x86_reg(b, regs[1]);
+
+    if (strcmp(op, "newsv") == 0) { _k_x86_declare(x86, args[0], args[1]); return; }
+
+    if (strcmp(op, "poprr") == 0 && regs[0] >= 0 && x86->pops < x86->sigs[x86->func].param_count) {
+        _k_x86_sig_t *sig   = &x86->sigs[x86->func];
+        int           param = sig->param_count - 1 - x86->pops++;
+        char          reg[16];
+
+        /* Arguments are held in registers as the interpreter holds them.  */
+        if (_k_x86_param_reg(sig, param, reg)) {
+            if (strcmp(sig->params[param], "f32") == 0) _k_x86_emit(out, "\tcvtss2sd %%%s, %%%s", reg, reg);
+
+            _k_x86_emit(out, "\tmovsd %%%s, %s", reg, a);
+        } else {
+            _k_x86_emit(out, "\tmovq %%%s, %s", reg, a);
+        }
+
+        return;
+    }
+
+    if (strcmp(op, "pushr") == 0 && regs[0] >= 0) { _k_x86_emit(out, "\tpushq %s", a); x86->pushes++; return; }
+    if (strcmp(op, "callf") == 0)                 { _k_x86_call(out, args[0]); return; }
+    if (strcmp(op, "leave") == 0)                 { _k_x86_return(out); return; }
+
+    if (strcmp(op, "jmpal") == 0 && args[0] != (char*)0x0 && args[0][0] == 'S') { _k_x86_emit(out, "\tjmp .LS%s", args[0] + 1); return; }
+    if (strcmp(op, "jmpeq") == 0 && args[0] != (char*)0x0 && args[0][0] == 'S') { _k_x86_emit(out, "\tje .LS%s", args[0] + 1); return; }
+
+    if (op[0] == 'j' && (strcmp(suffix, "ii") == 0 || strcmp(suffix, "in") == 0)) { _k_x86_jump(out, (char[3]){ op[1], op[2], 0 }, 0, args); return; }
+    if (op[0] == 'j' && (strcmp(suffix, "ff") == 0 || strcmp(suffix, "fn") == 0)) { _k_x86_jump(out, (char[3]){ op[1], op[2], 0 }, 1, args); return; }
+
+    if (strcmp(op, "loadr") == 0 || strcmp(op, "saver") == 0 || strcmp(op, "refsv") == 0) {
+        int           save = op[0] == 's';
+        _k_x86_var_t *var  = _k_x86_find_var(x86, save ? args[0] : args[1]);
+        long          reg  = save ? regs[1] : regs[0];
+
+        if (var == (_k_x86_var_t*)0x0 || reg < 0) { x86->failed = 1; return; }
+
+        long size = _k_x86_size(var->type);
+        int  real = var->type[0] == 'f';
+
+        _k_x86_reg(a, reg);
+
+        if (op[0] == 'r') {
+            _k_x86_emit(out, "\tleaq %ld(%%rbp), %%rax", var->disp);
+            _k_x86_emit(out, "\tmovq %%rax, %s", a);
+        } else if (save && size == 4 && real) {
+            _k_x86_emit(out, "\tcvtsd2ss %s, %%xmm0", a);
+            _k_x86_emit(out, "\tmovss %%xmm0, %ld(%%rbp)", var->disp);
+        } else if (save) {
+            _k_x86_emit(out, "\tmovq %s, %%rax", a);
+            _k_x86_emit(out, size == 4 ? "\tmovl %%eax, %ld(%%rbp)" : "\tmovq %%rax, %ld(%%rbp)", var->disp);
+        } else if (size == 4 && real) {
+            _k_x86_emit(out, "\tcvtss2sd %ld(%%rbp), %%xmm0", var->disp);
+            _k_x86_emit(out, "\tmovsd %%xmm0, %s", a);
+        } else {
+            _k_x86_emit(out, size == 4 ? "\tmovl %ld(%%rbp), %%eax" : "\tmovq %ld(%%rbp), %%rax", var->disp);
+            _k_x86_emit(out, "\tmovq %%rax, %s", a);
+        }
+
+        return;
+    }
+
+    if (strcmp(op, "movrn") == 0 && regs[0] >= 0 && args[1] != (char*)0x0) {
+        _k_x86_emit(out, "\tmovabsq $%ld, %%rax", atol(args[1]));
+        _k_x86_emit(out, "\tmovq %%rax, %s", a);
+
+        return;
+    }
+
+    if (strcmp(op, "movrf") == 0 && regs[0] >= 0 && args[1] != (char*)0x0) {
+        _k_x86_load_float(out, args[1], 0);
+        _k_x86_emit(out, "\tmovsd %%xmm0, %s", a);
+
+        return;
+    }
+
+    if (strcmp(op, "cmprd") == 0 && regs[0] >= 0 && args[1] != (char*)0x0) {
+        _k_x86_emit(out, "\tmovabsq $%ld, %%rax", atol(args[1]));
+        _k_x86_emit(out, "\tcmpq %%rax, %s", a);
+
+        return;
+    }
+
+    if (regs[0] < 0 || regs[1] < 0) { x86->failed = 1; return; }
+
+    if (regs[2] >= 0 && (strcmp(suffix, "ii") == 0 || strcmp(suffix, "ff") == 0 || strcmp(suffix, "ww") == 0 || strcmp(suffix, "ss") == 0)) {
+        if (!_k_x86_arith(out, op, suffix, regs)) x86->failed = 1;
+
+        return;
+    }
+
+    /* Conversions and accesses through addresses, on two registers.  */
+    if (strcmp(op, "movrr") == 0) {
+        _k_x86_emit(out, "\tmovq %s, %%rax", b);
+        _k_x86_emit(out, "\tmovq %%rax, %s", a);
+    } else if (strcmp(op, "negii") == 0 || strcmp(op, "negww") == 0) {
+        _k_x86_emit(out, "\tmovq %s, %%rax", b);
+        _k_x86_emit(out, "\tnegq %%rax");
+
+        if (op[3] == 'w') _k_x86_emit(out, "\tmovl %%eax, %%eax");
+
+        _k_x86_emit(out, "\tmovq %%rax, %s", a);
+    } else if (strcmp(op, "negff") == 0) {
+        _k_x86_emit(out, "\tmovq %s, %%rax", b);
+        _k_x86_emit(out, "\tbtcq $63, %%rax");
+        _k_x86_emit(out, "\tmovq %%rax, %s", a);
+    } else if (strcmp(op, "itofr") == 0) {
+        _k_x86_emit(out, "\tcvtsi2sdq %s, %%xmm0", b);
+        _k_x86_emit(out, "\tmovsd %%xmm0, %s", a);
+    } else if (strcmp(op, "ftoir") == 0) {
+        _k_x86_emit(out, "\tcvttsd2siq %s, %%rax", b);
+        _k_x86_emit(out, "\tmovq %%rax, %s", a);
+    } else if (strcmp(op, "itowr") == 0) {
+        _k_x86_emit(out, "\tmovl %s, %%eax", b);
+        _k_x86_emit(out, "\tmovq %%rax, %s", a);
+    } else if (strcmp(op, "ftosr") == 0) {
+        _k_x86_emit(out, "\tcvtsd2ss %s, %%xmm0", b);
+        _k_x86_emit(out, "\tcvtss2sd %%xmm0, %%xmm0");
+        _k_x86_emit(out, "\tmovsd %%xmm0, %s", a);
+    } else if (strncmp(op, "der", 3) == 0 && strcmp(suffix, "ss") == 0) {
+        _k_x86_emit(out, "\tmovq %s, %%rax", b);
+        _k_x86_emit(out, "\tcvtss2sd (%%rax), %%xmm0");
+        _k_x86_emit(out, "\tmovsd %%xmm0, %s", a);
+    } else if (strncmp(op, "der", 3) == 0 && (strcmp(suffix, "ii") == 0 || strcmp(suffix, "ff") == 0 || strcmp(suffix, "ww") == 0)) {
+        _k_x86_emit(out, "\tmovq %s, %%rax", b);
+        _k_x86_emit(out, suffix[0] == 'w' ? "\tmovl (%%rax), %%eax" : "\tmovq (%%rax), %%rax");
+        _k_x86_emit(out, "\tmovq %%rax, %s", a);
+    } else if (strncmp(op, "sav", 3) == 0 && strcmp(suffix, "ss") == 0) {
+        _k_x86_emit(out, "\tmovq %s, %%rax", a);
+        _k_x86_emit(out, "\tcvtsd2ss %s, %%xmm0", b);
+        _k_x86_emit(out, "\tmovss %%xmm0, (%%rax)");
+    } else if (strncmp(op, "sav", 3) == 0 && (strcmp(suffix, "ii") == 0 || strcmp(suffix, "ff") == 0 || strcmp(suffix, "ww") == 0)) {
+        _k_x86_emit(out, "\tmovq %s, %%rax", a);
+        _k_x86_emit(out, "\tmovq %s, %%rcx", b);
+        _k_x86_emit(out, suffix[0] == 'w' ? "\tmovl %%ecx, (%%rax)" : "\tmovq %%rcx, (%%rax)");
+    } else {
+        /* Untyped instructions depend on the kinds the interpreter tracks at runtime.  */
+        x86->failed = 1;
+    }
+}
+
+/*
+ *    Translates a line of IR.
+ *
+ *    Instructions outside of functions only run when the interpreter
+ *    loads the module, and are dropped. Line table entries wait for
+ *    the code they cover, so an entry ahead of a function lands past
+ *    its label.
+ *
+ *    @param _k_emitter_t *out     The emitter.
+ *    @param char         *line    The line, without its newline.
+ */
+void _k_x86_line(_k_emitter_t *out, char *line) {
+    struct _k_x86_s *x86 = out->x86;
+    char            *args[4] = { (char*)0x0, (char*)0x0, (char*)0x0, (char*)0x0 };
+    char            *save;
+
+    char *op = strtok_r(line, " \t", &save);
+
+    if (op == (char*)0x0 || x86->failed) return;
+
+    for (int i = 0; i < 4; i++) {
+        if ((args[i] = strtok_r((char*)0x0, " \t", &save)) == (char*)0x0) break;
+    }
+
+    if (strcmp(op, ".file:") == 0) {
+        if (args[0] != (char*)0x0) _k_x86_emit(out, "\t.file 1 \"%s\"", args[0]);
+
+        x86->file = args[0] != (char*)0x0;
+
+        return;
+    }
+
+    if (strcmp(op, ".line:") == 0) {
+        x86->loc        = args[1] != (char*)0x0;
+        x86->loc_line   = x86->loc ? atol(args[0]) : 0;
+        x86->loc_column = x86->loc ? atol(args[1]) : 0;
+
+        return;
+    }
+
+    if (strcmp(op, ".func:") == 0) { _k_x86_start(out); return; }
+
+    if (x86->func < 0) {
+        /* Named labels outside of functions start types, which have no layout here.  */
+        if (line[0] != '\t' && line[0] != '.' && line[0] != 'S') x86->failed = 1;
+
+        return;
+    }
+
+    unsigned long len = strlen(op);
+
+    if (op[len - 1] != ':') { x86->failed = 1; return; }
+
+    op[len - 1] = '\0';
+
+    /* The function's own label was written as it started.  */
+    if (line[0] != '\t' && strcmp(op, x86->sigs[x86->func].name) == 0) return;
+
+    _k_x86_loc(out);
+
+    if (line[0] != '\t') {
+        if (op[0] == 'S') _k_x86_emit(out, ".LS%s:", op + 1);
+        else              x86->failed = 1;
+
+        return;
+    }
+
+    _k_x86_inst(out, op, args);
+}
+
+/*
+ *    Holds IR written to the emitter until the module ends.
+ *
+ *    @param _k_emitter_t  *out     The emitter.
+ *    @param const char    *data    The bytes written.
+ *    @param unsigned long  n       The number of bytes.
+ */
+void _k_x86_write(_k_emitter_t *out, const char *data, unsigned long n) {
+    struct _k_x86_s *x86 = out->x86;
+
+    if (x86->failed) return;
+
+    /* Keep a byte free for the terminator.  */
+    if (x86->ir_len + n + 1 > x86->ir_cap) {
+        unsigned long cap = x86->ir_cap ? x86->ir_cap : 0x1000;
+
+        while (x86->ir_len + n + 1 > cap) cap *= 2;
+
+        char *ir = realloc(x86->ir, cap);
+
+        if (ir == (char*)0x0) { x86->failed = 1; return; }
+
+        x86->ir     = ir;
+        x86->ir_cap = cap;
+    }
+
+    memcpy(x86->ir + x86->ir_len, data, n);
+
+    x86->ir_len += n;
+}
+
+/*
+ *    Ends the module, translating the IR held for it, and stops
+ *    translating.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ *
+ *    @return int    0 on success, 1 if the module used an instruction
+ *                   with no x86-64 translation.
+ */
+int _k_x86_close(_k_emitter_t *out) {
+    struct _k_x86_s *x86 = out->x86;
+
+    if (x86 == (struct _k_x86_s*)0x0) return 0;
+
+    if (x86->ir != (char*)0x0) {
+        char *end = x86->ir + x86->ir_len;
+
+        *end = '\0';
+
+        for (char *p = x86->ir; (p = strchr(p, '\n')) != (char*)0x0; ) *p++ = '\0';
+
+        /* Every signature is known before any call is translated.  */
+        for (char *p = x86->ir; p < end && !x86->failed; p += strlen(p) + 1) {
+            if (strncmp(p, ".func:", 6) == 0) _k_x86_sig(x86, p);
+        }
+
+        /* Translating a line splits it up, so the next one is found first.  */
+        for (char *p = x86->ir, *next; p < end && !x86->failed; p = next) {
+            next = p + strlen(p) + 1;
+
+            _k_x86_line(out, p);
+        }
+    }
+
+    _k_x86_end_func(out);
+
+    _k_x86_emit(out, "\t.section .note.GNU-stack,\"\",@progbits");
+
+    int failed = x86->failed;
+
+    free(x86->ir);
+    free(x86->sigs);
+    free(x86->vars);
+    free(x86);
+
+    out->x86 = (struct _k_x86_s*)0x0;
+
+    return failed;
+}
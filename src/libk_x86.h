@@ -0,0 +1,44 @@
+/*
+ *    libk_x86.h    --    Header for the KAPPA x86-64 target
+ *
+ *    Authored by Karl "p0lyh3dron" Kreuze on October 18, 2026
+ *
+ *    This file is part of the KAPPA project.
+ *
+ *    This file declares the emitter target that translates the IR
+ *    the assembler emits into GNU assembler x86-64 code, following
+ *    the System V calling convention.
+ */
+#ifndef _LIBK_X86_H
+#define _LIBK_X86_H
+
+#include "libk_emit.h"
+
+/*
+ *    Starts translating an emitter's output to x86-64.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ */
+void _k_x86_open(_k_emitter_t *out);
+
+/*
+ *    Holds IR written to the emitter until the module ends.
+ *
+ *    @param _k_emitter_t  *out     The emitter.
+ *    @param const char    *data    The bytes written.
+ *    @param unsigned long  n       The number of bytes.
+ */
+void _k_x86_write(_k_emitter_t *out, const char *data, unsigned long n);
+
+/*
+ *    Ends the module, translating the IR held for it, and stops
+ *    translating.
+ *
+ *    @param _k_emitter_t *out    The emitter.
+ *
+ *    @return int    0 on success, 1 if the module used an instruction
+ *                   with no x86-64 translation.
+ */
+int _k_x86_close(_k_emitter_t *out);
+
+#endif /* _LIBK_X86_H  */